@@ -0,0 +1,601 @@
+// rbasic_bench - runs the BASIC workloads in bench/workloads in interpret
+// and compile mode and reports ns/op, heap allocations and peak RSS as JSON.
+//
+// Each workload starts with header comments the harness reads:
+//   // ops: N           operations the workload performs, for ns/op
+//   // expect: text     output the run must contain to count as passing
+//   // requires: sqlite skipped unless built with SQLite3 support
+//
+// Every run happens in a child process, so peak RSS comes from wait4() and
+// one workload's heap cannot affect the next. Interpret mode runs the
+// lexer, parser and interpreter in the forked child and reads the heap
+// counters (memory_stats.h) there; compile mode builds the workload with
+// `rbasic -c --mem-report` and times the resulting executable, which prints
+// its own heap counts to stderr as it exits.
+
+#include "lexer.h"
+#include "parser.h"
+#include "interpreter.h"
+#include "memory_stats.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Workload {
+    std::string name;
+    fs::path path;
+    unsigned long long ops = 1;
+    std::string expect;
+    bool needsSqlite = false;
+};
+
+struct Run {
+    bool ok = false;
+    std::string error;
+    double ns = 0;
+    long long allocations = -1;     // -1 when not measured
+    long long allocatedBytes = -1;
+    long peakRssKb = 0;
+};
+
+struct Result {
+    std::string workload;
+    std::string mode;
+    std::string status;             // ok, failed or skipped
+    std::string error;
+    unsigned long long ops = 0;
+    double nsPerOp = 0;
+    double minNsPerOp = 0;
+    double compileMs = -1;
+    long long allocations = -1;
+    long long allocatedBytes = -1;
+    long peakRssKb = 0;
+};
+
+struct Options {
+    std::string mode = "both";
+    std::string filter;
+    std::string outFile;
+    std::string baselineFile;
+    double threshold = 10.0;        // Percent slowdown that counts as a regression
+    int repeat = 3;
+    fs::path workloads = RBASIC_BENCH_WORKLOADS;
+    fs::path sourceDir = RBASIC_SOURCE_DIR;
+    fs::path rbasic;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n\n"
+              << "Options:\n"
+              << "  --mode <m>         interpret, compile or both (default: both)\n"
+              << "  --filter <text>    Only run workloads whose name contains text\n"
+              << "  --repeat <n>       Runs per workload and mode; ns/op is the median (default: 3)\n"
+              << "  --out <file>       Write the JSON report to file instead of stdout\n"
+              << "  --baseline <file>  Compare ns/op against an earlier report\n"
+              << "  --threshold <pct>  Slowdown that counts as a regression (default: 10)\n"
+              << "  --workloads <dir>  Workload directory (default: bench/workloads)\n"
+              << "  --rbasic <path>    rbasic executable for compile mode\n";
+}
+
+Workload loadWorkload(const fs::path& path) {
+    Workload workload;
+    workload.name = path.stem().string();
+    workload.path = path;
+
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line) && line.rfind("//", 0) == 0) {
+        std::string text = line.substr(2);
+        text.erase(0, text.find_first_not_of(' '));
+        if (text.rfind("ops:", 0) == 0) {
+            workload.ops = std::max(1ULL, std::stoull(text.substr(4)));
+        } else if (text.rfind("expect:", 0) == 0) {
+            workload.expect = text.substr(7);
+            workload.expect.erase(0, workload.expect.find_first_not_of(' '));
+        } else if (text.rfind("requires:", 0) == 0) {
+            workload.needsSqlite = text.find("sqlite") != std::string::npos;
+        }
+    }
+    return workload;
+}
+
+std::string readAll(int fd) {
+    std::string data;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0 || (n < 0 && errno == EINTR)) {
+        if (n > 0) {
+            data.append(buffer, static_cast<std::size_t>(n));
+        }
+    }
+    return data;
+}
+
+// Collects a child's output until it closes the pipe, then reaps it
+bool finishChild(pid_t pid, int outputFd, std::string& output, long& peakRssKb) {
+    output = readAll(outputFd);
+    close(outputFd);
+    int status = 0;
+    struct rusage usage {};
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {
+    }
+    peakRssKb = usage.ru_maxrss;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void checkOutput(Run& run, bool exitedCleanly, const std::string& output, const Workload& workload) {
+    if (!exitedCleanly) {
+        run.error = "non-zero exit";
+    } else if (output.find("Runtime error") != std::string::npos) {
+        run.error = "runtime error";
+    } else if (output.find(workload.expect) == std::string::npos) {
+        run.error = "output did not contain \"" + workload.expect + "\"";
+    } else {
+        run.ok = true;
+    }
+}
+
+Run interpretOnce(const Workload& workload, const fs::path& workDir) {
+    Run run;
+    int output[2], result[2];
+    if (pipe(output) != 0 || pipe(result) != 0) {
+        run.error = "pipe failed";
+        return run;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(output[0]);
+        close(result[0]);
+        dup2(output[1], STDOUT_FILENO);
+        dup2(output[1], STDERR_FILENO);
+        close(output[1]);
+        if (chdir(workDir.c_str()) != 0) {
+            _exit(2);
+        }
+
+        std::ifstream file(workload.path);
+        std::stringstream source;
+        source << file.rdbuf();
+        std::string text = source.str();
+
+        rbasic::HeapCounts before = rbasic::heapCounts();
+        auto start = Clock::now();
+        try {
+            rbasic::Lexer lexer(text);
+            rbasic::Parser parser(lexer.tokenize(), workload.path.string());
+            auto program = parser.parse();
+            rbasic::Interpreter interpreter;
+            interpreter.setCurrentFile(workload.path.string());
+            interpreter.interpret(*program);
+        } catch (const std::exception& e) {
+            std::cout << "Runtime error: " << e.what() << std::endl;
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        rbasic::HeapCounts after = rbasic::heapCounts();
+        unsigned long long counts[2] = {after.allocations - before.allocations, after.bytes - before.bytes};
+        std::cout.flush();
+
+        char line[128];
+        int length = std::snprintf(line, sizeof(line), "%.0f %llu %llu\n", ns, counts[0], counts[1]);
+        ssize_t written = write(result[1], line, static_cast<std::size_t>(length));
+        _exit(written == length ? 0 : 2);
+    }
+
+    close(output[1]);
+    close(result[1]);
+    if (pid < 0) {
+        close(output[0]);
+        close(result[0]);
+        run.error = "fork failed";
+        return run;
+    }
+
+    std::string text;
+    bool exited = finishChild(pid, output[0], text, run.peakRssKb);
+    std::string measured = readAll(result[0]);
+    close(result[0]);
+    checkOutput(run, exited, text, workload);
+
+    unsigned long long allocations = 0, bytes = 0;
+    if (run.ok && std::sscanf(measured.c_str(), "%lf %llu %llu", &run.ns, &allocations, &bytes) == 3) {
+        run.allocations = static_cast<long long>(allocations);
+        run.allocatedBytes = static_cast<long long>(bytes);
+    } else if (run.ok) {
+        run.ok = false;
+        run.error = "no measurement from child";
+    }
+    return run;
+}
+
+// Runs argv with the given working directory, output captured into 'output'.
+// A bare program name is looked up on the PATH.
+bool runProcess(const std::vector<std::string>& args, const fs::path& workDir, std::string& output,
+                long& peakRssKb) {
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) {
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(pipeFds[0]);
+        dup2(pipeFds[1], STDOUT_FILENO);
+        dup2(pipeFds[1], STDERR_FILENO);
+        close(pipeFds[1]);
+        if (chdir(workDir.c_str()) != 0) {
+            _exit(127);
+        }
+        std::vector<char*> argv;
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    close(pipeFds[1]);
+    if (pid < 0) {
+        close(pipeFds[0]);
+        return false;
+    }
+    return finishChild(pid, pipeFds[0], output, peakRssKb);
+}
+
+bool compileWorkload(const Workload& workload, const Options& options, const fs::path& executable,
+                     double& compileMs, std::string& error) {
+    std::string output;
+    long rss = 0;
+    auto start = Clock::now();
+    // rbasic -c finds include/ and runtime/ relative to its working directory
+    bool built = runProcess({options.rbasic.string(), "-c", fs::absolute(workload.path).string(), "-o",
+                             executable.string(), "--mem-report"},
+                            options.sourceDir, output, rss);
+    compileMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    if (!built || !fs::exists(executable)) {
+        error = "compilation failed";
+        return false;
+    }
+    return true;
+}
+
+Run executeOnce(const Workload& workload, const fs::path& executable, const fs::path& workDir) {
+    Run run;
+    std::string output;
+    auto start = Clock::now();
+    bool exited = runProcess({executable.string()}, workDir, output, run.peakRssKb);
+    run.ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    checkOutput(run, exited, output, workload);
+
+    // The line write_memory_report() prints at exit; the counts include the
+    // runtime's startup, which the interpreter's figures leave out
+    unsigned long long allocations = 0, bytes = 0;
+    size_t report = output.rfind("=== Memory: peak ");
+    if (run.ok && report != std::string::npos &&
+        std::sscanf(output.c_str() + report, "=== Memory: peak %*s %*s %llu allocations, %llu bytes", &allocations,
+                    &bytes) == 2) {
+        run.allocations = static_cast<long long>(allocations);
+        run.allocatedBytes = static_cast<long long>(bytes);
+    }
+    return run;
+}
+
+Result summarize(const Workload& workload, const std::string& mode, std::vector<Run>& runs) {
+    Result result;
+    result.workload = workload.name;
+    result.mode = mode;
+    result.ops = workload.ops;
+    for (const Run& run : runs) {
+        if (!run.ok) {
+            result.status = "failed";
+            result.error = run.error;
+            return result;
+        }
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.ns < b.ns; });
+    const Run& median = runs[runs.size() / 2];
+    result.status = "ok";
+    result.nsPerOp = median.ns / static_cast<double>(workload.ops);
+    result.minNsPerOp = runs.front().ns / static_cast<double>(workload.ops);
+    result.allocations = median.allocations;
+    result.allocatedBytes = median.allocatedBytes;
+    for (const Run& run : runs) {
+        result.peakRssKb = std::max(result.peakRssKb, run.peakRssKb);
+    }
+    return result;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+            quoted += escape;
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+std::string gitCommit(const fs::path& sourceDir) {
+    std::string output;
+    long rss = 0;
+    if (!runProcess({"git", "rev-parse", "--short", "HEAD"}, sourceDir, output, rss)) {
+        return "";
+    }
+    output.erase(output.find_last_not_of(" \n\r") + 1);
+    return output;
+}
+
+// One result object per line, which is also what readBaseline() relies on.
+// "commit" is left out when the source directory is not a git checkout.
+void writeJson(std::ostream& out, const std::vector<Result>& results, const Options& options) {
+    std::string commit = gitCommit(options.sourceDir);
+    out << "{\n";
+    if (!commit.empty()) {
+        out << "  \"commit\": " << jsonString(commit) << ",\n";
+    }
+    out << "  \"timestamp\": " << std::chrono::duration_cast<std::chrono::seconds>(
+                                          std::chrono::system_clock::now().time_since_epoch()).count()
+        << ",\n  \"repeat\": " << options.repeat << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        char number[64];
+        out << "    {\"workload\": " << jsonString(r.workload) << ", \"mode\": " << jsonString(r.mode)
+            << ", \"status\": " << jsonString(r.status) << ", \"ops\": " << r.ops;
+        if (r.status == "ok") {
+            std::snprintf(number, sizeof(number), "%.2f", r.nsPerOp);
+            out << ", \"ns_per_op\": " << number;
+            std::snprintf(number, sizeof(number), "%.2f", r.minNsPerOp);
+            out << ", \"min_ns_per_op\": " << number;
+            out << ", \"allocations\": " << (r.allocations < 0 ? "null" : std::to_string(r.allocations));
+            out << ", \"allocated_bytes\": " << (r.allocatedBytes < 0 ? "null" : std::to_string(r.allocatedBytes));
+            out << ", \"peak_rss_kb\": " << r.peakRssKb;
+        }
+        if (r.compileMs >= 0) {
+            std::snprintf(number, sizeof(number), "%.1f", r.compileMs);
+            out << ", \"compile_ms\": " << number;
+        }
+        if (!r.error.empty()) {
+            out << ", \"error\": " << jsonString(r.error);
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+std::string fieldText(const std::string& line, const std::string& key) {
+    std::string marker = "\"" + key + "\": ";
+    std::size_t pos = line.find(marker);
+    if (pos == std::string::npos) {
+        return "";
+    }
+    pos += marker.size();
+    if (line[pos] == '"') {
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+struct BaselineEntry {
+    std::string workload;
+    std::string mode;
+    double nsPerOp;
+};
+
+std::vector<BaselineEntry> readBaseline(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) {
+        throw std::runtime_error("cannot read baseline " + filename);
+    }
+    std::vector<BaselineEntry> entries;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string ns = fieldText(line, "ns_per_op");
+        if (!ns.empty() && fieldText(line, "status") == "ok") {
+            entries.push_back({fieldText(line, "workload"), fieldText(line, "mode"), std::stod(ns)});
+        }
+    }
+    return entries;
+}
+
+// Prints a comparison table and returns the number of regressions
+int compareWithBaseline(const std::vector<Result>& results, const std::vector<BaselineEntry>& baseline,
+                        double threshold) {
+    int regressions = 0;
+    char row[160];
+    std::snprintf(row, sizeof(row), "\n%-20s %-10s %14s %14s %9s\n", "workload", "mode", "baseline ns/op", "ns/op",
+                  "change");
+    std::cerr << row;
+    for (const Result& r : results) {
+        if (r.status != "ok") {
+            continue;
+        }
+        for (const BaselineEntry& entry : baseline) {
+            if (entry.workload != r.workload || entry.mode != r.mode || entry.nsPerOp <= 0) {
+                continue;
+            }
+            double change = 100.0 * (r.nsPerOp - entry.nsPerOp) / entry.nsPerOp;
+            bool regressed = change > threshold;
+            regressions += regressed;
+            std::snprintf(row, sizeof(row), "%-20s %-10s %14.2f %14.2f %+8.1f%%%s\n", r.workload.c_str(),
+                          r.mode.c_str(), entry.nsPerOp, r.nsPerOp, change, regressed ? "  REGRESSION" : "");
+            std::cerr << row;
+        }
+    }
+    return regressions;
+}
+
+void printSummary(const Result& r) {
+    char row[192];
+    if (r.status == "ok") {
+        std::snprintf(row, sizeof(row), "%-20s %-10s %12.2f ns/op %12s allocs %8ld KB RSS\n", r.workload.c_str(),
+                      r.mode.c_str(), r.nsPerOp, r.allocations < 0 ? "-" : std::to_string(r.allocations).c_str(),
+                      r.peakRssKb);
+    } else {
+        std::snprintf(row, sizeof(row), "%-20s %-10s %s%s%s\n", r.workload.c_str(), r.mode.c_str(), r.status.c_str(),
+                      r.error.empty() ? "" : ": ", r.error.c_str());
+    }
+    std::cerr << row;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.rbasic = fs::absolute(argv[0]).parent_path() / "rbasic";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--mode" && hasValue) {
+            options.mode = argv[++i];
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--out" && hasValue) {
+            options.outFile = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselineFile = argv[++i];
+        } else if (arg == "--threshold" && hasValue) {
+            options.threshold = std::atof(argv[++i]);
+        } else if (arg == "--workloads" && hasValue) {
+            options.workloads = argv[++i];
+        } else if (arg == "--rbasic" && hasValue) {
+            options.rbasic = fs::absolute(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.mode != "interpret" && options.mode != "compile" && options.mode != "both") {
+        std::cerr << "Error: --mode must be interpret, compile or both\n";
+        return 2;
+    }
+
+    std::vector<Workload> workloads;
+    for (const auto& entry : fs::directory_iterator(options.workloads)) {
+        if (entry.path().extension() == ".bas" &&
+            entry.path().stem().string().find(options.filter) != std::string::npos) {
+            workloads.push_back(loadWorkload(entry.path()));
+        }
+    }
+    std::sort(workloads.begin(), workloads.end(), [](const Workload& a, const Workload& b) { return a.name < b.name; });
+
+    char tempTemplate[] = "/tmp/rbasic_bench_XXXXXX";
+    if (!mkdtemp(tempTemplate)) {
+        std::cerr << "Error: cannot create a temporary directory\n";
+        return 1;
+    }
+    fs::path workDir = tempTemplate;
+
+#ifdef SQLITE3_SUPPORT_ENABLED
+    const bool haveSqlite = true;
+#else
+    const bool haveSqlite = false;
+#endif
+
+    std::vector<Result> results;
+    for (const Workload& workload : workloads) {
+        for (const std::string mode : {"interpret", "compile"}) {
+            if (options.mode != "both" && options.mode != mode) {
+                continue;
+            }
+            Result result;
+            if (workload.needsSqlite && !haveSqlite) {
+                result.workload = workload.name;
+                result.mode = mode;
+                result.ops = workload.ops;
+                result.status = "skipped";
+                result.error = "built without SQLite3 support";
+            } else if (mode == "interpret") {
+                std::vector<Run> runs;
+                for (int i = 0; i < options.repeat; i++) {
+                    runs.push_back(interpretOnce(workload, workDir));
+                }
+                result = summarize(workload, mode, runs);
+            } else {
+                fs::path executable = workDir / workload.name;
+                double compileMs = 0;
+                std::string error;
+                if (compileWorkload(workload, options, executable, compileMs, error)) {
+                    std::vector<Run> runs;
+                    for (int i = 0; i < options.repeat; i++) {
+                        runs.push_back(executeOnce(workload, executable, workDir));
+                    }
+                    result = summarize(workload, mode, runs);
+                } else {
+                    result.workload = workload.name;
+                    result.mode = mode;
+                    result.ops = workload.ops;
+                    result.status = "failed";
+                    result.error = error;
+                }
+                result.compileMs = compileMs;
+            }
+            printSummary(result);
+            results.push_back(result);
+        }
+    }
+    std::error_code ignored;
+    fs::remove_all(workDir, ignored);
+
+    if (options.outFile.empty()) {
+        writeJson(std::cout, results, options);
+    } else {
+        std::ofstream out(options.outFile);
+        if (!out) {
+            std::cerr << "Error: cannot write " << options.outFile << "\n";
+            return 1;
+        }
+        writeJson(out, results, options);
+        std::cerr << "Results written to " << options.outFile << "\n";
+    }
+
+    int failures = static_cast<int>(std::count_if(results.begin(), results.end(),
+                                                  [](const Result& r) { return r.status == "failed"; }));
+    int regressions = 0;
+    if (!options.baselineFile.empty()) {
+        try {
+            regressions = compareWithBaseline(results, readBaseline(options.baselineFile), options.threshold);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        if (regressions > 0) {
+            std::cerr << regressions << " regression(s) above " << options.threshold << "%\n";
+        }
+    }
+    return failures > 0 || regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,10 @@
+// Integer and floating-point arithmetic in a tight loop
+// ops: 50000
+// expect: 149999 1500
+var sum = 0;
+var x = 0.5;
+for (var i = 0; i < 50000; i = i + 1) {
+    sum = sum + (i * 3) mod 7;
+    x = x * 0.999 + 1.5;
+}
+print(sum, round(x));
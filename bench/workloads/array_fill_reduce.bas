@@ -0,0 +1,8 @@
+// Element-wise writes to a typed array, then whole-array reductions
+// ops: 10000
+// expect: 24997500 4999.5
+var a = double_array(10000);
+for (var i = 0; i < 10000; i = i + 1) {
+    a[i] = i * 0.5;
+}
+print(array_sum(a), array_max(a));
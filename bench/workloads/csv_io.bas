@@ -0,0 +1,15 @@
+// Write a CSV file, read it back and sum a column; one op per row
+// ops: 1000
+// expect: 999000
+var rows = "";
+for (var i = 0; i < 1000; i = i + 1) {
+    rows = rows + str(i) + "," + str(i * 2) + ",x\n";
+}
+write_text_file("rbasic_bench.csv", rows);
+var lines = split(read_text_file("rbasic_bench.csv"), "\n");
+var total = 0;
+for (var i = 0; i < 1000; i = i + 1) {
+    var fields = split(lines[i], ",");
+    total = total + val(fields[1]);
+}
+print(total);
@@ -0,0 +1,13 @@
+// Batch mat4 transforms over a vec3 array; one op per transformed point
+// ops: 2000000
+// expect: 59 1 2
+var points = vec3_array(20000);
+for (var i = 0; i < 20000; i = i + 1) {
+    points[i] = vec3(i mod 10, 1, 2);
+}
+var m = mat4(1,0,0,0, 0,1,0,0, 0,0,1,0, 0.5,0,0,1);
+for (var step = 0; step < 100; step = step + 1) {
+    points = transform_points(m, points);
+}
+var last = points[19999];
+print(last.x, last.y, last.z);
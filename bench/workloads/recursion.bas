@@ -0,0 +1,10 @@
+// Recursive function calls (naive Fibonacci); one op per call
+// ops: 21891
+// expect: 6765
+function fib(n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+print(fib(20));
@@ -0,0 +1,15 @@
+// Array columns inserted into an in-memory SQLite table with sqlite_exec_batch
+// ops: 100000
+// expect: inserted 100000
+// requires: sqlite
+var n = 100000;
+var ids = int_array(n);
+var values = double_array(n);
+for (var i = 0; i < n; i = i + 1) {
+    ids[i] = i;
+    values[i] = i * 0.25;
+}
+var db = sqlite_open(":memory:");
+sqlite_exec(db, "CREATE TABLE readings (id INTEGER, value REAL)");
+print("inserted " + str(sqlite_exec_batch(db, "INSERT INTO readings VALUES (?, ?)", ids, values)));
+sqlite_close(db);
@@ -0,0 +1,11 @@
+// Single-row INSERTs into an in-memory SQLite table
+// ops: 2000
+// expect: inserted
+// requires: sqlite
+var db = sqlite_open(":memory:");
+sqlite_exec(db, "CREATE TABLE t (id INTEGER, name TEXT)");
+for (var i = 0; i < 2000; i = i + 1) {
+    sqlite_exec(db, "INSERT INTO t VALUES (" + str(i) + ", 'row')");
+}
+print("inserted");
+sqlite_close(db);
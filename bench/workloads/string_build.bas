@@ -0,0 +1,8 @@
+// Growing a string by concatenation
+// ops: 20000
+// expect: 20000 90123
+var s = "";
+for (var i = 0; i < 20000; i = i + 1) {
+    s = s + str(i mod 10);
+}
+print(len(s), mid(s, 100, 5));
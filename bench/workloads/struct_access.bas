@@ -0,0 +1,14 @@
+// Field reads and writes on an array of structs; one op per element update
+// ops: 40000
+// expect: 80000
+struct Particle { x, v };
+dim p(10000) as Particle;
+for (var i = 0; i < 10000; i = i + 1) {
+    p[i].v = i mod 5;
+}
+for (var step = 0; step < 4; step = step + 1) {
+    for (var i = 0; i < 10000; i = i + 1) {
+        p[i].x = p[i].x + p[i].v;
+    }
+}
+print(array_sum(p.x));
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "struct_array.h"
+
+namespace rbasic {
+
+// Binary container used by save_array/load_array in both execution modes.
+//
+// Layout (all header fields in the writer's byte order):
+//   0   "RBAR"            magic
+//   4   uint8  version    (1)
+//   5   uint8  byte order (1 = little endian, 2 = big endian)
+//   6   uint8  element type (see ElementType)
+//   7   uint8  reserved
+//   8   uint32 rank, then rank x uint32 dimensions
+//   ..  uint64 element count
+//   payload, starting on an 8-byte boundary
+//
+// Typed arrays store their elements as raw machine values, and vec3/vec4
+// arrays their float lanes. Generic arrays store (int32 index, tagged value)
+// records for the elements that are set, and a struct is a single tagged
+// value. A struct array (`dim a(n) as T`) stores its type name and then each
+// column: its name, its kind, and its rows as raw int32 or double values or
+// as tagged values. Readers byte-swap when the file was written on a machine
+// with the other byte order.
+namespace ArrayFile {
+    enum class ElementType : uint8_t {
+        BYTE = 1,
+        INT32 = 2,
+        DOUBLE = 3,
+        GENERIC = 4,       // Generic array of tagged records
+        STRUCT = 5,        // A single struct value
+        STRUCT_ARRAY = 6,  // Struct array, column by column
+        VEC3 = 7,          // vec3 array, 3 float32 lanes per element
+        VEC4 = 8           // vec4 array, 4 float32 lanes per element
+    };
+
+    // Tags for values inside GENERIC and STRUCT payloads
+    enum class ValueTag : uint8_t {
+        INT = 1,
+        DOUBLE = 2,
+        STRING = 3,
+        BOOL = 4,
+        STRUCT = 5
+    };
+
+    struct Header {
+        ElementType type = ElementType::BYTE;
+        std::vector<int> dimensions;
+        uint64_t count = 0;
+    };
+
+    // Writes header and payload in a single pass. Returns false on I/O failure.
+    bool write(const std::string& filename, const Header& header, const void* payload, size_t payloadBytes);
+
+    // Read-only view of a whole file: memory-mapped where the platform
+    // supports it, otherwise read into an owned buffer.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return opened_; }
+        const uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        bool opened_ = false;
+        bool mapped_ = false;
+        std::vector<uint8_t> buffer_;
+    };
+
+    // Parses and validates the header. On success payload points at the
+    // payload, payloadBytes is its length and swapBytes says whether values
+    // need byte-swapping. Throws std::runtime_error on a malformed file.
+    void readHeader(const MappedFile& file, Header& header, const uint8_t*& payload,
+                    size_t& payloadBytes, bool& swapBytes);
+
+    // Copies count raw elements of width bytes out of the payload, swapping if needed
+    void copyElements(void* destination, const uint8_t* payload, size_t count, size_t width, bool swapBytes);
+
+    // Element type tag for the typed array element types
+    template<typename Element>
+    constexpr ElementType typedElementType() {
+        static_assert(sizeof(int) == 4, "INT32 payloads assume a 32-bit int");
+        if constexpr (std::is_same_v<Element, uint8_t>) {
+            return ElementType::BYTE;
+        } else if constexpr (std::is_same_v<Element, int>) {
+            return ElementType::INT32;
+        } else {
+            static_assert(std::is_same_v<Element, double>, "unsupported typed array element");
+            return ElementType::DOUBLE;
+        }
+    }
+
+    // Element type tag for the packed vector array elements (glm::vec3, glm::vec4)
+    template<typename Vec>
+    constexpr ElementType vectorElementType() {
+        static_assert(sizeof(Vec) == Vec::length() * 4, "vector lanes must be packed float32");
+        static_assert(Vec::length() == 3 || Vec::length() == 4, "unsupported vector array element");
+        return Vec::length() == 3 ? ElementType::VEC3 : ElementType::VEC4;
+    }
+
+    // Fills a typed array's storage from a payload in one copy
+    template<typename Element>
+    void readElements(std::vector<Element>& elements, const uint8_t* payload, size_t payloadBytes,
+                      uint64_t count, bool swapBytes) {
+        if (count > payloadBytes / sizeof(Element)) {
+            throw std::runtime_error("truncated array file");
+        }
+        elements.resize(static_cast<size_t>(count));
+        copyElements(elements.data(), payload, elements.size(), sizeof(Element), swapBytes);
+    }
+
+    // Fills a vec3/vec4 array's storage from a payload, swapping lane by lane
+    template<typename Vec>
+    void readVectors(std::vector<Vec>& elements, const uint8_t* payload, size_t payloadBytes,
+                     uint64_t count, bool swapBytes) {
+        if (count > payloadBytes / sizeof(Vec)) {
+            throw std::runtime_error("truncated array file");
+        }
+        elements.resize(static_cast<size_t>(count));
+        copyElements(elements.data(), payload, elements.size() * Vec::length(), 4, swapBytes);
+    }
+
+    // Builds GENERIC/STRUCT payloads
+    class RecordWriter {
+    public:
+        void putTag(ValueTag tag) { bytes_.push_back(static_cast<uint8_t>(tag)); }
+        void putInt(int32_t value);
+        void putDouble(double value);
+        void putBool(bool value) { bytes_.push_back(value ? 1 : 0); }
+        void putString(std::string_view value);
+        void putCount(uint32_t value);
+        void putBytes(const void* data, size_t bytes);
+
+        const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+    private:
+        std::vector<uint8_t> bytes_;
+    };
+
+    // Reads GENERIC/STRUCT payloads with bounds checking
+    class RecordReader {
+    public:
+        RecordReader(const uint8_t* data, size_t size, bool swapBytes)
+            : data_(data), size_(size), swapBytes_(swapBytes) {}
+
+        bool atEnd() const { return offset_ >= size_; }
+        ValueTag getTag();
+        int32_t getInt();
+        double getDouble();
+        bool getBool();
+        std::string getString();
+        uint32_t getCount();
+        // Reads count raw elements of width bytes, swapping if needed
+        void getElements(void* destination, size_t count, size_t width);
+
+    private:
+        void read(void* out, size_t bytes, bool swappable);
+
+        const uint8_t* data_;
+        size_t size_;
+        size_t offset_ = 0;
+        bool swapBytes_;
+    };
+
+    // A scalar in a GENERIC/STRUCT/STRUCT_ARRAY payload, as a tag and its value
+    using Scalar = std::variant<int, double, std::string, bool>;
+    void putScalar(RecordWriter& out, const Scalar& value);
+    Scalar getScalar(RecordReader& in, ValueTag tag);
+
+    // STRUCT_ARRAY payloads. The header's dimensions and count give the rows;
+    // the array is rebuilt with a layout of its own. Throws std::runtime_error
+    // on a malformed payload.
+    void putStructArray(RecordWriter& out, const StructArray& array);
+    void getStructArray(RecordReader& in, const Header& header, StructArray& array);
+
+} // namespace ArrayFile
+
+} // namespace rbasic
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rbasic {
+
+// Whole-array kernels over contiguous typed array storage.
+// Shared by the interpreter (typed array builtins) and the compiled runtime.
+// Loops are written over raw pointers so they vectorise (omp simd when
+// OpenMP is available) and arrays above PARALLEL_THRESHOLD are split
+// across threads. Instantiated for uint8_t, int and double.
+namespace ArrayOps {
+    // Same cut-over as the runtime's parallel_fill_* helpers
+    constexpr std::size_t PARALLEL_THRESHOLD = 1000;
+
+    // Elementwise: out[i] = a[i] op b[i] (out may alias a or b)
+    template<typename T> void add(const T* a, const T* b, T* out, std::size_t n);
+    template<typename T> void subtract(const T* a, const T* b, T* out, std::size_t n);
+    template<typename T> void multiply(const T* a, const T* b, T* out, std::size_t n);
+    template<typename T> void divide(const T* a, const T* b, T* out, std::size_t n);
+
+    // Elementwise with a scalar right-hand side: out[i] = a[i] op s
+    template<typename T> void addScalar(const T* a, T s, T* out, std::size_t n);
+    template<typename T> void subtractScalar(const T* a, T s, T* out, std::size_t n);
+    template<typename T> void multiplyScalar(const T* a, T s, T* out, std::size_t n);
+    template<typename T> void divideScalar(const T* a, T s, T* out, std::size_t n);
+
+    // y[i] += alpha * x[i]
+    template<typename T> void axpy(T alpha, const T* x, T* y, std::size_t n);
+
+    // Reductions (min/max require n > 0)
+    template<typename T> double sum(const T* a, std::size_t n);
+    template<typename T> double dot(const T* a, const T* b, std::size_t n);
+    template<typename T> T minValue(const T* a, std::size_t n);
+    template<typename T> T maxValue(const T* a, std::size_t n);
+
+    template<typename T> void fill(T* out, T value, std::size_t n);
+    template<typename T> void copy(const T* src, T* dst, std::size_t n);
+    template<typename T> void sort(T* a, std::size_t n);
+    template<> void sort<uint8_t>(uint8_t* a, std::size_t n);  // counting sort
+
+    // Inclusive scan: out[i] = a[0] + ... + a[i] (out may alias a)
+    template<typename T> void prefixSum(const T* a, T* out, std::size_t n);
+
+    // True if any element is zero (integer division guard)
+    template<typename T> bool containsZero(const T* a, std::size_t n);
+
+} // namespace ArrayOps
+
+} // namespace rbasic
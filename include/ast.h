@@ -2,6 +2,7 @@
 
 #include "common.h"
 #include "lexer.h"  // For TokenType
+#include "swizzle.h"
 #include <memory>
 #include <vector>
 
@@ -45,6 +46,7 @@ public:
     std::string name;
     std::vector<std::unique_ptr<Expression>> indices; // For multidimensional array access
     std::string member;                               // For struct member access
+    FieldCache memberCache;                           // Field index of member, resolved on first use
     
     explicit VariableExpr(std::string n, std::vector<std::unique_ptr<Expression>> idx = {}, 
                          std::string mem = "", const SourcePosition& pos = SourcePosition())
@@ -58,6 +60,11 @@ public:
     std::string operator_;
     std::unique_ptr<Expression> right;
     
+    // Whether evaluating right can assign to a variable, worked out by the
+    // interpreter on first use; if not, a variable on the left is read in place
+    enum class RightEffects { Unknown, None, MayAssign };
+    RightEffects rightEffects = RightEffects::Unknown;
+    
     BinaryExpr(std::unique_ptr<Expression> l, std::string op, std::unique_ptr<Expression> r,
                const SourcePosition& pos = SourcePosition())
         : Expression(pos), left(std::move(l)), operator_(std::move(op)), right(std::move(r)) {}
@@ -80,9 +87,12 @@ public:
     std::unique_ptr<Expression> object;
     std::string component;
     std::unique_ptr<Expression> value;
+    FieldCache fieldCache;  // Field index of component for struct targets
+    Swizzle swizzle;        // Lanes of component for vector targets
     
     ComponentAssignExpr(std::unique_ptr<Expression> obj, std::string comp, std::unique_ptr<Expression> val)
-        : object(std::move(obj)), component(std::move(comp)), value(std::move(val)) {}
+        : object(std::move(obj)), component(std::move(comp)), value(std::move(val)),
+          swizzle(parseSwizzle(component)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -130,11 +140,12 @@ public:
 class GLMComponentAccessExpr : public Expression {
 public:
     std::unique_ptr<Expression> object;
-    std::string component;  // "x", "y", "z", "w"
+    std::string component;  // "x", "y", "z", "w" or a swizzle such as "xy"
+    Swizzle swizzle;        // Lanes of component
     
     GLMComponentAccessExpr(std::unique_ptr<Expression> obj, std::string comp,
                           const SourcePosition& pos = SourcePosition())
-        : Expression(pos), object(std::move(obj)), component(std::move(comp)) {}
+        : Expression(pos), object(std::move(obj)), component(std::move(comp)), swizzle(parseSwizzle(component)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
@@ -142,16 +153,20 @@ class MemberAccessExpr : public Expression {
 public:
     std::unique_ptr<Expression> object;
     std::string member;  // struct member name
+    FieldCache fieldCache;  // Field index of member, resolved on first use
+    Swizzle swizzle;        // Lanes of member when the object is a vector
     
     MemberAccessExpr(std::unique_ptr<Expression> obj, std::string mem,
                     const SourcePosition& pos = SourcePosition())
-        : Expression(pos), object(std::move(obj)), member(std::move(mem)) {}
+        : Expression(pos), object(std::move(obj)), member(std::move(mem)), swizzle(parseSwizzle(member)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
 // Statement nodes
 class Statement : public ASTNode {
 public:
+    int coverageSlot = -1;  // Counter index assigned by Coverage::addProgram (--coverage)
+    
     Statement(const SourcePosition& pos = SourcePosition()) : ASTNode(pos) {}
     virtual ~Statement() = default;
 };
@@ -171,6 +186,7 @@ public:
     std::vector<std::unique_ptr<Expression>> indices; // For multidimensional array assignment
     std::string member;                                // For struct member assignment
     std::unique_ptr<Expression> value;
+    FieldCache memberCache;                            // Field index of member, resolved on first use
     
     VarStmt(std::string var, std::unique_ptr<Expression> val, 
             std::vector<std::unique_ptr<Expression>> idx = {}, std::string mem = "")
@@ -249,6 +265,7 @@ public:
     std::vector<std::string> paramTypes;
     std::string returnType;
     std::vector<std::unique_ptr<Statement>> body;
+    std::shared_ptr<FunctionDecl> definition;  // The interpreter's copy, which took the body over
     
     FunctionDecl(std::string n, std::vector<std::string> params, 
                  std::vector<std::string> paramTypes_, std::string retType,
@@ -264,9 +281,11 @@ public:
     std::string name;
     std::vector<std::string> fields;
     std::vector<std::string> fieldTypes;
+    StructLayoutPtr layout;  // Shared by every instance of this struct type
     
     StructDecl(std::string n, std::vector<std::string> f, std::vector<std::string> ft)
-        : name(std::move(n)), fields(std::move(f)), fieldTypes(std::move(ft)) {}
+        : name(std::move(n)), fields(std::move(f)), fieldTypes(std::move(ft)),
+          layout(makeStructLayout(name, fields)) {}
     void accept(ASTVisitor& visitor) override;
 };
 
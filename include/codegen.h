@@ -3,6 +3,7 @@
 #include "common.h"
 #include "ast.h"
 #include <sstream>
+#include <set>
 
 namespace rbasic {
 
@@ -11,6 +12,7 @@ private:
     std::ostringstream output;
     std::string functionForwardDeclarations;
     std::string functionDeclarations;
+    std::string structLayouts;  // Globals holding each declared struct's layout
     int indentLevel;
     std::string currentFunction; // Track current function name (empty if in main)
     std::map<std::string, std::unique_ptr<StructDecl>> structs; // Store struct declarations
@@ -21,14 +23,23 @@ private:
     std::string generateVariableName(const std::string& basicName);
     std::string generateTempVar();
     std::string escapeString(const std::string& str);
+    std::string structLayoutName(const std::string& structName);
+    std::string fieldCache();  // Expression naming a fresh per-site FieldCache
     bool isParallelizable(ModernForStmt& node);  // Analyze if loop can be parallelized
+    bool isArrayOperation(const std::string& name) const;  // Whole-array builtins (array_add, ...)
     int tempVarCounter;
+    bool usesMemStats = false;  // Set in the first pass; links in the heap counter
+    bool memoryReport = false;  // --mem-report: heap counts on stderr at exit
     
 public:
     CodeGenerator();
     
     std::string generate(Program& program);
     
+    // Link the heap counter into the program and have it print its
+    // allocations and peak RSS to stderr when it exits
+    void setMemoryReport(bool on) { memoryReport = on; }
+    
     // Visitor methods
     void visit(LiteralExpr& node) override;
     void visit(VariableExpr& node) override;
@@ -9,6 +9,9 @@
 #include <stdexcept>
 #include <cstdint>
 
+#include "struct_array.h"
+#include "tagged_value.h"
+
 // GLM includes for vector and matrix types
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -170,12 +173,37 @@ struct PointerValue {
     PointerValue(void* p, const std::string& type = "") : ptr(p), typeName(type) {}
 };
 
+// Struct instance: field values in declaration order, named by a layout
+// shared with every other instance of the same struct type
 struct StructValue {
-    std::string typeName;
-    std::map<std::string, std::variant<int, double, std::string, bool>> fields;
-    
+    using Field = std::variant<int, double, std::string, bool>;
+
+    StructLayoutPtr layout;
+    std::vector<Field> fields;    // Parallel to layout->fieldNames
+
     StructValue() = default;
-    StructValue(const std::string& type) : typeName(type) {}
+    explicit StructValue(StructLayoutPtr structLayout)
+        : layout(std::move(structLayout)), fields(layout->fieldNames.size(), 0) {}
+
+    const std::string& typeName() const {
+        static const std::string none;
+        return layout ? layout->typeName : none;
+    }
+
+    // By-name access for callers without a cached index; nullptr if absent
+    Field* field(const std::string& name) {
+        int index = layout ? layout->fieldIndex(name) : -1;
+        return index < 0 ? nullptr : &fields[index];
+    }
+    const Field* field(const std::string& name) const {
+        int index = layout ? layout->fieldIndex(name) : -1;
+        return index < 0 ? nullptr : &fields[index];
+    }
+};
+
+// Array of a declared struct type, stored as one column per field
+struct StructArrayValue : StructArray {
+    using StructArray::StructArray;
 };
 
 // GLM value types for built-in vector and matrix support
@@ -219,8 +247,41 @@ struct QuatValue {
     QuatValue(const glm::quat& q) : data(q) {}
 };
 
+// Packed arrays of vectors (vec3_array, vec4_array): the vectors sit back to
+// back as floats, so whole-array kernels (vec_ops.h) run over them directly
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "vec3 arrays must be packed");
+static_assert(sizeof(glm::vec4) == 4 * sizeof(float), "vec4 arrays must be packed");
+
+struct Vec3ArrayValue {
+    std::vector<glm::vec3> elements;
+    std::vector<int> dimensions;
+    
+    Vec3ArrayValue() = default;
+    Vec3ArrayValue(const std::vector<int>& dims) : dimensions(dims) {
+        int totalSize = 1;
+        for (int dim : dims) {
+            totalSize *= dim;
+        }
+        elements.resize(totalSize, glm::vec3(0.0f));
+    }
+};
+
+struct Vec4ArrayValue {
+    std::vector<glm::vec4> elements;
+    std::vector<int> dimensions;
+    
+    Vec4ArrayValue() = default;
+    Vec4ArrayValue(const std::vector<int>& dims) : dimensions(dims) {
+        int totalSize = 1;
+        for (int dim : dims) {
+            totalSize *= dim;
+        }
+        elements.resize(totalSize, glm::vec4(0.0f));
+    }
+};
+
 // Common types
-using ValueType = std::variant<int, double, std::string, bool, void*, ArrayValue, StructValue, PointerValue, ByteArrayValue, IntArrayValue, DoubleArrayValue, Vec2Value, Vec3Value, Vec4Value, Mat3Value, Mat4Value, QuatValue>;
+using ValueType = TaggedValue<int, double, std::string, bool, void*, ArrayValue, StructValue, PointerValue, ByteArrayValue, IntArrayValue, DoubleArrayValue, Vec2Value, Vec3Value, Vec4Value, Mat3Value, Mat4Value, QuatValue, StructArrayValue, Vec3ArrayValue, Vec4ArrayValue>;
 
 // Type system
 enum class BasicType {
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rbasic {
+
+class Program;
+class Statement;
+
+// Execution counters for --coverage. addProgram gives every statement of a
+// parsed program a slot (Statement::coverageSlot) before it runs, so lines
+// that never execute are still reported; the interpreter then bumps plain
+// counters by slot with no lookups. Results are written in lcov's
+// tracefile format, with if statements and loops as two-way branches.
+class Coverage {
+public:
+    struct Counter {
+        std::uint64_t hits = 0;          // Times the statement started
+        std::uint64_t calls = 0;         // Function declarations: calls made
+        std::uint64_t taken[2] = {0, 0}; // if: then/else; loops: iterations/exits
+    };
+
+    // Registers the statements of program (including nested blocks and
+    // function bodies); statements that already have a slot keep it
+    void addProgram(Program& program);
+
+    Counter& counter(int slot) { return counters_[slot]; }
+
+    // lcov tracefile (TN/SF/FN/FNDA/BRDA/DA/end_of_record)
+    void writeLcov(std::ostream& out) const;
+
+    // Line, branch and function totals plus the loops with the most iterations
+    void writeSummary(std::ostream& out, std::size_t maxLoops = 10) const;
+
+private:
+    enum class Kind { STATEMENT, BRANCH, LOOP, FUNCTION };
+
+    struct Site {
+        std::string file;
+        int line;
+        Kind kind;
+        std::string name;   // Function name for FUNCTION sites
+    };
+
+    void addStatements(std::vector<std::unique_ptr<Statement>>& statements);
+
+    std::vector<Site> sites_;
+    std::vector<Counter> counters_;
+};
+
+} // namespace rbasic
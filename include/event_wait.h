@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace rbasic {
+
+// wait_event(timeout_ms): one blocking wait for whichever input is ready
+// first, instead of spinning on terminal_kbhit/sdl_poll_event plus a sleep.
+// Sources are stdin, a periodic timer, watched files, extra descriptors such
+// as serial ports and, while SDL is initialised, the SDL event queue. Nothing
+// is consumed except timer ticks and file change notifications, so the
+// script reads the key, event or serial data as before.
+//
+// On Linux the descriptors are multiplexed with epoll, the timer is a
+// timerfd and files are watched with inotify. SDL events do not arrive on a
+// descriptor, so while SDL is active the wait blocks in SDL and a helper
+// thread waits on the epoll set and wakes SDL when a descriptor is ready.
+// Elsewhere the wait checks the keyboard, timer and SDL once a millisecond.
+class EventWait {
+public:
+    enum class Source {
+        TIMEOUT,
+        KEY,
+        SDL,
+        SERIAL,
+        TIMER,
+        FILE
+    };
+
+    // An event queue that is not a descriptor (SDL). pending() and wait()
+    // are called on the waiting thread, wake() from the helper thread.
+    class ExternalQueue {
+    public:
+        virtual ~ExternalQueue() = default;
+        virtual bool pending() = 0;             // An event is queued
+        virtual void wait(int timeoutMs) = 0;   // Until an event is queued or timeoutMs passes
+        virtual void wake() = 0;                // Make a wait() in progress return
+        virtual void clearWakes() = 0;          // Drop what wake() queued
+    };
+
+    static EventWait& instance();
+
+    // Blocks until a source is ready or timeoutMs passes (negative waits forever)
+    Source wait(int timeoutMs);
+    static const char* name(Source source);  // "timeout", "key", "sdl", ...
+
+    bool setTimer(int intervalMs);               // Periodic; 0 stops it
+    bool watchFile(const std::string& path);     // Modified, written, moved or deleted
+    bool watchDescriptor(int fd);                // Readable data; reported as SERIAL
+    void setExternalQueue(ExternalQueue* queue); // nullptr when SDL shuts down
+    void setKeySource(int fd);                   // Watch fd for keys instead of stdin; -1 for stdin again
+
+private:
+    EventWait() = default;
+    ~EventWait();
+    EventWait(const EventWait&) = delete;
+    EventWait& operator=(const EventWait&) = delete;
+
+    using Clock = std::chrono::steady_clock;
+
+    bool ready(int timeoutMs, Source& source);   // One pass over the sources
+
+#ifdef __linux__
+    Source waitExternal(int timeoutMs);
+    bool open();
+    bool add(int fd, Source source);
+    void helperLoop();
+
+    int epollFd_ = -1;
+    int timerFd_ = -1;
+    int inotifyFd_ = -1;
+    int cancelFd_ = -1;  // eventfd that ends the helper's epoll_wait
+    int keyFd_ = 0;      // stdin, or the key reader's pipe
+
+    std::thread helper_;
+    std::mutex helperMutex_;
+    std::condition_variable helperChanged_;
+    bool helperArmed_ = false;
+    bool helperStopping_ = false;
+#else
+    Clock::duration timerInterval_{};
+    Clock::time_point nextTick_{};
+#endif
+
+    ExternalQueue* external_ = nullptr;
+};
+
+} // namespace rbasic
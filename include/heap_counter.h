@@ -0,0 +1,138 @@
+#pragma once
+
+// Counting replacements for every form of the global allocation functions,
+// the source of heapCounts() (memory_stats.h). Include this header in exactly
+// one translation unit of a program: src/heap_counter.cpp does so for the
+// interpreter, the tests and the benchmark harness, and the code generator
+// adds it to compiled programs that call mem_stats(). Other compiled programs
+// allocate through the standard library directly and pay nothing for it.
+//
+// Replacement allocation functions may not be inline, so this header defines
+// them out of line; a second inclusion in the same program fails to link.
+
+#include "memory_stats.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace rbasic {
+namespace heap_counter_detail {
+
+inline void* allocate(std::size_t size) {
+    countAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+inline void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    countAllocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    void* p = nullptr;
+    if (align < sizeof(void*)) {
+        align = sizeof(void*);
+    }
+    return posix_memalign(&p, align, size ? size : 1) == 0 ? p : nullptr;
+#endif
+}
+
+inline void releaseAligned(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace heap_counter_detail
+} // namespace rbasic
+
+void* operator new(std::size_t size) {
+    if (void* p = rbasic::heap_counter_detail::allocate(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return rbasic::heap_counter_detail::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return rbasic::heap_counter_detail::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = rbasic::heap_counter_detail::allocateAligned(size, alignment)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return rbasic::heap_counter_detail::allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return rbasic::heap_counter_detail::allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    rbasic::heap_counter_detail::releaseAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    rbasic::heap_counter_detail::releaseAligned(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    rbasic::heap_counter_detail::releaseAligned(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    rbasic::heap_counter_detail::releaseAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    rbasic::heap_counter_detail::releaseAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    rbasic::heap_counter_detail::releaseAligned(p);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef __linux__
+#include <condition_variable>
+#include <filesystem>
+#endif
+
+namespace rbasic {
+
+class FunctionDecl;
+
+// File watching for --watch. The interpreter registers the main file and
+// each file it imports; a background thread notes which of them are saved,
+// and between two statements the interpreter re-parses just those files and
+// swaps in their functions (see Interpreter::reloadChangedFiles). Checking
+// for changes is one atomic load, so a run with nothing saved pays almost
+// nothing for it.
+//
+// On Linux the thread blocks on inotify. It watches the directories rather
+// than the files, as many editors save by writing a new file and renaming
+// it over the old one. Elsewhere it compares modification times four
+// times a second.
+class HotReload {
+public:
+    HotReload();
+    ~HotReload();
+    HotReload(const HotReload&) = delete;
+    HotReload& operator=(const HotReload&) = delete;
+
+    void watch(const std::string& path);  // Watching a file twice is harmless
+
+    bool pending() const { return pending_.load(std::memory_order_acquire); }
+    std::vector<std::string> takeChanged();  // Saved since the last call, as passed to watch
+
+    // A definition that has been replaced. It is kept alive because a call
+    // to it may still be running.
+    void retire(std::shared_ptr<FunctionDecl> definition) { retired_.push_back(std::move(definition)); }
+
+private:
+    void run();
+
+    std::mutex mutex_;
+    std::map<std::string, std::string> files_;  // Absolute path -> path as passed to watch
+    std::set<std::string> changed_;
+    std::atomic<bool> pending_{false};
+    std::vector<std::shared_ptr<FunctionDecl>> retired_;
+
+#ifdef __linux__
+    int inotifyFd_ = -1;
+    int stopFd_ = -1;                           // eventfd that ends the thread
+    std::map<int, std::string> directories_;    // inotify watch -> directory
+#else
+    std::map<std::string, std::filesystem::file_time_type> stamps_;
+    std::condition_variable stop_;
+    bool stopping_ = false;
+#endif
+
+    std::thread thread_;
+};
+
+} // namespace rbasic
@@ -3,6 +3,12 @@
 #include "common.h"
 #include "ast.h"
 #include "io_handler.h"
+#include "profiler.h"
+#include "coverage.h"
+#include "memory_tracker.h"
+#include "slow_trace.h"
+#include "hot_reload.h"
+#include "scratch_pool.h"
 #include <map>
 #include <set>
 #include <stack>
@@ -15,7 +21,7 @@ class Interpreter : public ASTVisitor {
 private:
     std::map<std::string, ValueType> globals;
     std::vector<std::map<std::string, ValueType>> scopes;
-    std::map<std::string, std::unique_ptr<FunctionDecl>> functions;
+    std::map<std::string, std::shared_ptr<FunctionDecl>> functions;
     std::map<std::string, std::unique_ptr<StructDecl>> structs;
     std::map<std::string, std::map<std::string, ValueType>> structInstances;
     std::set<std::string> importedFiles;     // Track imported files to prevent re-importing
@@ -25,17 +31,50 @@ private:
     bool hasReturned;
     std::unique_ptr<IOHandler> ioHandler;
     SourcePosition currentPosition;  // Track current source position for error reporting
+    Profiler* profiler = nullptr;    // Set by --profile
+    Coverage* coverage = nullptr;    // Set by --coverage
+    MemoryTracker* memoryTracker = nullptr;  // Set by --mem-report
+    SlowTrace* slowTrace = nullptr;          // Set by --trace-slow
+    HotReload* hotReload = nullptr;          // Set by --watch
     
-    void defineVariable(const std::string& name, const ValueType& value);
+    // Evaluation temporaries reuse these rather than allocating per expression
+    ScratchPool<int> indexPool;              // Array subscripts
+    ScratchPool<ValueType> argumentPool;     // Call arguments
+    std::vector<std::map<std::string, ValueType>::node_type> spareVariables;  // Nodes from popped scopes
+    
+    void execute(Statement& stmt);
+    
+    // branch 0: if condition true / loop iteration; 1: else / loop exit
+    void countBranch(const Statement& stmt, int branch) {
+        if (coverage && stmt.coverageSlot >= 0) {
+            coverage->counter(stmt.coverageSlot).taken[branch]++;
+        }
+    }
+    
+    void defineVariable(const std::string& name, ValueType value);
     ValueType getVariable(const std::string& name);
+    ValueType* findVariable(const std::string& name);  // nullptr if undefined
+    // Fills indices (a vector leased from indexPool) and returns it
+    const std::vector<int>& evaluateIndices(std::vector<std::unique_ptr<Expression>>& indexExprs,
+                                            std::vector<int>& indices);
     bool variableExists(const std::string& name);
-    void setVariable(const std::string& name, const ValueType& value);
+    void setVariable(const std::string& name, ValueType value);
+    // name[indices] = value, written into the array in place
+    void setArrayElement(const std::string& name, std::vector<std::unique_ptr<Expression>>& indexExprs,
+                         const ValueType& value);
+    
+    // The value of an operand: the variable itself when expr names one and
+    // nothing evaluated after it can assign, otherwise the result in scratch
+    const ValueType& evaluateOperand(Expression& expr, ValueType& scratch, bool borrow);
     
     void pushScope();
     void popScope();
     
     // Import resolution helper
     std::string resolveImportPath(const std::string& filename);
+    
+    // Re-parse the files hotReload saw saved and swap in their functions
+    void reloadChangedFiles();
     std::string getCurrentExecutablePath();
     
 public:
@@ -47,6 +86,28 @@ public:
     // Set current file for import path resolution
     void setCurrentFile(const std::string& filepath) { currentFile = filepath; }
     
+    // Time statements and function calls into profiler (nullptr turns profiling off)
+    void setProfiler(Profiler* p) { profiler = p; }
+    
+    // Count statement, branch and call executions into coverage; the program's
+    // statements must have been registered with coverage->addProgram first
+    void setCoverage(Coverage* c) { coverage = c; }
+    
+    // Count heap allocations per line into tracker (nullptr turns it off)
+    void setMemoryTracker(MemoryTracker* tracker) { memoryTracker = tracker; }
+    
+    // Log statements and function calls slower than the trace's threshold (nullptr turns it off)
+    void setSlowTrace(SlowTrace* trace) { slowTrace = trace; }
+    
+    // Reload functions from watched files as they are saved (nullptr turns it
+    // off); imported files are watched as they are imported
+    void setHotReload(HotReload* reload) { hotReload = reload; }
+    
+    // Bytes held by all live variables, and function bodies kept per file
+    LiveValueBytes liveValueBytes() const;
+    std::vector<RetainedCode> retainedCode() const;
+    ValueType memStatsValue() const;  // The MemStats struct mem_stats() returns
+    
     // Get the IO handler (for external access if needed)
     IOHandler* getIOHandler() const;
     
@@ -55,10 +116,16 @@ public:
     const SourcePosition& getCurrentPosition() const { return currentPosition; }
     
     // Function call dispatch methods
+    void dispatchCall(CallExpr& node);
+    std::string argumentSummary(CallExpr& node);  // For the slow trace: literals and variable values
     bool handleIOFunctions(CallExpr& node);
     bool handleMathFunctions(CallExpr& node);
     bool handleStringFunctions(CallExpr& node);
     bool handleArrayFunctions(CallExpr& node);
+    bool handleTypedArrayOperation(CallExpr& node);
+    bool handleVecArrayOperation(CallExpr& node);
+    // target: index of an argument the builtin updates in place (always the variable itself), or -1
+    std::vector<ValueType*> evaluateArgumentsInPlace(CallExpr& node, std::vector<ValueType>& scratch, int target = -1);
     bool handleFileFunctions(CallExpr& node);
     bool handleTerminalFunctions(CallExpr& node);
     bool handleRPIFunctions(CallExpr& node);
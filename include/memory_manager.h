@@ -71,7 +71,7 @@ private:
     // Thread-safe resource tracking
     mutable std::mutex mutex_;
     std::unordered_set<void*> tracked_resources_;
-    size_t total_allocated_bytes_;
+    size_t total_allocated_bytes_ = 0;
     
     // Private allocation helpers
     void track_resource(void* ptr, size_t size);
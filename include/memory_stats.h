@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rbasic {
+
+// Process-wide heap counters, kept by the replacement allocation functions
+// in heap_counter.h. Both count from program start and never decrease, and
+// both stay 0 in a program that does not include heap_counter.h.
+struct HeapCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+HeapCounts heapCounts();
+void countAllocation(std::size_t bytes) noexcept;
+
+// Resident set size of this process in bytes, or 0 where the platform
+// gives no figure
+std::size_t currentRssBytes();
+std::size_t peakRssBytes();
+
+// Heap bytes owned by a string or vector, beyond the object itself
+inline std::size_t heapBytes(const std::string& s) {
+    const char* data = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    bool inline_buffer = data >= self && data < self + sizeof(s);  // Short string optimisation
+    return inline_buffer ? 0 : s.capacity() + 1;
+}
+
+template<typename T>
+std::size_t heapBytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+// Bytes held by live variables, grouped by the kind of each variable's
+// value; an array of strings counts as array bytes
+struct LiveValueBytes {
+    std::size_t strings = 0;
+    std::size_t arrays = 0;
+    std::size_t structs = 0;
+    std::size_t other = 0;      // Numbers, vectors, matrices, pointers
+    std::size_t variables = 0;
+
+    std::size_t total() const { return strings + arrays + structs + other; }
+};
+
+// "512 B", "3.4 KB", "12.0 MB"
+std::string formatBytes(std::uint64_t bytes);
+
+} // namespace rbasic
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "memory_stats.h"
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rbasic {
+
+class Statement;
+
+// Function bodies kept alive after the file that declared them has run
+struct RetainedCode {
+    std::string file;
+    std::size_t functions = 0;
+    std::size_t statements = 0;
+};
+
+// Per-line heap allocation counts for interpreted programs (--mem-report).
+// Like the profiler, the interpreter brackets every statement with a scope;
+// each line is charged the allocations made while it ran, minus those of
+// statements nested inside it.
+class MemoryTracker {
+public:
+    class LineScope {
+    public:
+        LineScope(MemoryTracker& tracker, const Statement& stmt) : tracker_(tracker) { tracker_.enterLine(stmt); }
+        ~LineScope() { tracker_.exitLine(); }
+        LineScope(const LineScope&) = delete;
+        LineScope& operator=(const LineScope&) = delete;
+
+    private:
+        MemoryTracker& tracker_;
+    };
+
+    void enterLine(const Statement& stmt);
+    void exitLine();
+
+    // Process figures, live values and retained code, then the lines that
+    // allocated the most bytes
+    void writeReport(std::ostream& out, const LiveValueBytes& values, const std::vector<RetainedCode>& code,
+                     std::size_t maxLines = 15) const;
+
+private:
+    struct Stats {
+        std::string name;               // file:line
+        std::uint64_t executions = 0;
+        HeapCounts allocated;
+    };
+
+    struct Frame {
+        std::size_t index;
+        HeapCounts start;
+        HeapCounts children;
+    };
+
+    std::vector<Stats> lines_;
+    std::unordered_map<const Statement*, std::size_t> lineIndex_;
+    std::unordered_map<std::string, std::size_t> lineByName_;
+    std::vector<Frame> frames_;
+};
+
+} // namespace rbasic
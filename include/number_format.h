@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace rbasic {
+
+// Number <-> text conversion shared by the interpreter, the compiled runtime
+// and the code generator. Built on std::to_chars/std::from_chars: no locale,
+// no iostreams, and doubles are written in the shortest form that reads back
+// to the same value (2.5 prints as "2.5", not "2.500000").
+namespace NumberFormat {
+    std::string formatInt(int value);
+    // A double that is exactly a float (a vector component, length, dot)
+    // takes the float's shortest form when that is shorter: 0.8f prints as
+    // "0.8", not "0.800000011920929"
+    std::string formatDouble(double value);
+
+    // Append without a temporary string (CSV writers, join)
+    void appendInt(std::string& out, int value);
+    void appendDouble(std::string& out, double value);
+
+    // C++ source literal that round-trips exactly and is always typed double
+    std::string doubleLiteral(double value);
+
+    // Parse the leading number in text, like stoi/stod: leading whitespace and
+    // a '+' sign are skipped, trailing characters are ignored. Return false if
+    // no number is present or it is out of range.
+    bool parseInt(std::string_view text, int& value);
+    bool parseDouble(std::string_view text, double& value);
+
+    // val()/input() semantics: an int unless the number has a fraction or
+    // exponent (or does not fit in an int), in which case a double
+    enum class NumberKind { NONE, INT, DOUBLE };
+    NumberKind parseNumber(std::string_view text, int& intValue, double& doubleValue);
+
+} // namespace NumberFormat
+
+} // namespace rbasic
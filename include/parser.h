@@ -12,6 +12,7 @@ class Parser {
 private:
     std::vector<Token> tokens;
     size_t current;
+    std::string filename;  // Recorded in statement positions
     
     Token peek() const;
     Token previous() const;
@@ -38,6 +39,7 @@ private:
     
     // Statement parsing
     std::unique_ptr<Statement> statement();
+    std::unique_ptr<Statement> statementBody();
     std::unique_ptr<Statement> varStatement();
     std::unique_ptr<Statement> ifStatement();
     std::unique_ptr<Statement> forStatement();
@@ -54,7 +56,7 @@ private:
     std::vector<std::unique_ptr<Statement>> blockUntil(TokenType endToken);
     
 public:
-    explicit Parser(std::vector<Token> token_list);
+    explicit Parser(std::vector<Token> token_list, std::string source_file = "");
     
     std::unique_ptr<Program> parse();
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rbasic {
+
+// Software framebuffers for procedural graphics, shared by the interpreter
+// and the compiled runtime. A framebuffer is an ordinary typed array, so
+// pixel loops are plain array writes and whole-array builtins work on it:
+//   byte_array(h, w, 4)  R, G, B, A bytes per pixel (what framebuffer(w, h) makes)
+//   int_array(h, w)      one 0xRRGGBB int per pixel, always opaque
+// sdl_present_framebuffer uploads one to a streaming texture, and
+// save_image writes one as a BMP or PPM file without needing SDL.
+namespace PixelImage {
+    enum class Format {
+        RGBA_BYTES,
+        RGB_INTS
+    };
+
+    // A framebuffer's pixels as laid out in memory, rows top to bottom
+    struct View {
+        const void* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        Format format = Format::RGBA_BYTES;
+
+        int pitch() const { return width * 4; }  // Bytes per row in either format
+    };
+
+    // Check that an array has a framebuffer's shape. Throw std::runtime_error if it does not.
+    View byteView(const std::vector<uint8_t>& elements, const std::vector<int>& dimensions);
+    View intView(const std::vector<int>& elements, const std::vector<int>& dimensions);
+
+    // Storage for framebuffer(w, h): h x w x 4 bytes, black and opaque
+    std::vector<uint8_t> blank(int width, int height);
+
+    // Writes a 32-bit BMP or a binary (P6) PPM, chosen by the filename's
+    // extension. PPM has no alpha channel, so it is dropped. Throws
+    // std::runtime_error for any other extension; returns false on I/O failure.
+    bool save(const std::string& filename, const View& image);
+
+} // namespace PixelImage
+
+} // namespace rbasic
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rbasic {
+
+class Statement;
+class FunctionDecl;
+
+// Wall-clock profiler for interpreted programs (--profile). The interpreter
+// brackets every statement and every user function call with a scope, and
+// the clock is read at those boundaries, so a profiled statement costs two
+// clock reads and an unprofiled run costs nothing beyond a null check.
+//
+// Lines and functions both get a count plus inclusive time (everything
+// between entry and exit) and exclusive time (inclusive minus nested lines
+// or called functions). Recursive frames add to inclusive time only once.
+// Function call stacks are also kept for a collapsed-stack ("folded") file
+// that flame graph tools accept.
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class LineScope {
+    public:
+        LineScope(Profiler& profiler, const Statement& stmt) : profiler_(profiler) { profiler_.enterLine(stmt); }
+        ~LineScope() { profiler_.exitLine(); }
+        LineScope(const LineScope&) = delete;
+        LineScope& operator=(const LineScope&) = delete;
+
+    private:
+        Profiler& profiler_;
+    };
+
+    // A null function stands for the top level of the program
+    class FunctionScope {
+    public:
+        FunctionScope(Profiler& profiler, const FunctionDecl* func) : profiler_(profiler) { profiler_.enterFunction(func); }
+        ~FunctionScope() { profiler_.exitFunction(); }
+        FunctionScope(const FunctionScope&) = delete;
+        FunctionScope& operator=(const FunctionScope&) = delete;
+
+    private:
+        Profiler& profiler_;
+    };
+
+    void enterLine(const Statement& stmt);
+    void exitLine();
+    void enterFunction(const FunctionDecl* func);
+    void exitFunction();
+
+    // Flat report: functions, then the busiest lines, by exclusive time
+    void writeReport(std::ostream& out, std::size_t maxLines = 25) const;
+
+    // One "outer;inner;leaf microseconds" line per distinct call stack,
+    // weighted by the exclusive time of the leaf
+    void writeCollapsedStacks(std::ostream& out) const;
+
+private:
+    struct Stats {
+        std::string name;             // Function name, or file:line
+        std::uint64_t count = 0;      // Calls or executions
+        Clock::duration inclusive{};
+        Clock::duration exclusive{};
+        int active = 0;               // Frames of this entry currently open
+    };
+
+    struct Frame {
+        std::size_t index;            // Into lines_ or functions_
+        std::size_t stack;            // Call stack id (function frames only)
+        Clock::time_point start;
+        Clock::duration children{};
+    };
+
+    struct CallStack {
+        std::size_t parent;           // Stack id of the caller, or npos
+        std::size_t function;         // Index into functions_
+        Clock::duration exclusive{};
+    };
+
+    static void enter(std::vector<Stats>& stats, std::vector<Frame>& frames, std::size_t index, std::size_t stack);
+    // Closes the innermost frame and returns its exclusive time
+    static Clock::duration exit(std::vector<Stats>& stats, std::vector<Frame>& frames);
+    std::string stackName(std::size_t stack) const;
+
+    std::vector<Stats> lines_;
+    std::vector<Stats> functions_;
+    std::vector<CallStack> stacks_;
+    std::unordered_map<const Statement*, std::size_t> lineIndex_;
+    std::unordered_map<std::string, std::size_t> lineByName_;
+    std::unordered_map<const FunctionDecl*, std::size_t> functionIndex_;
+    std::unordered_map<std::uint64_t, std::size_t> stackIndex_;  // (parent, function) -> stack id
+    std::vector<Frame> lineFrames_;
+    std::vector<Frame> functionFrames_;
+};
+
+} // namespace rbasic
@@ -4,6 +4,8 @@
 #include "lexer.h"
 #include "parser.h"
 #include "terminal.h"
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -13,15 +15,26 @@ class REPL {
 private:
     Interpreter interpreter;
     std::vector<std::string> history;
-    std::string currentMultilineBuffer;
+    
+    // The statement being entered. Each line is lexed once, as it is typed,
+    // and its tokens appended; lines that end inside a string or block
+    // comment wait in unlexed until it closes.
+    std::vector<Token> pendingTokens;
+    std::string unlexed;
+    int lexedLines;
+    int braceDepth;
     bool inMultilineMode;
     int lineNumber;
     
+    // Names the session has defined at top level, and what they are
+    std::map<std::string, std::string> symbols;
+    
     // Helper methods
     void showWelcome();
     void showHelp();
     void processLine(const std::string& line);
-    bool isCompleteStatement(const std::string& code);
+    void lexPending();
+    bool isCompleteStatement() const;
     void executeBuffer();
     void handleMetaCommand(const std::string& command);
     void listVariables();
@@ -30,7 +43,14 @@ private:
     void saveSession(const std::string& filename);
     void showHistory();
     std::string getPrompt() const;
-    int countBraces(const std::string& code);
+    
+    // Parses code on its own, printing any syntax error; nullptr if one occurred
+    std::unique_ptr<Program> parseCode(const std::string& code);
+    // Runs a parsed program in the session, printing any error; false if one occurred
+    bool runProgram(Program& program);
+    void recordSymbols(const Program& program);
+    void timeCode(const std::string& code);
+    void benchCode(int runs, const std::string& code);
     
 public:
     REPL();
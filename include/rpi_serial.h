@@ -50,6 +50,9 @@ public:
     // Check if serial port is open
     bool isOpen() const { return fd_ >= 0; }
     
+    // Underlying file descriptor, -1 when closed
+    int fd() const { return fd_; }
+    
     // Configure serial port
     bool setBaudRate(BaudRate baud);
     bool setDataBits(int bits);
@@ -109,6 +112,9 @@ extern "C" {
     // Check available data
     int serial_available(int handle);
     
+    // File descriptor of an open port (for wait_event), or -1
+    int serial_fd(int handle);
+    
     // Flush buffer
     void serial_flush(int handle);
     
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace rbasic {
+
+// Vectors for evaluation temporaries (index lists, call arguments) that keep
+// their capacity from one use to the next, so evaluating an expression does
+// not go back to the heap for them once the pool is warm. Nested uses, as in
+// a[b[i]] or f(g(x)), lease successive vectors; a deque keeps the vectors
+// already leased in place while deeper ones are added.
+template<typename T>
+class ScratchPool {
+public:
+    class Lease {
+    public:
+        explicit Lease(ScratchPool& pool) : pool_(pool), items_(pool.acquire()) {}
+        ~Lease() { pool_.release(); }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        std::vector<T>& operator*() { return items_; }
+        std::vector<T>* operator->() { return &items_; }
+
+    private:
+        ScratchPool& pool_;
+        std::vector<T>& items_;
+    };
+
+private:
+    std::vector<T>& acquire() {
+        if (depth_ == vectors_.size()) {
+            vectors_.emplace_back();
+        }
+        return vectors_[depth_++];
+    }
+
+    // Elements are destroyed here, but the vector's storage is kept
+    void release() { vectors_[--depth_].clear(); }
+
+    std::deque<std::vector<T>> vectors_;
+    std::size_t depth_ = 0;
+};
+
+} // namespace rbasic
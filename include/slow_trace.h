@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rbasic {
+
+class Statement;
+class FunctionDecl;
+
+// Slow statement log for interpreted programs (--trace-slow=<ms>). The
+// interpreter times every statement and function call; one that runs past
+// the threshold is written as a line with its position, the user function
+// stack and, for calls, a summary of the arguments. Lines go into a fixed
+// ring that a background thread writes out, so a slow log destination never
+// holds up the program. When the ring is full a line is dropped and counted.
+class SlowTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class StatementScope {
+    public:
+        StatementScope(SlowTrace& trace, const Statement& stmt) : trace_(trace), start_(Clock::now()) {
+            trace_.statements_.push_back(&stmt);
+        }
+        ~StatementScope() { trace_.statementDone(Clock::now() - start_); }
+        StatementScope(const StatementScope&) = delete;
+        StatementScope& operator=(const StatementScope&) = delete;
+
+    private:
+        SlowTrace& trace_;
+        Clock::time_point start_;
+    };
+
+    class FunctionScope {
+    public:
+        FunctionScope(SlowTrace& trace, const FunctionDecl& func) : trace_(trace) { trace_.stack_.push_back(&func); }
+        ~FunctionScope() { trace_.stack_.pop_back(); }
+        FunctionScope(const FunctionScope&) = delete;
+        FunctionScope& operator=(const FunctionScope&) = delete;
+
+    private:
+        SlowTrace& trace_;
+    };
+
+    // Lines are written to out, which must outlive the trace
+    SlowTrace(std::ostream& out, double thresholdMs, std::size_t capacity = 1024);
+    ~SlowTrace();  // Writes out what is left in the ring
+    SlowTrace(const SlowTrace&) = delete;
+    SlowTrace& operator=(const SlowTrace&) = delete;
+
+    bool isSlow(Clock::duration elapsed) const { return elapsed >= threshold_; }
+
+    // A builtin or user function call, name(arguments), made by the innermost open statement
+    void callDone(const std::string& name, const std::string& arguments, Clock::duration elapsed);
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void statementDone(Clock::duration elapsed);  // Closes the innermost statement
+    void push(std::string line);
+    std::string prefix(Clock::duration elapsed) const;
+    void writerLoop();
+
+    std::ostream& out_;
+    Clock::duration threshold_;
+    std::vector<const Statement*> statements_;  // Open statements, innermost last
+    std::vector<const FunctionDecl*> stack_;
+
+    // Single producer (the interpreter) and single consumer (writer_).
+    // head_ and tail_ count lines pushed and written; slots are head_ % size.
+    std::vector<std::string> ring_;
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::thread writer_;
+};
+
+} // namespace rbasic
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rbasic {
+
+// String builtin helpers shared by the interpreter and the compiled runtime.
+// Slicing works on string_view so callers only allocate for the final result.
+// Positions follow BASIC conventions: 1-based, 0 means "not found".
+namespace StringOps {
+    // mid(s, start[, length]); a negative length means "to the end"
+    std::string_view mid(std::string_view s, int start, int length = -1);
+    std::string_view left(std::string_view s, int length);
+    std::string_view right(std::string_view s, int length);
+
+    // 1-based position of needle at or after start, or 0 if not found
+    int instr(std::string_view haystack, std::string_view needle, int start = 1);
+
+    // Pieces between delimiters; an empty delimiter splits into single characters
+    std::vector<std::string_view> split(std::string_view s, std::string_view delimiter);
+
+    // Replaces every occurrence of from with to (no-op for an empty from)
+    std::string replace(std::string_view s, std::string_view from, std::string_view to);
+
+    std::string upper(std::string_view s);
+    std::string lower(std::string_view s);
+    std::string_view trim(std::string_view s);
+
+} // namespace StringOps
+
+} // namespace rbasic
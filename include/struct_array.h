@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "struct_layout.h"
+
+namespace rbasic {
+
+// Struct-of-arrays storage behind `dim name(n) as StructType`.
+// Each field of the struct is kept in its own contiguous column, so
+// arr[i].field is a load from one vector and a loop over a single field
+// walks memory sequentially. Shared by the interpreter and the compiled
+// runtime.
+
+// One field of a struct array. Columns start out as int and widen the first
+// time a wider value is stored: int -> double -> generic (any scalar).
+// Numeric columns stay contiguous machine values and can be handed to the
+// whole-array kernels directly.
+class StructColumn {
+public:
+    using Field = std::variant<int, double, std::string, bool>;
+    enum class Kind { INT, DOUBLE, GENERIC };
+
+    explicit StructColumn(std::size_t size = 0) : ints_(size, 0) {}
+
+    Kind kind() const { return kind_; }
+    std::size_t size() const;
+
+    Field get(std::size_t index) const;
+    void set(std::size_t index, const Field& value);
+
+    // Storage of INT and DOUBLE columns (empty for other kinds)
+    const std::vector<int>& ints() const { return ints_; }
+    const std::vector<double>& doubles() const { return doubles_; }
+
+    // Replace the whole column; the size must match
+    void assign(std::vector<int> values);
+    void assign(std::vector<double> values);
+    void assign(std::vector<Field> values);  // Leaves the column generic
+
+    // Heap bytes held by the column's storage, for memory statistics
+    std::size_t heapBytes() const;
+
+private:
+    void widenToDouble();
+    void widenToGeneric();
+
+    Kind kind_ = Kind::INT;
+    std::vector<int> ints_;
+    std::vector<double> doubles_;
+    std::vector<Field> values_;
+};
+
+struct StructArray {
+    StructLayoutPtr layout;               // Field names in declaration order
+    std::vector<StructColumn> columns;    // Parallel to layout->fieldNames
+    std::vector<int> dimensions;
+
+    StructArray() = default;
+    StructArray(StructLayoutPtr structLayout, const std::vector<int>& dims);
+
+    const std::string& typeName() const { return layout->typeName; }
+    std::size_t size() const;
+    std::size_t heapBytes() const;
+
+    // Column position of a field, or -1 if the struct has no such field
+    int fieldIndex(const std::string& field) const { return layout->fieldIndex(field); }
+
+    // Throws std::runtime_error for an unknown field
+    StructColumn& column(const std::string& field);
+    const StructColumn& column(const std::string& field) const;
+
+    // Row-major flat index; throws std::out_of_range outside the dimensions
+    std::size_t flatIndex(const std::vector<int>& indices) const;
+};
+
+} // namespace rbasic
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rbasic {
+
+// Field layout of a struct type, built once from its declaration and shared
+// by every instance. Instances store their fields in a vector in declaration
+// order, so a field is an index into that vector rather than a name lookup.
+struct StructLayout {
+    std::string typeName;
+    std::vector<std::string> fieldNames;
+
+    StructLayout(std::string type, std::vector<std::string> fields)
+        : typeName(std::move(type)), fieldNames(std::move(fields)) {}
+
+    // Position of a field, or -1 if the struct has no such field
+    int fieldIndex(const std::string& name) const {
+        for (size_t i = 0; i < fieldNames.size(); i++) {
+            if (fieldNames[i] == name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+};
+
+using StructLayoutPtr = std::shared_ptr<const StructLayout>;
+
+inline StructLayoutPtr makeStructLayout(std::string type, std::vector<std::string> fields) {
+    return std::make_shared<const StructLayout>(std::move(type), std::move(fields));
+}
+
+// Inline cache for one member access site (p.x in the source): the field
+// index is resolved on first use and reused while the same layout is seen.
+// Holding the layout keeps the cached pointer from being reused by another.
+class FieldCache {
+public:
+    int lookup(const StructLayoutPtr& layout, const std::string& name) {
+        if (layout != layout_) {
+            layout_ = layout;
+            index_ = layout ? layout->fieldIndex(name) : -1;
+        }
+        return index_;
+    }
+
+private:
+    StructLayoutPtr layout_;
+    int index_ = -1;
+};
+
+} // namespace rbasic
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "glm/glm.hpp"
+
+namespace rbasic {
+
+// A vector component selector (v.x, v.zy, v.xyzw) resolved to lane indices
+// once, so reads and writes index the vector directly instead of comparing
+// component names on every access. Letters come from one of GLSL's sets,
+// xyzw, rgba or stpq, without mixing sets, as with GLM's swizzles.
+struct Swizzle {
+    std::array<std::uint8_t, 4> lanes{};
+    std::uint8_t count = 0;  // 0 if the name is not a swizzle
+
+    bool valid() const { return count > 0; }
+
+    // True if every selected lane exists in a vector of the given size
+    bool fits(int size) const {
+        for (int i = 0; i < count; i++) {
+            if (lanes[i] >= size) {
+                return false;
+            }
+        }
+        return valid();
+    }
+
+    // A swizzle can be assigned to only if no lane repeats (v.xx = ... is ambiguous)
+    bool writable() const {
+        for (int i = 0; i < count; i++) {
+            for (int j = i + 1; j < count; j++) {
+                if (lanes[i] == lanes[j]) {
+                    return false;
+                }
+            }
+        }
+        return valid();
+    }
+};
+
+inline Swizzle parseSwizzle(const std::string& name) {
+    static const char* const sets[] = {"xyzw", "rgba", "stpq"};
+    Swizzle swizzle;
+    if (name.empty() || name.size() > 4) {
+        return swizzle;
+    }
+    for (const char* set : sets) {
+        size_t i = 0;
+        for (; i < name.size(); i++) {
+            int lane = 0;
+            while (lane < 4 && set[lane] != name[i]) {
+                lane++;
+            }
+            if (lane == 4) {
+                break;
+            }
+            swizzle.lanes[i] = static_cast<std::uint8_t>(lane);
+        }
+        if (i == name.size()) {
+            swizzle.count = static_cast<std::uint8_t>(name.size());
+            return swizzle;
+        }
+    }
+    return Swizzle();
+}
+
+// The selected lanes of v as an N-lane vector; swizzle.count must be N and
+// swizzle.fits(L) must hold
+template<glm::length_t N, glm::length_t L, glm::qualifier Q>
+glm::vec<N, float, Q> swizzleRead(const glm::vec<L, float, Q>& v, const Swizzle& swizzle) {
+    glm::vec<N, float, Q> result;
+    for (glm::length_t i = 0; i < N; i++) {
+        result[i] = v[swizzle.lanes[i]];
+    }
+    return result;
+}
+
+// Writes value into the selected lanes of v in place; swizzle must be writable
+template<glm::length_t N, glm::length_t L, glm::qualifier Q>
+void swizzleWrite(glm::vec<L, float, Q>& v, const Swizzle& swizzle, const glm::vec<N, float, Q>& value) {
+    for (glm::length_t i = 0; i < N; i++) {
+        v[swizzle.lanes[i]] = value[i];
+    }
+}
+
+} // namespace rbasic
@@ -0,0 +1,572 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace rbasic {
+
+// The value representation behind both ValueType (interpreter) and
+// BasicValue (compiled runtime): 16 bytes, where std::variant over the same
+// alternatives takes over 100. Numbers, booleans, pointers, vec2 and vec3
+// sit in the value itself, as do strings of up to 14 bytes. Longer strings
+// and every aggregate (arrays, structs, vec4, matrices) live in a
+// reference-counted box, so copying a value never copies an array: the
+// copies share the box until one of them is written.
+//
+// Access follows std::variant, through rbasic::get, get_if,
+// holds_alternative and visit, with two differences that come from the
+// sharing:
+//
+// - A non-const get or get_if gives the value its own copy of a shared box
+//   first, as a write through the result must not show in other copies. A
+//   reference obtained this way is valid until the value is next copied,
+//   assigned or destroyed; copy a value before taking a reference to write
+//   through, not after.
+// - A short string has no std::string to refer to, so const get of a string
+//   returns a copy, and const get_if of a string is not available. Read
+//   strings with text(), which returns a view without copying. A non-const
+//   get moves a short string into a box, which can then grow in place.
+//
+// rbasic::get and friends also accept std::variant, for the few smaller
+// variants (struct fields, generic array elements) that are still variants.
+template<typename... Ts>
+class TaggedValue;
+
+namespace tagged_value_detail {
+
+template<typename T, typename... Ts>
+struct IndexOf;
+
+template<typename T, typename... Ts>
+struct IndexOf<T, T, Ts...> : std::integral_constant<std::size_t, 0> {};
+
+template<typename T, typename U, typename... Ts>
+struct IndexOf<T, U, Ts...> : std::integral_constant<std::size_t, 1 + IndexOf<T, Ts...>::value> {};
+
+template<typename T>
+struct IndexOf<T> : std::integral_constant<std::size_t, 0> {};  // Not an alternative; caught by static_assert
+
+template<typename T, typename... Ts>
+inline constexpr bool contains = (std::is_same_v<T, Ts> || ...);
+
+template<std::size_t I, typename... Ts>
+using Alternative = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+// Alternatives kept in the value rather than a box: numbers, pointers and
+// small plain structs such as vec2 and vec3, which are copied as bytes
+template<typename T>
+inline constexpr bool isInline = std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T> &&
+                                 sizeof(T) <= 14 && alignof(T) <= 8;
+
+struct BoxBase {
+    std::atomic<std::uint32_t> refs{1};
+};
+
+template<typename T>
+struct Box : BoxBase {
+    template<typename... Args>
+    explicit Box(Args&&... args) : value(std::forward<Args>(args)...) {}
+    T value;
+};
+
+// The alternative a converting constructor picks, as std::variant does:
+// overload resolution among the alternatives, leaving out narrowing
+// conversions and taking bool only from bool
+template<typename T>
+using Array1 = T[1];
+
+template<typename T, std::size_t I, typename U, typename = void>
+struct Candidate {
+    void operator()(std::integral_constant<std::size_t, I>) const;  // Not viable; never selected
+};
+
+template<typename T, std::size_t I, typename U>
+struct Candidate<T, I, U,
+                 std::void_t<decltype(Array1<T>{std::declval<U>()}),
+                             std::enable_if_t<!std::is_same_v<T, bool> ||
+                                              std::is_same_v<std::remove_cv_t<std::remove_reference_t<U>>, bool>>>> {
+    std::integral_constant<std::size_t, I> operator()(T) const;
+};
+
+template<typename U, typename Indices, typename... Ts>
+struct Overloads;
+
+template<typename U, std::size_t... Is, typename... Ts>
+struct Overloads<U, std::index_sequence<Is...>, Ts...> : Candidate<Ts, Is, U>... {
+    using Candidate<Ts, Is, U>::operator()...;
+};
+
+template<typename U, typename... Ts>
+using Selected = decltype(Overloads<U, std::index_sequence_for<Ts...>, Ts...>{}(std::declval<U>()));
+
+} // namespace tagged_value_detail
+
+template<typename... Ts>
+class TaggedValue {
+    static_assert(sizeof...(Ts) < 255, "too many alternatives");
+    static_assert(tagged_value_detail::isInline<tagged_value_detail::Alternative<0, Ts...>>,
+                  "the first alternative is the default and must be held inline");
+
+    template<typename...> friend class TaggedValue;
+
+    template<typename T>
+    static constexpr std::size_t indexOf = tagged_value_detail::IndexOf<T, Ts...>::value;
+    static constexpr bool hasString = tagged_value_detail::contains<std::string, Ts...>;
+    static constexpr std::size_t STRING = indexOf<std::string>;
+    static constexpr std::uint8_t BOXED = 0xFF;  // aux_ when storage_ holds a box
+
+    template<typename T>
+    using Box = tagged_value_detail::Box<T>;
+
+public:
+    static constexpr std::size_t SHORT_STRING = 14;  // Longest string held inline
+
+    TaggedValue() noexcept : aux_(0), index_(0) {
+        new (storage_) tagged_value_detail::Alternative<0, Ts...>();
+    }
+
+    TaggedValue(const TaggedValue& other) noexcept { copyFrom(other); }
+
+    TaggedValue(TaggedValue&& other) noexcept {
+        std::memcpy(storage_, other.storage_, sizeof(storage_));
+        aux_ = other.aux_;
+        index_ = other.index_;
+        if (other.aux_ == BOXED) {
+            other.clear();
+        }
+    }
+
+    template<typename U, typename = std::enable_if_t<!std::is_same_v<std::decay_t<U>, TaggedValue>>,
+             std::size_t I = tagged_value_detail::Selected<U&&, Ts...>::value>
+    TaggedValue(U&& value) {
+        construct<I>(std::forward<U>(value));
+    }
+
+    ~TaggedValue() { release(); }
+
+    TaggedValue& operator=(const TaggedValue& other) noexcept {
+        if (this != &other) {
+            if (other.aux_ == BOXED) {
+                other.box()->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+            release();
+            std::memcpy(storage_, other.storage_, sizeof(storage_));
+            aux_ = other.aux_;
+            index_ = other.index_;
+        }
+        return *this;
+    }
+
+    TaggedValue& operator=(TaggedValue&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::memcpy(storage_, other.storage_, sizeof(storage_));
+            aux_ = other.aux_;
+            index_ = other.index_;
+            if (other.aux_ == BOXED) {
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    // Assigning the alternative already held reuses its storage (a string's
+    // buffer, an array's elements) when this value is its only owner
+    template<typename U, typename = std::enable_if_t<!std::is_same_v<std::decay_t<U>, TaggedValue>>,
+             std::size_t I = tagged_value_detail::Selected<U&&, Ts...>::value>
+    TaggedValue& operator=(U&& value) {
+        using T = tagged_value_detail::Alternative<I, Ts...>;
+        if (index_ == I) {
+            if constexpr (tagged_value_detail::isInline<T>) {
+                *inlinePtr<T>() = std::forward<U>(value);
+                return *this;
+            } else {
+                if (aux_ == BOXED && box()->refs.load(std::memory_order_acquire) == 1) {
+                    static_cast<Box<T>*>(box())->value = std::forward<U>(value);
+                    return *this;
+                }
+            }
+        }
+        TaggedValue replacement(std::forward<U>(value));
+        *this = std::move(replacement);
+        return *this;
+    }
+
+    std::size_t index() const noexcept { return index_; }
+
+    // The held string, which must be the current alternative
+    std::string_view text() const noexcept {
+        static_assert(hasString, "no string alternative");
+        if (aux_ == BOXED) {
+            return static_cast<const Box<std::string>*>(box())->value;
+        }
+        return std::string_view(reinterpret_cast<const char*>(storage_), aux_);
+    }
+
+    // The held string when it lives in a box, nullptr when it is held inline
+    const std::string* boxedString() const noexcept {
+        static_assert(hasString, "no string alternative");
+        return aux_ == BOXED ? &static_cast<const Box<std::string>*>(box())->value : nullptr;
+    }
+
+    // Adopts a value of another instantiation whose current alternative is
+    // the same type at the same index (the numbers, strings and pointers
+    // both value types start with), without copying it. False otherwise.
+    template<typename... Us>
+    bool adopt(TaggedValue<Us...>&& other) noexcept {
+        if (!sameAlternative<Us...>(other.index_, std::index_sequence_for<Ts...>{})) {
+            return false;
+        }
+        release();
+        std::memcpy(storage_, other.storage_, sizeof(storage_));
+        aux_ = other.aux_;
+        index_ = other.index_;
+        if (other.aux_ == BOXED) {
+            other.clear();
+        }
+        return true;
+    }
+
+    // Heap bytes of the box behind the value, 0 when it is held inline
+    std::size_t boxBytes() const noexcept {
+        return aux_ == BOXED ? boxSizes[index_] : 0;
+    }
+
+    // Implementation of the free functions below
+    template<typename T>
+    T& mutableRef() {
+        constexpr std::size_t I = indexOf<T>;
+        if constexpr (tagged_value_detail::isInline<T>) {
+            return *inlinePtr<T>();
+        } else {
+            if constexpr (std::is_same_v<T, std::string>) {
+                if (aux_ != BOXED) {
+                    Box<std::string>* boxed = new Box<std::string>(text());
+                    setBox(boxed, I);
+                    return boxed->value;
+                }
+            }
+            unshare<T>();
+            return static_cast<Box<T>*>(box())->value;
+        }
+    }
+
+    template<typename T>
+    const T& constRef() const noexcept {
+        static_assert(!std::is_same_v<T, std::string>, "a short string has no std::string; use text()");
+        if constexpr (tagged_value_detail::isInline<T>) {
+            return *inlinePtr<T>();
+        } else {
+            return static_cast<const Box<T>*>(box())->value;
+        }
+    }
+
+    // The held T as a prvalue, moved out when this value owns it
+    template<typename T>
+    T take() {
+        if constexpr (std::is_same_v<T, std::string>) {
+            if (aux_ != BOXED) {
+                return std::string(text());
+            }
+        }
+        if constexpr (tagged_value_detail::isInline<T>) {
+            return *inlinePtr<T>();
+        } else {
+            auto* boxed = static_cast<Box<T>*>(box());
+            if (boxed->refs.load(std::memory_order_acquire) == 1) {
+                return std::move(boxed->value);
+            }
+            return boxed->value;
+        }
+    }
+
+private:
+    template<std::size_t I, typename U>
+    void construct(U&& value) {
+        using T = tagged_value_detail::Alternative<I, Ts...>;
+        index_ = static_cast<std::uint8_t>(I);
+        if constexpr (tagged_value_detail::isInline<T>) {
+            aux_ = 0;
+            new (storage_) T(std::forward<U>(value));
+        } else if constexpr (std::is_same_v<T, std::string> &&
+                             std::is_convertible_v<U&&, std::string_view>) {
+            std::string_view view(value);
+            if (view.size() <= SHORT_STRING) {
+                setShort(view);
+            } else {
+                setBox(new Box<std::string>(std::forward<U>(value)), I);
+            }
+        } else {
+            setBox(new Box<T>(std::forward<U>(value)), I);
+        }
+    }
+
+    void setShort(std::string_view view) noexcept {
+        std::memcpy(storage_, view.data(), view.size());
+        aux_ = static_cast<std::uint8_t>(view.size());
+    }
+
+    void setBox(tagged_value_detail::BoxBase* boxed, std::size_t index) noexcept {
+        std::memcpy(storage_, &boxed, sizeof(boxed));
+        aux_ = BOXED;
+        index_ = static_cast<std::uint8_t>(index);
+    }
+
+    tagged_value_detail::BoxBase* box() const noexcept {
+        tagged_value_detail::BoxBase* boxed;
+        std::memcpy(&boxed, storage_, sizeof(boxed));
+        return boxed;
+    }
+
+    template<typename T>
+    T* inlinePtr() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    template<typename T>
+    const T* inlinePtr() const noexcept {
+        return std::launder(reinterpret_cast<const T*>(storage_));
+    }
+
+    template<typename T>
+    void unshare() {
+        auto* boxed = static_cast<Box<T>*>(box());
+        if (boxed->refs.load(std::memory_order_acquire) != 1) {
+            auto* copy = new Box<T>(boxed->value);
+            release();
+            setBox(copy, indexOf<T>);
+        }
+    }
+
+    void copyFrom(const TaggedValue& other) noexcept {
+        std::memcpy(storage_, other.storage_, sizeof(storage_));
+        aux_ = other.aux_;
+        index_ = other.index_;
+        if (aux_ == BOXED) {
+            box()->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Drops this value's reference to its box, if it has one; the value is
+    // left for the caller to overwrite
+    void release() noexcept {
+        if (aux_ == BOXED) {
+            tagged_value_detail::BoxBase* boxed = box();
+            if (boxed->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                destroyers[index_](boxed);
+            }
+        }
+    }
+
+    // A moved-from value holds the empty string if it held a string, else
+    // the first alternative
+    void clear() noexcept {
+        if constexpr (hasString) {
+            if (index_ == STRING) {
+                aux_ = 0;
+                return;
+            }
+        }
+        aux_ = 0;
+        index_ = 0;
+        new (storage_) tagged_value_detail::Alternative<0, Ts...>();
+    }
+
+    template<typename... Us, std::size_t... Is>
+    static constexpr bool sameAlternative(std::size_t index, std::index_sequence<Is...>) {
+        return ((index == Is && Is < sizeof...(Us) && sameAt<Is, Us...>()) || ...);
+    }
+
+    template<std::size_t I, typename... Us>
+    static constexpr bool sameAt() {
+        if constexpr (I < sizeof...(Us)) {
+            return std::is_same_v<tagged_value_detail::Alternative<I, Ts...>,
+                                  tagged_value_detail::Alternative<I, Us...>>;
+        } else {
+            return false;
+        }
+    }
+
+    template<typename T>
+    static void destroy(tagged_value_detail::BoxBase* boxed) noexcept {
+        delete static_cast<Box<T>*>(boxed);
+    }
+
+    template<typename T>
+    static constexpr std::size_t boxSize() noexcept {
+        if constexpr (tagged_value_detail::isInline<T>) {
+            return 0;
+        } else {
+            return sizeof(Box<T>);
+        }
+    }
+
+    static constexpr void (*destroyers[])(tagged_value_detail::BoxBase*) = {&destroy<Ts>...};
+    static constexpr std::size_t boxSizes[] = {boxSize<Ts>()...};
+
+    alignas(8) unsigned char storage_[SHORT_STRING];  // Inline alternative, short string or box pointer
+    std::uint8_t aux_;                                // Short string length, or BOXED
+    std::uint8_t index_;                              // Current alternative
+};
+
+// std::variant-style access
+
+template<typename T, typename... Ts>
+bool holds_alternative(const TaggedValue<Ts...>& value) noexcept {
+    static_assert(tagged_value_detail::contains<T, Ts...>, "not an alternative");
+    return value.index() == tagged_value_detail::IndexOf<T, Ts...>::value;
+}
+
+template<typename T, typename... Ts>
+T& get(TaggedValue<Ts...>& value) {
+    if (!rbasic::holds_alternative<T>(value)) {
+        throw std::bad_variant_access();
+    }
+    return value.template mutableRef<T>();
+}
+
+// A string comes back as a copy; other alternatives by const reference
+template<typename T, typename... Ts>
+std::conditional_t<std::is_same_v<T, std::string>, std::string, const T&> get(const TaggedValue<Ts...>& value) {
+    if (!rbasic::holds_alternative<T>(value)) {
+        throw std::bad_variant_access();
+    }
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(value.text());
+    } else {
+        return value.template constRef<T>();
+    }
+}
+
+template<typename T, typename... Ts>
+T get(TaggedValue<Ts...>&& value) {
+    if (!rbasic::holds_alternative<T>(value)) {
+        throw std::bad_variant_access();
+    }
+    return value.template take<T>();
+}
+
+template<typename T, typename... Ts>
+T* get_if(TaggedValue<Ts...>* value) {
+    if (!value || !rbasic::holds_alternative<T>(*value)) {
+        return nullptr;
+    }
+    return &value->template mutableRef<T>();
+}
+
+template<typename T, typename... Ts>
+const T* get_if(const TaggedValue<Ts...>* value) noexcept {
+    if (!value || !rbasic::holds_alternative<T>(*value)) {
+        return nullptr;
+    }
+    return &value->template constRef<T>();
+}
+
+namespace tagged_value_detail {
+
+template<typename T, typename F, typename V>
+decltype(auto) visitOne(F&& visitor, V&& value) {
+    if constexpr (std::is_same_v<T, std::string> && std::is_const_v<std::remove_reference_t<V>>) {
+        const std::string text(value.text());
+        return std::forward<F>(visitor)(text);
+    } else if constexpr (std::is_lvalue_reference_v<V>) {
+        if constexpr (std::is_const_v<std::remove_reference_t<V>>) {
+            return std::forward<F>(visitor)(value.template constRef<T>());
+        } else {
+            return std::forward<F>(visitor)(value.template mutableRef<T>());
+        }
+    } else {
+        return std::forward<F>(visitor)(value.template take<T>());
+    }
+}
+
+template<std::size_t I, typename R, typename F, typename V, typename... Ts>
+R visitAt(F&& visitor, V&& value) {
+    return visitOne<Alternative<I, Ts...>>(std::forward<F>(visitor), std::forward<V>(value));
+}
+
+template<typename F, typename V, typename... Ts, std::size_t... Is>
+decltype(auto) visitIndex(F&& visitor, V&& value, std::index_sequence<Is...>) {
+    using R = decltype(visitOne<Alternative<0, Ts...>>(std::forward<F>(visitor), std::forward<V>(value)));
+    using Dispatch = R (*)(F&&, V&&);
+    static constexpr Dispatch table[] = {&visitAt<Is, R, F, V, Ts...>...};
+    return table[value.index()](std::forward<F>(visitor), std::forward<V>(value));
+}
+
+} // namespace tagged_value_detail
+
+template<typename F, typename... Ts>
+decltype(auto) visit(F&& visitor, TaggedValue<Ts...>& value) {
+    return tagged_value_detail::visitIndex<F, TaggedValue<Ts...>&, Ts...>(
+        std::forward<F>(visitor), value, std::index_sequence_for<Ts...>{});
+}
+
+template<typename F, typename... Ts>
+decltype(auto) visit(F&& visitor, const TaggedValue<Ts...>& value) {
+    return tagged_value_detail::visitIndex<F, const TaggedValue<Ts...>&, Ts...>(
+        std::forward<F>(visitor), value, std::index_sequence_for<Ts...>{});
+}
+
+template<typename F, typename... Ts>
+decltype(auto) visit(F&& visitor, TaggedValue<Ts...>&& value) {
+    return tagged_value_detail::visitIndex<F, TaggedValue<Ts...>&&, Ts...>(
+        std::forward<F>(visitor), std::move(value), std::index_sequence_for<Ts...>{});
+}
+
+// The same calls on std::variant
+
+template<typename T, typename... Ts>
+bool holds_alternative(const std::variant<Ts...>& value) noexcept {
+    return std::holds_alternative<T>(value);
+}
+
+template<typename T, typename... Ts>
+T& get(std::variant<Ts...>& value) {
+    return std::get<T>(value);
+}
+
+template<typename T, typename... Ts>
+const T& get(const std::variant<Ts...>& value) {
+    return std::get<T>(value);
+}
+
+template<typename T, typename... Ts>
+T&& get(std::variant<Ts...>&& value) {
+    return std::get<T>(std::move(value));
+}
+
+template<typename T, typename... Ts>
+T* get_if(std::variant<Ts...>* value) noexcept {
+    return std::get_if<T>(value);
+}
+
+template<typename T, typename... Ts>
+const T* get_if(const std::variant<Ts...>* value) noexcept {
+    return std::get_if<T>(value);
+}
+
+template<typename F, typename... Ts>
+decltype(auto) visit(F&& visitor, std::variant<Ts...>& value) {
+    return std::visit(std::forward<F>(visitor), value);
+}
+
+template<typename F, typename... Ts>
+decltype(auto) visit(F&& visitor, const std::variant<Ts...>& value) {
+    return std::visit(std::forward<F>(visitor), value);
+}
+
+template<typename F, typename... Ts>
+decltype(auto) visit(F&& visitor, std::variant<Ts...>&& value) {
+    return std::visit(std::forward<F>(visitor), std::move(value));
+}
+
+} // namespace rbasic
@@ -71,6 +71,21 @@ public:
     // Get a single character (blocking)
     static int getch();
     
+    // Next key, or "" if none arrives within timeoutMs (0 polls, negative
+    // waits forever). Printable keys come back as their text and others by
+    // name: "UP", "DOWN", "LEFT", "RIGHT", "HOME", "END", "PGUP", "PGDN",
+    // "INSERT", "DELETE", "F1".."F12", "ENTER", "TAB", "BACKSPACE", "ESC";
+    // other control keys as their character. The first call switches the
+    // terminal to raw mode once and starts a thread that reads and decodes
+    // keys into a lock-free queue, so polling costs no system call. While it
+    // runs kbhit and getch take keys from the queue; cleanup, getline,
+    // getCursor and input stop it and restore the terminal.
+    static std::string readKey(int timeoutMs);
+
+    // Stop readKey's reader, if running, and restore the terminal. Anything
+    // that reads whole lines from stdin calls this first.
+    static void stopReadingKeys();
+    
     // Get a string with optional prompt and colour
     static std::string getline(const std::string& prompt = "", Colour promptColour = Colour::DEFAULT);
     
@@ -79,6 +94,16 @@ public:
     
     // Enable/disable echo (for password input)
     static void setEcho(bool enabled);
+    
+    // Off-screen frame for full-screen redraws. beginFrame starts a blank
+    // frame the size of the terminal; put writes text into it, clipped to
+    // the screen, with a newline going on at col on the next row. endFrame
+    // sends only the cells that differ from the frame last shown, in one
+    // write. After clear(), or when the terminal is resized, the next frame
+    // is drawn in full.
+    static void beginFrame();
+    static void put(int row, int col, const std::string& text, Colour foreground = Colour::DEFAULT, Colour background = Colour::DEFAULT);
+    static void endFrame();
 
 private:
     // All state is now encapsulated in TerminalState (see terminal.cpp)
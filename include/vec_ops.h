@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+namespace rbasic {
+
+// Whole-array kernels over packed vec3/vec4 arrays (vec3_array, vec4_array).
+// Shared by the interpreter and the compiled runtime. Vectors are Lanes
+// consecutive floats (x, y, z[, w]) with no padding, which is how
+// std::vector<glm::vec3> and std::vector<glm::vec4> lay them out. On x86 the
+// per-vector maths uses GLM's SSE helpers (glm/simd); arrays above
+// ArrayOps::PARALLEL_THRESHOLD are split across threads. Instantiated for
+// Lanes = 3 and 4; out may alias in.
+namespace VecOps {
+    // out[i] = m * in[i], m a column-major 4x4 matrix (16 floats).
+    // vec3 elements are treated as points (w = 1) and the w result dropped.
+    template<int Lanes> void transform(const float* m, const float* in, float* out, std::size_t n);
+
+    // q is a unit quaternion given as x, y, z, w. vec4 elements keep their w.
+    template<int Lanes> void rotate(const float* q, const float* in, float* out, std::size_t n);
+
+    template<int Lanes> void normalize(const float* in, float* out, std::size_t n);
+
+    // out[i] = dot(a[i], b[i])
+    template<int Lanes> void dot(const float* a, const float* b, double* out, std::size_t n);
+
+} // namespace VecOps
+
+} // namespace rbasic
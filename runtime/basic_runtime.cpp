@@ -2,6 +2,15 @@
 #include "../include/io_handler.h"
 #include "../include/common.h"
 #include "../include/terminal.h"
+#include "../include/array_ops.h"
+#include "../include/string_ops.h"
+#include "../include/number_format.h"
+#include "../include/array_file.h"
+#include "../include/pixel_image.h"
+#include "../include/event_wait.h"
+#include "../include/vec_ops.h"
+#include "../include/swizzle.h"
+#include "../include/memory_stats.h"
 
 // Raspberry Pi hardware support (conditional)
 #ifdef RPI_SUPPORT_ENABLED
@@ -74,80 +83,21 @@ void parallel_fill_array(BasicArray& array, const BasicValue& value) {
 }
 
 void parallel_fill_int_array(BasicIntArray& array, int value) {
-    int size = static_cast<int>(array.elements.size());
-#ifdef _OPENMP
-    if (size > 1000) { // Only parallelize large arrays
-        #pragma omp parallel for
-        for (int i = 0; i < size; ++i) {
-            array.elements[i] = value;
-        }
-    } else {
-#endif
-        // Use serial loop for small arrays or when OpenMP not available
-        for (int i = 0; i < size; ++i) {
-            array.elements[i] = value;
-        }
-#ifdef _OPENMP
-    }
-#endif
+    rbasic::ArrayOps::fill(array.elements.data(), value, array.elements.size());
 }
 
 void parallel_fill_double_array(BasicDoubleArray& array, double value) {
-    int size = static_cast<int>(array.elements.size());
-#ifdef _OPENMP
-    if (size > 1000) { // Only parallelize large arrays
-        #pragma omp parallel for
-        for (int i = 0; i < size; ++i) {
-            array.elements[i] = value;
-        }
-    } else {
-#endif
-        // Use serial loop for small arrays or when OpenMP not available
-        for (int i = 0; i < size; ++i) {
-            array.elements[i] = value;
-        }
-#ifdef _OPENMP
-    }
-#endif
+    rbasic::ArrayOps::fill(array.elements.data(), value, array.elements.size());
 }
 
 void parallel_array_add(BasicDoubleArray& result, const BasicDoubleArray& a, const BasicDoubleArray& b) {
-    auto min_size = std::min(a.elements.size(), b.elements.size());
-    int size = static_cast<int>(min_size);
+    auto size = std::min(a.elements.size(), b.elements.size());
     result.elements.resize(size);
-    
-#ifdef _OPENMP
-    if (size > 1000) { // Only parallelize large arrays
-        #pragma omp parallel for
-        for (int i = 0; i < size; ++i) {
-            result.elements[i] = a.elements[i] + b.elements[i];
-        }
-    } else {
-#endif
-        for (int i = 0; i < size; ++i) {
-            result.elements[i] = a.elements[i] + b.elements[i];
-        }
-#ifdef _OPENMP
-    }
-#endif
+    rbasic::ArrayOps::add(a.elements.data(), b.elements.data(), result.elements.data(), size);
 }
 
 void parallel_array_multiply_scalar(BasicDoubleArray& array, double scalar) {
-    int size = static_cast<int>(array.elements.size());
-#ifdef _OPENMP
-    if (size > 1000) { // Only parallelize large arrays
-        #pragma omp parallel for
-        for (int i = 0; i < size; ++i) {
-            array.elements[i] = array.elements[i] * scalar;
-        }
-    } else {
-#endif
-        for (int i = 0; i < size; ++i) {
-            array.elements[i] = array.elements[i] * scalar;
-        }
-#ifdef _OPENMP
-    }
-#endif
+    rbasic::ArrayOps::multiplyScalar(array.elements.data(), scalar, array.elements.data(), array.elements.size());
 }
 
 // Global IOHandler for compiled programs
@@ -211,67 +161,143 @@ BasicValue input() {
     if (g_io_handler) {
         line = g_io_handler->input();
     } else {
+        rbasic::Terminal::stopReadingKeys();
         std::getline(std::cin, line);
     }
     
     // Try to parse as number
-    try {
-        if (rbasic::hasDecimalPoint(line)) {
-            return std::stod(line);
-        } else {
-            return std::stoi(line);
-        }
-    } catch (const std::exception&) {
-        return line; // Return as string if not a number
+    int intValue = 0;
+    double doubleValue = 0.0;
+    switch (rbasic::NumberFormat::parseNumber(line, intValue, doubleValue)) {
+        case rbasic::NumberFormat::NumberKind::INT: return intValue;
+        case rbasic::NumberFormat::NumberKind::DOUBLE: return doubleValue;
+        default: return line; // Return as string if not a number
     }
 }
 
 int len(const BasicValue& str) {
+    // len of an array is its number of elements
+    if (auto* array = rbasic::get_if<BasicArray>(&str)) {
+        return static_cast<int>(array->elements.size());
+    } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&str)) {
+        return static_cast<int>(bytes->elements.size());
+    } else if (auto* ints = rbasic::get_if<BasicIntArray>(&str)) {
+        return static_cast<int>(ints->elements.size());
+    } else if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&str)) {
+        return static_cast<int>(doubles->elements.size());
+    } else if (auto* structArray = rbasic::get_if<BasicStructArray>(&str)) {
+        return static_cast<int>(structArray->size());
+    } else if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&str)) {
+        return static_cast<int>(vec3s->elements.size());
+    } else if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&str)) {
+        return static_cast<int>(vec4s->elements.size());
+    }
     return static_cast<int>(to_string(str).length());
 }
 
 BasicValue mid(const BasicValue& str, int start, int length) {
     std::string s = to_string(str);
-    int adjusted_start = std::max(0, start - 1); // BASIC is 1-indexed
-    start = adjusted_start;
-    
-    if (length == -1) {
-        return s.substr(start);
-    } else {
-        return s.substr(start, length);
-    }
+    return std::string(rbasic::StringOps::mid(s, start, length));
 }
 
 BasicValue left(const BasicValue& str, int length) {
     std::string s = to_string(str);
-    return s.substr(0, length);
+    return std::string(rbasic::StringOps::left(s, length));
 }
 
 BasicValue right(const BasicValue& str, int length) {
     std::string s = to_string(str);
-    int string_len = static_cast<int>(s.length());
-    int start = std::max(0, string_len - length);
-    return s.substr(start);
+    return std::string(rbasic::StringOps::right(s, length));
 }
 
-BasicValue val(const BasicValue& str) {
+BasicValue func_instr(const BasicValue& str, const BasicValue& find, const BasicValue& start) {
     std::string s = to_string(str);
-    try {
-        if (rbasic::hasDecimalPoint(s)) {
-            return std::stod(s);
-        } else {
-            return std::stoi(s);
+    std::string f = to_string(find);
+    return rbasic::StringOps::instr(s, f, to_int(start));
+}
+
+BasicValue func_split(const BasicValue& str, const BasicValue& delimiter) {
+    std::string s = to_string(str);
+    std::string d = to_string(delimiter);
+    auto parts = rbasic::StringOps::split(s, d);
+    BasicArray result({static_cast<int>(parts.size())});
+    for (size_t i = 0; i < parts.size(); i++) {
+        result.elements[i] = std::string(parts[i]);
+    }
+    return result;
+}
+
+BasicValue func_join(const BasicValue& array, const BasicValue& separator) {
+    std::string sep = to_string(separator);
+    std::string result;
+    auto join_elements = [&](const auto& elements) {
+        for (size_t i = 0; i < elements.size(); i++) {
+            if (i > 0) {
+                result += sep;
+            }
+            result += to_string(BasicValue(elements[i]));
         }
-    } catch (const std::exception&) {
-        return 0; // Default to 0 if conversion fails
+    };
+    if (auto* generic = rbasic::get_if<BasicArray>(&array)) {
+        join_elements(generic->elements);
+    } else if (auto* ints = rbasic::get_if<BasicIntArray>(&array)) {
+        join_elements(ints->elements);
+    } else if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&array)) {
+        join_elements(doubles->elements);
+    } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&array)) {
+        std::vector<int> widened(bytes->elements.begin(), bytes->elements.end());
+        join_elements(widened);
+    } else {
+        throw std::runtime_error("join requires an array");
+    }
+    return result;
+}
+
+BasicValue func_replace(const BasicValue& str, const BasicValue& from, const BasicValue& to) {
+    std::string s = to_string(str);
+    std::string f = to_string(from);
+    std::string t = to_string(to);
+    return rbasic::StringOps::replace(s, f, t);
+}
+
+BasicValue func_upper(const BasicValue& str) {
+    if (rbasic::holds_alternative<std::string>(str)) {
+        return rbasic::StringOps::upper(str.text());
+    }
+    return rbasic::StringOps::upper(to_string(str));
+}
+
+BasicValue func_lower(const BasicValue& str) {
+    if (rbasic::holds_alternative<std::string>(str)) {
+        return rbasic::StringOps::lower(str.text());
+    }
+    return rbasic::StringOps::lower(to_string(str));
+}
+
+BasicValue func_trim(const BasicValue& str) {
+    if (rbasic::holds_alternative<std::string>(str)) {
+        return std::string(rbasic::StringOps::trim(str.text()));
+    }
+    std::string s = to_string(str);
+    return std::string(rbasic::StringOps::trim(s));
+}
+
+BasicValue val(const BasicValue& str) {
+    std::string s = to_string(str);
+    int intValue = 0;
+    double doubleValue = 0.0;
+    switch (rbasic::NumberFormat::parseNumber(s, intValue, doubleValue)) {
+        case rbasic::NumberFormat::NumberKind::INT: return intValue;
+        case rbasic::NumberFormat::NumberKind::DOUBLE: return doubleValue;
+        default: return 0; // Default to 0 if conversion fails
     }
 }
 
 BasicValue abs_val(const BasicValue& value) {
-    if (std::holds_alternative<int>(value)) {
-        return std::abs(std::get<int>(value));
-    } else if (std::holds_alternative<double>(value)) {
-        return std::abs(std::get<double>(value));
+    if (rbasic::holds_alternative<int>(value)) {
+        return std::abs(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return std::abs(rbasic::get<double>(value));
     }
     return 0;
 }
@@ -438,154 +464,919 @@ BasicIntArray int_array_range(int start, int end) {
     return arr;
 }
 
-// Typed array element access
-uint8_t get_byte_array_element(const BasicByteArray& array, const std::vector<int>& indices) {
-    return array.at(indices);
+// Typed array element access
+uint8_t get_byte_array_element(const BasicByteArray& array, const std::vector<int>& indices) {
+    return array.at(indices);
+}
+
+void set_byte_array_element(BasicByteArray& array, const std::vector<int>& indices, uint8_t value) {
+    array.at(indices) = value;
+}
+
+int get_int_array_element(const BasicIntArray& array, const std::vector<int>& indices) {
+    return array.at(indices);
+}
+
+void set_int_array_element(BasicIntArray& array, const std::vector<int>& indices, int value) {
+    array.at(indices) = value;
+}
+
+double get_double_array_element(const BasicDoubleArray& array, const std::vector<int>& indices) {
+    return array.at(indices);
+}
+
+void set_double_array_element(BasicDoubleArray& array, const std::vector<int>& indices, double value) {
+    array.at(indices) = value;
+}
+
+// Wrapper functions for code generator (with func_ prefix)
+BasicValue func_byte_array(int size) {
+    return BasicByteArray({size});
+}
+
+BasicValue func_int_array(int size) {
+    return BasicIntArray({size});
+}
+
+BasicValue func_double_array(int size) {
+    return BasicDoubleArray({size});
+}
+
+// Whole-array operations on typed arrays (kernels shared with the interpreter)
+namespace {
+
+template<typename Fn>
+bool with_typed_array(const BasicValue& value, Fn&& fn) {
+    if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&value)) {
+        fn(*doubles);
+    } else if (auto* ints = rbasic::get_if<BasicIntArray>(&value)) {
+        fn(*ints);
+    } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&value)) {
+        fn(*bytes);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template<typename Fn>
+bool with_typed_array(BasicValue& value, Fn&& fn) {
+    if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&value)) {
+        fn(*doubles);
+    } else if (auto* ints = rbasic::get_if<BasicIntArray>(&value)) {
+        fn(*ints);
+    } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&value)) {
+        fn(*bytes);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+T typed_array_scalar(const BasicValue& value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return to_double(value);
+    } else {
+        return static_cast<T>(to_int(value));
+    }
+}
+
+template<typename T, typename R>
+BasicValue typed_array_result(R value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<double>(value);
+    } else {
+        return static_cast<int>(value);
+    }
+}
+
+bool is_number(const BasicValue& value) {
+    return rbasic::holds_alternative<int>(value) || rbasic::holds_alternative<double>(value);
+}
+
+[[noreturn]] void typed_array_error(const std::string& name) {
+    throw std::runtime_error(name + " requires a typed array (byte_array, int_array or double_array)");
+}
+
+BasicValue array_elementwise(const char* name, char op, const BasicValue& left, const BasicValue& right) {
+    BasicValue result;
+    bool handled = with_typed_array(left, [&](const auto& a) {
+        using ArrayT = std::decay_t<decltype(a)>;
+        using T = typename decltype(a.elements)::value_type;
+        ArrayT out;
+        out.dimensions = a.dimensions;
+        out.elements.resize(a.elements.size());
+        const size_t n = a.elements.size();
+
+        if (auto* b = rbasic::get_if<ArrayT>(&right)) {
+            if (b->elements.size() != n) {
+                throw std::runtime_error(std::string(name) + " requires arrays of the same size");
+            }
+            if constexpr (std::is_integral_v<T>) {
+                if (op == 'd' && rbasic::ArrayOps::containsZero(b->elements.data(), n)) {
+                    throw std::runtime_error("Division by zero");
+                }
+            }
+            switch (op) {
+                case 'a': rbasic::ArrayOps::add(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                case 's': rbasic::ArrayOps::subtract(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                case 'm': rbasic::ArrayOps::multiply(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                default:  rbasic::ArrayOps::divide(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+            }
+        } else if (is_number(right)) {
+            T s = typed_array_scalar<T>(right);
+            if (op == 'd' && s == T()) {
+                throw std::runtime_error("Division by zero");
+            }
+            switch (op) {
+                case 'a': rbasic::ArrayOps::addScalar(a.elements.data(), s, out.elements.data(), n); break;
+                case 's': rbasic::ArrayOps::subtractScalar(a.elements.data(), s, out.elements.data(), n); break;
+                case 'm': rbasic::ArrayOps::multiplyScalar(a.elements.data(), s, out.elements.data(), n); break;
+                default:  rbasic::ArrayOps::divideScalar(a.elements.data(), s, out.elements.data(), n); break;
+            }
+        } else {
+            throw std::runtime_error(std::string(name) + " requires a typed array of the same type or a number as its second argument");
+        }
+        result = std::move(out);
+    });
+    if (!handled) {
+        typed_array_error(name);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+BasicValue func_array_add(const BasicValue& a, const BasicValue& b) {
+    return array_elementwise("array_add", 'a', a, b);
+}
+
+BasicValue func_array_sub(const BasicValue& a, const BasicValue& b) {
+    return array_elementwise("array_sub", 's', a, b);
+}
+
+BasicValue func_array_mul(const BasicValue& a, const BasicValue& b) {
+    return array_elementwise("array_mul", 'm', a, b);
+}
+
+BasicValue func_array_div(const BasicValue& a, const BasicValue& b) {
+    return array_elementwise("array_div", 'd', a, b);
+}
+
+BasicValue func_array_axpy(const BasicValue& alpha, const BasicValue& x, BasicValue& y) {
+    bool handled = with_typed_array(y, [&](auto& ys) {
+        using ArrayT = std::decay_t<decltype(ys)>;
+        using T = typename decltype(ys.elements)::value_type;
+        auto* xs = rbasic::get_if<ArrayT>(&x);
+        if (!xs || xs->elements.size() != ys.elements.size()) {
+            throw std::runtime_error("array_axpy requires x and y to be typed arrays of the same type and size");
+        }
+        rbasic::ArrayOps::axpy(typed_array_scalar<T>(alpha), xs->elements.data(), ys.elements.data(), ys.elements.size());
+    });
+    if (!handled) {
+        typed_array_error("array_axpy");
+    }
+    return 0;
+}
+
+BasicValue func_array_sum(const BasicValue& array) {
+    BasicValue result;
+    bool handled = with_typed_array(array, [&](const auto& a) {
+        result = rbasic::ArrayOps::sum(a.elements.data(), a.elements.size());
+    });
+    if (!handled) {
+        typed_array_error("array_sum");
+    }
+    return result;
+}
+
+BasicValue func_array_min(const BasicValue& array) {
+    BasicValue result;
+    bool handled = with_typed_array(array, [&](const auto& a) {
+        using T = typename decltype(a.elements)::value_type;
+        if (a.elements.empty()) {
+            throw std::runtime_error("array_min requires a non-empty array");
+        }
+        result = typed_array_result<T>(rbasic::ArrayOps::minValue(a.elements.data(), a.elements.size()));
+    });
+    if (!handled) {
+        typed_array_error("array_min");
+    }
+    return result;
+}
+
+BasicValue func_array_max(const BasicValue& array) {
+    BasicValue result;
+    bool handled = with_typed_array(array, [&](const auto& a) {
+        using T = typename decltype(a.elements)::value_type;
+        if (a.elements.empty()) {
+            throw std::runtime_error("array_max requires a non-empty array");
+        }
+        result = typed_array_result<T>(rbasic::ArrayOps::maxValue(a.elements.data(), a.elements.size()));
+    });
+    if (!handled) {
+        typed_array_error("array_max");
+    }
+    return result;
+}
+
+BasicValue func_array_mean(const BasicValue& array) {
+    BasicValue result;
+    bool handled = with_typed_array(array, [&](const auto& a) {
+        if (a.elements.empty()) {
+            throw std::runtime_error("array_mean requires a non-empty array");
+        }
+        result = rbasic::ArrayOps::sum(a.elements.data(), a.elements.size()) / static_cast<double>(a.elements.size());
+    });
+    if (!handled) {
+        typed_array_error("array_mean");
+    }
+    return result;
+}
+
+BasicValue func_array_dot(const BasicValue& a, const BasicValue& b) {
+    BasicValue result;
+    bool handled = with_typed_array(a, [&](const auto& as) {
+        using ArrayT = std::decay_t<decltype(as)>;
+        auto* bs = rbasic::get_if<ArrayT>(&b);
+        if (!bs || bs->elements.size() != as.elements.size()) {
+            throw std::runtime_error("array_dot requires typed arrays of the same type and size");
+        }
+        result = rbasic::ArrayOps::dot(as.elements.data(), bs->elements.data(), as.elements.size());
+    });
+    if (!handled) {
+        typed_array_error("array_dot");
+    }
+    return result;
+}
+
+BasicValue func_array_fill(BasicValue& array, const BasicValue& value) {
+    bool handled = with_typed_array(array, [&](auto& a) {
+        using T = typename decltype(a.elements)::value_type;
+        rbasic::ArrayOps::fill(a.elements.data(), typed_array_scalar<T>(value), a.elements.size());
+    });
+    if (!handled) {
+        typed_array_error("array_fill");
+    }
+    return 0;
+}
+
+BasicValue func_array_copy(BasicValue& dst, const BasicValue& dstStart, const BasicValue& src, const BasicValue& srcStart, const BasicValue& count) {
+    const int dstOffset = to_int(dstStart);
+    const int srcOffset = to_int(srcStart);
+    const int n = to_int(count);
+    bool handled = with_typed_array(dst, [&](auto& d) {
+        using ArrayT = std::decay_t<decltype(d)>;
+        auto* s = rbasic::get_if<ArrayT>(&src);
+        if (!s) {
+            throw std::runtime_error("array_copy requires source and destination arrays of the same type");
+        }
+        if (dstOffset < 0 || srcOffset < 0 || n < 0 ||
+            static_cast<size_t>(dstOffset) + n > d.elements.size() ||
+            static_cast<size_t>(srcOffset) + n > s->elements.size()) {
+            throw std::runtime_error("array_copy range out of bounds");
+        }
+        rbasic::ArrayOps::copy(s->elements.data() + srcOffset, d.elements.data() + dstOffset, static_cast<size_t>(n));
+    });
+    if (!handled) {
+        typed_array_error("array_copy");
+    }
+    return n;
+}
+
+BasicValue func_array_slice(const BasicValue& array, const BasicValue& start, const BasicValue& count) {
+    const int offset = to_int(start);
+    const int n = to_int(count);
+    BasicValue result;
+    bool handled = with_typed_array(array, [&](const auto& a) {
+        using ArrayT = std::decay_t<decltype(a)>;
+        if (offset < 0 || n < 0 || static_cast<size_t>(offset) + n > a.elements.size()) {
+            throw std::runtime_error("array_slice range out of bounds");
+        }
+        ArrayT out(std::vector<int>{n});
+        rbasic::ArrayOps::copy(a.elements.data() + offset, out.elements.data(), static_cast<size_t>(n));
+        result = std::move(out);
+    });
+    if (!handled) {
+        typed_array_error("array_slice");
+    }
+    return result;
+}
+
+BasicValue func_array_sort(BasicValue& array) {
+    bool handled = with_typed_array(array, [&](auto& a) {
+        rbasic::ArrayOps::sort(a.elements.data(), a.elements.size());
+    });
+    if (!handled) {
+        typed_array_error("array_sort");
+    }
+    return 0;
+}
+
+BasicValue func_array_prefix_sum(const BasicValue& array) {
+    BasicValue result;
+    bool handled = with_typed_array(array, [&](const auto& a) {
+        using ArrayT = std::decay_t<decltype(a)>;
+        ArrayT out;
+        out.dimensions = a.dimensions;
+        out.elements.resize(a.elements.size());
+        rbasic::ArrayOps::prefixSum(a.elements.data(), out.elements.data(), a.elements.size());
+        result = std::move(out);
+    });
+    if (!handled) {
+        typed_array_error("array_prefix_sum");
+    }
+    return result;
+}
+
+} // namespace basic_runtime
+
+BasicStruct::BasicStruct(rbasic::StructLayoutPtr structLayout)
+    : layout(std::move(structLayout)), fields(layout->fieldNames.size(), BasicValue(0)) {}
+
+BasicValue* BasicStruct::field(const std::string& name) {
+    int index = layout ? layout->fieldIndex(name) : -1;
+    return index < 0 ? nullptr : &fields[index];
+}
+
+const BasicValue* BasicStruct::field(const std::string& name) const {
+    int index = layout ? layout->fieldIndex(name) : -1;
+    return index < 0 ? nullptr : &fields[index];
+}
+
+namespace basic_runtime {
+
+rbasic::StructLayoutPtr create_struct_layout(const std::string& typeName, const std::vector<std::string>& fields) {
+    return rbasic::makeStructLayout(typeName, fields);
+}
+
+BasicStruct create_struct(const std::string& typeName) {
+    return BasicStruct(rbasic::makeStructLayout(typeName, {}));
+}
+
+BasicValue make_struct(const rbasic::StructLayoutPtr& layout, std::vector<BasicValue> fields) {
+    BasicStruct value(layout);
+    for (size_t i = 0; i < fields.size() && i < value.fields.size(); i++) {
+        value.fields[i] = std::move(fields[i]);
+    }
+    return value;
+}
+
+BasicValue get_struct_field(const BasicStruct& struct_, const std::string& fieldName) {
+    if (const BasicValue* field = struct_.field(fieldName)) {
+        return *field;
+    }
+    return 0; // Default value if field not found
+}
+
+// Overload that accepts BasicValue and extracts the struct
+BasicValue get_struct_field(const BasicValue& value, const std::string& fieldName) {
+    if (rbasic::holds_alternative<BasicStruct>(value)) {
+        return get_struct_field(rbasic::get<BasicStruct>(value), fieldName);
+    }
+    return 0; // Return 0 if not a struct
+}
+
+void set_struct_field(BasicStruct& struct_, const std::string& fieldName, const BasicValue& value) {
+    if (BasicValue* field = struct_.field(fieldName)) {
+        *field = value;
+        return;
+    }
+    // Ad hoc structs (create_struct by name) grow a new layout per added field
+    std::vector<std::string> names = struct_.layout ? struct_.layout->fieldNames : std::vector<std::string>{};
+    names.push_back(fieldName);
+    struct_.layout = rbasic::makeStructLayout(struct_.typeName(), std::move(names));
+    struct_.fields.push_back(value);
+}
+
+// Struct arrays
+namespace {
+
+BasicValue field_to_value(const rbasic::StructColumn::Field& field) {
+    return rbasic::visit([](const auto& value) { return BasicValue(value); }, field);
+}
+
+rbasic::StructColumn::Field value_to_field(const BasicValue& value) {
+    if (auto* i = rbasic::get_if<int>(&value)) return *i;
+    if (auto* d = rbasic::get_if<double>(&value)) return *d;
+    if (rbasic::holds_alternative<std::string>(value)) return std::string(value.text());
+    if (auto* b = rbasic::get_if<bool>(&value)) return *b;
+    throw std::runtime_error("Unsupported value type for struct field");
+}
+
+std::vector<int> to_indices(const std::vector<BasicValue>& indices) {
+    std::vector<int> result;
+    result.reserve(indices.size());
+    for (const auto& index : indices) {
+        result.push_back(to_int(index));
+    }
+    return result;
+}
+
+int cached_field_index(rbasic::FieldCache& cache, const rbasic::StructLayoutPtr& layout, const std::string& member) {
+    int index = cache.lookup(layout, member);
+    if (index < 0) {
+        throw std::runtime_error("Struct member '" + member + "' not found");
+    }
+    return index;
+}
+
+BasicStruct struct_array_element(const BasicStructArray& array, size_t index) {
+    BasicStruct value(array.layout);
+    for (size_t f = 0; f < array.columns.size(); f++) {
+        value.fields[f] = field_to_value(array.columns[f].get(index));
+    }
+    return value;
+}
+
+void set_struct_array_element(BasicStructArray& array, size_t index, const BasicValue& value) {
+    auto* structValue = rbasic::get_if<BasicStruct>(&value);
+    if (!structValue || structValue->typeName() != array.typeName()) {
+        throw std::runtime_error("Array of " + array.typeName() + " can only hold " + array.typeName() + " values");
+    }
+    if (structValue->layout == array.layout) {
+        for (size_t f = 0; f < array.columns.size(); f++) {
+            array.columns[f].set(index, value_to_field(structValue->fields[f]));
+        }
+        return;
+    }
+    // Same type name but a different layout (e.g. loaded from a file)
+    for (size_t f = 0; f < array.columns.size(); f++) {
+        if (const BasicValue* field = structValue->field(array.layout->fieldNames[f])) {
+            array.columns[f].set(index, value_to_field(*field));
+        }
+    }
+}
+
+BasicValue struct_array_column(const BasicStructArray& array, const std::string& member) {
+    const rbasic::StructColumn& column = array.column(member);
+    switch (column.kind()) {
+        case rbasic::StructColumn::Kind::INT: {
+            BasicIntArray result;
+            result.dimensions = array.dimensions;
+            result.elements = column.ints();
+            return result;
+        }
+        case rbasic::StructColumn::Kind::DOUBLE: {
+            BasicDoubleArray result;
+            result.dimensions = array.dimensions;
+            result.elements = column.doubles();
+            return result;
+        }
+        default: {
+            BasicArray result(array.dimensions);
+            for (size_t i = 0; i < column.size(); i++) {
+                result.elements[i] = field_to_value(column.get(i));
+            }
+            return result;
+        }
+    }
+}
+
+void set_struct_array_column(BasicStructArray& array, const std::string& member, const BasicValue& value) {
+    rbasic::StructColumn& column = array.column(member);
+    if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&value)) {
+        column.assign(doubles->elements);
+    } else if (auto* ints = rbasic::get_if<BasicIntArray>(&value)) {
+        column.assign(ints->elements);
+    } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&value)) {
+        column.assign(std::vector<int>(bytes->elements.begin(), bytes->elements.end()));
+    } else {
+        throw std::runtime_error("Assigning to " + array.typeName() + " array member '" + member + "' requires a typed array");
+    }
+}
+
+} // anonymous namespace
+
+BasicValue create_struct_array(const rbasic::StructLayoutPtr& layout, const std::vector<int>& dimensions) {
+    return BasicStructArray(layout, dimensions);
+}
+
+namespace {
+
+template<typename Fn>
+bool with_vec(BasicValue& value, Fn&& fn) {
+    if (auto* v3 = rbasic::get_if<BasicVec3>(&value)) {
+        fn(v3->data);
+    } else if (auto* v4 = rbasic::get_if<BasicVec4>(&value)) {
+        fn(v4->data);
+    } else if (auto* v2 = rbasic::get_if<BasicVec2>(&value)) {
+        fn(v2->data);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template<glm::length_t L>
+BasicValue read_lanes(const glm::vec<L, float>& v, const std::string& component) {
+    rbasic::Swizzle swizzle = rbasic::parseSwizzle(component);
+    if (!swizzle.fits(L)) {
+        throw std::runtime_error("Invalid vector component '" + component + "'");
+    }
+    switch (swizzle.count) {
+        case 1: return static_cast<double>(v[swizzle.lanes[0]]);
+        case 2: return BasicVec2(rbasic::swizzleRead<2>(v, swizzle));
+        case 3: return BasicVec3(rbasic::swizzleRead<3>(v, swizzle));
+        default: return BasicVec4(rbasic::swizzleRead<4>(v, swizzle));
+    }
+}
+
+template<glm::length_t L>
+void write_lanes(glm::vec<L, float>& v, const std::string& component, const BasicValue& value) {
+    rbasic::Swizzle swizzle = rbasic::parseSwizzle(component);
+    if (!swizzle.fits(L) || !swizzle.writable()) {
+        throw std::runtime_error("Invalid vector component '" + component + "'");
+    }
+    if (swizzle.count == 1) {
+        v[swizzle.lanes[0]] = static_cast<float>(to_double(value));
+    } else if (auto* v2 = rbasic::get_if<BasicVec2>(&value); v2 && swizzle.count == 2) {
+        rbasic::swizzleWrite(v, swizzle, v2->data);
+    } else if (auto* v3 = rbasic::get_if<BasicVec3>(&value); v3 && swizzle.count == 3) {
+        rbasic::swizzleWrite(v, swizzle, v3->data);
+    } else if (auto* v4 = rbasic::get_if<BasicVec4>(&value); v4 && swizzle.count == 4) {
+        rbasic::swizzleWrite(v, swizzle, v4->data);
+    } else {
+        throw std::runtime_error("Assigning to '" + component + "' requires a vec" + std::to_string(swizzle.count));
+    }
+}
+
+// Writes a component or swizzle of a vector in place; false if value is not a vector
+bool write_vec_component(BasicValue& vec, const std::string& component, const BasicValue& value) {
+    return with_vec(vec, [&](auto& data) { write_lanes(data, component, value); });
+}
+
+} // anonymous namespace
+
+// Row-major flat index into a vector array, bounds checked
+static size_t vec_array_index(const std::vector<int>& dimensions, const std::vector<int>& indices) {
+    if (indices.size() != dimensions.size()) {
+        throw std::out_of_range("vector array expects " + std::to_string(dimensions.size()) + " indices");
+    }
+    size_t index = 0;
+    for (size_t i = 0; i < dimensions.size(); i++) {
+        if (indices[i] < 0 || indices[i] >= dimensions[i]) {
+            throw std::out_of_range("vector array index out of range");
+        }
+        index = index * static_cast<size_t>(dimensions[i]) + static_cast<size_t>(indices[i]);
+    }
+    return index;
+}
+
+BasicValue get_member(const BasicValue& object, const std::string& member) {
+    if (auto* array = rbasic::get_if<BasicStructArray>(&object)) {
+        return struct_array_column(*array, member);
+    }
+    if (rbasic::holds_alternative<BasicVec2>(object) || rbasic::holds_alternative<BasicVec3>(object) ||
+        rbasic::holds_alternative<BasicVec4>(object)) {
+        return get_vec_component(object, member);
+    }
+    return get_struct_field(object, member);
+}
+
+BasicValue get_member(const BasicValue& object, const std::string& member, rbasic::FieldCache& cache) {
+    if (auto* structValue = rbasic::get_if<BasicStruct>(&object)) {
+        return structValue->fields[cached_field_index(cache, structValue->layout, member)];
+    }
+    return get_member(object, member);
+}
+
+BasicValue set_member(BasicValue& object, const std::string& member, const BasicValue& value) {
+    if (auto* array = rbasic::get_if<BasicStructArray>(&object)) {
+        set_struct_array_column(*array, member, value);
+    } else if (auto* structValue = rbasic::get_if<BasicStruct>(&object)) {
+        set_struct_field(*structValue, member, value);
+    } else if (!write_vec_component(object, member, value)) {
+        throw std::runtime_error("Component assignment requires a vector or struct");
+    }
+    return value;
+}
+
+BasicValue set_member(BasicValue& object, const std::string& member, const BasicValue& value, rbasic::FieldCache& cache) {
+    if (auto* structValue = rbasic::get_if<BasicStruct>(&object)) {
+        structValue->fields[cached_field_index(cache, structValue->layout, member)] = value;
+        return value;
+    }
+    return set_member(object, member, value);
+}
+
+BasicValue get_element_member(const BasicValue& arrayVar, const std::vector<BasicValue>& indices, const std::string& member,
+                              rbasic::FieldCache& cache) {
+    if (auto* array = rbasic::get_if<BasicStructArray>(&arrayVar)) {
+        int field = cached_field_index(cache, array->layout, member);
+        return field_to_value(array->columns[field].get(array->flatIndex(to_indices(indices))));
+    } else if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&arrayVar)) {
+        return read_lanes(vec3s->elements[vec_array_index(vec3s->dimensions, to_indices(indices))], member);
+    } else if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&arrayVar)) {
+        return read_lanes(vec4s->elements[vec_array_index(vec4s->dimensions, to_indices(indices))], member);
+    }
+    return get_member(get_array_element(arrayVar, indices), member, cache);
+}
+
+BasicValue set_element_member(BasicValue& arrayVar, const std::vector<BasicValue>& indices, const std::string& member,
+                              const BasicValue& value, rbasic::FieldCache& cache) {
+    if (auto* structs = rbasic::get_if<BasicStructArray>(&arrayVar)) {
+        int field = cached_field_index(cache, structs->layout, member);
+        structs->columns[field].set(structs->flatIndex(to_indices(indices)), value_to_field(value));
+    } else if (auto* array = rbasic::get_if<BasicArray>(&arrayVar)) {
+        BasicValue& element = array->at(to_indices(indices));
+        if (rbasic::holds_alternative<BasicStruct>(element)) {
+            set_member(element, member, value, cache);
+        }
+    } else if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&arrayVar)) {
+        write_lanes(vec3s->elements[vec_array_index(vec3s->dimensions, to_indices(indices))], member, value);
+    } else if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&arrayVar)) {
+        write_lanes(vec4s->elements[vec_array_index(vec4s->dimensions, to_indices(indices))], member, value);
+    }
+    return value;
+}
+
+// component is a single lane (x, y, z, w) or a swizzle such as xy or zyx
+BasicValue get_vec_component(const BasicValue& vec, const std::string& component) {
+    if (auto* v2 = rbasic::get_if<BasicVec2>(&vec)) return read_lanes(v2->data, component);
+    if (auto* v3 = rbasic::get_if<BasicVec3>(&vec)) return read_lanes(v3->data, component);
+    if (auto* v4 = rbasic::get_if<BasicVec4>(&vec)) return read_lanes(v4->data, component);
+    throw std::runtime_error("Component access requires a vector");
+}
+
+BasicValue set_vec_component(const BasicValue& vec, const std::string& component, const BasicValue& value) {
+    BasicValue result = vec;
+    if (!write_vec_component(result, component, value)) {
+        throw std::runtime_error("Component assignment requires a vector or struct");
+    }
+    return result;
+}
+
+BasicValue create_vec2(float x, float y) {
+    return BasicVec2(x, y);
+}
+
+BasicValue create_vec3(float x, float y, float z) {
+    return BasicVec3(x, y, z);
 }
 
-void set_byte_array_element(BasicByteArray& array, const std::vector<int>& indices, uint8_t value) {
-    array.at(indices) = value;
+BasicValue create_vec4(float x, float y, float z, float w) {
+    return BasicVec4(x, y, z, w);
 }
 
-int get_int_array_element(const BasicIntArray& array, const std::vector<int>& indices) {
-    return array.at(indices);
+// Matrix arguments are taken column by column, as glm's constructors take them
+BasicValue create_mat3(float m00, float m01, float m02, float m10, float m11, float m12, float m20, float m21, float m22) {
+    return BasicMat3(glm::mat3(m00, m01, m02, m10, m11, m12, m20, m21, m22));
 }
 
-void set_int_array_element(BasicIntArray& array, const std::vector<int>& indices, int value) {
-    array.at(indices) = value;
+BasicValue create_mat4(float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13, float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33) {
+    return BasicMat4(glm::mat4(m00, m01, m02, m03, m10, m11, m12, m13, m20, m21, m22, m23, m30, m31, m32, m33));
 }
 
-double get_double_array_element(const BasicDoubleArray& array, const std::vector<int>& indices) {
-    return array.at(indices);
+BasicValue create_mat3() {
+    return BasicMat3();
 }
 
-void set_double_array_element(BasicDoubleArray& array, const std::vector<int>& indices, double value) {
-    array.at(indices) = value;
+BasicValue create_mat4() {
+    return BasicMat4();
 }
 
-// Wrapper functions for code generator (with func_ prefix)
-BasicValue func_byte_array(int size) {
-    return BasicByteArray({size});
+BasicValue create_quat(float w, float x, float y, float z) {
+    return BasicQuat(w, x, y, z);
 }
 
-BasicValue func_int_array(int size) {
-    return BasicIntArray({size});
+BasicValue vec_length(const BasicValue& vec) {
+    if (auto* v2 = rbasic::get_if<BasicVec2>(&vec)) return static_cast<double>(glm::length(v2->data));
+    if (auto* v3 = rbasic::get_if<BasicVec3>(&vec)) return static_cast<double>(glm::length(v3->data));
+    if (auto* v4 = rbasic::get_if<BasicVec4>(&vec)) return static_cast<double>(glm::length(v4->data));
+    throw std::runtime_error("length() requires a vector argument");
 }
 
-BasicValue func_double_array(int size) {
-    return BasicDoubleArray({size});
+BasicValue vec_normalize(const BasicValue& vec) {
+    if (auto* v2 = rbasic::get_if<BasicVec2>(&vec)) return BasicVec2(glm::normalize(v2->data));
+    if (auto* v3 = rbasic::get_if<BasicVec3>(&vec)) return BasicVec3(glm::normalize(v3->data));
+    if (auto* v4 = rbasic::get_if<BasicVec4>(&vec)) return BasicVec4(glm::normalize(v4->data));
+    throw std::runtime_error("normalize() requires a vector argument");
 }
 
-BasicStruct create_struct(const std::string& typeName) {
-    return BasicStruct(typeName);
+BasicValue vec_dot(const BasicValue& left, const BasicValue& right) {
+    auto* l2 = rbasic::get_if<BasicVec2>(&left);
+    auto* r2 = rbasic::get_if<BasicVec2>(&right);
+    if (l2 && r2) return static_cast<double>(glm::dot(l2->data, r2->data));
+    auto* l3 = rbasic::get_if<BasicVec3>(&left);
+    auto* r3 = rbasic::get_if<BasicVec3>(&right);
+    if (l3 && r3) return static_cast<double>(glm::dot(l3->data, r3->data));
+    auto* l4 = rbasic::get_if<BasicVec4>(&left);
+    auto* r4 = rbasic::get_if<BasicVec4>(&right);
+    if (l4 && r4) return static_cast<double>(glm::dot(l4->data, r4->data));
+    throw std::runtime_error("dot() requires two vectors of the same type");
 }
 
-BasicValue get_struct_field(const BasicStruct& struct_, const std::string& fieldName) {
-    auto it = struct_.fields.find(fieldName);
-    if (it != struct_.fields.end()) {
-        return it->second;
+BasicValue vec_cross(const BasicValue& left, const BasicValue& right) {
+    auto* l3 = rbasic::get_if<BasicVec3>(&left);
+    auto* r3 = rbasic::get_if<BasicVec3>(&right);
+    if (l3 && r3) return BasicVec3(glm::cross(l3->data, r3->data));
+    throw std::runtime_error("cross() requires two vec3 arguments");
+}
+
+BasicValue vec_distance(const BasicValue& left, const BasicValue& right) {
+    auto* l2 = rbasic::get_if<BasicVec2>(&left);
+    auto* r2 = rbasic::get_if<BasicVec2>(&right);
+    if (l2 && r2) return static_cast<double>(glm::distance(l2->data, r2->data));
+    auto* l3 = rbasic::get_if<BasicVec3>(&left);
+    auto* r3 = rbasic::get_if<BasicVec3>(&right);
+    if (l3 && r3) return static_cast<double>(glm::distance(l3->data, r3->data));
+    auto* l4 = rbasic::get_if<BasicVec4>(&left);
+    auto* r4 = rbasic::get_if<BasicVec4>(&right);
+    if (l4 && r4) return static_cast<double>(glm::distance(l4->data, r4->data));
+    throw std::runtime_error("distance() requires two vectors of the same type");
+}
+
+BasicValue func_vec3_array(int size) {
+    return BasicVec3Array({size});
+}
+
+BasicValue func_vec4_array(int size) {
+    return BasicVec4Array({size});
+}
+
+namespace {
+
+template<typename Fn>
+bool with_vec_array(const BasicValue& value, Fn&& fn) {
+    if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&value)) {
+        fn(*vec3s);
+    } else if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&value)) {
+        fn(*vec4s);
+    } else {
+        return false;
     }
-    return 0; // Default value if field not found
+    return true;
 }
 
-// Overload that accepts BasicValue and extracts the struct
-BasicValue get_struct_field(const BasicValue& value, const std::string& fieldName) {
-    if (std::holds_alternative<BasicStruct>(value)) {
-        return get_struct_field(std::get<BasicStruct>(value), fieldName);
+template<typename Array>
+constexpr int vec_array_lanes() {
+    return std::is_same_v<Array, BasicVec3Array> ? 3 : 4;
+}
+
+// Runs op(in, out, n) over a copy-shaped result of the given vector array
+template<typename Op>
+BasicValue map_vec_array(const char* name, const BasicValue& array, Op&& op) {
+    BasicValue result;
+    bool handled = with_vec_array(array, [&](const auto& source) {
+        using ArrayT = std::decay_t<decltype(source)>;
+        ArrayT mapped;
+        mapped.dimensions = source.dimensions;
+        mapped.elements.resize(source.elements.size());
+        if (!source.elements.empty()) {
+            op(std::integral_constant<int, vec_array_lanes<ArrayT>()>(), glm::value_ptr(source.elements.front()),
+               glm::value_ptr(mapped.elements.front()), source.elements.size());
+        }
+        result = std::move(mapped);
+    });
+    if (!handled) {
+        throw std::runtime_error(std::string(name) + " requires a vec3_array or vec4_array");
     }
-    return 0; // Return 0 if not a struct
+    return result;
 }
 
-void set_struct_field(BasicStruct& struct_, const std::string& fieldName, const BasicValue& value) {
-    struct_.fields[fieldName] = value;
+} // anonymous namespace
+
+BasicValue func_transform_points(const BasicValue& matrix, const BasicValue& array) {
+    auto* m = rbasic::get_if<BasicMat4>(&matrix);
+    if (!m) {
+        throw std::runtime_error("transform_points requires a mat4 and a vector array");
+    }
+    const float* columns = glm::value_ptr(m->data);
+    return map_vec_array("transform_points", array, [&](auto lanes, const float* in, float* out, size_t n) {
+        rbasic::VecOps::transform<decltype(lanes)::value>(columns, in, out, n);
+    });
 }
 
-int to_int(const BasicValue& value) {
-    if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value);
-    } else if (std::holds_alternative<double>(value)) {
-        return static_cast<int>(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? 1 : 0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        try {
-            return std::stoi(std::get<std::string>(value));
-        } catch (const std::exception&) {
-            return 0;
+BasicValue func_rotate_all(const BasicValue& rotation, const BasicValue& array) {
+    auto* q = rbasic::get_if<BasicQuat>(&rotation);
+    if (!q) {
+        throw std::runtime_error("rotate_all requires a quat and a vector array");
+    }
+    const float xyzw[4] = {q->data.x, q->data.y, q->data.z, q->data.w};
+    return map_vec_array("rotate_all", array, [&](auto lanes, const float* in, float* out, size_t n) {
+        rbasic::VecOps::rotate<decltype(lanes)::value>(xyzw, in, out, n);
+    });
+}
+
+BasicValue func_normalize_all(const BasicValue& array) {
+    return map_vec_array("normalize_all", array, [](auto lanes, const float* in, float* out, size_t n) {
+        rbasic::VecOps::normalize<decltype(lanes)::value>(in, out, n);
+    });
+}
+
+BasicValue func_dot_all(const BasicValue& a, const BasicValue& b) {
+    BasicValue result;
+    bool handled = with_vec_array(b, [&](const auto& right) {
+        using ArrayT = std::decay_t<decltype(right)>;
+        auto* left = rbasic::get_if<ArrayT>(&a);
+        if (!left || left->elements.size() != right.elements.size()) {
+            throw std::runtime_error("dot_all requires two vector arrays of the same type and size");
         }
+        BasicDoubleArray dots;
+        dots.dimensions = right.dimensions;
+        dots.elements.resize(right.elements.size());
+        if (!right.elements.empty()) {
+            rbasic::VecOps::dot<vec_array_lanes<ArrayT>()>(glm::value_ptr(left->elements.front()),
+                glm::value_ptr(right.elements.front()), dots.elements.data(), dots.elements.size());
+        }
+        result = std::move(dots);
+    });
+    if (!handled) {
+        throw std::runtime_error("dot_all requires a vec3_array or vec4_array");
+    }
+    return result;
+}
+
+int to_int(const BasicValue& value) {
+    if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value);
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return static_cast<int>(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? 1 : 0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        int result = 0;
+        rbasic::NumberFormat::parseInt(rbasic::get<std::string>(value), result);
+        return result;
     }
     return 0;
 }
 
 double to_double(const BasicValue& value) {
-    if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return static_cast<double>(std::get<int>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? 1.0 : 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        try {
-            return std::stod(std::get<std::string>(value));
-        } catch (const std::exception&) {
-            return 0.0;
-        }
+    if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return static_cast<double>(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? 1.0 : 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        double result = 0.0;
+        rbasic::NumberFormat::parseDouble(rbasic::get<std::string>(value), result);
+        return result;
     }
     return 0.0;
 }
 
 std::string to_string(const BasicValue& value) {
-    if (std::holds_alternative<std::string>(value)) {
-        return std::get<std::string>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::to_string(std::get<int>(value));
-    } else if (std::holds_alternative<double>(value)) {
-        return std::to_string(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? "true" : "false";
-    } else if (std::holds_alternative<BasicStruct>(value)) {
-        return "[struct " + std::get<BasicStruct>(value).typeName + "]";
-    } else if (std::holds_alternative<BasicArray>(value)) {
+    if (rbasic::holds_alternative<std::string>(value)) {
+        return rbasic::get<std::string>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::NumberFormat::formatInt(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::NumberFormat::formatDouble(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? "true" : "false";
+    } else if (rbasic::holds_alternative<BasicStruct>(value)) {
+        return "[struct " + rbasic::get<BasicStruct>(value).typeName() + "]";
+    } else if (rbasic::holds_alternative<BasicArray>(value)) {
         return "[array]";
+    } else if (rbasic::holds_alternative<BasicStructArray>(value)) {
+        return "[" + rbasic::get<BasicStructArray>(value).typeName() + " array]";
+    } else if (rbasic::holds_alternative<BasicVec3Array>(value)) {
+        return "[vec3 array]";
+    } else if (rbasic::holds_alternative<BasicVec4Array>(value)) {
+        return "[vec4 array]";
     }
     return "";
 }
 
 bool to_bool(const BasicValue& value) {
-    if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value) != 0;
-    } else if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value) != 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        return !std::get<std::string>(value).empty();
+    if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value) != 0;
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value) != 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        return !rbasic::get<std::string>(value).empty();
     }
     return false;
 }
 
 BasicValue add(const BasicValue& left, const BasicValue& right) {
     // GLM vector addition
-    if (std::holds_alternative<BasicVec2>(left) && std::holds_alternative<BasicVec2>(right)) {
-        BasicVec2 leftVec = std::get<BasicVec2>(left);
-        BasicVec2 rightVec = std::get<BasicVec2>(right);
+    if (rbasic::holds_alternative<BasicVec2>(left) && rbasic::holds_alternative<BasicVec2>(right)) {
+        BasicVec2 leftVec = rbasic::get<BasicVec2>(left);
+        BasicVec2 rightVec = rbasic::get<BasicVec2>(right);
         return BasicValue(BasicVec2(leftVec.data + rightVec.data));
     }
-    if (std::holds_alternative<BasicVec3>(left) && std::holds_alternative<BasicVec3>(right)) {
-        BasicVec3 leftVec = std::get<BasicVec3>(left);
-        BasicVec3 rightVec = std::get<BasicVec3>(right);
+    if (rbasic::holds_alternative<BasicVec3>(left) && rbasic::holds_alternative<BasicVec3>(right)) {
+        BasicVec3 leftVec = rbasic::get<BasicVec3>(left);
+        BasicVec3 rightVec = rbasic::get<BasicVec3>(right);
         return BasicValue(BasicVec3(leftVec.data + rightVec.data));
     }
-    if (std::holds_alternative<BasicVec4>(left) && std::holds_alternative<BasicVec4>(right)) {
-        BasicVec4 leftVec = std::get<BasicVec4>(left);
-        BasicVec4 rightVec = std::get<BasicVec4>(right);
+    if (rbasic::holds_alternative<BasicVec4>(left) && rbasic::holds_alternative<BasicVec4>(right)) {
+        BasicVec4 leftVec = rbasic::get<BasicVec4>(left);
+        BasicVec4 rightVec = rbasic::get<BasicVec4>(right);
         return BasicValue(BasicVec4(leftVec.data + rightVec.data));
     }
     
     // Original string and numeric addition
-    if (std::holds_alternative<std::string>(left) || std::holds_alternative<std::string>(right)) {
+    if (rbasic::holds_alternative<std::string>(left) || rbasic::holds_alternative<std::string>(right)) {
         return to_string(left) + to_string(right);
-    } else if (std::holds_alternative<double>(left) || std::holds_alternative<double>(right)) {
+    } else if (rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<double>(right)) {
         return to_double(left) + to_double(right);
     } else {
         return to_int(left) + to_int(right);
@@ -594,24 +1385,24 @@ BasicValue add(const BasicValue& left, const BasicValue& right) {
 
 BasicValue subtract(const BasicValue& left, const BasicValue& right) {
     // GLM vector subtraction
-    if (std::holds_alternative<BasicVec2>(left) && std::holds_alternative<BasicVec2>(right)) {
-        BasicVec2 leftVec = std::get<BasicVec2>(left);
-        BasicVec2 rightVec = std::get<BasicVec2>(right);
+    if (rbasic::holds_alternative<BasicVec2>(left) && rbasic::holds_alternative<BasicVec2>(right)) {
+        BasicVec2 leftVec = rbasic::get<BasicVec2>(left);
+        BasicVec2 rightVec = rbasic::get<BasicVec2>(right);
         return BasicValue(BasicVec2(leftVec.data - rightVec.data));
     }
-    if (std::holds_alternative<BasicVec3>(left) && std::holds_alternative<BasicVec3>(right)) {
-        BasicVec3 leftVec = std::get<BasicVec3>(left);
-        BasicVec3 rightVec = std::get<BasicVec3>(right);
+    if (rbasic::holds_alternative<BasicVec3>(left) && rbasic::holds_alternative<BasicVec3>(right)) {
+        BasicVec3 leftVec = rbasic::get<BasicVec3>(left);
+        BasicVec3 rightVec = rbasic::get<BasicVec3>(right);
         return BasicValue(BasicVec3(leftVec.data - rightVec.data));
     }
-    if (std::holds_alternative<BasicVec4>(left) && std::holds_alternative<BasicVec4>(right)) {
-        BasicVec4 leftVec = std::get<BasicVec4>(left);
-        BasicVec4 rightVec = std::get<BasicVec4>(right);
+    if (rbasic::holds_alternative<BasicVec4>(left) && rbasic::holds_alternative<BasicVec4>(right)) {
+        BasicVec4 leftVec = rbasic::get<BasicVec4>(left);
+        BasicVec4 rightVec = rbasic::get<BasicVec4>(right);
         return BasicValue(BasicVec4(leftVec.data - rightVec.data));
     }
     
     // Original numeric subtraction
-    if (std::holds_alternative<double>(left) || std::holds_alternative<double>(right)) {
+    if (rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<double>(right)) {
         return to_double(left) - to_double(right);
     } else {
         return to_int(left) - to_int(right);
@@ -620,56 +1411,56 @@ BasicValue subtract(const BasicValue& left, const BasicValue& right) {
 
 BasicValue multiply(const BasicValue& left, const BasicValue& right) {
     // GLM vector-scalar multiplication
-    if (std::holds_alternative<BasicVec2>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        BasicVec2 vec = std::get<BasicVec2>(left);
+    if (rbasic::holds_alternative<BasicVec2>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        BasicVec2 vec = rbasic::get<BasicVec2>(left);
         float scalar = static_cast<float>(to_double(right));
         return BasicValue(BasicVec2(vec.data * scalar));
     }
-    if ((std::holds_alternative<double>(left) || std::holds_alternative<int>(left)) && std::holds_alternative<BasicVec2>(right)) {
+    if ((rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<int>(left)) && rbasic::holds_alternative<BasicVec2>(right)) {
         float scalar = static_cast<float>(to_double(left));
-        BasicVec2 vec = std::get<BasicVec2>(right);
+        BasicVec2 vec = rbasic::get<BasicVec2>(right);
         return BasicValue(BasicVec2(scalar * vec.data));
     }
-    if (std::holds_alternative<BasicVec3>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        BasicVec3 vec = std::get<BasicVec3>(left);
+    if (rbasic::holds_alternative<BasicVec3>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        BasicVec3 vec = rbasic::get<BasicVec3>(left);
         float scalar = static_cast<float>(to_double(right));
         return BasicValue(BasicVec3(vec.data * scalar));
     }
-    if ((std::holds_alternative<double>(left) || std::holds_alternative<int>(left)) && std::holds_alternative<BasicVec3>(right)) {
+    if ((rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<int>(left)) && rbasic::holds_alternative<BasicVec3>(right)) {
         float scalar = static_cast<float>(to_double(left));
-        BasicVec3 vec = std::get<BasicVec3>(right);
+        BasicVec3 vec = rbasic::get<BasicVec3>(right);
         return BasicValue(BasicVec3(scalar * vec.data));
     }
-    if (std::holds_alternative<BasicVec4>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        BasicVec4 vec = std::get<BasicVec4>(left);
+    if (rbasic::holds_alternative<BasicVec4>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        BasicVec4 vec = rbasic::get<BasicVec4>(left);
         float scalar = static_cast<float>(to_double(right));
         return BasicValue(BasicVec4(vec.data * scalar));
     }
-    if ((std::holds_alternative<double>(left) || std::holds_alternative<int>(left)) && std::holds_alternative<BasicVec4>(right)) {
+    if ((rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<int>(left)) && rbasic::holds_alternative<BasicVec4>(right)) {
         float scalar = static_cast<float>(to_double(left));
-        BasicVec4 vec = std::get<BasicVec4>(right);
+        BasicVec4 vec = rbasic::get<BasicVec4>(right);
         return BasicValue(BasicVec4(scalar * vec.data));
     }
     
     // GLM vector-vector multiplication (component-wise)
-    if (std::holds_alternative<BasicVec2>(left) && std::holds_alternative<BasicVec2>(right)) {
-        BasicVec2 leftVec = std::get<BasicVec2>(left);
-        BasicVec2 rightVec = std::get<BasicVec2>(right);
+    if (rbasic::holds_alternative<BasicVec2>(left) && rbasic::holds_alternative<BasicVec2>(right)) {
+        BasicVec2 leftVec = rbasic::get<BasicVec2>(left);
+        BasicVec2 rightVec = rbasic::get<BasicVec2>(right);
         return BasicValue(BasicVec2(leftVec.data * rightVec.data));
     }
-    if (std::holds_alternative<BasicVec3>(left) && std::holds_alternative<BasicVec3>(right)) {
-        BasicVec3 leftVec = std::get<BasicVec3>(left);
-        BasicVec3 rightVec = std::get<BasicVec3>(right);
+    if (rbasic::holds_alternative<BasicVec3>(left) && rbasic::holds_alternative<BasicVec3>(right)) {
+        BasicVec3 leftVec = rbasic::get<BasicVec3>(left);
+        BasicVec3 rightVec = rbasic::get<BasicVec3>(right);
         return BasicValue(BasicVec3(leftVec.data * rightVec.data));
     }
-    if (std::holds_alternative<BasicVec4>(left) && std::holds_alternative<BasicVec4>(right)) {
-        BasicVec4 leftVec = std::get<BasicVec4>(left);
-        BasicVec4 rightVec = std::get<BasicVec4>(right);
+    if (rbasic::holds_alternative<BasicVec4>(left) && rbasic::holds_alternative<BasicVec4>(right)) {
+        BasicVec4 leftVec = rbasic::get<BasicVec4>(left);
+        BasicVec4 rightVec = rbasic::get<BasicVec4>(right);
         return BasicValue(BasicVec4(leftVec.data * rightVec.data));
     }
     
     // Original numeric multiplication
-    if (std::holds_alternative<double>(left) || std::holds_alternative<double>(right)) {
+    if (rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<double>(right)) {
         return to_double(left) * to_double(right);
     } else {
         return to_int(left) * to_int(right);
@@ -687,14 +1478,14 @@ BasicValue divide(const BasicValue& left, const BasicValue& right) {
 bool equal(const BasicValue& left, const BasicValue& right) {
     // Handle same types
     if (left.index() == right.index()) {
-        if (std::holds_alternative<int>(left)) {
-            return std::get<int>(left) == std::get<int>(right);
-        } else if (std::holds_alternative<double>(left)) {
-            return std::get<double>(left) == std::get<double>(right);
-        } else if (std::holds_alternative<std::string>(left)) {
-            return std::get<std::string>(left) == std::get<std::string>(right);
-        } else if (std::holds_alternative<bool>(left)) {
-            return std::get<bool>(left) == std::get<bool>(right);
+        if (rbasic::holds_alternative<int>(left)) {
+            return rbasic::get<int>(left) == rbasic::get<int>(right);
+        } else if (rbasic::holds_alternative<double>(left)) {
+            return rbasic::get<double>(left) == rbasic::get<double>(right);
+        } else if (rbasic::holds_alternative<std::string>(left)) {
+            return rbasic::get<std::string>(left) == rbasic::get<std::string>(right);
+        } else if (rbasic::holds_alternative<bool>(left)) {
+            return rbasic::get<bool>(left) == rbasic::get<bool>(right);
         } else {
             // For struct and array types, compare as strings for now
             return to_string(left) == to_string(right);
@@ -702,8 +1493,8 @@ bool equal(const BasicValue& left, const BasicValue& right) {
     }
     
     // Different types, try to compare as numbers or strings
-    if ((std::holds_alternative<int>(left) || std::holds_alternative<double>(left)) &&
-        (std::holds_alternative<int>(right) || std::holds_alternative<double>(right))) {
+    if ((rbasic::holds_alternative<int>(left) || rbasic::holds_alternative<double>(left)) &&
+        (rbasic::holds_alternative<int>(right) || rbasic::holds_alternative<double>(right))) {
         return to_double(left) == to_double(right);
     }
     return to_string(left) == to_string(right);
@@ -714,8 +1505,8 @@ bool not_equal(const BasicValue& left, const BasicValue& right) {
 }
 
 bool less_than(const BasicValue& left, const BasicValue& right) {
-    if ((std::holds_alternative<int>(left) || std::holds_alternative<double>(left)) &&
-        (std::holds_alternative<int>(right) || std::holds_alternative<double>(right))) {
+    if ((rbasic::holds_alternative<int>(left) || rbasic::holds_alternative<double>(left)) &&
+        (rbasic::holds_alternative<int>(right) || rbasic::holds_alternative<double>(right))) {
         return to_double(left) < to_double(right);
     }
     return to_string(left) < to_string(right);
@@ -816,27 +1607,27 @@ int get_ticks() {
 }
 
 // Simple 1D array access helpers
-BasicValue get_array_element(BasicValue& arrayVar, BasicValue index) {
-    if (std::holds_alternative<BasicArray>(arrayVar)) {
-        BasicArray& array = std::get<BasicArray>(arrayVar);
+BasicValue get_array_element(const BasicValue& arrayVar, BasicValue index) {
+    if (rbasic::holds_alternative<BasicArray>(arrayVar)) {
+        const BasicArray& array = rbasic::get<BasicArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             return array.elements[idx]; // Use 0-based indexing directly
         }
-    } else if (std::holds_alternative<BasicByteArray>(arrayVar)) {
-        BasicByteArray& array = std::get<BasicByteArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicByteArray>(arrayVar)) {
+        const BasicByteArray& array = rbasic::get<BasicByteArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             return BasicValue(static_cast<int>(array.elements[idx]));
         }
-    } else if (std::holds_alternative<BasicIntArray>(arrayVar)) {
-        BasicIntArray& array = std::get<BasicIntArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicIntArray>(arrayVar)) {
+        const BasicIntArray& array = rbasic::get<BasicIntArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             return BasicValue(array.elements[idx]);
         }
-    } else if (std::holds_alternative<BasicDoubleArray>(arrayVar)) {
-        BasicDoubleArray& array = std::get<BasicDoubleArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicDoubleArray>(arrayVar)) {
+        const BasicDoubleArray& array = rbasic::get<BasicDoubleArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             return BasicValue(array.elements[idx]);
@@ -846,26 +1637,26 @@ BasicValue get_array_element(BasicValue& arrayVar, BasicValue index) {
 }
 
 void set_array_element(BasicValue& arrayVar, BasicValue index, BasicValue value) {
-    if (std::holds_alternative<BasicArray>(arrayVar)) {
-        BasicArray& array = std::get<BasicArray>(arrayVar);
+    if (rbasic::holds_alternative<BasicArray>(arrayVar)) {
+        BasicArray& array = rbasic::get<BasicArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             array.elements[idx] = value; // Use 0-based indexing directly
         }
-    } else if (std::holds_alternative<BasicByteArray>(arrayVar)) {
-        BasicByteArray& array = std::get<BasicByteArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicByteArray>(arrayVar)) {
+        BasicByteArray& array = rbasic::get<BasicByteArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             array.elements[idx] = static_cast<uint8_t>(to_int(value));
         }
-    } else if (std::holds_alternative<BasicIntArray>(arrayVar)) {
-        BasicIntArray& array = std::get<BasicIntArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicIntArray>(arrayVar)) {
+        BasicIntArray& array = rbasic::get<BasicIntArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             array.elements[idx] = to_int(value);
         }
-    } else if (std::holds_alternative<BasicDoubleArray>(arrayVar)) {
-        BasicDoubleArray& array = std::get<BasicDoubleArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicDoubleArray>(arrayVar)) {
+        BasicDoubleArray& array = rbasic::get<BasicDoubleArray>(arrayVar);
         int idx = to_int(index);
         if (idx >= 0 && idx < static_cast<int>(array.elements.size())) {
             array.elements[idx] = to_double(value);
@@ -874,24 +1665,30 @@ void set_array_element(BasicValue& arrayVar, BasicValue index, BasicValue value)
 }
 
 // Multidimensional array access helpers
-BasicValue get_array_element(BasicValue& arrayVar, const std::vector<BasicValue>& indices) {
+BasicValue get_array_element(const BasicValue& arrayVar, const std::vector<BasicValue>& indices) {
     // Convert BasicValue indices to int indices
     std::vector<int> intIndices;
     for (const auto& index : indices) {
         intIndices.push_back(to_int(index));
     }
     
-    if (std::holds_alternative<BasicArray>(arrayVar)) {
-        BasicArray& array = std::get<BasicArray>(arrayVar);
+    if (auto* structArray = rbasic::get_if<BasicStructArray>(&arrayVar)) {
+        return struct_array_element(*structArray, structArray->flatIndex(intIndices));
+    } else if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&arrayVar)) {
+        return BasicVec3(vec3s->elements[vec_array_index(vec3s->dimensions, intIndices)]);
+    } else if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&arrayVar)) {
+        return BasicVec4(vec4s->elements[vec_array_index(vec4s->dimensions, intIndices)]);
+    } else if (rbasic::holds_alternative<BasicArray>(arrayVar)) {
+        const BasicArray& array = rbasic::get<BasicArray>(arrayVar);
         return get_array_element(array, intIndices);
-    } else if (std::holds_alternative<BasicByteArray>(arrayVar)) {
-        BasicByteArray& array = std::get<BasicByteArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicByteArray>(arrayVar)) {
+        const BasicByteArray& array = rbasic::get<BasicByteArray>(arrayVar);
         return static_cast<int>(get_byte_array_element(array, intIndices));
-    } else if (std::holds_alternative<BasicIntArray>(arrayVar)) {
-        BasicIntArray& array = std::get<BasicIntArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicIntArray>(arrayVar)) {
+        const BasicIntArray& array = rbasic::get<BasicIntArray>(arrayVar);
         return get_int_array_element(array, intIndices);
-    } else if (std::holds_alternative<BasicDoubleArray>(arrayVar)) {
-        BasicDoubleArray& array = std::get<BasicDoubleArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicDoubleArray>(arrayVar)) {
+        const BasicDoubleArray& array = rbasic::get<BasicDoubleArray>(arrayVar);
         return get_double_array_element(array, intIndices);
     }
     
@@ -905,17 +1702,31 @@ void set_array_element(BasicValue& arrayVar, const std::vector<BasicValue>& indi
         intIndices.push_back(to_int(index));
     }
     
-    if (std::holds_alternative<BasicArray>(arrayVar)) {
-        BasicArray& array = std::get<BasicArray>(arrayVar);
+    if (auto* structArray = rbasic::get_if<BasicStructArray>(&arrayVar)) {
+        set_struct_array_element(*structArray, structArray->flatIndex(intIndices), value);
+    } else if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&arrayVar)) {
+        auto* vec = rbasic::get_if<BasicVec3>(&value);
+        if (!vec) {
+            throw std::runtime_error("vec3_array elements must be vec3 values");
+        }
+        vec3s->elements[vec_array_index(vec3s->dimensions, intIndices)] = vec->data;
+    } else if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&arrayVar)) {
+        auto* vec = rbasic::get_if<BasicVec4>(&value);
+        if (!vec) {
+            throw std::runtime_error("vec4_array elements must be vec4 values");
+        }
+        vec4s->elements[vec_array_index(vec4s->dimensions, intIndices)] = vec->data;
+    } else if (rbasic::holds_alternative<BasicArray>(arrayVar)) {
+        BasicArray& array = rbasic::get<BasicArray>(arrayVar);
         set_array_element(array, intIndices, value);
-    } else if (std::holds_alternative<BasicByteArray>(arrayVar)) {
-        BasicByteArray& array = std::get<BasicByteArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicByteArray>(arrayVar)) {
+        BasicByteArray& array = rbasic::get<BasicByteArray>(arrayVar);
         set_byte_array_element(array, intIndices, static_cast<uint8_t>(to_int(value)));
-    } else if (std::holds_alternative<BasicIntArray>(arrayVar)) {
-        BasicIntArray& array = std::get<BasicIntArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicIntArray>(arrayVar)) {
+        BasicIntArray& array = rbasic::get<BasicIntArray>(arrayVar);
         set_int_array_element(array, intIndices, to_int(value));
-    } else if (std::holds_alternative<BasicDoubleArray>(arrayVar)) {
-        BasicDoubleArray& array = std::get<BasicDoubleArray>(arrayVar);
+    } else if (rbasic::holds_alternative<BasicDoubleArray>(arrayVar)) {
+        BasicDoubleArray& array = rbasic::get<BasicDoubleArray>(arrayVar);
         set_double_array_element(array, intIndices, to_double(value));
     }
 }
@@ -1045,36 +1856,67 @@ BasicValue load_binary_file(const std::string& filename) {
 }
 
 // CSV/structured data I/O
-bool save_int_array_csv(const std::string& filename, const BasicIntArray& array) {
-    std::ofstream file(filename);
+namespace {
+
+// Formats a whole CSV row in memory and writes it in one call
+template<typename T>
+bool save_csv_row(const std::string& filename, const std::vector<T>& elements) {
+    std::string row;
+    row.reserve(elements.size() * 8);
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (i > 0) row += ',';
+        if constexpr (std::is_floating_point_v<T>) {
+            rbasic::NumberFormat::appendDouble(row, elements[i]);
+        } else {
+            rbasic::NumberFormat::appendInt(row, elements[i]);
+        }
+    }
+    row += '\n';
+
+    std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         return false;
     }
-    
-    for (size_t i = 0; i < array.elements.size(); ++i) {
-        if (i > 0) file << ",";
-        file << array.elements[i];
-    }
-    file << "\n";
+    file.write(row.data(), static_cast<std::streamsize>(row.size()));
     file.close();
-    
     return !file.fail();
 }
 
-bool save_double_array_csv(const std::string& filename, const BasicDoubleArray& array) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        return false;
-    }
-    
-    for (size_t i = 0; i < array.elements.size(); ++i) {
-        if (i > 0) file << ",";
-        file << array.elements[i];
+// Parses the first line of a CSV file in place, without a stream per field
+template<typename T>
+std::vector<T> load_csv_row(std::ifstream& file) {
+    std::string line;
+    std::getline(file, line);
+
+    std::vector<T> values;
+    std::string_view rest(line);
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view token = rest.substr(0, comma);
+        T value = T();  // Default value on parse error
+        if constexpr (std::is_floating_point_v<T>) {
+            rbasic::NumberFormat::parseDouble(token, value);
+        } else {
+            rbasic::NumberFormat::parseInt(token, value);
+        }
+        values.push_back(value);
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        rest.remove_prefix(comma + 1);
     }
-    file << "\n";
-    file.close();
-    
-    return !file.fail();
+    return values;
+}
+
+} // anonymous namespace
+
+// CSV/structured data I/O
+bool save_int_array_csv(const std::string& filename, const BasicIntArray& array) {
+    return save_csv_row(filename, array.elements);
+}
+
+bool save_double_array_csv(const std::string& filename, const BasicDoubleArray& array) {
+    return save_csv_row(filename, array.elements);
 }
 
 BasicValue load_int_array_csv(const std::string& filename) {
@@ -1083,27 +1925,9 @@ BasicValue load_int_array_csv(const std::string& filename) {
         return BasicIntArray(); // Return empty array on error
     }
     
-    std::string line;
-    std::getline(file, line);
-    file.close();
-    
-    // Parse CSV line
-    std::vector<int> values;
-    std::stringstream ss(line);
-    std::string token;
-    
-    while (std::getline(ss, token, ',')) {
-        try {
-            values.push_back(std::stoi(token));
-        } catch (...) {
-            values.push_back(0); // Default value on parse error
-        }
-    }
-    
-    // Create array
+    std::vector<int> values = load_csv_row<int>(file);
     BasicIntArray result({static_cast<int>(values.size())});
-    std::copy(values.begin(), values.end(), result.elements.begin());
-    
+    result.elements = std::move(values);
     return result;
 }
 
@@ -1113,28 +1937,211 @@ BasicValue load_double_array_csv(const std::string& filename) {
         return BasicDoubleArray(); // Return empty array on error
     }
     
-    std::string line;
-    std::getline(file, line);
-    file.close();
-    
-    // Parse CSV line
-    std::vector<double> values;
-    std::stringstream ss(line);
-    std::string token;
-    
-    while (std::getline(ss, token, ',')) {
-        try {
-            values.push_back(std::stod(token));
-        } catch (...) {
-            values.push_back(0.0); // Default value on parse error
+    std::vector<double> values = load_csv_row<double>(file);
+    BasicDoubleArray result({static_cast<int>(values.size())});
+    result.elements = std::move(values);
+    return result;
+}
+
+// Binary array files (format documented in array_file.h)
+namespace {
+
+namespace ArrayFile = rbasic::ArrayFile;
+
+void put_value(ArrayFile::RecordWriter& out, const BasicValue& value) {
+    if (auto* i = rbasic::get_if<int>(&value)) {
+        out.putTag(ArrayFile::ValueTag::INT);
+        out.putInt(*i);
+    } else if (auto* d = rbasic::get_if<double>(&value)) {
+        out.putTag(ArrayFile::ValueTag::DOUBLE);
+        out.putDouble(*d);
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        out.putTag(ArrayFile::ValueTag::STRING);
+        out.putString(value.text());
+    } else if (auto* b = rbasic::get_if<bool>(&value)) {
+        out.putTag(ArrayFile::ValueTag::BOOL);
+        out.putBool(*b);
+    } else if (auto* structValue = rbasic::get_if<BasicStruct>(&value)) {
+        out.putTag(ArrayFile::ValueTag::STRUCT);
+        out.putString(structValue->typeName());
+        out.putCount(static_cast<uint32_t>(structValue->fields.size()));
+        for (size_t field = 0; field < structValue->fields.size(); field++) {
+            out.putString(structValue->layout->fieldNames[field]);
+            put_value(out, structValue->fields[field]);
+        }
+    } else {
+        throw std::runtime_error("save_array: unsupported element type");
+    }
+}
+
+// Structs of the same shape within one file share a single layout
+BasicValue get_value(ArrayFile::RecordReader& in, std::vector<rbasic::StructLayoutPtr>& layouts) {
+    switch (in.getTag()) {
+        case ArrayFile::ValueTag::INT: return in.getInt();
+        case ArrayFile::ValueTag::DOUBLE: return in.getDouble();
+        case ArrayFile::ValueTag::STRING: return in.getString();
+        case ArrayFile::ValueTag::BOOL: return in.getBool();
+        case ArrayFile::ValueTag::STRUCT: {
+            std::string typeName = in.getString();
+            uint32_t fieldCount = in.getCount();
+            std::vector<std::string> names;
+            std::vector<BasicValue> fields;
+            for (uint32_t i = 0; i < fieldCount; i++) {
+                names.push_back(in.getString());
+                fields.push_back(get_value(in, layouts));
+            }
+            auto layout = std::find_if(layouts.begin(), layouts.end(), [&](const rbasic::StructLayoutPtr& candidate) {
+                return candidate->typeName == typeName && candidate->fieldNames == names;
+            });
+            if (layout == layouts.end()) {
+                layout = layouts.insert(layouts.end(), rbasic::makeStructLayout(typeName, std::move(names)));
+            }
+            return make_struct(*layout, std::move(fields));
         }
     }
+    throw std::runtime_error("corrupt value record");
+}
+
+template<typename Array>
+bool save_typed_array(const std::string& filename, const Array& array) {
+    using Element = typename decltype(array.elements)::value_type;
+    ArrayFile::Header header;
+    header.type = ArrayFile::typedElementType<Element>();
+    header.dimensions = array.dimensions;
+    header.count = array.elements.size();
+    return ArrayFile::write(filename, header, array.elements.data(), array.elements.size() * sizeof(Element));
+}
+
+template<typename Array>
+BasicValue load_typed_array(const ArrayFile::Header& header, const uint8_t* payload, size_t payloadBytes, bool swapBytes) {
+    Array array;
+    array.dimensions = header.dimensions;
+    ArrayFile::readElements(array.elements, payload, payloadBytes, header.count, swapBytes);
+    return array;
+}
+
+template<typename Array>
+bool save_vector_array(const std::string& filename, const Array& array) {
+    using Vec = typename decltype(array.elements)::value_type;
+    ArrayFile::Header header;
+    header.type = ArrayFile::vectorElementType<Vec>();
+    header.dimensions = array.dimensions;
+    header.count = array.elements.size();
+    return ArrayFile::write(filename, header, array.elements.data(), array.elements.size() * sizeof(Vec));
+}
+
+template<typename Array>
+BasicValue load_vector_array(const ArrayFile::Header& header, const uint8_t* payload, size_t payloadBytes, bool swapBytes) {
+    Array array;
+    array.dimensions = header.dimensions;
+    ArrayFile::readVectors(array.elements, payload, payloadBytes, header.count, swapBytes);
+    return array;
+}
+
+} // anonymous namespace
+
+bool save_array(const std::string& filename, const BasicValue& value) {
+    if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&value)) {
+        return save_typed_array(filename, *doubles);
+    }
+    if (auto* ints = rbasic::get_if<BasicIntArray>(&value)) {
+        return save_typed_array(filename, *ints);
+    }
+    if (auto* bytes = rbasic::get_if<BasicByteArray>(&value)) {
+        return save_typed_array(filename, *bytes);
+    }
+    if (auto* vec3s = rbasic::get_if<BasicVec3Array>(&value)) {
+        return save_vector_array(filename, *vec3s);
+    }
+    if (auto* vec4s = rbasic::get_if<BasicVec4Array>(&value)) {
+        return save_vector_array(filename, *vec4s);
+    }
     
-    // Create array
-    BasicDoubleArray result({static_cast<int>(values.size())});
-    std::copy(values.begin(), values.end(), result.elements.begin());
+    ArrayFile::Header header;
+    ArrayFile::RecordWriter records;
+    if (auto* structArray = rbasic::get_if<BasicStructArray>(&value)) {
+        header.type = ArrayFile::ElementType::STRUCT_ARRAY;
+        header.dimensions = structArray->dimensions;
+        header.count = structArray->size();
+        ArrayFile::putStructArray(records, *structArray);
+    } else if (auto* array = rbasic::get_if<BasicArray>(&value)) {
+        header.type = ArrayFile::ElementType::GENERIC;
+        header.dimensions = array->dimensions;
+        header.count = array->elements.size();
+        for (size_t i = 0; i < array->elements.size(); i++) {
+            records.putInt(static_cast<int32_t>(i));
+            put_value(records, array->elements[i]);
+        }
+    } else if (rbasic::holds_alternative<BasicStruct>(value)) {
+        header.type = ArrayFile::ElementType::STRUCT;
+        header.count = 1;
+        put_value(records, value);
+    } else {
+        throw std::runtime_error("save_array requires an array or struct");
+    }
+    return ArrayFile::write(filename, header, records.bytes().data(), records.bytes().size());
+}
+
+BasicValue load_array(const std::string& filename) {
+    ArrayFile::MappedFile file(filename);
+    if (!file.isOpen()) {
+        throw std::runtime_error("load_array: cannot open file '" + filename + "'");
+    }
     
-    return result;
+    try {
+        ArrayFile::Header header;
+        const uint8_t* payload = nullptr;
+        size_t payloadBytes = 0;
+        bool swapBytes = false;
+        ArrayFile::readHeader(file, header, payload, payloadBytes, swapBytes);
+        
+        switch (header.type) {
+            case ArrayFile::ElementType::BYTE:
+                return load_typed_array<BasicByteArray>(header, payload, payloadBytes, swapBytes);
+            case ArrayFile::ElementType::INT32:
+                return load_typed_array<BasicIntArray>(header, payload, payloadBytes, swapBytes);
+            case ArrayFile::ElementType::DOUBLE:
+                return load_typed_array<BasicDoubleArray>(header, payload, payloadBytes, swapBytes);
+            case ArrayFile::ElementType::GENERIC: {
+                BasicArray array(header.dimensions);
+                ArrayFile::RecordReader in(payload, payloadBytes, swapBytes);
+                std::vector<rbasic::StructLayoutPtr> layouts;
+                for (uint64_t i = 0; i < header.count; i++) {
+                    int index = in.getInt();
+                    if (index < 0) {
+                        throw std::runtime_error("corrupt element index");
+                    }
+                    if (static_cast<size_t>(index) >= array.elements.size()) {
+                        array.elements.resize(static_cast<size_t>(index) + 1);
+                    }
+                    array.elements[index] = get_value(in, layouts);
+                }
+                return array;
+            }
+            case ArrayFile::ElementType::STRUCT: {
+                ArrayFile::RecordReader in(payload, payloadBytes, swapBytes);
+                std::vector<rbasic::StructLayoutPtr> layouts;
+                BasicValue value = get_value(in, layouts);
+                if (!rbasic::holds_alternative<BasicStruct>(value)) {
+                    throw std::runtime_error("corrupt struct record");
+                }
+                return value;
+            }
+            case ArrayFile::ElementType::STRUCT_ARRAY: {
+                BasicStructArray array;
+                ArrayFile::RecordReader in(payload, payloadBytes, swapBytes);
+                ArrayFile::getStructArray(in, header, array);
+                return array;
+            }
+            case ArrayFile::ElementType::VEC3:
+                return load_vector_array<BasicVec3Array>(header, payload, payloadBytes, swapBytes);
+            case ArrayFile::ElementType::VEC4:
+                return load_vector_array<BasicVec4Array>(header, payload, payloadBytes, swapBytes);
+        }
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("load_array: " + std::string(e.what()) + " in '" + filename + "'");
+    }
+    throw std::runtime_error("load_array: unknown element type in '" + filename + "'");
 }
 
 // Wrapper functions for code generator (file I/O)
@@ -1159,15 +2166,15 @@ BasicValue func_read_text_file(const std::string& filename) {
 }
 
 BasicValue func_write_text_file(const BasicValue& filenameVal, const BasicValue& contentVal) {
-    if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<std::string>(contentVal)) {
-        return write_text_file(std::get<std::string>(filenameVal), std::get<std::string>(contentVal));
+    if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<std::string>(contentVal)) {
+        return write_text_file(rbasic::get<std::string>(filenameVal), rbasic::get<std::string>(contentVal));
     }
     return false;
 }
 
 BasicValue func_append_text_file(const BasicValue& filenameVal, const BasicValue& contentVal) {
-    if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<std::string>(contentVal)) {
-        return append_text_file(std::get<std::string>(filenameVal), std::get<std::string>(contentVal));
+    if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<std::string>(contentVal)) {
+        return append_text_file(rbasic::get<std::string>(filenameVal), rbasic::get<std::string>(contentVal));
     }
     return false;
 }
@@ -1177,8 +2184,8 @@ BasicValue func_load_binary_file(const std::string& filename) {
 }
 
 BasicValue func_write_binary_file(const BasicValue& filenameVal, const BasicValue& buffer) {
-    if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<BasicByteArray>(buffer)) {
-        return write_binary_file(std::get<std::string>(filenameVal), std::get<BasicByteArray>(buffer));
+    if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<BasicByteArray>(buffer)) {
+        return write_binary_file(rbasic::get<std::string>(filenameVal), rbasic::get<BasicByteArray>(buffer));
     }
     return false;
 }
@@ -1191,23 +2198,164 @@ BasicValue func_load_double_array_csv(const std::string& filename) {
     return load_double_array_csv(filename);
 }
 
+BasicValue func_save_array(const BasicValue& filenameVal, const BasicValue& value) {
+    if (!rbasic::holds_alternative<std::string>(filenameVal)) {
+        throw std::runtime_error("save_array requires a filename");
+    }
+    return save_array(rbasic::get<std::string>(filenameVal), value);
+}
+
+BasicValue func_load_array(const BasicValue& filenameVal) {
+    if (!rbasic::holds_alternative<std::string>(filenameVal)) {
+        throw std::runtime_error("load_array requires a filename");
+    }
+    return load_array(rbasic::get<std::string>(filenameVal));
+}
+
+// The pixels of a framebuffer argument, read in place
+static rbasic::PixelImage::View framebuffer_view(const std::string& name, const BasicValue& image) {
+    try {
+        if (auto* bytes = rbasic::get_if<BasicByteArray>(&image)) {
+            return rbasic::PixelImage::byteView(bytes->elements, bytes->dimensions);
+        }
+        if (auto* ints = rbasic::get_if<BasicIntArray>(&image)) {
+            return rbasic::PixelImage::intView(ints->elements, ints->dimensions);
+        }
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(name + ": " + e.what());
+    }
+    throw std::runtime_error(name + " requires a byte_array or int_array framebuffer");
+}
+
+BasicValue func_framebuffer(const BasicValue& width, const BasicValue& height) {
+    BasicByteArray image;
+    image.elements = rbasic::PixelImage::blank(to_int(width), to_int(height));
+    image.dimensions = {to_int(height), to_int(width), 4};
+    return image;
+}
+
+BasicValue func_save_image(const BasicValue& filenameVal, const BasicValue& image) {
+    if (!rbasic::holds_alternative<std::string>(filenameVal)) {
+        throw std::runtime_error("save_image requires a filename");
+    }
+    rbasic::PixelImage::View view = framebuffer_view("save_image", image);
+    try {
+        return rbasic::PixelImage::save(rbasic::get<std::string>(filenameVal), view);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error("save_image: " + std::string(e.what()));
+    }
+}
+
 BasicValue func_sleep(const BasicValue& milliseconds) {
-    int ms = std::holds_alternative<int>(milliseconds) ? std::get<int>(milliseconds) :
-             static_cast<int>(std::get<double>(milliseconds));
+    int ms = rbasic::holds_alternative<int>(milliseconds) ? rbasic::get<int>(milliseconds) :
+             static_cast<int>(rbasic::get<double>(milliseconds));
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
     return 0;
 }
 
+BasicValue func_wait_event(const BasicValue& timeoutMs) {
+    rbasic::EventWait::Source source = rbasic::EventWait::instance().wait(to_int(timeoutMs));
+    return std::string(rbasic::EventWait::name(source));
+}
+
+BasicValue func_event_timer(const BasicValue& intervalMs) {
+    return rbasic::EventWait::instance().setTimer(to_int(intervalMs));
+}
+
+BasicValue func_event_watch_file(const BasicValue& path) {
+    if (!rbasic::holds_alternative<std::string>(path)) {
+        throw std::runtime_error("event_watch_file requires a filename");
+    }
+    return rbasic::EventWait::instance().watchFile(rbasic::get<std::string>(path));
+}
+
+namespace {
+
+// Heap bytes a value owns beyond its own 16 bytes: its box and what that holds
+size_t value_heap_bytes(const BasicValue& value) {
+    if (rbasic::holds_alternative<std::string>(value)) {
+        const std::string* boxed = value.boxedString();
+        return boxed ? value.boxBytes() + rbasic::heapBytes(*boxed) : 0;
+    }
+    return value.boxBytes() + rbasic::visit([](const auto& v) -> size_t {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, BasicArray>) {
+            size_t bytes = rbasic::heapBytes(v.elements) + rbasic::heapBytes(v.dimensions);
+            for (const auto& element : v.elements) {
+                bytes += value_heap_bytes(element);
+            }
+            return bytes;
+        } else if constexpr (std::is_same_v<T, BasicStruct>) {
+            size_t bytes = rbasic::heapBytes(v.fields);
+            for (const auto& field : v.fields) {
+                bytes += value_heap_bytes(field);
+            }
+            return bytes;
+        } else if constexpr (std::is_same_v<T, BasicStructArray>) {
+            return v.heapBytes();
+        } else if constexpr (std::is_same_v<T, BasicByteArray> || std::is_same_v<T, BasicIntArray> ||
+                             std::is_same_v<T, BasicDoubleArray> || std::is_same_v<T, BasicVec3Array> ||
+                             std::is_same_v<T, BasicVec4Array>) {
+            return rbasic::heapBytes(v.elements) + rbasic::heapBytes(v.dimensions);
+        } else {
+            return 0;
+        }
+    }, value);
+}
+
+} // anonymous namespace
+
+BasicValue func_mem_stats(const std::map<std::string, BasicValue>& variables) {
+    static const rbasic::StructLayoutPtr layout = rbasic::makeStructLayout("MemStats", {
+        "rss", "peak_rss", "allocations", "allocated_bytes", "string_bytes", "array_bytes", "struct_bytes",
+        "other_bytes", "variables", "functions", "function_statements"});
+
+    rbasic::LiveValueBytes values;
+    for (const auto& entry : variables) {
+        size_t bytes = sizeof(BasicValue) + value_heap_bytes(entry.second);
+        if (rbasic::holds_alternative<std::string>(entry.second)) {
+            values.strings += bytes;
+        } else if (rbasic::holds_alternative<BasicStruct>(entry.second)) {
+            values.structs += bytes;
+        } else if (rbasic::holds_alternative<BasicArray>(entry.second) || rbasic::holds_alternative<BasicByteArray>(entry.second) ||
+                   rbasic::holds_alternative<BasicIntArray>(entry.second) || rbasic::holds_alternative<BasicDoubleArray>(entry.second) ||
+                   rbasic::holds_alternative<BasicStructArray>(entry.second) || rbasic::holds_alternative<BasicVec3Array>(entry.second) ||
+                   rbasic::holds_alternative<BasicVec4Array>(entry.second)) {
+            values.arrays += bytes;
+        } else {
+            values.other += bytes;
+        }
+        values.variables++;
+    }
+
+    // Compiled programs keep no AST, so there are no retained function bodies
+    rbasic::HeapCounts heap = rbasic::heapCounts();
+    BasicStruct stats(layout);
+    stats.fields = {static_cast<double>(rbasic::currentRssBytes()), static_cast<double>(rbasic::peakRssBytes()),
+                    static_cast<double>(heap.allocations), static_cast<double>(heap.bytes),
+                    static_cast<double>(values.strings), static_cast<double>(values.arrays),
+                    static_cast<double>(values.structs), static_cast<double>(values.other),
+                    static_cast<int>(values.variables), 0, 0};
+    return stats;
+}
+
+void write_memory_report() {
+    // Exact byte count, unlike the interpreter's report, so tools can read it back
+    rbasic::HeapCounts heap = rbasic::heapCounts();
+    std::cerr << "=== Memory: peak " << rbasic::formatBytes(rbasic::peakRssBytes()) << ", " << heap.allocations
+              << " allocations, " << heap.bytes << " bytes ===" << std::endl;
+}
+
 BasicValue func_save_int_array_csv(const BasicValue& filenameVal, const BasicValue& array) {
-    if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<BasicIntArray>(array)) {
-        return save_int_array_csv(std::get<std::string>(filenameVal), std::get<BasicIntArray>(array));
+    if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<BasicIntArray>(array)) {
+        return save_int_array_csv(rbasic::get<std::string>(filenameVal), rbasic::get<BasicIntArray>(array));
     }
     return false;
 }
 
 BasicValue func_save_double_array_csv(const BasicValue& filenameVal, const BasicValue& array) {
-    if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<BasicDoubleArray>(array)) {
-        return save_double_array_csv(std::get<std::string>(filenameVal), std::get<BasicDoubleArray>(array));
+    if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<BasicDoubleArray>(array)) {
+        return save_double_array_csv(rbasic::get<std::string>(filenameVal), rbasic::get<BasicDoubleArray>(array));
     }
     return false;
 }
@@ -1292,6 +2440,10 @@ BasicValue terminal_getch() {
     return rbasic::Terminal::getch();
 }
 
+BasicValue terminal_read_key(int timeoutMs) {
+    return rbasic::Terminal::readKey(timeoutMs);
+}
+
 BasicValue terminal_getline(const std::string& prompt, int promptColour) {
     return rbasic::Terminal::getline(prompt, static_cast<rbasic::Colour>(promptColour));
 }
@@ -1304,6 +2456,19 @@ void terminal_set_echo(bool enabled) {
     rbasic::Terminal::setEcho(enabled);
 }
 
+void terminal_begin_frame() {
+    rbasic::Terminal::beginFrame();
+}
+
+void terminal_put(int row, int col, const std::string& text, int foreground, int background) {
+    rbasic::Terminal::put(row, col, text, static_cast<rbasic::Colour>(foreground),
+                          static_cast<rbasic::Colour>(background));
+}
+
+void terminal_end_frame() {
+    rbasic::Terminal::endFrame();
+}
+
 // Terminal wrapper functions for code generator (with func_ prefix)
 BasicValue func_terminal_init() {
     return terminal_init();
@@ -1407,6 +2572,10 @@ BasicValue func_terminal_getch() {
     return terminal_getch();
 }
 
+BasicValue func_terminal_read_key(const BasicValue& timeout) {
+    return terminal_read_key(to_int(timeout));
+}
+
 BasicValue func_terminal_getline() {
     return terminal_getline("", -1);
 }
@@ -1429,6 +2598,33 @@ BasicValue func_terminal_set_echo(const BasicValue& enabled) {
     return 0;
 }
 
+BasicValue func_terminal_begin_frame() {
+    terminal_begin_frame();
+    return 0;
+}
+
+BasicValue func_terminal_put(const BasicValue& row, const BasicValue& col, const BasicValue& text) {
+    terminal_put(to_int(row), to_int(col), to_string(text), -1, -1);
+    return 0;
+}
+
+BasicValue func_terminal_put(const BasicValue& row, const BasicValue& col, const BasicValue& text,
+                             const BasicValue& foreground) {
+    terminal_put(to_int(row), to_int(col), to_string(text), to_int(foreground), -1);
+    return 0;
+}
+
+BasicValue func_terminal_put(const BasicValue& row, const BasicValue& col, const BasicValue& text,
+                             const BasicValue& foreground, const BasicValue& background) {
+    terminal_put(to_int(row), to_int(col), to_string(text), to_int(foreground), to_int(background));
+    return 0;
+}
+
+BasicValue func_terminal_end_frame() {
+    terminal_end_frame();
+    return 0;
+}
+
 // Core constants (NULL, TRUE, FALSE)
 BasicValue get_constant(const std::string& name) {
     // Core language constants
@@ -1543,15 +2739,15 @@ BasicValue get_constant(const std::string& name) {
 }
 
 BasicValue is_null(const BasicValue& value) {
-    if (std::holds_alternative<void*>(value)) {
-        return BasicValue(std::get<void*>(value) == nullptr);
+    if (rbasic::holds_alternative<void*>(value)) {
+        return BasicValue(rbasic::get<void*>(value) == nullptr);
     }
     return BasicValue(false);
 }
 
 BasicValue not_null(const BasicValue& value) {
-    if (std::holds_alternative<void*>(value)) {
-        return BasicValue(std::get<void*>(value) != nullptr);
+    if (rbasic::holds_alternative<void*>(value)) {
+        return BasicValue(rbasic::get<void*>(value) != nullptr);
     }
     return BasicValue(true);
 }
@@ -1680,6 +2876,111 @@ BasicValue func_sdl_render_fill_rect(const BasicValue& renderer_handle, const Ba
     return BasicValue(0);
 }
 
+// Batched primitives and draw lists. The columns read the arrays' storage
+// in place; every array must hold count elements. A BasicArray's values are
+// converted into 'converted', which must outlive the column.
+static DrawColumn draw_column(const std::string& name, int argument, const BasicValue& value, std::size_t& count,
+                              std::vector<int>& converted) {
+    std::size_t length = 0;
+    DrawColumn column;
+    if (auto* ints = rbasic::get_if<BasicIntArray>(&value)) {
+        column = draw_int_column(ints->elements);
+        length = ints->elements.size();
+    } else if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&value)) {
+        column = draw_double_column(doubles->elements);
+        length = doubles->elements.size();
+    } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&value)) {
+        column = draw_byte_column(bytes->elements);
+        length = bytes->elements.size();
+    } else if (auto* array = rbasic::get_if<BasicArray>(&value)) {
+        converted.resize(array->elements.size());
+        for (std::size_t i = 0; i < converted.size(); ++i) {
+            converted[i] = to_int(array->elements[i]);
+        }
+        column = draw_int_column(converted);
+        length = converted.size();
+    } else {
+        throw std::runtime_error(name + ": argument " + std::to_string(argument) + " is not an array");
+    }
+    if (argument > 2 && length != count) {
+        throw std::runtime_error(name + ": the arrays differ in length (" + std::to_string(count) + " and " +
+                                 std::to_string(length) + ")");
+    }
+    count = length;
+    return column;
+}
+
+BasicValue func_sdl_render_draw_points(const BasicValue& renderer_handle, const BasicValue& xs, const BasicValue& ys) {
+    std::size_t count = 0;
+    std::vector<int> converted[2];
+    DrawColumn x = draw_column("sdl_render_draw_points", 2, xs, count, converted[0]);
+    DrawColumn y = draw_column("sdl_render_draw_points", 3, ys, count, converted[1]);
+    return BasicValue(sdl_render_draw_points(to_int(renderer_handle), x, y, count));
+}
+
+BasicValue func_sdl_render_fill_rects(const BasicValue& renderer_handle, const BasicValue& xs, const BasicValue& ys,
+                                      const BasicValue& ws, const BasicValue& hs) {
+    std::size_t count = 0;
+    std::vector<int> converted[4];
+    DrawColumn x = draw_column("sdl_render_fill_rects", 2, xs, count, converted[0]);
+    DrawColumn y = draw_column("sdl_render_fill_rects", 3, ys, count, converted[1]);
+    DrawColumn w = draw_column("sdl_render_fill_rects", 4, ws, count, converted[2]);
+    DrawColumn h = draw_column("sdl_render_fill_rects", 5, hs, count, converted[3]);
+    return BasicValue(sdl_render_fill_rects(to_int(renderer_handle), x, y, w, h, count));
+}
+
+BasicValue func_sdl_draw_list_create() {
+    return BasicValue(sdl_draw_list_create());
+}
+
+BasicValue func_sdl_draw_list_destroy(const BasicValue& list_handle) {
+    sdl_draw_list_destroy(to_int(list_handle));
+    return BasicValue(0);
+}
+
+BasicValue func_sdl_draw_list_clear(const BasicValue& list_handle) {
+    sdl_draw_list_clear(to_int(list_handle));
+    return BasicValue(0);
+}
+
+BasicValue func_sdl_draw_list_set_color(const BasicValue& list_handle, const BasicValue& r, const BasicValue& g,
+                                        const BasicValue& b, const BasicValue& a) {
+    sdl_draw_list_set_color(to_int(list_handle), to_int(r), to_int(g), to_int(b), to_int(a));
+    return BasicValue(0);
+}
+
+BasicValue func_sdl_draw_list_points(const BasicValue& list_handle, const BasicValue& xs, const BasicValue& ys) {
+    std::size_t count = 0;
+    std::vector<int> converted[2];
+    DrawColumn x = draw_column("sdl_draw_list_points", 2, xs, count, converted[0]);
+    DrawColumn y = draw_column("sdl_draw_list_points", 3, ys, count, converted[1]);
+    sdl_draw_list_points(to_int(list_handle), x, y, count);
+    return BasicValue(0);
+}
+
+BasicValue func_sdl_draw_list_fill_rects(const BasicValue& list_handle, const BasicValue& xs, const BasicValue& ys,
+                                         const BasicValue& ws, const BasicValue& hs) {
+    std::size_t count = 0;
+    std::vector<int> converted[4];
+    DrawColumn x = draw_column("sdl_draw_list_fill_rects", 2, xs, count, converted[0]);
+    DrawColumn y = draw_column("sdl_draw_list_fill_rects", 3, ys, count, converted[1]);
+    DrawColumn w = draw_column("sdl_draw_list_fill_rects", 4, ws, count, converted[2]);
+    DrawColumn h = draw_column("sdl_draw_list_fill_rects", 5, hs, count, converted[3]);
+    sdl_draw_list_fill_rects(to_int(list_handle), x, y, w, h, count);
+    return BasicValue(0);
+}
+
+BasicValue func_sdl_draw_list_replay(const BasicValue& list_handle, const BasicValue& renderer_handle) {
+    return BasicValue(sdl_draw_list_replay(to_int(list_handle), to_int(renderer_handle)));
+}
+
+BasicValue func_sdl_present_framebuffer(const BasicValue& renderer_handle, const BasicValue& image) {
+    rbasic::PixelImage::View view = framebuffer_view("sdl_present_framebuffer", image);
+    Uint32 format = view.format == rbasic::PixelImage::Format::RGBA_BYTES ? SDL_PIXELFORMAT_RGBA32
+                                                                           : SDL_PIXELFORMAT_RGB888;
+    return BasicValue(sdl_present_framebuffer(to_int(renderer_handle), view.pixels, view.width, view.height, format));
+}
+
 // Advanced drawing (SDL2_gfx)
 #ifdef SDL2_GFX_AVAILABLE
 BasicValue func_sdl_render_draw_circle(const BasicValue& renderer_handle, const BasicValue& x,
@@ -1756,12 +3057,9 @@ BasicValue func_sdl_query_texture(const BasicValue& texture_handle) {
     sdl_query_texture(to_int(texture_handle), &format, &access, &w, &h);
     
     // Return as a struct with width and height
-    BasicStruct result("SDL_TextureInfo");
-    result.fields["width"] = BasicValue(w);
-    result.fields["height"] = BasicValue(h);
-    result.fields["format"] = BasicValue(format);
-    result.fields["access"] = BasicValue(access);
-    return BasicValue(result);
+    static const rbasic::StructLayoutPtr layout =
+        create_struct_layout("SDL_TextureInfo", {"width", "height", "format", "access"});
+    return make_struct(layout, {BasicValue(w), BasicValue(h), BasicValue(format), BasicValue(access)});
 }
 
 // Event functions
@@ -1964,6 +3262,87 @@ BasicValue func_sqlite_rollback_transaction(const BasicValue& db_handle) {
     return BasicValue(result);
 }
 
+// Bulk fetch
+BasicValue func_sqlite_fetch_all(const BasicValue& stmt_handle) {
+    BasicStructArray rows;
+    static_cast<rbasic::StructArray&>(rows) = sqlite_fetch_rows(to_int(stmt_handle), 0);
+    return rows;
+}
+
+BasicValue func_sqlite_fetch_columns(const BasicValue& stmt_handle, const BasicValue& max_rows) {
+    int limit = to_int(max_rows);
+    if (limit <= 0) {
+        throw std::runtime_error("sqlite_fetch_columns: max_rows must be positive");
+    }
+    BasicStructArray rows;
+    static_cast<rbasic::StructArray&>(rows) = sqlite_fetch_rows(to_int(stmt_handle), static_cast<size_t>(limit));
+    return rows;
+}
+
+// Asynchronous writes
+BasicValue func_sqlite_async(const BasicValue& db_handle, const BasicValue& batch_rows, const BasicValue& window_ms) {
+    return BasicValue(sqlite_async(to_int(db_handle), to_int(batch_rows), to_int(window_ms)));
+}
+
+BasicValue func_sqlite_async(const BasicValue& db_handle, const BasicValue& batch_rows, const BasicValue& window_ms,
+                             const BasicValue& synchronous) {
+    return BasicValue(sqlite_async(to_int(db_handle), to_int(batch_rows), to_int(window_ms), to_string(synchronous)));
+}
+
+BasicValue func_sqlite_flush(const BasicValue& db_handle) {
+    return BasicValue(sqlite_flush(to_int(db_handle)));
+}
+
+// Batch execution
+static int bind_batch_value(sqlite3_stmt* stmt, int index, const BasicValue& value) {
+    if (auto* i = rbasic::get_if<int>(&value)) {
+        return sqlite3_bind_int(stmt, index, *i);
+    } else if (auto* d = rbasic::get_if<double>(&value)) {
+        return sqlite3_bind_double(stmt, index, *d);
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        std::string_view text = value.text();
+        return sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+    } else if (auto* b = rbasic::get_if<bool>(&value)) {
+        return sqlite3_bind_int(stmt, index, *b ? 1 : 0);
+    }
+    return SQLITE_MISMATCH;
+}
+
+BasicValue func_sqlite_exec_batch(const BasicValue& db_handle, const BasicValue& sql,
+                                  const std::vector<const BasicValue*>& columns) {
+    // Columns are bound straight from the arrays' storage, without copying
+    std::vector<BatchColumn> binders;
+    binders.reserve(columns.size());
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        const BasicValue& column = *columns[i];
+        std::size_t length = 0;
+        if (auto* ints = rbasic::get_if<BasicIntArray>(&column)) {
+            binders.push_back(batch_int_column(ints->elements));
+            length = ints->elements.size();
+        } else if (auto* doubles = rbasic::get_if<BasicDoubleArray>(&column)) {
+            binders.push_back(batch_double_column(doubles->elements));
+            length = doubles->elements.size();
+        } else if (auto* bytes = rbasic::get_if<BasicByteArray>(&column)) {
+            binders.push_back(batch_byte_column(bytes->elements));
+            length = bytes->elements.size();
+        } else if (auto* array = rbasic::get_if<BasicArray>(&column)) {
+            binders.push_back([array](sqlite3_stmt* stmt, int index, std::size_t row) {
+                return bind_batch_value(stmt, index, array->elements[row]);
+            });
+            length = array->elements.size();
+        } else {
+            throw std::runtime_error("sqlite_exec_batch: argument " + std::to_string(i + 3) + " is not an array");
+        }
+        if (i > 0 && length != rows) {
+            throw std::runtime_error("sqlite_exec_batch: the arrays differ in length (" + std::to_string(rows) +
+                                     " and " + std::to_string(length) + ")");
+        }
+        rows = length;
+    }
+    return BasicValue(sqlite_exec_batch(to_int(db_handle), to_string(sql), binders, rows));
+}
+
 #endif // SQLITE3_SUPPORT_ENABLED
 
 } // namespace basic_runtime
@@ -18,6 +18,9 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
 
+#include "../include/struct_array.h"
+#include "../include/tagged_value.h"
+
 // Forward declarations
 struct BasicStruct;
 struct BasicArray;
@@ -25,6 +28,9 @@ struct BasicByteArray;
 struct BasicIntArray;
 struct BasicDoubleArray;
 struct BasicPointer;
+struct BasicStructArray;
+struct BasicVec3Array;
+struct BasicVec4Array;
 
 // GLM value wrappers for runtime
 struct BasicVec2 {
@@ -68,7 +74,7 @@ struct BasicQuat {
 };
 
 // Value type for compiled BASIC programs
-using BasicValue = std::variant<int, double, std::string, bool, void*, BasicStruct, BasicArray, BasicByteArray, BasicIntArray, BasicDoubleArray, BasicVec2, BasicVec3, BasicVec4, BasicMat3, BasicMat4, BasicQuat>;
+using BasicValue = rbasic::TaggedValue<int, double, std::string, bool, void*, BasicStruct, BasicArray, BasicByteArray, BasicIntArray, BasicDoubleArray, BasicVec2, BasicVec3, BasicVec4, BasicMat3, BasicMat4, BasicQuat, BasicStructArray, BasicVec3Array, BasicVec4Array>;
 
 // Pointer wrapper for FFI
 struct BasicPointer {
@@ -79,13 +85,28 @@ struct BasicPointer {
     BasicPointer(void* p, const std::string& type = "") : ptr(p), typeName(type) {}
 };
 
-// Structure type
+// Structure type: field values in declaration order, named by a layout
+// shared with every other instance of the same struct type
 struct BasicStruct {
-    std::string typeName;
-    std::map<std::string, BasicValue> fields;
+    rbasic::StructLayoutPtr layout;
+    std::vector<BasicValue> fields;  // Parallel to layout->fieldNames
     
     BasicStruct() = default;
-    BasicStruct(const std::string& type) : typeName(type) {}
+    explicit BasicStruct(rbasic::StructLayoutPtr structLayout);  // Fields start as 0
+    
+    const std::string& typeName() const {
+        static const std::string none;
+        return layout ? layout->typeName : none;
+    }
+    
+    // By-name access for callers without a cached index; nullptr if absent
+    BasicValue* field(const std::string& name);
+    const BasicValue* field(const std::string& name) const;
+};
+
+// Array of a declared struct type, stored as one column per field
+struct BasicStructArray : rbasic::StructArray {
+    using rbasic::StructArray::StructArray;
 };
 
 // Array type
@@ -242,6 +263,35 @@ struct BasicDoubleArray {
     }
 };
 
+// Packed vector arrays (vec3_array, vec4_array); see vec_ops.h for the kernels
+struct BasicVec3Array {
+    std::vector<glm::vec3> elements;
+    std::vector<int> dimensions;
+    
+    BasicVec3Array() = default;
+    BasicVec3Array(const std::vector<int>& dims) : dimensions(dims) {
+        int totalSize = 1;
+        for (int dim : dims) {
+            totalSize *= dim;
+        }
+        elements.resize(totalSize, glm::vec3(0.0f));
+    }
+};
+
+struct BasicVec4Array {
+    std::vector<glm::vec4> elements;
+    std::vector<int> dimensions;
+    
+    BasicVec4Array() = default;
+    BasicVec4Array(const std::vector<int>& dims) : dimensions(dims) {
+        int totalSize = 1;
+        for (int dim : dims) {
+            totalSize *= dim;
+        }
+        elements.resize(totalSize, glm::vec4(0.0f));
+    }
+};
+
 // Library handle for FFI - Temporarily disabled for Phase 1
 /*
 struct BasicLibraryHandle {
@@ -278,6 +328,13 @@ BasicValue mid(const BasicValue& str, int start, int length = -1);
 BasicValue left(const BasicValue& str, int length);
 BasicValue right(const BasicValue& str, int length);
 BasicValue val(const BasicValue& str);  // Convert string to number
+BasicValue func_instr(const BasicValue& str, const BasicValue& find, const BasicValue& start = 1);
+BasicValue func_split(const BasicValue& str, const BasicValue& delimiter);
+BasicValue func_join(const BasicValue& array, const BasicValue& separator);
+BasicValue func_replace(const BasicValue& str, const BasicValue& from, const BasicValue& to);
+BasicValue func_upper(const BasicValue& str);
+BasicValue func_lower(const BasicValue& str);
+BasicValue func_trim(const BasicValue& str);
 
 // Math functions
 BasicValue abs_val(const BasicValue& value);
@@ -353,6 +410,10 @@ bool save_double_array_csv(const std::string& filename, const BasicDoubleArray&
 BasicValue load_int_array_csv(const std::string& filename);
 BasicValue load_double_array_csv(const std::string& filename);
 
+// Binary array/struct files; load_array throws on a missing or malformed file
+bool save_array(const std::string& filename, const BasicValue& value);
+BasicValue load_array(const std::string& filename);
+
 // Wrapper functions for code generator (file I/O)
 BasicValue func_file_exists(const std::string& filename);
 BasicValue func_file_size(const std::string& filename);
@@ -367,10 +428,25 @@ BasicValue func_load_int_array_csv(const std::string& filename);
 BasicValue func_load_double_array_csv(const std::string& filename);
 BasicValue func_save_int_array_csv(const BasicValue& filenameVal, const BasicValue& array);
 BasicValue func_save_double_array_csv(const BasicValue& filenameVal, const BasicValue& array);
+BasicValue func_save_array(const BasicValue& filenameVal, const BasicValue& value);
+BasicValue func_load_array(const BasicValue& filenameVal);
+
+// Software framebuffers: byte_array(h, w, 4) RGBA or int_array(h, w) 0xRRGGBB.
+// save_image writes a BMP or PPM, chosen by the filename's extension.
+BasicValue func_framebuffer(const BasicValue& width, const BasicValue& height);
+BasicValue func_save_image(const BasicValue& filenameVal, const BasicValue& image);
 
 // Utility functions
 BasicValue func_sleep(const BasicValue& milliseconds);
 
+// Event wait (see event_wait.h): wait_event returns the source that fired,
+// "timeout", "key", "sdl", "serial", "timer" or "file"
+BasicValue func_wait_event(const BasicValue& timeoutMs);
+BasicValue func_event_timer(const BasicValue& intervalMs);
+BasicValue func_event_watch_file(const BasicValue& path);
+BasicValue func_mem_stats(const std::map<std::string, BasicValue>& variables);  // MemStats struct
+void write_memory_report();  // --mem-report: peak RSS and heap counts on stderr, run at exit
+
 // Buffer allocation wrapper functions for code generator
 BasicValue func_alloc_int_buffer();
 BasicValue func_alloc_pointer_buffer();
@@ -411,26 +487,52 @@ BasicValue func_terminal_get_rows();
 BasicValue func_terminal_get_cols();
 BasicValue func_terminal_kbhit();
 BasicValue func_terminal_getch();
+BasicValue func_terminal_read_key(const BasicValue& timeout);
 BasicValue func_terminal_getline();
 BasicValue func_terminal_getline(const BasicValue& prompt);
 BasicValue func_terminal_getline(const BasicValue& prompt, const BasicValue& promptColour);
 BasicValue func_terminal_show_cursor(const BasicValue& visible);
 BasicValue func_terminal_set_echo(const BasicValue& enabled);
+BasicValue func_terminal_begin_frame();
+BasicValue func_terminal_put(const BasicValue& row, const BasicValue& col, const BasicValue& text);
+BasicValue func_terminal_put(const BasicValue& row, const BasicValue& col, const BasicValue& text,
+                             const BasicValue& foreground);
+BasicValue func_terminal_put(const BasicValue& row, const BasicValue& col, const BasicValue& text,
+                             const BasicValue& foreground, const BasicValue& background);
+BasicValue func_terminal_end_frame();
 
 // Simple 1D array access helpers
-BasicValue get_array_element(BasicValue& arrayVar, BasicValue index);
+BasicValue get_array_element(const BasicValue& arrayVar, BasicValue index);
 void set_array_element(BasicValue& arrayVar, BasicValue index, BasicValue value);
 
 // Multidimensional array access helpers
-BasicValue get_array_element(BasicValue& arrayVar, const std::vector<BasicValue>& indices);
+BasicValue get_array_element(const BasicValue& arrayVar, const std::vector<BasicValue>& indices);
 void set_array_element(BasicValue& arrayVar, const std::vector<BasicValue>& indices, BasicValue value);
 
-// Structure functions
+// Structure functions. Generated programs build one layout per declared
+// struct and create instances from it with make_struct.
+rbasic::StructLayoutPtr create_struct_layout(const std::string& typeName, const std::vector<std::string>& fields);
 BasicStruct create_struct(const std::string& typeName);
+BasicValue make_struct(const rbasic::StructLayoutPtr& layout, std::vector<BasicValue> fields);
 BasicValue get_struct_field(const BasicStruct& struct_, const std::string& fieldName);
 BasicValue get_struct_field(const BasicValue& value, const std::string& fieldName);
 void set_struct_field(BasicStruct& struct_, const std::string& fieldName, const BasicValue& value);
 
+// Struct arrays (dim name(n) as StructType) and member access dispatch.
+// get_member/set_member handle structs, struct arrays (whole columns as typed
+// arrays) and vector components; the element forms handle arr[i].member.
+// The FieldCache overloads are used by generated code: one cache per access
+// site, so a field index is resolved once rather than on every access.
+BasicValue create_struct_array(const rbasic::StructLayoutPtr& layout, const std::vector<int>& dimensions);
+BasicValue get_member(const BasicValue& object, const std::string& member);
+BasicValue get_member(const BasicValue& object, const std::string& member, rbasic::FieldCache& cache);
+BasicValue set_member(BasicValue& object, const std::string& member, const BasicValue& value);
+BasicValue set_member(BasicValue& object, const std::string& member, const BasicValue& value, rbasic::FieldCache& cache);
+BasicValue get_element_member(const BasicValue& arrayVar, const std::vector<BasicValue>& indices, const std::string& member,
+                              rbasic::FieldCache& cache);
+BasicValue set_element_member(BasicValue& arrayVar, const std::vector<BasicValue>& indices, const std::string& member,
+                              const BasicValue& value, rbasic::FieldCache& cache);
+
 // Buffer allocation and output parameter functions
 BasicValue alloc_int_buffer();              // Allocates int* for output parameters
 BasicValue alloc_pointer_buffer();          // Allocates void** for output parameters  
@@ -459,6 +561,8 @@ BasicValue create_vec3(float x, float y, float z);
 BasicValue create_vec4(float x, float y, float z, float w);
 BasicValue create_mat3(float m00, float m01, float m02, float m10, float m11, float m12, float m20, float m21, float m22);
 BasicValue create_mat4(float m00, float m01, float m02, float m03, float m10, float m11, float m12, float m13, float m20, float m21, float m22, float m23, float m30, float m31, float m32, float m33);
+BasicValue create_mat3();  // Identity
+BasicValue create_mat4();  // Identity
 BasicValue create_quat(float w = 1.0f, float x = 0.0f, float y = 0.0f, float z = 0.0f);
 
 // GLM component access
@@ -472,6 +576,14 @@ BasicValue vec_dot(const BasicValue& left, const BasicValue& right);
 BasicValue vec_cross(const BasicValue& left, const BasicValue& right);
 BasicValue vec_distance(const BasicValue& left, const BasicValue& right);
 
+// Packed vector arrays and whole-array GLM operations (kernels shared with the interpreter)
+BasicValue func_vec3_array(int size);
+BasicValue func_vec4_array(int size);
+BasicValue func_transform_points(const BasicValue& matrix, const BasicValue& array);
+BasicValue func_rotate_all(const BasicValue& rotation, const BasicValue& array);
+BasicValue func_normalize_all(const BasicValue& array);
+BasicValue func_dot_all(const BasicValue& a, const BasicValue& b);
+
 // Type conversion
 int to_int(const BasicValue& value);
 double to_double(const BasicValue& value);
@@ -494,9 +606,13 @@ BasicValue terminal_get_rows();
 BasicValue terminal_get_cols();
 bool terminal_kbhit();
 BasicValue terminal_getch();
+BasicValue terminal_read_key(int timeoutMs);
 BasicValue terminal_getline(const std::string& prompt, int promptColour);
 void terminal_show_cursor(bool visible);
 void terminal_set_echo(bool enabled);
+void terminal_begin_frame();
+void terminal_put(int row, int col, const std::string& text, int foreground, int background);
+void terminal_end_frame();
 
 // Arithmetic operations
 BasicValue add(const BasicValue& left, const BasicValue& right);
@@ -541,6 +657,24 @@ void parallel_fill_double_array(BasicDoubleArray& array, double value);
 void parallel_array_add(BasicDoubleArray& result, const BasicDoubleArray& a, const BasicDoubleArray& b);
 void parallel_array_multiply_scalar(BasicDoubleArray& array, double scalar);
 
+// Whole-array operations on typed arrays (code generator wrappers)
+// Arrays passed by non-const reference are modified in place.
+BasicValue func_array_add(const BasicValue& a, const BasicValue& b);
+BasicValue func_array_sub(const BasicValue& a, const BasicValue& b);
+BasicValue func_array_mul(const BasicValue& a, const BasicValue& b);
+BasicValue func_array_div(const BasicValue& a, const BasicValue& b);
+BasicValue func_array_axpy(const BasicValue& alpha, const BasicValue& x, BasicValue& y);
+BasicValue func_array_sum(const BasicValue& array);
+BasicValue func_array_min(const BasicValue& array);
+BasicValue func_array_max(const BasicValue& array);
+BasicValue func_array_mean(const BasicValue& array);
+BasicValue func_array_dot(const BasicValue& a, const BasicValue& b);
+BasicValue func_array_fill(BasicValue& array, const BasicValue& value);
+BasicValue func_array_copy(BasicValue& dst, const BasicValue& dstStart, const BasicValue& src, const BasicValue& srcStart, const BasicValue& count);
+BasicValue func_array_slice(const BasicValue& array, const BasicValue& start, const BasicValue& count);
+BasicValue func_array_sort(BasicValue& array);
+BasicValue func_array_prefix_sum(const BasicValue& array);
+
 // Foreign Function Interface (FFI)
 BasicValue load_library(const std::string& library_name);
 BasicValue unload_library(const BasicValue& library_handle);
@@ -605,6 +739,21 @@ BasicValue func_sdl_render_draw_rect(const BasicValue& renderer_handle, const Ba
 BasicValue func_sdl_render_fill_rect(const BasicValue& renderer_handle, const BasicValue& x, const BasicValue& y,
                                      const BasicValue& w, const BasicValue& h);
 
+// Batched primitives and draw lists: coordinates come from equal-length arrays
+BasicValue func_sdl_render_draw_points(const BasicValue& renderer_handle, const BasicValue& xs, const BasicValue& ys);
+BasicValue func_sdl_render_fill_rects(const BasicValue& renderer_handle, const BasicValue& xs, const BasicValue& ys,
+                                      const BasicValue& ws, const BasicValue& hs);
+BasicValue func_sdl_draw_list_create();
+BasicValue func_sdl_draw_list_destroy(const BasicValue& list_handle);
+BasicValue func_sdl_draw_list_clear(const BasicValue& list_handle);
+BasicValue func_sdl_draw_list_set_color(const BasicValue& list_handle, const BasicValue& r, const BasicValue& g,
+                                        const BasicValue& b, const BasicValue& a);
+BasicValue func_sdl_draw_list_points(const BasicValue& list_handle, const BasicValue& xs, const BasicValue& ys);
+BasicValue func_sdl_draw_list_fill_rects(const BasicValue& list_handle, const BasicValue& xs, const BasicValue& ys,
+                                         const BasicValue& ws, const BasicValue& hs);
+BasicValue func_sdl_draw_list_replay(const BasicValue& list_handle, const BasicValue& renderer_handle);
+BasicValue func_sdl_present_framebuffer(const BasicValue& renderer_handle, const BasicValue& image);
+
 // Advanced drawing (SDL2_gfx)
 #ifdef SDL2_GFX_AVAILABLE
 BasicValue func_sdl_render_draw_circle(const BasicValue& renderer_handle, const BasicValue& x, 
@@ -697,6 +846,24 @@ BasicValue func_sqlite_begin_transaction(const BasicValue& db_handle);
 BasicValue func_sqlite_commit_transaction(const BasicValue& db_handle);
 BasicValue func_sqlite_rollback_transaction(const BasicValue& db_handle);
 
+// Bulk fetch: the rows as a struct array with one field per result column
+BasicValue func_sqlite_fetch_all(const BasicValue& stmt_handle);
+BasicValue func_sqlite_fetch_columns(const BasicValue& stmt_handle, const BasicValue& max_rows);
+
+// Batch execution: sql runs once per element of the column arrays, bound in order
+BasicValue func_sqlite_exec_batch(const BasicValue& db_handle, const BasicValue& sql,
+                                  const std::vector<const BasicValue*>& columns);
+template<typename... Columns>
+BasicValue func_sqlite_exec_batch(const BasicValue& db_handle, const BasicValue& sql, const Columns&... columns) {
+    return func_sqlite_exec_batch(db_handle, sql, std::vector<const BasicValue*>{&columns...});
+}
+
+// Asynchronous writes: sqlite_exec queues its SQL for a writer thread
+BasicValue func_sqlite_async(const BasicValue& db_handle, const BasicValue& batch_rows, const BasicValue& window_ms);
+BasicValue func_sqlite_async(const BasicValue& db_handle, const BasicValue& batch_rows, const BasicValue& window_ms,
+                             const BasicValue& synchronous);
+BasicValue func_sqlite_flush(const BasicValue& db_handle);
+
 #endif // SQLITE3_SUPPORT_ENABLED
 
 } // namespace basic_runtime
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifdef SDL2_SUPPORT_ENABLED
 
 #include "sdl2_wrapper.h"
+#include "../include/event_wait.h"
 #include <stdexcept>
 #include <SDL_image.h>
 
@@ -15,6 +16,31 @@ namespace basic_runtime {
 static SDL_Event last_event;
 static bool event_available = false;
 
+// Coordinates of the batched primitives, kept between calls for their capacity
+static std::vector<SDL_Point> point_scratch;
+static std::vector<SDL_Rect> rect_scratch;
+
+// The SDL event queue as a wait_event source. Waits peek, so the event is
+// still there for sdl_poll_event; wakes are a registered user event type.
+class SDLEventQueue : public rbasic::EventWait::ExternalQueue {
+public:
+    bool pending() override {
+        SDL_PumpEvents();
+        return SDL_PeepEvents(nullptr, 0, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0;
+    }
+    void wait(int timeoutMs) override { SDL_WaitEventTimeout(nullptr, timeoutMs); }
+    void wake() override {
+        SDL_Event event{};
+        event.type = wakeType;
+        SDL_PushEvent(&event);
+    }
+    void clearWakes() override { SDL_FlushEvent(wakeType); }
+
+    Uint32 wakeType = SDL_RegisterEvents(1);
+};
+
+static std::unique_ptr<SDLEventQueue> event_queue;
+
 // ResourceManager implementation
 SDL2_ResourceManager& SDL2_ResourceManager::instance() {
     static SDL2_ResourceManager instance;
@@ -49,6 +75,7 @@ SDL_Renderer* SDL2_ResourceManager::getRenderer(int handle) {
 
 void SDL2_ResourceManager::removeRenderer(int handle) {
     renderers.erase(handle);
+    framebufferTextures.erase(handle);  // Destroyed along with its renderer
 }
 
 int SDL2_ResourceManager::addTexture(SDL_Texture* texture) {
@@ -81,7 +108,48 @@ void SDL2_ResourceManager::removeSurface(int handle) {
     surfaces.erase(handle);
 }
 
+int SDL2_ResourceManager::addDrawList() {
+    int id = nextDrawListId++;
+    drawLists[id];
+    return id;
+}
+
+DrawList* SDL2_ResourceManager::getDrawList(int handle) {
+    auto it = drawLists.find(handle);
+    return (it != drawLists.end()) ? &it->second : nullptr;
+}
+
+void SDL2_ResourceManager::removeDrawList(int handle) {
+    drawLists.erase(handle);
+}
+
+SDL_Texture* SDL2_ResourceManager::getFramebufferTexture(int rendererHandle, int width, int height, Uint32 format) {
+    SDL_Renderer* renderer = getRenderer(rendererHandle);
+    if (!renderer) {
+        return nullptr;
+    }
+    auto it = framebufferTextures.find(rendererHandle);
+    if (it != framebufferTextures.end()) {
+        const FramebufferTexture& cached = it->second;
+        if (cached.width == width && cached.height == height && cached.format == format) {
+            return cached.texture;
+        }
+        SDL_DestroyTexture(cached.texture);
+        framebufferTextures.erase(it);
+    }
+    SDL_Texture* texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (texture) {
+        framebufferTextures[rendererHandle] = {texture, width, height, format};
+    }
+    return texture;
+}
+
 void SDL2_ResourceManager::cleanup() {
+    drawLists.clear();
+    
+    // Framebuffer textures go with the renderers below
+    framebufferTextures.clear();
+    
     // Clean up all textures
     for (auto& pair : textures) {
         if (pair.second) {
@@ -117,10 +185,17 @@ void SDL2_ResourceManager::cleanup() {
 
 // Core SDL functions
 int sdl_init(int flags) {
-    return SDL_Init(flags);
+    int result = SDL_Init(flags);
+    if (result == 0 && SDL_WasInit(SDL_INIT_EVENTS) && !event_queue) {
+        event_queue = std::make_unique<SDLEventQueue>();
+        rbasic::EventWait::instance().setExternalQueue(event_queue.get());
+    }
+    return result;
 }
 
 void sdl_quit() {
+    rbasic::EventWait::instance().setExternalQueue(nullptr);
+    event_queue.reset();
     SDL2_ResourceManager::instance().cleanup();
     SDL_Quit();
 }
@@ -268,6 +343,177 @@ void sdl_render_fill_rect(int renderer_handle, int x, int y, int w, int h) {
     }
 }
 
+// Batched primitives
+DrawColumn draw_int_column(const std::vector<int>& values) {
+    return {DrawColumn::Kind::INT, values.data()};
+}
+
+DrawColumn draw_double_column(const std::vector<double>& values) {
+    return {DrawColumn::Kind::DOUBLE, values.data()};
+}
+
+DrawColumn draw_byte_column(const std::vector<uint8_t>& values) {
+    return {DrawColumn::Kind::BYTE, values.data()};
+}
+
+// Copies count coordinates from column into the given int field of out[0..count)
+template<typename Shape>
+static void store_column(Shape* out, int Shape::*field, const DrawColumn& column, std::size_t count) {
+    switch (column.kind) {
+    case DrawColumn::Kind::INT: {
+        const int* values = static_cast<const int*>(column.data);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i].*field = values[i];
+        }
+        break;
+    }
+    case DrawColumn::Kind::DOUBLE: {
+        const double* values = static_cast<const double*>(column.data);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i].*field = static_cast<int>(values[i]);
+        }
+        break;
+    }
+    case DrawColumn::Kind::BYTE: {
+        const uint8_t* values = static_cast<const uint8_t*>(column.data);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i].*field = values[i];
+        }
+        break;
+    }
+    }
+}
+
+static void append_points(std::vector<SDL_Point>& points, const DrawColumn& xs, const DrawColumn& ys,
+                          std::size_t count) {
+    std::size_t first = points.size();
+    points.resize(first + count);
+    store_column(points.data() + first, &SDL_Point::x, xs, count);
+    store_column(points.data() + first, &SDL_Point::y, ys, count);
+}
+
+static void append_rects(std::vector<SDL_Rect>& rects, const DrawColumn& xs, const DrawColumn& ys,
+                         const DrawColumn& ws, const DrawColumn& hs, std::size_t count) {
+    std::size_t first = rects.size();
+    rects.resize(first + count);
+    store_column(rects.data() + first, &SDL_Rect::x, xs, count);
+    store_column(rects.data() + first, &SDL_Rect::y, ys, count);
+    store_column(rects.data() + first, &SDL_Rect::w, ws, count);
+    store_column(rects.data() + first, &SDL_Rect::h, hs, count);
+}
+
+int sdl_render_draw_points(int renderer_handle, const DrawColumn& xs, const DrawColumn& ys, std::size_t count) {
+    SDL_Renderer* renderer = SDL2_ResourceManager::instance().getRenderer(renderer_handle);
+    if (!renderer) {
+        return -1;
+    }
+    point_scratch.clear();
+    append_points(point_scratch, xs, ys, count);
+    return SDL_RenderDrawPoints(renderer, point_scratch.data(), static_cast<int>(count));
+}
+
+int sdl_render_fill_rects(int renderer_handle, const DrawColumn& xs, const DrawColumn& ys, const DrawColumn& ws,
+                          const DrawColumn& hs, std::size_t count) {
+    SDL_Renderer* renderer = SDL2_ResourceManager::instance().getRenderer(renderer_handle);
+    if (!renderer) {
+        return -1;
+    }
+    rect_scratch.clear();
+    append_rects(rect_scratch, xs, ys, ws, hs, count);
+    return SDL_RenderFillRects(renderer, rect_scratch.data(), static_cast<int>(count));
+}
+
+// Software framebuffer
+int sdl_present_framebuffer(int renderer_handle, const void* pixels, int width, int height, Uint32 format) {
+    SDL_Renderer* renderer = SDL2_ResourceManager::instance().getRenderer(renderer_handle);
+    SDL_Texture* texture =
+        SDL2_ResourceManager::instance().getFramebufferTexture(renderer_handle, width, height, format);
+    if (!renderer || !texture) {
+        return -1;
+    }
+    if (SDL_UpdateTexture(texture, nullptr, pixels, width * 4) != 0 ||
+        SDL_RenderCopy(renderer, texture, nullptr, nullptr) != 0) {
+        return -1;
+    }
+    SDL_RenderPresent(renderer);
+    return 0;
+}
+
+// Draw lists
+int sdl_draw_list_create() {
+    return SDL2_ResourceManager::instance().addDrawList();
+}
+
+void sdl_draw_list_destroy(int list_handle) {
+    SDL2_ResourceManager::instance().removeDrawList(list_handle);
+}
+
+void sdl_draw_list_clear(int list_handle) {
+    DrawList* list = SDL2_ResourceManager::instance().getDrawList(list_handle);
+    if (list) {
+        // Storage is kept for the next frame's commands
+        list->commands.clear();
+        list->points.clear();
+        list->rects.clear();
+    }
+}
+
+void sdl_draw_list_set_color(int list_handle, int r, int g, int b, int a) {
+    DrawList* list = SDL2_ResourceManager::instance().getDrawList(list_handle);
+    if (list) {
+        SDL_Color color = {static_cast<Uint8>(r), static_cast<Uint8>(g), static_cast<Uint8>(b), static_cast<Uint8>(a)};
+        list->commands.push_back({DrawList::Op::SET_COLOR, 0, 0, color});
+    }
+}
+
+void sdl_draw_list_points(int list_handle, const DrawColumn& xs, const DrawColumn& ys, std::size_t count) {
+    DrawList* list = SDL2_ResourceManager::instance().getDrawList(list_handle);
+    if (list) {
+        list->commands.push_back({DrawList::Op::POINTS, list->points.size(), count, SDL_Color{}});
+        append_points(list->points, xs, ys, count);
+    }
+}
+
+void sdl_draw_list_fill_rects(int list_handle, const DrawColumn& xs, const DrawColumn& ys, const DrawColumn& ws,
+                              const DrawColumn& hs, std::size_t count) {
+    DrawList* list = SDL2_ResourceManager::instance().getDrawList(list_handle);
+    if (list) {
+        list->commands.push_back({DrawList::Op::FILL_RECTS, list->rects.size(), count, SDL_Color{}});
+        append_rects(list->rects, xs, ys, ws, hs, count);
+    }
+}
+
+int sdl_draw_list_replay(int list_handle, int renderer_handle) {
+    DrawList* list = SDL2_ResourceManager::instance().getDrawList(list_handle);
+    SDL_Renderer* renderer = SDL2_ResourceManager::instance().getRenderer(renderer_handle);
+    if (!list || !renderer) {
+        return -1;
+    }
+    
+    int result = 0;
+    for (const DrawList::Command& command : list->commands) {
+        int status = 0;
+        switch (command.op) {
+        case DrawList::Op::SET_COLOR:
+            status = SDL_SetRenderDrawColor(renderer, command.color.r, command.color.g, command.color.b,
+                                            command.color.a);
+            break;
+        case DrawList::Op::POINTS:
+            status = SDL_RenderDrawPoints(renderer, list->points.data() + command.first,
+                                          static_cast<int>(command.count));
+            break;
+        case DrawList::Op::FILL_RECTS:
+            status = SDL_RenderFillRects(renderer, list->rects.data() + command.first,
+                                         static_cast<int>(command.count));
+            break;
+        }
+        if (status != 0) {
+            result = -1;
+        }
+    }
+    return result;
+}
+
 // Advanced drawing (requires SDL2_gfx)
 #ifdef SDL2_GFX_AVAILABLE
 void sdl_render_draw_circle(int renderer_handle, int x, int y, int radius) {
@@ -4,9 +4,12 @@
 #ifdef SDL2_SUPPORT_ENABLED
 
 #include <SDL.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace basic_runtime {
 
@@ -32,6 +35,30 @@ struct SurfaceHandle {
     int id;
 };
 
+// Commands recorded by the sdl_draw_list_* functions. points and rects hold
+// the coordinates of every command; a command draws a range of one of them.
+struct DrawList {
+    enum class Op { SET_COLOR, POINTS, FILL_RECTS };
+    struct Command {
+        Op op;
+        std::size_t first;
+        std::size_t count;
+        SDL_Color color;
+    };
+    std::vector<Command> commands;
+    std::vector<SDL_Point> points;
+    std::vector<SDL_Rect> rects;
+};
+
+// Streaming texture that sdl_present_framebuffer keeps for a renderer,
+// replaced when the framebuffer's size or pixel format changes
+struct FramebufferTexture {
+    SDL_Texture* texture;
+    int width;
+    int height;
+    Uint32 format;
+};
+
 // Resource managers
 class SDL2_ResourceManager {
 public:
@@ -57,21 +84,32 @@ public:
     SDL_Surface* getSurface(int handle);
     void removeSurface(int handle);
     
+    // Draw list management
+    int addDrawList();
+    DrawList* getDrawList(int handle);
+    void removeDrawList(int handle);
+    
+    // Framebuffer upload texture for a renderer, created on first use
+    SDL_Texture* getFramebufferTexture(int rendererHandle, int width, int height, Uint32 format);
+    
     // Cleanup
     void cleanup();
     
 private:
-    SDL2_ResourceManager() : nextWindowId(1), nextRendererId(1), nextTextureId(1), nextSurfaceId(1) {}
+    SDL2_ResourceManager() : nextWindowId(1), nextRendererId(1), nextTextureId(1), nextSurfaceId(1), nextDrawListId(1) {}
     
     std::map<int, SDL_Window*> windows;
     std::map<int, SDL_Renderer*> renderers;
     std::map<int, SDL_Texture*> textures;
     std::map<int, SDL_Surface*> surfaces;
+    std::map<int, DrawList> drawLists;
+    std::map<int, FramebufferTexture> framebufferTextures;  // By renderer handle
     
     int nextWindowId;
     int nextRendererId;
     int nextTextureId;
     int nextSurfaceId;
+    int nextDrawListId;
 };
 
 // Core SDL functions
@@ -102,6 +140,43 @@ void sdl_render_draw_line(int renderer_handle, int x1, int y1, int x2, int y2);
 void sdl_render_draw_rect(int renderer_handle, int x, int y, int w, int h);
 void sdl_render_fill_rect(int renderer_handle, int x, int y, int w, int h);
 
+// Batched primitives: count points or rectangles in one SDL call, their
+// coordinates read from BASIC arrays through DrawColumns. The result is
+// SDL's, 0 or -1 (see sdl_get_error), or -1 for an invalid handle.
+//
+// A DrawColumn points at an array's storage; its element type is switched
+// on once per array, so each coordinate is a plain load and conversion.
+// Arrays of mixed values are converted into an int vector first.
+struct DrawColumn {
+    enum class Kind { INT, DOUBLE, BYTE };
+    Kind kind = Kind::INT;
+    const void* data = nullptr;
+};
+DrawColumn draw_int_column(const std::vector<int>& values);
+DrawColumn draw_double_column(const std::vector<double>& values);  // Truncated
+DrawColumn draw_byte_column(const std::vector<uint8_t>& values);
+int sdl_render_draw_points(int renderer_handle, const DrawColumn& xs, const DrawColumn& ys, std::size_t count);
+int sdl_render_fill_rects(int renderer_handle, const DrawColumn& xs, const DrawColumn& ys, const DrawColumn& ws,
+                          const DrawColumn& hs, std::size_t count);
+
+// Draw lists: commands recorded once, with their coordinates copied in, and
+// replayed on a renderer every frame by sdl_draw_list_replay, which makes
+// one SDL call per command and returns 0, or -1 if a call failed
+int sdl_draw_list_create();
+void sdl_draw_list_destroy(int list_handle);
+void sdl_draw_list_clear(int list_handle);
+void sdl_draw_list_set_color(int list_handle, int r, int g, int b, int a);
+void sdl_draw_list_points(int list_handle, const DrawColumn& xs, const DrawColumn& ys, std::size_t count);
+void sdl_draw_list_fill_rects(int list_handle, const DrawColumn& xs, const DrawColumn& ys, const DrawColumn& ws,
+                              const DrawColumn& hs, std::size_t count);
+int sdl_draw_list_replay(int list_handle, int renderer_handle);
+
+// Software framebuffer: uploads width x height pixels (rows of width * 4
+// bytes, in SDL pixel format format) to the renderer's streaming texture,
+// copies it over the whole target and presents. Returns 0, or -1 if SDL
+// failed or the handle is invalid.
+int sdl_present_framebuffer(int renderer_handle, const void* pixels, int width, int height, Uint32 format);
+
 // Advanced drawing (requires SDL2_gfx)
 #ifdef SDL2_GFX_AVAILABLE
 void sdl_render_draw_circle(int renderer_handle, int x, int y, int radius);
@@ -1,10 +1,183 @@
 #ifdef SQLITE3_SUPPORT_ENABLED
 
 #include "sqlite3_wrapper.h"
+#include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <limits>
+#include <stdexcept>
 
 namespace basic_runtime {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// How long either connection waits for the other to release the file
+constexpr int ASYNC_BUSY_TIMEOUT_MS = 5000;
+
+// Whether queued SQL starts or ends a transaction itself, judged by its
+// first keyword
+bool isTransactionControl(const std::string& sql) {
+    std::size_t start = sql.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) {
+        return false;
+    }
+    std::size_t end = start;
+    while (end < sql.size() && std::isalpha(static_cast<unsigned char>(sql[end]))) {
+        ++end;
+    }
+    std::string keyword = sql.substr(start, end - start);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return keyword == "BEGIN" || keyword == "COMMIT" || keyword == "END" || keyword == "ROLLBACK" ||
+           keyword == "SAVEPOINT" || keyword == "RELEASE";
+}
+
+} // namespace
+
+// SQLite3_AsyncWriter implementation
+SQLite3_AsyncWriter::SQLite3_AsyncWriter(sqlite3* db, int batchRows, std::chrono::milliseconds window,
+                                         std::size_t capacity)
+    : db_(db), batchRows_(batchRows), window_(window), ring_(capacity) {
+    writer_ = std::thread([this] { writerLoop(); });
+}
+
+SQLite3_AsyncWriter::~SQLite3_AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_.store(true);
+    }
+    wake_.notify_one();
+    writer_.join();
+    sqlite3_close(db_);
+}
+
+void SQLite3_AsyncWriter::push(std::string sql) {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == ring_.size()) {
+        // The writer notifies without the mutex, so the wait is timed
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        while (head - tail_.load(std::memory_order_acquire) == ring_.size()) {
+            space_.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+    ring_[head % ring_.size()] = std::move(sql);
+    head_.store(head + 1, std::memory_order_release);
+    wake_.notify_one();
+}
+
+int SQLite3_AsyncWriter::flush(std::string& error) {
+    std::size_t target = head_.load(std::memory_order_relaxed);
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        flushTarget_.store(target);
+        wake_.notify_one();
+        flushed_.wait(lock, [&] { return written_.load() >= target; });
+    }
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    int result = error_;
+    error = std::move(errorMessage_);
+    error_ = SQLITE_OK;
+    errorMessage_.clear();
+    return result;
+}
+
+void SQLite3_AsyncWriter::run(const char* sql) {
+    char* message = nullptr;
+    int result = sqlite3_exec(db_, sql, nullptr, nullptr, &message);
+    if (result != SQLITE_OK) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (error_ == SQLITE_OK) {
+            error_ = result;
+            errorMessage_ = message ? message : sqlite3_errstr(result);
+        }
+    }
+    sqlite3_free(message);
+}
+
+void SQLite3_AsyncWriter::commit(std::size_t written) {
+    // Queued SQL may have ended the transaction itself
+    if (!sqlite3_get_autocommit(db_)) {
+        run("COMMIT");
+        if (!sqlite3_get_autocommit(db_)) {
+            sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+    }
+    setWritten(written);
+}
+
+void SQLite3_AsyncWriter::setWritten(std::size_t written) {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        written_.store(written);
+    }
+    flushed_.notify_all();
+}
+
+void SQLite3_AsyncWriter::writerLoop() {
+    std::size_t pending = 0;  // Statements run since the transaction began
+    Clock::time_point began;
+    bool scriptTransaction = false;  // Queued SQL opened a transaction; no batching until it ends
+    for (;;) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            std::string sql = std::move(ring_[tail % ring_.size()]);
+            tail_.store(tail + 1, std::memory_order_release);
+            space_.notify_one();
+            
+            // BEGIN, COMMIT and the like run as they are, after the batch
+            // so far is committed, and inside the script's own transaction
+            // statements run one by one
+            if (scriptTransaction || isTransactionControl(sql)) {
+                if (pending > 0) {
+                    commit(tail);
+                    pending = 0;
+                }
+                run(sql.c_str());
+                scriptTransaction = !sqlite3_get_autocommit(db_);
+                setWritten(tail + 1);
+                continue;
+            }
+            
+            if (pending == 0) {
+                began = Clock::now();
+                run("BEGIN");
+            }
+            run(sql.c_str());
+            if (sqlite3_get_autocommit(db_)) {
+                // The statement ended the batch itself, as "...; COMMIT" would
+                setWritten(tail + 1);
+                pending = 0;
+            } else if (++pending >= static_cast<std::size_t>(batchRows_)) {
+                commit(tail + 1);
+                pending = 0;
+            }
+        }
+        
+        bool drained = tail == head_.load(std::memory_order_acquire);
+        if (pending > 0 && (Clock::now() - began >= window_ ||
+                            (drained && (stopping_.load() || flushTarget_.load() > written_.load())))) {
+            commit(tail);
+            pending = 0;
+        }
+        if (drained && stopping_.load()) {
+            return;
+        }
+        
+        // A flush or stop is requested under the mutex and cannot be missed;
+        // push() notifies without it, so a wait for more SQL is timed
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        if (tail_.load() == head_.load() && !stopping_.load() && flushTarget_.load() <= written_.load()) {
+            auto timeout = std::chrono::duration_cast<Clock::duration>(std::chrono::milliseconds(100));
+            if (pending > 0) {
+                timeout = std::min(timeout, std::max(Clock::duration::zero(), began + window_ - Clock::now()));
+            }
+            wake_.wait_for(lock, timeout);
+        }
+    }
+}
 
 // SQLite3_ResourceManager implementation
 SQLite3_ResourceManager& SQLite3_ResourceManager::instance() {
@@ -42,7 +215,165 @@ void SQLite3_ResourceManager::removeStatement(int handle) {
     statements.erase(handle);
 }
 
+sqlite3_stmt* SQLite3_ResourceManager::acquireStatement(sqlite3* db, const std::string& sql, bool* hasTail,
+                                                        bool onlyRepeated) {
+    auto& bySql = cacheBySql[db];
+    auto found = bySql.find(sql);
+    if (found == bySql.end() && onlyRepeated && !seenBefore(db, sql)) {
+        return nullptr;
+    }
+    if (found != bySql.end() && !found->second->inUse) {
+        CacheEntry entry = found->second;
+        entry->inUse = true;
+        cache.splice(cache.begin(), cache, entry);
+        if (hasTail) {
+            *hasTail = entry->hasTail;
+        }
+        return entry->stmt;
+    }
+    
+    sqlite3_stmt* stmt = nullptr;
+    const char* tail = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), static_cast<int>(sql.size()) + 1, &stmt, &tail) != SQLITE_OK || !stmt) {
+        if (stmt) {
+            sqlite3_finalize(stmt);
+        }
+        return nullptr;
+    }
+    bool more = tail && tail[std::strspn(tail, " \t\r\n;")] != '\0';
+    if (hasTail) {
+        *hasTail = more;
+    }
+    
+    // The same SQL already checked out (a second handle to one query) is
+    // prepared again but not cached; releaseStatement finalizes it
+    if (found == bySql.end()) {
+        cache.push_front(CachedStatement{db, sql, stmt, more, true});
+        bySql.emplace(cache.front().sql, cache.begin());
+        cacheByStatement.emplace(stmt, cache.begin());
+        evictIdleStatements();
+    }
+    return stmt;
+}
+
+int SQLite3_ResourceManager::releaseStatement(sqlite3_stmt* stmt) {
+    fetchedStatements.erase(stmt);
+    auto found = cacheByStatement.find(stmt);
+    if (found == cacheByStatement.end()) {
+        return sqlite3_finalize(stmt);
+    }
+    found->second->inUse = false;
+    int result = sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    evictIdleStatements();
+    return result;
+}
+
+void SQLite3_ResourceManager::evictIdleStatements() {
+    for (auto it = cache.end(); cache.size() > CACHE_CAPACITY && it != cache.begin();) {
+        --it;
+        if (!it->inUse) {
+            cacheBySql[it->db].erase(std::string_view(it->sql));
+            cacheByStatement.erase(it->stmt);
+            sqlite3_finalize(it->stmt);
+            it = cache.erase(it);
+        }
+    }
+}
+
+void SQLite3_ResourceManager::setFetchedToEnd(sqlite3_stmt* stmt, bool done) {
+    if (done) {
+        fetchedStatements.insert(stmt);
+    } else {
+        fetchedStatements.erase(stmt);
+    }
+}
+
+bool SQLite3_ResourceManager::seenBefore(sqlite3* db, const std::string& sql) {
+    std::size_t hash = std::hash<std::string>()(sql) ^ std::hash<sqlite3*>()(db);
+    if (seen.count(hash)) {
+        return true;
+    }
+    if (seenRing.size() < SEEN_CAPACITY) {
+        seenRing.push_back(hash);
+    } else {
+        seen.erase(seenRing[seenNext]);
+        seenRing[seenNext] = hash;
+        seenNext = (seenNext + 1) % SEEN_CAPACITY;
+    }
+    seen.insert(hash);
+    return false;
+}
+
+void SQLite3_ResourceManager::dropStatements(sqlite3* db) {
+    // Statements still checked out stay with their handles and are
+    // finalized by their owner
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->db != db) {
+            ++it;
+            continue;
+        }
+        cacheByStatement.erase(it->stmt);
+        if (!it->inUse) {
+            sqlite3_finalize(it->stmt);
+        }
+        it = cache.erase(it);
+    }
+    cacheBySql.erase(db);
+}
+
+void SQLite3_ResourceManager::setAsyncWriter(int handle, std::unique_ptr<SQLite3_AsyncWriter> writer) {
+    flushAsync(handle);
+    if (writer) {
+        asyncWriters[handle] = std::move(writer);
+    } else {
+        asyncWriters.erase(handle);
+    }
+}
+
+bool SQLite3_ResourceManager::queueAsync(int handle, const std::string& sql) {
+    auto it = asyncWriters.find(handle);
+    if (it == asyncWriters.end()) {
+        return false;
+    }
+    asyncErrors.erase(handle);
+    it->second->push(sql);
+    return true;
+}
+
+int SQLite3_ResourceManager::flushAsync(int handle) {
+    auto it = asyncWriters.find(handle);
+    if (it == asyncWriters.end()) {
+        return SQLITE_OK;
+    }
+    std::string message;
+    int result = it->second->flush(message);
+    if (result != SQLITE_OK) {
+        asyncErrors[handle] = AsyncError{result, std::move(message)};
+    }
+    return result;
+}
+
+const SQLite3_ResourceManager::AsyncError* SQLite3_ResourceManager::asyncError(int handle) const {
+    auto it = asyncErrors.find(handle);
+    return it != asyncErrors.end() ? &it->second : nullptr;
+}
+
 void SQLite3_ResourceManager::cleanup() {
+    // Writers commit their queues and close their own connections first
+    asyncWriters.clear();
+    asyncErrors.clear();
+    
+    // Clean up idle cached statements; the rest are in statements
+    for (auto& entry : cache) {
+        if (!entry.inUse) {
+            sqlite3_finalize(entry.stmt);
+        }
+    }
+    cache.clear();
+    cacheBySql.clear();
+    cacheByStatement.clear();
+    
     // Clean up all statements
     for (auto& pair : statements) {
         if (pair.second) {
@@ -78,15 +409,28 @@ int sqlite_open(const std::string& filename) {
 void sqlite_close(int db_handle) {
     sqlite3* db = SQLite3_ResourceManager::instance().getDatabase(db_handle);
     if (db) {
+        SQLite3_ResourceManager::instance().setAsyncWriter(db_handle, nullptr);
+        SQLite3_ResourceManager::instance().dropStatements(db);
         sqlite3_close(db);
         SQLite3_ResourceManager::instance().removeDatabase(db_handle);
     }
 }
 
-int sqlite_exec(int db_handle, const std::string& sql) {
-    sqlite3* db = SQLite3_ResourceManager::instance().getDatabase(db_handle);
-    if (!db) {
-        return SQLITE_ERROR;
+// Runs sql on the script's own connection, whether or not it writes asynchronously
+static int exec_now(SQLite3_ResourceManager& manager, sqlite3* db, const std::string& sql) {
+    // SQL run again is prepared once and then stepped from the cache. New
+    // SQL, several statements, and SQL that fails to prepare (for its error
+    // message) go through sqlite3_exec.
+    bool hasTail = false;
+    if (sqlite3_stmt* stmt = manager.acquireStatement(db, sql, &hasTail, true)) {
+        if (!hasTail) {
+            int result;
+            while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+            }
+            manager.releaseStatement(stmt);
+            return result == SQLITE_DONE ? SQLITE_OK : result;
+        }
+        manager.releaseStatement(stmt);
     }
     
     char* error_msg = nullptr;
@@ -99,11 +443,26 @@ int sqlite_exec(int db_handle, const std::string& sql) {
     return result;
 }
 
+int sqlite_exec(int db_handle, const std::string& sql) {
+    auto& manager = SQLite3_ResourceManager::instance();
+    sqlite3* db = manager.getDatabase(db_handle);
+    if (!db) {
+        return SQLITE_ERROR;
+    }
+    if (manager.queueAsync(db_handle, sql)) {
+        return SQLITE_OK;
+    }
+    return exec_now(manager, db, sql);
+}
+
 std::string sqlite_errmsg(int db_handle) {
     sqlite3* db = SQLite3_ResourceManager::instance().getDatabase(db_handle);
     if (!db) {
         return "Invalid database handle";
     }
+    if (auto* error = SQLite3_ResourceManager::instance().asyncError(db_handle)) {
+        return error->message;
+    }
     
     const char* msg = sqlite3_errmsg(db);
     return msg ? std::string(msg) : std::string();
@@ -114,6 +473,9 @@ int sqlite_get_last_error_code(int db_handle) {
     if (!db) {
         return SQLITE_ERROR;
     }
+    if (auto* error = SQLite3_ResourceManager::instance().asyncError(db_handle)) {
+        return error->code;
+    }
     
     return sqlite3_errcode(db);
 }
@@ -142,14 +504,13 @@ int sqlite_prepare(int db_handle, const std::string& sql) {
     if (!db) {
         return -1;
     }
+    // A query sees the queued writes
+    SQLite3_ResourceManager::instance().flushAsync(db_handle);
     
-    sqlite3_stmt* stmt = nullptr;
-    int result = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
-    
-    if (result != SQLITE_OK) {
-        if (stmt) {
-            sqlite3_finalize(stmt);
-        }
+    // Preparing the same SQL again, as a loop that prepares and finalizes
+    // each time does, takes the statement from the cache
+    sqlite3_stmt* stmt = SQLite3_ResourceManager::instance().acquireStatement(db, sql);
+    if (!stmt) {
         return -1;
     }
     
@@ -162,7 +523,7 @@ int sqlite_finalize(int stmt_handle) {
         return SQLITE_ERROR;
     }
     
-    int result = sqlite3_finalize(stmt);
+    int result = SQLite3_ResourceManager::instance().releaseStatement(stmt);
     SQLite3_ResourceManager::instance().removeStatement(stmt_handle);
     return result;
 }
@@ -173,6 +534,7 @@ int sqlite_reset(int stmt_handle) {
         return SQLITE_ERROR;
     }
     
+    SQLite3_ResourceManager::instance().setFetchedToEnd(stmt, false);
     return sqlite3_reset(stmt);
 }
 
@@ -238,6 +600,7 @@ int sqlite_step(int stmt_handle) {
         return SQLITE_ERROR;
     }
     
+    SQLite3_ResourceManager::instance().setFetchedToEnd(stmt, false);
     return sqlite3_step(stmt);
 }
 
@@ -307,6 +670,135 @@ std::string sqlite_column_text(int stmt_handle, int index) {
     return text ? std::string(reinterpret_cast<const char*>(text)) : std::string();
 }
 
+// Bulk fetch
+namespace {
+
+// One result column, kept in the narrowest storage that holds what was read
+struct FetchColumn {
+    using Kind = rbasic::StructColumn::Kind;
+    Kind kind = Kind::INT;
+    std::vector<int> ints;
+    std::vector<double> doubles;
+    std::vector<rbasic::StructColumn::Field> values;
+    
+    void widenToDouble() {
+        doubles.assign(ints.begin(), ints.end());
+        ints = std::vector<int>();
+        kind = Kind::DOUBLE;
+    }
+    
+    void widenToGeneric() {
+        if (kind == Kind::INT) {
+            values.assign(ints.begin(), ints.end());
+            ints = std::vector<int>();
+        } else if (kind == Kind::DOUBLE) {
+            values.assign(doubles.begin(), doubles.end());
+            doubles = std::vector<double>();
+        }
+        kind = Kind::GENERIC;
+    }
+    
+    void addInt(int value) {
+        switch (kind) {
+            case Kind::INT: ints.push_back(value); break;
+            case Kind::DOUBLE: doubles.push_back(value); break;
+            default: values.emplace_back(value); break;
+        }
+    }
+    
+    void addDouble(double value) {
+        if (kind == Kind::INT) {
+            widenToDouble();
+        }
+        if (kind == Kind::DOUBLE) {
+            doubles.push_back(value);
+        } else {
+            values.emplace_back(value);
+        }
+    }
+    
+    void addText(std::string value) {
+        if (kind != Kind::GENERIC) {
+            widenToGeneric();
+        }
+        values.emplace_back(std::move(value));
+    }
+    
+    void read(sqlite3_stmt* stmt, int index) {
+        switch (sqlite3_column_type(stmt, index)) {
+            case SQLITE_INTEGER: {
+                sqlite3_int64 value = sqlite3_column_int64(stmt, index);
+                if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max()) {
+                    addInt(static_cast<int>(value));
+                } else {
+                    addDouble(static_cast<double>(value));
+                }
+                break;
+            }
+            case SQLITE_FLOAT:
+                addDouble(sqlite3_column_double(stmt, index));
+                break;
+            case SQLITE_TEXT:
+            case SQLITE_BLOB: {
+                const char* text = static_cast<const char*>(sqlite3_column_blob(stmt, index));
+                addText(text ? std::string(text, sqlite3_column_bytes(stmt, index)) : std::string());
+                break;
+            }
+            default:
+                addInt(0);
+                break;
+        }
+    }
+    
+    void moveInto(rbasic::StructColumn& column) {
+        switch (kind) {
+            case Kind::INT: column.assign(std::move(ints)); break;
+            case Kind::DOUBLE: column.assign(std::move(doubles)); break;
+            default: column.assign(std::move(values)); break;
+        }
+    }
+};
+
+} // anonymous namespace
+
+rbasic::StructArray sqlite_fetch_rows(int stmt_handle, std::size_t max_rows) {
+    auto& manager = SQLite3_ResourceManager::instance();
+    sqlite3_stmt* stmt = manager.getStatement(stmt_handle);
+    if (!stmt) {
+        throw std::runtime_error("sqlite fetch: invalid statement handle " + std::to_string(stmt_handle));
+    }
+    
+    int count = sqlite3_column_count(stmt);
+    std::vector<std::string> names;
+    for (int i = 0; i < count; ++i) {
+        const char* name = sqlite3_column_name(stmt, i);
+        names.push_back(name ? name : "");
+    }
+    
+    std::vector<FetchColumn> columns(count);
+    std::size_t rows = 0;
+    while (!manager.fetchedToEnd(stmt) && (max_rows == 0 || rows < max_rows)) {
+        int result = sqlite3_step(stmt);
+        if (result == SQLITE_DONE) {
+            manager.setFetchedToEnd(stmt, true);
+            break;
+        }
+        if (result != SQLITE_ROW) {
+            throw std::runtime_error("sqlite fetch: " + std::string(sqlite3_errmsg(sqlite3_db_handle(stmt))));
+        }
+        for (int i = 0; i < count; ++i) {
+            columns[i].read(stmt, i);
+        }
+        ++rows;
+    }
+    
+    rbasic::StructArray fetched(rbasic::makeStructLayout("SqliteRow", std::move(names)), {static_cast<int>(rows)});
+    for (int i = 0; i < count; ++i) {
+        columns[i].moveInto(fetched.columns[i]);
+    }
+    return fetched;
+}
+
 // Utility functions
 std::string sqlite_version() {
     return std::string(sqlite3_libversion());
@@ -316,6 +808,68 @@ int sqlite_threadsafe() {
     return sqlite3_threadsafe();
 }
 
+// Asynchronous writes
+int sqlite_async(int db_handle, int batch_rows, int window_ms, const std::string& synchronous) {
+    auto& manager = SQLite3_ResourceManager::instance();
+    sqlite3* db = manager.getDatabase(db_handle);
+    if (!db) {
+        return SQLITE_ERROR;
+    }
+    std::string level = synchronous;
+    std::transform(level.begin(), level.end(), level.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (level != "OFF" && level != "NORMAL" && level != "FULL" && level != "EXTRA") {
+        throw std::runtime_error("sqlite_async: unknown synchronous level '" + synchronous +
+                                 "', expected OFF, NORMAL, FULL or EXTRA");
+    }
+    
+    manager.setAsyncWriter(db_handle, nullptr);
+    if (batch_rows <= 0) {
+        return SQLITE_OK;
+    }
+    const char* filename = sqlite3_db_filename(db, "main");
+    if (!filename || !*filename) {
+        return SQLITE_MISUSE;
+    }
+    
+    sqlite3* writer = nullptr;
+    int result = sqlite3_open_v2(filename, &writer, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, nullptr);
+    if (result == SQLITE_OK) {
+        sqlite3_busy_timeout(writer, ASYNC_BUSY_TIMEOUT_MS);
+        result = sqlite3_exec(writer, ("PRAGMA synchronous=" + level).c_str(), nullptr, nullptr, nullptr);
+    }
+    if (result == SQLITE_OK) {
+        // The pragma answers with the mode in effect, which stays as it was
+        // while another connection is using the file
+        sqlite3_stmt* stmt = nullptr;
+        result = sqlite3_prepare_v2(writer, "PRAGMA journal_mode=WAL", -1, &stmt, nullptr);
+        if (result == SQLITE_OK) {
+            result = sqlite3_step(stmt);
+            const unsigned char* mode = result == SQLITE_ROW ? sqlite3_column_text(stmt, 0) : nullptr;
+            result = mode && sqlite3_stricmp(reinterpret_cast<const char*>(mode), "wal") == 0 ? SQLITE_OK
+                                                                                              : SQLITE_BUSY;
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (result != SQLITE_OK) {
+        sqlite3_close(writer);
+        return result;
+    }
+    
+    sqlite3_busy_timeout(db, ASYNC_BUSY_TIMEOUT_MS);
+    manager.setAsyncWriter(db_handle, std::make_unique<SQLite3_AsyncWriter>(
+                                          writer, batch_rows, std::chrono::milliseconds(std::max(window_ms, 0))));
+    return SQLITE_OK;
+}
+
+int sqlite_flush(int db_handle) {
+    auto& manager = SQLite3_ResourceManager::instance();
+    if (!manager.getDatabase(db_handle)) {
+        return SQLITE_ERROR;
+    }
+    return manager.flushAsync(db_handle);
+}
+
 // Transaction helpers
 int sqlite_begin_transaction(int db_handle) {
     return sqlite_exec(db_handle, "BEGIN TRANSACTION");
@@ -329,6 +883,87 @@ int sqlite_rollback_transaction(int db_handle) {
     return sqlite_exec(db_handle, "ROLLBACK");
 }
 
+// Batch execution
+BatchColumn batch_int_column(const std::vector<int>& values) {
+    return [&values](sqlite3_stmt* stmt, int index, std::size_t row) {
+        return sqlite3_bind_int(stmt, index, values[row]);
+    };
+}
+
+BatchColumn batch_double_column(const std::vector<double>& values) {
+    return [&values](sqlite3_stmt* stmt, int index, std::size_t row) {
+        return sqlite3_bind_double(stmt, index, values[row]);
+    };
+}
+
+BatchColumn batch_byte_column(const std::vector<uint8_t>& values) {
+    return [&values](sqlite3_stmt* stmt, int index, std::size_t row) {
+        return sqlite3_bind_int(stmt, index, values[row]);
+    };
+}
+
+int sqlite_exec_batch(int db_handle, const std::string& sql, const std::vector<BatchColumn>& columns, std::size_t rows) {
+    auto& manager = SQLite3_ResourceManager::instance();
+    sqlite3* db = manager.getDatabase(db_handle);
+    if (!db) {
+        return -1;
+    }
+    // The rows go in on this connection, after what is queued
+    manager.flushAsync(db_handle);
+    
+    sqlite3_stmt* stmt = manager.acquireStatement(db, sql);
+    if (!stmt) {
+        return -1;
+    }
+    int parameters = sqlite3_bind_parameter_count(stmt);
+    if (parameters != static_cast<int>(columns.size())) {
+        manager.releaseStatement(stmt);
+        throw std::runtime_error("sqlite_exec_batch: the SQL has " + std::to_string(parameters) +
+                                 " parameter(s) but " + std::to_string(columns.size()) + " array(s) were given");
+    }
+    
+    // Inside a caller's transaction the rows become part of it
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction && exec_now(manager, db, "BEGIN TRANSACTION") != SQLITE_OK) {
+        manager.releaseStatement(stmt);
+        return -1;
+    }
+    
+    int result = SQLITE_DONE;
+    std::size_t row = 0;
+    for (; row < rows && result == SQLITE_DONE; ++row) {
+        for (std::size_t i = 0; i < columns.size() && result == SQLITE_DONE; ++i) {
+            int bound = columns[i](stmt, static_cast<int>(i) + 1, row);
+            if (bound != SQLITE_OK) {
+                result = bound;
+            }
+        }
+        if (result == SQLITE_DONE) {
+            while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+            }
+            if (result == SQLITE_DONE) {
+                sqlite3_reset(stmt);
+            }
+        }
+    }
+    
+    if (result != SQLITE_DONE) {
+        if (ownTransaction) {
+            exec_now(manager, db, "ROLLBACK");
+        }
+        // Hands the failed step's error back to the connection, where the
+        // rollback had cleared it
+        manager.releaseStatement(stmt);
+        return -1;
+    }
+    manager.releaseStatement(stmt);
+    if (ownTransaction && exec_now(manager, db, "COMMIT") != SQLITE_OK) {
+        exec_now(manager, db, "ROLLBACK");
+        return -1;
+    }
+    return static_cast<int>(row);
+}
+
 } // namespace basic_runtime
 
 #endif // SQLITE3_SUPPORT_ENABLED
@@ -4,9 +4,24 @@
 #ifdef SQLITE3_SUPPORT_ENABLED
 
 #include <sqlite3.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
 #include <string>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../include/struct_array.h"
 
 namespace basic_runtime {
 
@@ -23,6 +38,58 @@ struct StatementHandle {
     int id;
 };
 
+// Writer thread behind sqlite_async. The script thread queues SQL in a
+// single-producer ring and returns; the writer runs it on its own connection,
+// grouping statements into one transaction until batchRows have run or
+// window has passed since it began. Queued BEGIN, COMMIT, ROLLBACK and
+// SAVEPOINT end the current group and run as written, and while they leave
+// a transaction open nothing is grouped. The producer waits only when the
+// ring is full, that is when the disk has fallen that far behind.
+class SQLite3_AsyncWriter {
+public:
+    // Takes ownership of db, a connection for the writer alone
+    SQLite3_AsyncWriter(sqlite3* db, int batchRows, std::chrono::milliseconds window, std::size_t capacity = 4096);
+    ~SQLite3_AsyncWriter();  // Commits what is queued, then closes the connection
+    SQLite3_AsyncWriter(const SQLite3_AsyncWriter&) = delete;
+    SQLite3_AsyncWriter& operator=(const SQLite3_AsyncWriter&) = delete;
+    
+    void push(std::string sql);
+    
+    // Waits until everything queued so far is committed. Returns SQLITE_OK,
+    // or the code of the first statement that failed since the last flush,
+    // with its message in error.
+    int flush(std::string& error);
+    
+private:
+    void writerLoop();
+    void run(const char* sql);  // Keeps the first failure for flush
+    void commit(std::size_t written);  // Ends the transaction; written_ = written
+    void setWritten(std::size_t written);  // Wakes flush
+    
+    sqlite3* db_;
+    int batchRows_;
+    std::chrono::milliseconds window_;
+    
+    // head_ and tail_ count statements queued and taken; slots are head_ % size
+    std::vector<std::string> ring_;
+    std::atomic<std::size_t> head_{0};
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<std::size_t> written_{0};     // Statements committed (or failed)
+    std::atomic<std::size_t> flushTarget_{0};
+    std::atomic<bool> stopping_{false};
+    
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;    // Writer: work, a flush or stop
+    std::condition_variable space_;   // Producer: a slot freed
+    std::condition_variable flushed_;  // Flush: written_ advanced
+    
+    std::mutex errorMutex_;
+    int error_ = SQLITE_OK;
+    std::string errorMessage_;
+    
+    std::thread writer_;
+};
+
 // Resource manager
 class SQLite3_ResourceManager {
 public:
@@ -38,15 +105,74 @@ public:
     sqlite3_stmt* getStatement(int handle);
     void removeStatement(int handle);
     
+    // Prepared statement cache, keyed by (database, SQL text). A statement is
+    // prepared the first time its SQL is seen and handed out again after it
+    // has been released; the least recently used idle statement is finalized
+    // once more than CACHE_CAPACITY are kept. With onlyRepeated, SQL is not
+    // prepared until it is seen a second time, so text built fresh for every
+    // call does not churn the cache. acquireStatement returns nullptr if the
+    // SQL does not prepare (or is new, with onlyRepeated); hasTail reports
+    // text after the first statement. releaseStatement resets the statement
+    // and returns the result of its last step, like sqlite3_finalize.
+    sqlite3_stmt* acquireStatement(sqlite3* db, const std::string& sql, bool* hasTail = nullptr,
+                                   bool onlyRepeated = false);
+    int releaseStatement(sqlite3_stmt* stmt);
+    void dropStatements(sqlite3* db);  // Before the database is closed
+    
+    // Statements a bulk fetch has read to the end. Fetching again returns no
+    // rows, rather than stepping the statement into a fresh run, until it is
+    // reset or stepped.
+    void setFetchedToEnd(sqlite3_stmt* stmt, bool done);
+    bool fetchedToEnd(sqlite3_stmt* stmt) const { return fetchedStatements.count(stmt) != 0; }
+    
+    // Asynchronous writes (sqlite_async). setAsyncWriter commits what a
+    // previous writer has queued before replacing it; nullptr removes it.
+    // queueAsync is false when the database has no writer. A failure found by
+    // flushAsync is kept, for sqlite_errmsg, until more SQL is queued.
+    struct AsyncError {
+        int code;
+        std::string message;
+    };
+    void setAsyncWriter(int handle, std::unique_ptr<SQLite3_AsyncWriter> writer);
+    bool queueAsync(int handle, const std::string& sql);
+    int flushAsync(int handle);
+    const AsyncError* asyncError(int handle) const;
+    
     // Cleanup
     void cleanup();
     
 private:
     SQLite3_ResourceManager() : nextDbId(1), nextStmtId(1) {}
     
+    struct CachedStatement {
+        sqlite3* db;
+        std::string sql;
+        sqlite3_stmt* stmt;
+        bool hasTail;
+        bool inUse;
+    };
+    using CacheEntry = std::list<CachedStatement>::iterator;
+    static const std::size_t CACHE_CAPACITY = 64;
+    static const std::size_t SEEN_CAPACITY = 256;
+    
+    void evictIdleStatements();
+    bool seenBefore(sqlite3* db, const std::string& sql);
+    
     std::map<int, sqlite3*> databases;
     std::map<int, sqlite3_stmt*> statements;
     
+    std::list<CachedStatement> cache;  // Most recently used first
+    std::map<sqlite3*, std::unordered_map<std::string_view, CacheEntry>> cacheBySql;  // Views of entry sql
+    std::unordered_map<sqlite3_stmt*, CacheEntry> cacheByStatement;
+    std::unordered_set<sqlite3_stmt*> fetchedStatements;
+    std::map<int, std::unique_ptr<SQLite3_AsyncWriter>> asyncWriters;
+    std::map<int, AsyncError> asyncErrors;
+    
+    // Hashes of the most recent SQL not yet cached, oldest at seenNext
+    std::vector<std::size_t> seenRing;
+    std::size_t seenNext = 0;
+    std::unordered_set<std::size_t> seen;
+    
     int nextDbId;
     int nextStmtId;
 };
@@ -85,6 +211,26 @@ long long sqlite_column_int64(int stmt_handle, int index);
 double sqlite_column_double(int stmt_handle, int index);
 std::string sqlite_column_text(int stmt_handle, int index);
 
+// Asynchronous writes. sqlite_async opens a second connection to the
+// database file for a writer thread, switches the file to WAL mode and sets
+// the writer's synchronous level (OFF, NORMAL, FULL or EXTRA). From then on
+// sqlite_exec on db queues its SQL and returns SQLITE_OK at once; calls that
+// read or need the connection flush first. batch_rows <= 0 turns it off.
+// Returns SQLITE_OK or an error code; in-memory databases cannot be shared
+// with a second connection and give SQLITE_MISUSE. Throws
+// std::runtime_error for an unknown synchronous level.
+int sqlite_async(int db_handle, int batch_rows, int window_ms, const std::string& synchronous = "NORMAL");
+// Waits for queued writes; SQLITE_OK or the first failure since the last flush
+int sqlite_flush(int db_handle);
+
+// Bulk fetch: steps the statement up to max_rows times (to the end if
+// max_rows is 0) and returns the rows read as a struct array, one field per
+// result column, named as sqlite3_column_name names it. Columns are int until
+// a REAL (or an integer beyond int) is read, then double; TEXT or BLOB makes
+// them generic. NULL reads as 0. Throws std::runtime_error for an invalid
+// handle or a failed step.
+rbasic::StructArray sqlite_fetch_rows(int stmt_handle, std::size_t max_rows);
+
 // Utility functions
 std::string sqlite_version();
 int sqlite_threadsafe();
@@ -94,6 +240,22 @@ int sqlite_begin_transaction(int db_handle);
 int sqlite_commit_transaction(int db_handle);
 int sqlite_rollback_transaction(int db_handle);
 
+// Batch execution. A column binds its value for a row to parameter index of
+// the statement; the source arrays outlive the batch, so text can be bound
+// SQLITE_STATIC.
+using BatchColumn = std::function<int(sqlite3_stmt* stmt, int index, std::size_t row)>;
+BatchColumn batch_int_column(const std::vector<int>& values);
+BatchColumn batch_double_column(const std::vector<double>& values);
+BatchColumn batch_byte_column(const std::vector<uint8_t>& values);
+
+// Runs sql once per row, binding parameter i + 1 from columns[i], inside one
+// transaction (or the caller's, if one is open). Returns the number of rows
+// run, or -1 if the SQL does not prepare or a row fails; a transaction the
+// batch opened is then rolled back, and sqlite_errmsg describes the failure.
+// Throws std::runtime_error if the statement's parameters and the columns
+// differ in number.
+int sqlite_exec_batch(int db_handle, const std::string& sql, const std::vector<BatchColumn>& columns, std::size_t rows);
+
 // SQLite constants
 namespace constants {
     // Result codes
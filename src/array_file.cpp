@@ -0,0 +1,364 @@
+#include "array_file.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rbasic {
+
+namespace ArrayFile {
+
+namespace {
+
+constexpr char MAGIC[4] = {'R', 'B', 'A', 'R'};
+constexpr uint8_t VERSION = 1;
+constexpr uint8_t LITTLE_ENDIAN_ORDER = 1;
+constexpr uint8_t BIG_ENDIAN_ORDER = 2;
+
+uint8_t hostByteOrder() {
+    const uint16_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1 ? LITTLE_ENDIAN_ORDER : BIG_ENDIAN_ORDER;
+}
+
+void swapInPlace(uint8_t* bytes, size_t width) {
+    std::reverse(bytes, bytes + width);
+}
+
+template<typename T>
+void append(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+size_t alignTo8(size_t offset) {
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+} // anonymous namespace
+
+bool write(const std::string& filename, const Header& header, const void* payload, size_t payloadBytes) {
+    std::vector<uint8_t> head;
+    head.insert(head.end(), MAGIC, MAGIC + 4);
+    head.push_back(VERSION);
+    head.push_back(hostByteOrder());
+    head.push_back(static_cast<uint8_t>(header.type));
+    head.push_back(0);
+    append<uint32_t>(head, static_cast<uint32_t>(header.dimensions.size()));
+    for (int dim : header.dimensions) {
+        append<uint32_t>(head, static_cast<uint32_t>(dim));
+    }
+    append<uint64_t>(head, header.count);
+    head.resize(alignTo8(head.size()), 0);
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(head.data()), static_cast<std::streamsize>(head.size()));
+    if (payloadBytes > 0) {
+        file.write(static_cast<const char*>(payload), static_cast<std::streamsize>(payloadBytes));
+    }
+    file.close();
+    return !file.fail();
+}
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) == 0) {
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ == 0) {
+            opened_ = true;
+        } else {
+            void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                ::madvise(mapping, size_, MADV_SEQUENTIAL);
+                data_ = static_cast<const uint8_t*>(mapping);
+                mapped_ = true;
+                opened_ = true;
+            }
+        }
+    }
+    ::close(fd);
+    if (opened_) {
+        return;
+    }
+    size_ = 0;
+#endif
+    // Fallback: read the whole file into memory
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return;
+    }
+    size_ = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    buffer_.resize(size_);
+    if (size_ > 0 && !file.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(size_))) {
+        size_ = 0;
+        return;
+    }
+    data_ = buffer_.data();
+    opened_ = true;
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+}
+
+void readHeader(const MappedFile& file, Header& header, const uint8_t*& payload,
+                size_t& payloadBytes, bool& swapBytes) {
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    if (size < 16 || std::memcmp(data, MAGIC, 4) != 0) {
+        throw std::runtime_error("not an rbasic array file");
+    }
+    if (data[4] != VERSION) {
+        throw std::runtime_error("unsupported array file version " + std::to_string(data[4]));
+    }
+    if (data[5] != LITTLE_ENDIAN_ORDER && data[5] != BIG_ENDIAN_ORDER) {
+        throw std::runtime_error("corrupt array file header");
+    }
+    swapBytes = data[5] != hostByteOrder();
+
+    RecordReader reader(data + 8, size - 8, swapBytes);
+    header.type = static_cast<ElementType>(data[6]);
+    if (header.type < ElementType::BYTE || header.type > ElementType::VEC4) {
+        throw std::runtime_error("unknown element type in array file");
+    }
+    uint32_t rank = reader.getCount();
+    header.dimensions.clear();
+    for (uint32_t i = 0; i < rank; i++) {
+        header.dimensions.push_back(static_cast<int>(reader.getCount()));
+    }
+    size_t countOffset = 8 + 4 * (1 + static_cast<size_t>(rank));
+    if (countOffset + sizeof(uint64_t) > size) {
+        throw std::runtime_error("truncated array file");
+    }
+    std::memcpy(&header.count, data + countOffset, sizeof(uint64_t));
+    if (swapBytes) {
+        swapInPlace(reinterpret_cast<uint8_t*>(&header.count), sizeof(uint64_t));
+    }
+
+    size_t offset = alignTo8(countOffset + sizeof(uint64_t));
+    if (offset > size) {
+        throw std::runtime_error("truncated array file");
+    }
+    payload = data + offset;
+    payloadBytes = size - offset;
+}
+
+void copyElements(void* destination, const uint8_t* payload, size_t count, size_t width, bool swapBytes) {
+    if (count == 0) {
+        return;
+    }
+    std::memcpy(destination, payload, count * width);
+    if (swapBytes && width > 1) {
+        uint8_t* bytes = static_cast<uint8_t*>(destination);
+        for (size_t i = 0; i < count; i++) {
+            swapInPlace(bytes + i * width, width);
+        }
+    }
+}
+
+void RecordWriter::putInt(int32_t value) {
+    append(bytes_, value);
+}
+
+void RecordWriter::putDouble(double value) {
+    append(bytes_, value);
+}
+
+void RecordWriter::putString(std::string_view value) {
+    putCount(static_cast<uint32_t>(value.size()));
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+}
+
+void RecordWriter::putCount(uint32_t value) {
+    append(bytes_, value);
+}
+
+void RecordWriter::putBytes(const void* data, size_t bytes) {
+    const uint8_t* begin = static_cast<const uint8_t*>(data);
+    bytes_.insert(bytes_.end(), begin, begin + bytes);
+}
+
+void RecordReader::read(void* out, size_t bytes, bool swappable) {
+    if (offset_ + bytes > size_) {
+        throw std::runtime_error("truncated array file");
+    }
+    std::memcpy(out, data_ + offset_, bytes);
+    if (swappable && swapBytes_) {
+        swapInPlace(static_cast<uint8_t*>(out), bytes);
+    }
+    offset_ += bytes;
+}
+
+ValueTag RecordReader::getTag() {
+    uint8_t tag;
+    read(&tag, 1, false);
+    if (tag < static_cast<uint8_t>(ValueTag::INT) || tag > static_cast<uint8_t>(ValueTag::STRUCT)) {
+        throw std::runtime_error("corrupt value record in array file");
+    }
+    return static_cast<ValueTag>(tag);
+}
+
+int32_t RecordReader::getInt() {
+    int32_t value;
+    read(&value, sizeof(value), true);
+    return value;
+}
+
+double RecordReader::getDouble() {
+    double value;
+    read(&value, sizeof(value), true);
+    return value;
+}
+
+bool RecordReader::getBool() {
+    uint8_t value;
+    read(&value, 1, false);
+    return value != 0;
+}
+
+std::string RecordReader::getString() {
+    uint32_t length = getCount();
+    if (offset_ + length > size_) {
+        throw std::runtime_error("truncated array file");
+    }
+    std::string value(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return value;
+}
+
+uint32_t RecordReader::getCount() {
+    uint32_t value;
+    read(&value, sizeof(value), true);
+    return value;
+}
+
+void RecordReader::getElements(void* destination, size_t count, size_t width) {
+    if (count > (size_ - offset_) / width) {
+        throw std::runtime_error("truncated array file");
+    }
+    copyElements(destination, data_ + offset_, count, width, swapBytes_);
+    offset_ += count * width;
+}
+
+void putScalar(RecordWriter& out, const Scalar& value) {
+    if (auto* i = std::get_if<int>(&value)) {
+        out.putTag(ValueTag::INT);
+        out.putInt(*i);
+    } else if (auto* d = std::get_if<double>(&value)) {
+        out.putTag(ValueTag::DOUBLE);
+        out.putDouble(*d);
+    } else if (auto* str = std::get_if<std::string>(&value)) {
+        out.putTag(ValueTag::STRING);
+        out.putString(*str);
+    } else {
+        out.putTag(ValueTag::BOOL);
+        out.putBool(std::get<bool>(value));
+    }
+}
+
+Scalar getScalar(RecordReader& in, ValueTag tag) {
+    switch (tag) {
+        case ValueTag::INT: return in.getInt();
+        case ValueTag::DOUBLE: return in.getDouble();
+        case ValueTag::STRING: return in.getString();
+        case ValueTag::BOOL: return in.getBool();
+        default: throw std::runtime_error("nested structs are not supported");
+    }
+}
+
+void putStructArray(RecordWriter& out, const StructArray& array) {
+    out.putString(array.typeName());
+    out.putCount(static_cast<uint32_t>(array.columns.size()));
+    for (size_t f = 0; f < array.columns.size(); f++) {
+        const StructColumn& column = array.columns[f];
+        out.putString(array.layout->fieldNames[f]);
+        out.putCount(static_cast<uint32_t>(column.kind()));
+        switch (column.kind()) {
+            case StructColumn::Kind::INT:
+                out.putBytes(column.ints().data(), column.ints().size() * sizeof(int32_t));
+                break;
+            case StructColumn::Kind::DOUBLE:
+                out.putBytes(column.doubles().data(), column.doubles().size() * sizeof(double));
+                break;
+            case StructColumn::Kind::GENERIC:
+                for (size_t row = 0; row < column.size(); row++) {
+                    putScalar(out, column.get(row));
+                }
+                break;
+        }
+    }
+}
+
+void getStructArray(RecordReader& in, const Header& header, StructArray& array) {
+    std::string typeName = in.getString();
+    uint32_t fieldCount = in.getCount();
+    std::vector<std::string> names;
+    std::vector<StructColumn> columns;
+    size_t rows = 1;
+    for (int dim : header.dimensions) {
+        rows *= static_cast<size_t>(dim);
+    }
+    if (rows != header.count) {
+        throw std::runtime_error("struct array rows do not match its dimensions");
+    }
+    for (uint32_t f = 0; f < fieldCount; f++) {
+        names.push_back(in.getString());
+        StructColumn column(rows);
+        uint32_t kind = in.getCount();
+        if (kind > static_cast<uint32_t>(StructColumn::Kind::GENERIC)) {
+            throw std::runtime_error("corrupt struct array column");
+        }
+        switch (static_cast<StructColumn::Kind>(kind)) {
+            case StructColumn::Kind::INT: {
+                std::vector<int> values(rows);
+                in.getElements(values.data(), rows, sizeof(int32_t));
+                column.assign(std::move(values));
+                break;
+            }
+            case StructColumn::Kind::DOUBLE: {
+                std::vector<double> values(rows);
+                in.getElements(values.data(), rows, sizeof(double));
+                column.assign(std::move(values));
+                break;
+            }
+            case StructColumn::Kind::GENERIC: {
+                std::vector<StructColumn::Field> values;
+                values.reserve(rows);
+                for (size_t row = 0; row < rows; row++) {
+                    values.push_back(getScalar(in, in.getTag()));
+                }
+                column.assign(std::move(values));
+                break;
+            }
+        }
+        columns.push_back(std::move(column));
+    }
+    array.layout = makeStructLayout(std::move(typeName), std::move(names));
+    array.columns = std::move(columns);
+    array.dimensions = header.dimensions;
+}
+
+} // namespace ArrayFile
+
+} // namespace rbasic
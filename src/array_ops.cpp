@@ -0,0 +1,247 @@
+#include "array_ops.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+// Vectorised loop, spread across threads once the array is large enough.
+// Every kernel names its element count 'n'.
+#define ARRAY_OPS_LOOP _Pragma("omp parallel for simd if(n > PARALLEL_THRESHOLD)")
+#define ARRAY_OPS_REDUCE(op, var) _Pragma(ARRAY_OPS_STR(omp parallel for simd reduction(op:var) if(n > PARALLEL_THRESHOLD)))
+#define ARRAY_OPS_STR(x) #x
+#else
+#define ARRAY_OPS_LOOP
+#define ARRAY_OPS_REDUCE(op, var)
+#endif
+
+namespace rbasic {
+
+namespace ArrayOps {
+
+template<typename T>
+void add(const T* a, const T* b, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] + b[i]);
+    }
+}
+
+template<typename T>
+void subtract(const T* a, const T* b, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] - b[i]);
+    }
+}
+
+template<typename T>
+void multiply(const T* a, const T* b, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] * b[i]);
+    }
+}
+
+template<typename T>
+void divide(const T* a, const T* b, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] / b[i]);
+    }
+}
+
+template<typename T>
+void addScalar(const T* a, T s, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] + s);
+    }
+}
+
+template<typename T>
+void subtractScalar(const T* a, T s, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] - s);
+    }
+}
+
+template<typename T>
+void multiplyScalar(const T* a, T s, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] * s);
+    }
+}
+
+template<typename T>
+void divideScalar(const T* a, T s, T* out, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = static_cast<T>(a[i] / s);
+    }
+}
+
+template<typename T>
+void axpy(T alpha, const T* x, T* y, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        y[i] = static_cast<T>(y[i] + alpha * x[i]);
+    }
+}
+
+template<typename T>
+double sum(const T* a, std::size_t n) {
+    double total = 0.0;
+    ARRAY_OPS_REDUCE(+, total)
+    for (std::size_t i = 0; i < n; ++i) {
+        total += static_cast<double>(a[i]);
+    }
+    return total;
+}
+
+template<typename T>
+double dot(const T* a, const T* b, std::size_t n) {
+    double total = 0.0;
+    ARRAY_OPS_REDUCE(+, total)
+    for (std::size_t i = 0; i < n; ++i) {
+        total += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+    }
+    return total;
+}
+
+template<typename T>
+T minValue(const T* a, std::size_t n) {
+    T result = a[0];
+    ARRAY_OPS_REDUCE(min, result)
+    for (std::size_t i = 1; i < n; ++i) {
+        result = a[i] < result ? a[i] : result;
+    }
+    return result;
+}
+
+template<typename T>
+T maxValue(const T* a, std::size_t n) {
+    T result = a[0];
+    ARRAY_OPS_REDUCE(max, result)
+    for (std::size_t i = 1; i < n; ++i) {
+        result = a[i] > result ? a[i] : result;
+    }
+    return result;
+}
+
+template<typename T>
+void fill(T* out, T value, std::size_t n) {
+    ARRAY_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = value;
+    }
+}
+
+template<typename T>
+void copy(const T* src, T* dst, std::size_t n) {
+    if (n > 0) {
+        std::memmove(dst, src, n * sizeof(T));
+    }
+}
+
+template<typename T>
+void sort(T* a, std::size_t n) {
+    std::sort(a, a + n);
+}
+
+// Bytes have only 256 possible values, so a counting sort beats comparison sorting
+template<>
+void sort<uint8_t>(uint8_t* a, std::size_t n) {
+    std::size_t counts[256] = {};
+    for (std::size_t i = 0; i < n; ++i) {
+        counts[a[i]]++;
+    }
+    uint8_t* out = a;
+    for (int value = 0; value < 256; ++value) {
+        std::memset(out, value, counts[value]);
+        out += counts[value];
+    }
+}
+
+template<typename T>
+void prefixSum(const T* a, T* out, std::size_t n) {
+#ifdef _OPENMP
+    if (n > PARALLEL_THRESHOLD) {
+        // Two-pass blocked scan: each thread scans its own block, then adds
+        // the running total of all blocks before it
+        std::vector<T> blockTotals(static_cast<std::size_t>(omp_get_max_threads()) + 1, T());
+        #pragma omp parallel
+        {
+            std::size_t thread = static_cast<std::size_t>(omp_get_thread_num());
+            std::size_t threads = static_cast<std::size_t>(omp_get_num_threads());
+            std::size_t begin = n * thread / threads;
+            std::size_t end = n * (thread + 1) / threads;
+
+            T running = T();
+            for (std::size_t i = begin; i < end; ++i) {
+                running = static_cast<T>(running + a[i]);
+                out[i] = running;
+            }
+            blockTotals[thread + 1] = running;
+
+            #pragma omp barrier
+            #pragma omp single
+            for (std::size_t t = 1; t <= threads; ++t) {
+                blockTotals[t] = static_cast<T>(blockTotals[t] + blockTotals[t - 1]);
+            }
+
+            T offset = blockTotals[thread];
+            #pragma omp simd
+            for (std::size_t i = begin; i < end; ++i) {
+                out[i] = static_cast<T>(out[i] + offset);
+            }
+        }
+        return;
+    }
+#endif
+    T running = T();
+    for (std::size_t i = 0; i < n; ++i) {
+        running = static_cast<T>(running + a[i]);
+        out[i] = running;
+    }
+}
+
+template<typename T>
+bool containsZero(const T* a, std::size_t n) {
+    return std::find(a, a + n, T()) != a + n;
+}
+
+// Explicit instantiations for the typed array element types
+#define ARRAY_OPS_INSTANTIATE(T) \
+    template void add<T>(const T*, const T*, T*, std::size_t); \
+    template void subtract<T>(const T*, const T*, T*, std::size_t); \
+    template void multiply<T>(const T*, const T*, T*, std::size_t); \
+    template void divide<T>(const T*, const T*, T*, std::size_t); \
+    template void addScalar<T>(const T*, T, T*, std::size_t); \
+    template void subtractScalar<T>(const T*, T, T*, std::size_t); \
+    template void multiplyScalar<T>(const T*, T, T*, std::size_t); \
+    template void divideScalar<T>(const T*, T, T*, std::size_t); \
+    template void axpy<T>(T, const T*, T*, std::size_t); \
+    template double sum<T>(const T*, std::size_t); \
+    template double dot<T>(const T*, const T*, std::size_t); \
+    template T minValue<T>(const T*, std::size_t); \
+    template T maxValue<T>(const T*, std::size_t); \
+    template void fill<T>(T*, T, std::size_t); \
+    template void copy<T>(const T*, T*, std::size_t); \
+    template void prefixSum<T>(const T*, T*, std::size_t); \
+    template bool containsZero<T>(const T*, std::size_t);
+
+ARRAY_OPS_INSTANTIATE(uint8_t)
+ARRAY_OPS_INSTANTIATE(int)
+ARRAY_OPS_INSTANTIATE(double)
+
+template void sort<int>(int*, std::size_t);
+template void sort<double>(double*, std::size_t);
+
+#undef ARRAY_OPS_INSTANTIATE
+
+} // namespace ArrayOps
+
+} // namespace rbasic
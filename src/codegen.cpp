@@ -1,4 +1,5 @@
 #include "codegen.h"
+#include "number_format.h"
 
 namespace rbasic {
 
@@ -19,6 +20,16 @@ void CodeGenerator::write(const std::string& text) {
     output << text;
 }
 
+bool CodeGenerator::isArrayOperation(const std::string& name) const {
+    static const std::set<std::string> arrayOperations = {
+        "array_add", "array_sub", "array_mul", "array_div", "array_axpy",
+        "array_sum", "array_min", "array_max", "array_mean", "array_dot",
+        "array_fill", "array_copy", "array_slice", "array_sort", "array_prefix_sum",
+        "transform_points", "rotate_all", "normalize_all", "dot_all"
+    };
+    return arrayOperations.count(name) > 0;
+}
+
 std::string CodeGenerator::generateVariableName(const std::string& basicName) {
     return "var_" + basicName;
 }
@@ -27,6 +38,15 @@ std::string CodeGenerator::generateTempVar() {
     return "temp_" + std::to_string(tempVarCounter++);
 }
 
+std::string CodeGenerator::structLayoutName(const std::string& structName) {
+    return "struct_layout_" + structName;
+}
+
+// A per-site inline cache: each expansion of the lambda owns its own static
+std::string CodeGenerator::fieldCache() {
+    return "[]() -> rbasic::FieldCache& { static rbasic::FieldCache cache; return cache; }()";
+}
+
 std::string CodeGenerator::escapeString(const std::string& str) {
     std::string escaped;
     for (char c : str) {
@@ -47,8 +67,11 @@ std::string CodeGenerator::generate(Program& program) {
     output.clear();
     functionForwardDeclarations = "";
     functionDeclarations = "";
+    structLayouts = "";
+    structs.clear();
     tempVarCounter = 0;
     indentLevel = 0;
+    usesMemStats = false;
     
     // First pass: collect function declarations
     program.accept(*this);
@@ -59,7 +82,10 @@ std::string CodeGenerator::generate(Program& program) {
     
     generateIncludes();
     
-    // Output forward declarations first
+    // Struct layouts, then forward declarations
+    if (!structLayouts.empty()) {
+        output << structLayouts << "\n";
+    }
     output << functionForwardDeclarations;
     
     // Then output function implementations
@@ -79,7 +105,12 @@ std::string CodeGenerator::generate(Program& program) {
 
 void CodeGenerator::generateIncludes() {
     writeLine("#include \"runtime/basic_runtime.h\"");
+    if (usesMemStats || memoryReport) {
+        // Counts allocations for mem_stats(); other programs allocate uncounted
+        writeLine("#include \"heap_counter.h\"");
+    }
     writeLine("#include <iostream>");
+    writeLine("#include <limits>");
     writeLine("#include <map>");
     writeLine("#include <string>");
     writeLine("");
@@ -90,6 +121,9 @@ void CodeGenerator::generateIncludes() {
 void CodeGenerator::generateMain() {
     writeLine("int main() {");
     writeLine("    init_runtime();");
+    if (memoryReport) {
+        writeLine("    std::atexit(write_memory_report);");
+    }
     writeLine("    std::map<std::string, BasicValue> variables;");
     writeLine("    ");
     writeLine("    // Initialize boolean constants");
@@ -100,15 +134,15 @@ void CodeGenerator::generateMain() {
 
 // Visitor implementations
 void CodeGenerator::visit(LiteralExpr& node) {
-    if (std::holds_alternative<int>(node.value)) {
-        write("BasicValue(" + std::to_string(std::get<int>(node.value)) + ")");
-    } else if (std::holds_alternative<double>(node.value)) {
-        write("BasicValue(" + std::to_string(std::get<double>(node.value)) + ")");
-    } else if (std::holds_alternative<std::string>(node.value)) {
-        write("BasicValue(\"" + escapeString(std::get<std::string>(node.value)) + "\")");
-    } else if (std::holds_alternative<bool>(node.value)) {
-        write("BasicValue(" + std::string(std::get<bool>(node.value) ? "true" : "false") + ")");
-    } else if (std::holds_alternative<void*>(node.value)) {
+    if (rbasic::holds_alternative<int>(node.value)) {
+        write("BasicValue(" + std::to_string(rbasic::get<int>(node.value)) + ")");
+    } else if (rbasic::holds_alternative<double>(node.value)) {
+        write("BasicValue(" + NumberFormat::doubleLiteral(rbasic::get<double>(node.value)) + ")");
+    } else if (rbasic::holds_alternative<std::string>(node.value)) {
+        write("BasicValue(\"" + escapeString(rbasic::get<std::string>(node.value)) + "\")");
+    } else if (rbasic::holds_alternative<bool>(node.value)) {
+        write("BasicValue(" + std::string(rbasic::get<bool>(node.value) ? "true" : "false") + ")");
+    } else if (rbasic::holds_alternative<void*>(node.value)) {
         write("BasicValue(static_cast<void*>(nullptr))");
     }
 }
@@ -131,7 +165,7 @@ void CodeGenerator::visit(VariableExpr& node) {
         write("})");
     } else if (!node.member.empty()) {
         // Struct member access: struct.member
-        write("get_struct_field(std::get<BasicStruct>(variables[\"" + node.name + "\"]), \"" + node.member + "\")");
+        write("get_member(variables[\"" + node.name + "\"], \"" + node.member + "\", " + fieldCache() + ")");
     } else {
         // Regular variable access
         write("variables[\"" + node.name + "\"]");
@@ -224,12 +258,20 @@ void CodeGenerator::visit(AssignExpr& node) {
 }
 
 void CodeGenerator::visit(ComponentAssignExpr& node) {
-    // Component assignment: vector.x = value
-    // First get the variable name
+    // Member assignment: s.field = value, arr[i].field = value, v.x = value
     if (auto varExpr = dynamic_cast<VariableExpr*>(node.object.get())) {
-        write("(variables[\"" + varExpr->name + "\"] = set_vec_component(variables[\"" + varExpr->name + "\"], \"" + node.component + "\", ");
+        if (!varExpr->indices.empty()) {
+            write("set_element_member(variables[\"" + varExpr->name + "\"], std::vector<BasicValue>{");
+            for (size_t i = 0; i < varExpr->indices.size(); ++i) {
+                if (i > 0) write(", ");
+                varExpr->indices[i]->accept(*this);
+            }
+            write("}, \"" + node.component + "\", ");
+        } else {
+            write("set_member(variables[\"" + varExpr->name + "\"], \"" + node.component + "\", ");
+        }
         node.value->accept(*this);
-        write("))");
+        write(", " + fieldCache() + ")");
     } else {
         throw std::runtime_error("Component assignment only supported for variables");
     }
@@ -462,6 +504,21 @@ void CodeGenerator::visit(CallExpr& node) {
         return;
     }
     
+    if ((node.name == "wait_event" || node.name == "event_timer" || node.name == "event_watch_file") &&
+        node.arguments.size() == 1) {
+        write("basic_runtime::func_" + node.name + "(");
+        node.arguments[0]->accept(*this);
+        write(")");
+        return;
+    }
+    
+    // Process memory and the globals' value bytes
+    if (node.name == "mem_stats" && node.arguments.empty()) {
+        usesMemStats = true;
+        write("basic_runtime::func_mem_stats(variables)");
+        return;
+    }
+    
     // File I/O functions
     if (node.name == "write_text_file" && node.arguments.size() == 2) {
         write("basic_runtime::func_write_text_file(");
@@ -473,8 +530,33 @@ void CodeGenerator::visit(CallExpr& node) {
     }
     
     if (node.name == "read_text_file" && node.arguments.size() == 1) {
-        write("basic_runtime::func_read_text_file(");
+        write("basic_runtime::func_read_text_file(to_string(");
+        node.arguments[0]->accept(*this);
+        write("))");
+        return;
+    }
+    
+    if (node.name == "save_array" && node.arguments.size() == 2) {
+        write("basic_runtime::func_save_array(");
         node.arguments[0]->accept(*this);
+        write(", ");
+        node.arguments[1]->accept(*this);
+        write(")");
+        return;
+    }
+    
+    if (node.name == "load_array" && node.arguments.size() == 1) {
+        write("basic_runtime::func_load_array(");
+        node.arguments[0]->accept(*this);
+        write(")");
+        return;
+    }
+    
+    if ((node.name == "framebuffer" || node.name == "save_image") && node.arguments.size() == 2) {
+        write("basic_runtime::func_" + node.name + "(");
+        node.arguments[0]->accept(*this);
+        write(", ");
+        node.arguments[1]->accept(*this);
         write(")");
         return;
     }
@@ -589,6 +671,23 @@ void CodeGenerator::visit(CallExpr& node) {
         return;
     }
     
+    // Batched primitives, draw lists and framebuffer upload
+    static const std::map<std::string, size_t> batchedDrawArity = {
+        {"sdl_render_draw_points", 3}, {"sdl_render_fill_rects", 5}, {"sdl_draw_list_create", 0},
+        {"sdl_draw_list_destroy", 1}, {"sdl_draw_list_clear", 1}, {"sdl_draw_list_set_color", 5},
+        {"sdl_draw_list_points", 3}, {"sdl_draw_list_fill_rects", 5}, {"sdl_draw_list_replay", 2},
+        {"sdl_present_framebuffer", 2}};
+    auto batched = batchedDrawArity.find(node.name);
+    if (batched != batchedDrawArity.end() && node.arguments.size() == batched->second) {
+        write("basic_runtime::func_" + node.name + "(");
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            node.arguments[i]->accept(*this);
+            if (i < node.arguments.size() - 1) write(", ");
+        }
+        write(")");
+        return;
+    }
+    
 #ifdef SDL2_GFX_AVAILABLE
     if (node.name == "sdl_render_draw_circle" && node.arguments.size() == 4) {
         write("basic_runtime::func_sdl_render_draw_circle(");
@@ -769,6 +868,54 @@ void CodeGenerator::visit(CallExpr& node) {
         write("basic_runtime::func_sqlite_version()");
         return;
     }
+
+    // Bulk fetch
+    if (node.name == "sqlite_fetch_all" && node.arguments.size() == 1) {
+        write("basic_runtime::func_sqlite_fetch_all(");
+        node.arguments[0]->accept(*this);
+        write(")");
+        return;
+    }
+    if (node.name == "sqlite_fetch_columns" && node.arguments.size() == 2) {
+        write("basic_runtime::func_sqlite_fetch_columns(");
+        node.arguments[0]->accept(*this);
+        write(", ");
+        node.arguments[1]->accept(*this);
+        write(")");
+        return;
+    }
+
+    // Batch execution: db, sql, then one array per parameter
+    if (node.name == "sqlite_exec_batch" && node.arguments.size() >= 3) {
+        write("basic_runtime::func_sqlite_exec_batch(");
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            if (i > 0) {
+                write(", ");
+            }
+            node.arguments[i]->accept(*this);
+        }
+        write(")");
+        return;
+    }
+
+    // Asynchronous writes
+    if (node.name == "sqlite_async" && (node.arguments.size() == 3 || node.arguments.size() == 4)) {
+        write("basic_runtime::func_sqlite_async(");
+        for (size_t i = 0; i < node.arguments.size(); ++i) {
+            if (i > 0) {
+                write(", ");
+            }
+            node.arguments[i]->accept(*this);
+        }
+        write(")");
+        return;
+    }
+    if (node.name == "sqlite_flush" && node.arguments.size() == 1) {
+        write("basic_runtime::func_sqlite_flush(");
+        node.arguments[0]->accept(*this);
+        write(")");
+        return;
+    }
 #endif // SQLITE3_SUPPORT_ENABLED
     
     // String conversion functions
@@ -809,6 +956,19 @@ void CodeGenerator::visit(CallExpr& node) {
         return;
     }
 
+    if ((node.name == "instr" && (node.arguments.size() == 2 || node.arguments.size() == 3)) ||
+        ((node.name == "split" || node.name == "join") && node.arguments.size() == 2) ||
+        (node.name == "replace" && node.arguments.size() == 3) ||
+        ((node.name == "upper" || node.name == "lower" || node.name == "trim") && node.arguments.size() == 1)) {
+        write("func_" + node.name + "(");
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            if (i > 0) write(", ");
+            node.arguments[i]->accept(*this);
+        }
+        write(")");
+        return;
+    }
+
     if (node.name == "left" && node.arguments.size() == 2) {
         write("left(");
         node.arguments[0]->accept(*this);
@@ -1100,13 +1260,75 @@ void CodeGenerator::visit(CallExpr& node) {
         return;
     }
     
+    if (node.name == "terminal_read_key" && node.arguments.size() == 1) {
+        write("func_terminal_read_key(");
+        node.arguments[0]->accept(*this);
+        write(")");
+        return;
+    }
+    
     if (node.name == "terminal_show_cursor" && node.arguments.size() == 1) {
         write("func_terminal_show_cursor(");
         node.arguments[0]->accept(*this);
         write(")");
         return;
     }
+    
+    if (node.name == "terminal_begin_frame" && node.arguments.size() == 0) {
+        write("func_terminal_begin_frame()");
+        return;
+    }
+    
+    if (node.name == "terminal_put" && node.arguments.size() >= 3 && node.arguments.size() <= 5) {
+        write("func_terminal_put(");
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            if (i > 0) write(", ");
+            node.arguments[i]->accept(*this);
+        }
+        write(")");
+        return;
+    }
+    
+    if (node.name == "terminal_end_frame" && node.arguments.size() == 0) {
+        write("func_terminal_end_frame()");
+        return;
+    }
 
+    // Typed array creation from a single size
+    if ((node.name == "byte_array" || node.name == "int_array" || node.name == "double_array" ||
+         node.name == "vec3_array" || node.name == "vec4_array") &&
+        node.arguments.size() == 1) {
+        write("func_" + node.name + "(to_int(");
+        node.arguments[0]->accept(*this);
+        write("))");
+        return;
+    }
+
+    // Multidimensional byte/int/double arrays, e.g. int_array(height, width) framebuffers
+    if ((node.name == "byte_array" || node.name == "int_array" || node.name == "double_array") &&
+        node.arguments.size() > 1) {
+        write("BasicValue(" + node.name + "({");
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            if (i > 0) write(", ");
+            write("to_int(");
+            node.arguments[i]->accept(*this);
+            write(")");
+        }
+        write("}))");
+        return;
+    }
+
+    // Whole-array operations map directly onto runtime wrappers of the same name
+    if (isArrayOperation(node.name)) {
+        write("func_" + node.name + "(");
+        for (size_t i = 0; i < node.arguments.size(); i++) {
+            if (i > 0) write(", ");
+            node.arguments[i]->accept(*this);
+        }
+        write(")");
+        return;
+    }
+    
     // User-defined function calls
     write("func_" + node.name + "(variables");
     for (size_t i = 0; i < node.arguments.size(); i++) {
@@ -1117,32 +1339,26 @@ void CodeGenerator::visit(CallExpr& node) {
 }
 
 void CodeGenerator::visit(StructLiteralExpr& node) {
-    // Generate struct construction code with field initialization
-    std::string tempVar = generateTempVar();
-    
-    // Create a struct constructor call
-    write("([&]() { BasicStruct " + tempVar + " = create_struct(\"" + node.structName + "\"); ");
-    
-    // Get the struct declaration to access field names
+    // Declared structs are built directly from their shared layout, fields in declaration order
     auto structIt = structs.find(node.structName);
     if (structIt != structs.end() && structIt->second) {
-        const auto& structDecl = *structIt->second;
-        
-        // Initialize fields with provided values using actual field names
-        for (size_t i = 0; i < node.values.size() && i < structDecl.fields.size(); i++) {
-            write("set_struct_field(" + tempVar + ", \"" + structDecl.fields[i] + "\", ");
-            node.values[i]->accept(*this);
-            write("); ");
-        }
-    } else {
-        // Fallback to generic field names if struct not found
-        for (size_t i = 0; i < node.values.size(); i++) {
-            write("set_struct_field(" + tempVar + ", \"field" + std::to_string(i) + "\", ");
+        write("make_struct(" + structLayoutName(node.structName) + ", {");
+        for (size_t i = 0; i < node.values.size() && i < structIt->second->fields.size(); i++) {
+            if (i > 0) write(", ");
             node.values[i]->accept(*this);
-            write("); ");
         }
+        write("})");
+        return;
     }
     
+    // Fallback to generic field names if struct not found
+    std::string tempVar = generateTempVar();
+    write("([&]() { BasicStruct " + tempVar + " = create_struct(\"" + node.structName + "\"); ");
+    for (size_t i = 0; i < node.values.size(); i++) {
+        write("set_struct_field(" + tempVar + ", \"field" + std::to_string(i) + "\", ");
+        node.values[i]->accept(*this);
+        write("); ");
+    }
     write("return BasicValue(" + tempVar + "); })()");
 }
 
@@ -1192,10 +1408,21 @@ void CodeGenerator::visit(GLMComponentAccessExpr& node) {
 }
 
 void CodeGenerator::visit(MemberAccessExpr& node) {
-    // Generate struct member access call  
-    write("get_struct_field(");
+    // arr[i].member reads the element's field in place (a column load for struct arrays)
+    auto varExpr = dynamic_cast<VariableExpr*>(node.object.get());
+    if (varExpr && !varExpr->indices.empty()) {
+        write("get_element_member(variables[\"" + varExpr->name + "\"], std::vector<BasicValue>{");
+        for (size_t i = 0; i < varExpr->indices.size(); ++i) {
+            if (i > 0) write(", ");
+            varExpr->indices[i]->accept(*this);
+        }
+        write("}, \"" + node.member + "\", " + fieldCache() + ")");
+        return;
+    }
+    
+    write("get_member(");
     node.object->accept(*this);
-    write(", \"" + node.member + "\")");
+    write(", \"" + node.member + "\", " + fieldCache() + ")");
 }
 
 void CodeGenerator::visit(ExpressionStmt& node) {
@@ -1218,9 +1445,9 @@ void CodeGenerator::visit(VarStmt& node) {
         write(");\n");
     } else if (!node.member.empty()) {
         // Struct member assignment: struct.member = value
-        write("set_struct_field(std::get<BasicStruct>(variables[\"" + node.variable + "\"]), \"" + node.member + "\", ");
+        write("set_member(variables[\"" + node.variable + "\"], \"" + node.member + "\", ");
         node.value->accept(*this);
-        write(");\n");
+        write(", " + fieldCache() + ");\n");
     } else {
         // Regular variable assignment
         write("variables[\"" + node.variable + "\"] = ");
@@ -1442,7 +1669,17 @@ void CodeGenerator::visit(FunctionDecl& node) {
 }
 
 void CodeGenerator::visit(StructDecl& node) {
-    // Store a copy of the struct declaration for later use
+    // Store a copy of the struct declaration for later use; the first time a
+    // struct is seen its layout becomes a global shared by all instances
+    if (structs.find(node.name) == structs.end()) {
+        structLayouts += "static const rbasic::StructLayoutPtr " + structLayoutName(node.name) +
+                         " = create_struct_layout(\"" + node.name + "\", {";
+        for (size_t i = 0; i < node.fields.size(); i++) {
+            if (i > 0) structLayouts += ", ";
+            structLayouts += "\"" + node.fields[i] + "\"";
+        }
+        structLayouts += "});\n";
+    }
     structs[node.name] = std::make_unique<StructDecl>(node.name, node.fields, node.fieldTypes);
     
     // Generate struct comment for documentation
@@ -1452,8 +1689,14 @@ void CodeGenerator::visit(StructDecl& node) {
 void CodeGenerator::visit(DimStmt& node) {
     indent();
     if (!node.dimensions.empty()) {
-        // Array declaration
-        write("variables[\"" + node.variable + "\"] = BasicArray(std::vector<int>{");
+        // Array declaration; arrays of a declared struct get column storage
+        auto structIt = structs.find(node.type);
+        if (structIt != structs.end()) {
+            write("variables[\"" + node.variable + "\"] = create_struct_array(" + structLayoutName(node.type) +
+                  ", std::vector<int>{");
+        } else {
+            write("variables[\"" + node.variable + "\"] = BasicArray(std::vector<int>{");
+        }
         for (size_t i = 0; i < node.dimensions.size(); i++) {
             write("to_int(");
             node.dimensions[i]->accept(*this);
@@ -1473,6 +1716,23 @@ void CodeGenerator::visit(DimStmt& node) {
             write("variables[\"" + node.variable + "\"] = BasicValue(std::string(\"\"));\n");
         } else if (node.type == "boolean") {
             write("variables[\"" + node.variable + "\"] = BasicValue(false);\n");
+        } else if (structs.find(node.type) != structs.end()) {
+            // Declared struct: default field values in declaration order
+            write("variables[\"" + node.variable + "\"] = make_struct(" + structLayoutName(node.type) + ", {");
+            const auto& fieldTypes = structs[node.type]->fieldTypes;
+            for (size_t i = 0; i < fieldTypes.size(); i++) {
+                if (i > 0) write(", ");
+                if (fieldTypes[i] == "double") {
+                    write("BasicValue(0.0)");
+                } else if (fieldTypes[i] == "string") {
+                    write("BasicValue(std::string(\"\"))");
+                } else if (fieldTypes[i] == "boolean") {
+                    write("BasicValue(false)");
+                } else {
+                    write("BasicValue(0)");
+                }
+            }
+            write("});\n");
         } else {
             write("variables[\"" + node.variable + "\"] = BasicValue(0); // " + node.type + "\n");
         }
@@ -1536,8 +1796,8 @@ bool CodeGenerator::isParallelizable(ModernForStmt& node) {
             binaryExpr->operator_ == ">" || binaryExpr->operator_ == ">=") {
             // If condition involves literal numbers, check if iteration count is large enough
             if (auto literal = dynamic_cast<LiteralExpr*>(binaryExpr->right.get())) {
-                if (std::holds_alternative<int>(literal->value)) {
-                    int limit = std::get<int>(literal->value);
+                if (rbasic::holds_alternative<int>(literal->value)) {
+                    int limit = rbasic::get<int>(literal->value);
                     if (limit < 1000) {
                         return false; // Too few iterations for parallelism to be beneficial
                     }
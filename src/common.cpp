@@ -1,4 +1,5 @@
 #include "common.h"
+#include "number_format.h"
 #include <sstream>
 #include <cmath>
 #include <filesystem>
@@ -10,206 +11,219 @@
 namespace rbasic {
 
 std::string valueToString(const ValueType& value) {
-    if (std::holds_alternative<std::string>(value)) {
-        return std::get<std::string>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::to_string(std::get<int>(value));
-    } else if (std::holds_alternative<double>(value)) {
-        return std::to_string(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? "true" : "false";
-    } else if (std::holds_alternative<ArrayValue>(value)) {
+    if (rbasic::holds_alternative<std::string>(value)) {
+        return rbasic::get<std::string>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return NumberFormat::formatInt(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return NumberFormat::formatDouble(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? "true" : "false";
+    } else if (rbasic::holds_alternative<ArrayValue>(value)) {
         return "[Array]";  // Simple representation for now
-    } else if (std::holds_alternative<StructValue>(value)) {
-        const auto& structVal = std::get<StructValue>(value);
-        return "[" + structVal.typeName + " struct]";  // Simple representation for now
+    } else if (rbasic::holds_alternative<StructValue>(value)) {
+        const auto& structVal = rbasic::get<StructValue>(value);
+        return "[" + structVal.typeName() + " struct]";  // Simple representation for now
+    } else if (rbasic::holds_alternative<StructArrayValue>(value)) {
+        return "[" + rbasic::get<StructArrayValue>(value).typeName() + " array]";
     }
     return "";
 }
 
 bool isTruthy(const ValueType& value) {
-    if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value) != 0;
-    } else if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value) != 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        return !std::get<std::string>(value).empty();
-    } else if (std::holds_alternative<ArrayValue>(value)) {
-        return !std::get<ArrayValue>(value).elements.empty();
+    if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value) != 0;
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value) != 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        return !rbasic::get<std::string>(value).empty();
+    } else if (rbasic::holds_alternative<ArrayValue>(value)) {
+        return !rbasic::get<ArrayValue>(value).elements.empty();
+    } else if (rbasic::holds_alternative<StructArrayValue>(value)) {
+        return rbasic::get<StructArrayValue>(value).size() > 0;
     }
     return false;
 }
 
 ValueType addValues(const ValueType& left, const ValueType& right) {
     // GLM vector addition
-    if (std::holds_alternative<Vec2Value>(left) && std::holds_alternative<Vec2Value>(right)) {
-        Vec2Value leftVec = std::get<Vec2Value>(left);
-        Vec2Value rightVec = std::get<Vec2Value>(right);
+    if (rbasic::holds_alternative<Vec2Value>(left) && rbasic::holds_alternative<Vec2Value>(right)) {
+        Vec2Value leftVec = rbasic::get<Vec2Value>(left);
+        Vec2Value rightVec = rbasic::get<Vec2Value>(right);
         return Vec2Value(leftVec.data + rightVec.data);
     }
-    if (std::holds_alternative<Vec3Value>(left) && std::holds_alternative<Vec3Value>(right)) {
-        Vec3Value leftVec = std::get<Vec3Value>(left);
-        Vec3Value rightVec = std::get<Vec3Value>(right);
+    if (rbasic::holds_alternative<Vec3Value>(left) && rbasic::holds_alternative<Vec3Value>(right)) {
+        Vec3Value leftVec = rbasic::get<Vec3Value>(left);
+        Vec3Value rightVec = rbasic::get<Vec3Value>(right);
         return Vec3Value(leftVec.data + rightVec.data);
     }
-    if (std::holds_alternative<Vec4Value>(left) && std::holds_alternative<Vec4Value>(right)) {
-        Vec4Value leftVec = std::get<Vec4Value>(left);
-        Vec4Value rightVec = std::get<Vec4Value>(right);
+    if (rbasic::holds_alternative<Vec4Value>(left) && rbasic::holds_alternative<Vec4Value>(right)) {
+        Vec4Value leftVec = rbasic::get<Vec4Value>(left);
+        Vec4Value rightVec = rbasic::get<Vec4Value>(right);
         return Vec4Value(leftVec.data + rightVec.data);
     }
     
-    // String concatenation
-    if (std::holds_alternative<std::string>(left) || std::holds_alternative<std::string>(right)) {
-        return valueToString(left) + valueToString(right);
+    // String concatenation: string operands are read in place and the result
+    // is sized once
+    if (rbasic::holds_alternative<std::string>(left) || rbasic::holds_alternative<std::string>(right)) {
+        std::string leftText;
+        std::string rightText;
+        std::string_view a = rbasic::holds_alternative<std::string>(left) ? left.text()
+                                                                          : std::string_view(leftText = valueToString(left));
+        std::string_view b = rbasic::holds_alternative<std::string>(right) ? right.text()
+                                                                           : std::string_view(rightText = valueToString(right));
+        std::string result;
+        result.reserve(a.size() + b.size());
+        return std::move(result.append(a).append(b));
     }
     
     // Numeric addition
-    bool hasDouble = std::holds_alternative<double>(left) || std::holds_alternative<double>(right);
+    bool hasDouble = rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<double>(right);
     
     if (hasDouble) {
-        double leftVal = std::holds_alternative<double>(left) ? std::get<double>(left) : 
-                        std::holds_alternative<int>(left) ? static_cast<double>(std::get<int>(left)) : 0.0;
-        double rightVal = std::holds_alternative<double>(right) ? std::get<double>(right) : 
-                         std::holds_alternative<int>(right) ? static_cast<double>(std::get<int>(right)) : 0.0;
+        double leftVal = rbasic::holds_alternative<double>(left) ? rbasic::get<double>(left) : 
+                        rbasic::holds_alternative<int>(left) ? static_cast<double>(rbasic::get<int>(left)) : 0.0;
+        double rightVal = rbasic::holds_alternative<double>(right) ? rbasic::get<double>(right) : 
+                         rbasic::holds_alternative<int>(right) ? static_cast<double>(rbasic::get<int>(right)) : 0.0;
         return leftVal + rightVal;
     } else {
-        int leftVal = std::holds_alternative<int>(left) ? std::get<int>(left) : 0;
-        int rightVal = std::holds_alternative<int>(right) ? std::get<int>(right) : 0;
+        int leftVal = rbasic::holds_alternative<int>(left) ? rbasic::get<int>(left) : 0;
+        int rightVal = rbasic::holds_alternative<int>(right) ? rbasic::get<int>(right) : 0;
         return leftVal + rightVal;
     }
 }
 
 ValueType subtractValues(const ValueType& left, const ValueType& right) {
     // GLM vector subtraction
-    if (std::holds_alternative<Vec2Value>(left) && std::holds_alternative<Vec2Value>(right)) {
-        Vec2Value leftVec = std::get<Vec2Value>(left);
-        Vec2Value rightVec = std::get<Vec2Value>(right);
+    if (rbasic::holds_alternative<Vec2Value>(left) && rbasic::holds_alternative<Vec2Value>(right)) {
+        Vec2Value leftVec = rbasic::get<Vec2Value>(left);
+        Vec2Value rightVec = rbasic::get<Vec2Value>(right);
         return Vec2Value(leftVec.data - rightVec.data);
     }
-    if (std::holds_alternative<Vec3Value>(left) && std::holds_alternative<Vec3Value>(right)) {
-        Vec3Value leftVec = std::get<Vec3Value>(left);
-        Vec3Value rightVec = std::get<Vec3Value>(right);
+    if (rbasic::holds_alternative<Vec3Value>(left) && rbasic::holds_alternative<Vec3Value>(right)) {
+        Vec3Value leftVec = rbasic::get<Vec3Value>(left);
+        Vec3Value rightVec = rbasic::get<Vec3Value>(right);
         return Vec3Value(leftVec.data - rightVec.data);
     }
-    if (std::holds_alternative<Vec4Value>(left) && std::holds_alternative<Vec4Value>(right)) {
-        Vec4Value leftVec = std::get<Vec4Value>(left);
-        Vec4Value rightVec = std::get<Vec4Value>(right);
+    if (rbasic::holds_alternative<Vec4Value>(left) && rbasic::holds_alternative<Vec4Value>(right)) {
+        Vec4Value leftVec = rbasic::get<Vec4Value>(left);
+        Vec4Value rightVec = rbasic::get<Vec4Value>(right);
         return Vec4Value(leftVec.data - rightVec.data);
     }
     
-    bool hasDouble = std::holds_alternative<double>(left) || std::holds_alternative<double>(right);
+    bool hasDouble = rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<double>(right);
     
     if (hasDouble) {
-        double leftVal = std::holds_alternative<double>(left) ? std::get<double>(left) : 
-                        std::holds_alternative<int>(left) ? static_cast<double>(std::get<int>(left)) : 0.0;
-        double rightVal = std::holds_alternative<double>(right) ? std::get<double>(right) : 
-                         std::holds_alternative<int>(right) ? static_cast<double>(std::get<int>(right)) : 0.0;
+        double leftVal = rbasic::holds_alternative<double>(left) ? rbasic::get<double>(left) : 
+                        rbasic::holds_alternative<int>(left) ? static_cast<double>(rbasic::get<int>(left)) : 0.0;
+        double rightVal = rbasic::holds_alternative<double>(right) ? rbasic::get<double>(right) : 
+                         rbasic::holds_alternative<int>(right) ? static_cast<double>(rbasic::get<int>(right)) : 0.0;
         return leftVal - rightVal;
     } else {
-        int leftVal = std::holds_alternative<int>(left) ? std::get<int>(left) : 0;
-        int rightVal = std::holds_alternative<int>(right) ? std::get<int>(right) : 0;
+        int leftVal = rbasic::holds_alternative<int>(left) ? rbasic::get<int>(left) : 0;
+        int rightVal = rbasic::holds_alternative<int>(right) ? rbasic::get<int>(right) : 0;
         return leftVal - rightVal;
     }
 }
 
 ValueType multiplyValues(const ValueType& left, const ValueType& right) {
     // GLM vector-scalar multiplication
-    if (std::holds_alternative<Vec2Value>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        Vec2Value vec = std::get<Vec2Value>(left);
-        float scalar = std::holds_alternative<double>(right) ? static_cast<float>(std::get<double>(right)) : static_cast<float>(std::get<int>(right));
+    if (rbasic::holds_alternative<Vec2Value>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        Vec2Value vec = rbasic::get<Vec2Value>(left);
+        float scalar = rbasic::holds_alternative<double>(right) ? static_cast<float>(rbasic::get<double>(right)) : static_cast<float>(rbasic::get<int>(right));
         return Vec2Value(vec.data * scalar);
     }
-    if ((std::holds_alternative<double>(left) || std::holds_alternative<int>(left)) && std::holds_alternative<Vec2Value>(right)) {
-        float scalar = std::holds_alternative<double>(left) ? static_cast<float>(std::get<double>(left)) : static_cast<float>(std::get<int>(left));
-        Vec2Value vec = std::get<Vec2Value>(right);
+    if ((rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<int>(left)) && rbasic::holds_alternative<Vec2Value>(right)) {
+        float scalar = rbasic::holds_alternative<double>(left) ? static_cast<float>(rbasic::get<double>(left)) : static_cast<float>(rbasic::get<int>(left));
+        Vec2Value vec = rbasic::get<Vec2Value>(right);
         return Vec2Value(scalar * vec.data);
     }
-    if (std::holds_alternative<Vec3Value>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        Vec3Value vec = std::get<Vec3Value>(left);
-        float scalar = std::holds_alternative<double>(right) ? static_cast<float>(std::get<double>(right)) : static_cast<float>(std::get<int>(right));
+    if (rbasic::holds_alternative<Vec3Value>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        Vec3Value vec = rbasic::get<Vec3Value>(left);
+        float scalar = rbasic::holds_alternative<double>(right) ? static_cast<float>(rbasic::get<double>(right)) : static_cast<float>(rbasic::get<int>(right));
         return Vec3Value(vec.data * scalar);
     }
-    if ((std::holds_alternative<double>(left) || std::holds_alternative<int>(left)) && std::holds_alternative<Vec3Value>(right)) {
-        float scalar = std::holds_alternative<double>(left) ? static_cast<float>(std::get<double>(left)) : static_cast<float>(std::get<int>(left));
-        Vec3Value vec = std::get<Vec3Value>(right);
+    if ((rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<int>(left)) && rbasic::holds_alternative<Vec3Value>(right)) {
+        float scalar = rbasic::holds_alternative<double>(left) ? static_cast<float>(rbasic::get<double>(left)) : static_cast<float>(rbasic::get<int>(left));
+        Vec3Value vec = rbasic::get<Vec3Value>(right);
         return Vec3Value(scalar * vec.data);
     }
-    if (std::holds_alternative<Vec4Value>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        Vec4Value vec = std::get<Vec4Value>(left);
-        float scalar = std::holds_alternative<double>(right) ? static_cast<float>(std::get<double>(right)) : static_cast<float>(std::get<int>(right));
+    if (rbasic::holds_alternative<Vec4Value>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        Vec4Value vec = rbasic::get<Vec4Value>(left);
+        float scalar = rbasic::holds_alternative<double>(right) ? static_cast<float>(rbasic::get<double>(right)) : static_cast<float>(rbasic::get<int>(right));
         return Vec4Value(vec.data * scalar);
     }
-    if ((std::holds_alternative<double>(left) || std::holds_alternative<int>(left)) && std::holds_alternative<Vec4Value>(right)) {
-        float scalar = std::holds_alternative<double>(left) ? static_cast<float>(std::get<double>(left)) : static_cast<float>(std::get<int>(left));
-        Vec4Value vec = std::get<Vec4Value>(right);
+    if ((rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<int>(left)) && rbasic::holds_alternative<Vec4Value>(right)) {
+        float scalar = rbasic::holds_alternative<double>(left) ? static_cast<float>(rbasic::get<double>(left)) : static_cast<float>(rbasic::get<int>(left));
+        Vec4Value vec = rbasic::get<Vec4Value>(right);
         return Vec4Value(scalar * vec.data);
     }
     
     // GLM vector component-wise multiplication
-    if (std::holds_alternative<Vec2Value>(left) && std::holds_alternative<Vec2Value>(right)) {
-        Vec2Value leftVec = std::get<Vec2Value>(left);
-        Vec2Value rightVec = std::get<Vec2Value>(right);
+    if (rbasic::holds_alternative<Vec2Value>(left) && rbasic::holds_alternative<Vec2Value>(right)) {
+        Vec2Value leftVec = rbasic::get<Vec2Value>(left);
+        Vec2Value rightVec = rbasic::get<Vec2Value>(right);
         return Vec2Value(leftVec.data * rightVec.data);
     }
-    if (std::holds_alternative<Vec3Value>(left) && std::holds_alternative<Vec3Value>(right)) {
-        Vec3Value leftVec = std::get<Vec3Value>(left);
-        Vec3Value rightVec = std::get<Vec3Value>(right);
+    if (rbasic::holds_alternative<Vec3Value>(left) && rbasic::holds_alternative<Vec3Value>(right)) {
+        Vec3Value leftVec = rbasic::get<Vec3Value>(left);
+        Vec3Value rightVec = rbasic::get<Vec3Value>(right);
         return Vec3Value(leftVec.data * rightVec.data);
     }
-    if (std::holds_alternative<Vec4Value>(left) && std::holds_alternative<Vec4Value>(right)) {
-        Vec4Value leftVec = std::get<Vec4Value>(left);
-        Vec4Value rightVec = std::get<Vec4Value>(right);
+    if (rbasic::holds_alternative<Vec4Value>(left) && rbasic::holds_alternative<Vec4Value>(right)) {
+        Vec4Value leftVec = rbasic::get<Vec4Value>(left);
+        Vec4Value rightVec = rbasic::get<Vec4Value>(right);
         return Vec4Value(leftVec.data * rightVec.data);
     }
     
-    bool hasDouble = std::holds_alternative<double>(left) || std::holds_alternative<double>(right);
+    bool hasDouble = rbasic::holds_alternative<double>(left) || rbasic::holds_alternative<double>(right);
     
     if (hasDouble) {
-        double leftVal = std::holds_alternative<double>(left) ? std::get<double>(left) : 
-                        std::holds_alternative<int>(left) ? static_cast<double>(std::get<int>(left)) : 0.0;
-        double rightVal = std::holds_alternative<double>(right) ? std::get<double>(right) : 
-                         std::holds_alternative<int>(right) ? static_cast<double>(std::get<int>(right)) : 0.0;
+        double leftVal = rbasic::holds_alternative<double>(left) ? rbasic::get<double>(left) : 
+                        rbasic::holds_alternative<int>(left) ? static_cast<double>(rbasic::get<int>(left)) : 0.0;
+        double rightVal = rbasic::holds_alternative<double>(right) ? rbasic::get<double>(right) : 
+                         rbasic::holds_alternative<int>(right) ? static_cast<double>(rbasic::get<int>(right)) : 0.0;
         return leftVal * rightVal;
     } else {
-        int leftVal = std::holds_alternative<int>(left) ? std::get<int>(left) : 0;
-        int rightVal = std::holds_alternative<int>(right) ? std::get<int>(right) : 0;
+        int leftVal = rbasic::holds_alternative<int>(left) ? rbasic::get<int>(left) : 0;
+        int rightVal = rbasic::holds_alternative<int>(right) ? rbasic::get<int>(right) : 0;
         return leftVal * rightVal;
     }
 }
 
 ValueType divideValues(const ValueType& left, const ValueType& right) {
     // GLM vector-scalar division
-    if (std::holds_alternative<Vec2Value>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        Vec2Value vec = std::get<Vec2Value>(left);
-        float scalar = std::holds_alternative<double>(right) ? static_cast<float>(std::get<double>(right)) : static_cast<float>(std::get<int>(right));
+    if (rbasic::holds_alternative<Vec2Value>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        Vec2Value vec = rbasic::get<Vec2Value>(left);
+        float scalar = rbasic::holds_alternative<double>(right) ? static_cast<float>(rbasic::get<double>(right)) : static_cast<float>(rbasic::get<int>(right));
         if (scalar == 0.0f) {
             throw RuntimeError("Division by zero");
         }
         return Vec2Value(vec.data / scalar);
     }
-    if (std::holds_alternative<Vec3Value>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        Vec3Value vec = std::get<Vec3Value>(left);
-        float scalar = std::holds_alternative<double>(right) ? static_cast<float>(std::get<double>(right)) : static_cast<float>(std::get<int>(right));
+    if (rbasic::holds_alternative<Vec3Value>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        Vec3Value vec = rbasic::get<Vec3Value>(left);
+        float scalar = rbasic::holds_alternative<double>(right) ? static_cast<float>(rbasic::get<double>(right)) : static_cast<float>(rbasic::get<int>(right));
         if (scalar == 0.0f) {
             throw RuntimeError("Division by zero");
         }
         return Vec3Value(vec.data / scalar);
     }
-    if (std::holds_alternative<Vec4Value>(left) && (std::holds_alternative<double>(right) || std::holds_alternative<int>(right))) {
-        Vec4Value vec = std::get<Vec4Value>(left);
-        float scalar = std::holds_alternative<double>(right) ? static_cast<float>(std::get<double>(right)) : static_cast<float>(std::get<int>(right));
+    if (rbasic::holds_alternative<Vec4Value>(left) && (rbasic::holds_alternative<double>(right) || rbasic::holds_alternative<int>(right))) {
+        Vec4Value vec = rbasic::get<Vec4Value>(left);
+        float scalar = rbasic::holds_alternative<double>(right) ? static_cast<float>(rbasic::get<double>(right)) : static_cast<float>(rbasic::get<int>(right));
         if (scalar == 0.0f) {
             throw RuntimeError("Division by zero");
         }
         return Vec4Value(vec.data / scalar);
     }
     
-    double leftVal = std::holds_alternative<double>(left) ? std::get<double>(left) : 
-                    std::holds_alternative<int>(left) ? static_cast<double>(std::get<int>(left)) : 0.0;
-    double rightVal = std::holds_alternative<double>(right) ? std::get<double>(right) : 
-                     std::holds_alternative<int>(right) ? static_cast<double>(std::get<int>(right)) : 0.0;
+    double leftVal = rbasic::holds_alternative<double>(left) ? rbasic::get<double>(left) : 
+                    rbasic::holds_alternative<int>(left) ? static_cast<double>(rbasic::get<int>(left)) : 0.0;
+    double rightVal = rbasic::holds_alternative<double>(right) ? rbasic::get<double>(right) : 
+                     rbasic::holds_alternative<int>(right) ? static_cast<double>(rbasic::get<int>(right)) : 0.0;
     
     if (rightVal == 0.0) {
         throw RuntimeError("Division by zero");
@@ -220,13 +234,13 @@ ValueType divideValues(const ValueType& left, const ValueType& right) {
 
 ValueType compareValues(const ValueType& left, const ValueType& right, const std::string& op) {
     // For numeric comparison
-    if ((std::holds_alternative<int>(left) || std::holds_alternative<double>(left)) &&
-        (std::holds_alternative<int>(right) || std::holds_alternative<double>(right))) {
+    if ((rbasic::holds_alternative<int>(left) || rbasic::holds_alternative<double>(left)) &&
+        (rbasic::holds_alternative<int>(right) || rbasic::holds_alternative<double>(right))) {
         
-        double leftVal = std::holds_alternative<double>(left) ? std::get<double>(left) : 
-                        static_cast<double>(std::get<int>(left));
-        double rightVal = std::holds_alternative<double>(right) ? std::get<double>(right) : 
-                         static_cast<double>(std::get<int>(right));
+        double leftVal = rbasic::holds_alternative<double>(left) ? rbasic::get<double>(left) : 
+                        static_cast<double>(rbasic::get<int>(left));
+        double rightVal = rbasic::holds_alternative<double>(right) ? rbasic::get<double>(right) : 
+                         static_cast<double>(rbasic::get<int>(right));
         
         if (op == "==") return leftVal == rightVal;
         if (op == "!=") return leftVal != rightVal;
@@ -1,4 +1,5 @@
 #include "console_io_handler.h"
+#include "terminal.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -31,6 +32,7 @@ void ConsoleIOHandler::newline() {
 
 // Text input methods
 std::string ConsoleIOHandler::input() {
+    Terminal::stopReadingKeys();  // Its raw mode and thread would take the line
     std::string line;
     std::getline(std::cin, line);
     return line;
@@ -0,0 +1,164 @@
+#include "coverage.h"
+#include "ast.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <ostream>
+
+namespace rbasic {
+
+void Coverage::addProgram(Program& program) {
+    addStatements(program.statements);
+}
+
+void Coverage::addStatements(std::vector<std::unique_ptr<Statement>>& statements) {
+    for (auto& stmt : statements) {
+        if (stmt->coverageSlot < 0) {
+            Site site{stmt->getPosition().filename, stmt->getPosition().line, Kind::STATEMENT, ""};
+            if (dynamic_cast<IfStmt*>(stmt.get())) {
+                site.kind = Kind::BRANCH;
+            } else if (dynamic_cast<ModernForStmt*>(stmt.get()) || dynamic_cast<WhileStmt*>(stmt.get())) {
+                site.kind = Kind::LOOP;
+            } else if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                site.kind = Kind::FUNCTION;
+                site.name = func->name;
+            }
+            stmt->coverageSlot = static_cast<int>(sites_.size());
+            sites_.push_back(std::move(site));
+            counters_.emplace_back();
+        }
+
+        if (auto* ifStmt = dynamic_cast<IfStmt*>(stmt.get())) {
+            addStatements(ifStmt->thenBranch);
+            addStatements(ifStmt->elseBranch);
+        } else if (auto* forStmt = dynamic_cast<ModernForStmt*>(stmt.get())) {
+            addStatements(forStmt->body);
+        } else if (auto* whileStmt = dynamic_cast<WhileStmt*>(stmt.get())) {
+            addStatements(whileStmt->body);
+        } else if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+            addStatements(func->body);
+        }
+    }
+}
+
+void Coverage::writeLcov(std::ostream& out) const {
+    // Slots grouped by file, in line order
+    std::map<std::string, std::vector<std::size_t>> files;
+    for (std::size_t slot = 0; slot < sites_.size(); slot++) {
+        if (sites_[slot].line >= 0) {
+            files[sites_[slot].file.empty() ? "<input>" : sites_[slot].file].push_back(slot);
+        }
+    }
+
+    out << "TN:\n";
+    for (auto& [file, slots] : files) {
+        std::stable_sort(slots.begin(), slots.end(),
+                         [&](std::size_t a, std::size_t b) { return sites_[a].line < sites_[b].line; });
+        out << "SF:" << file << "\n";
+
+        int functions = 0, functionsHit = 0;
+        for (std::size_t slot : slots) {
+            if (sites_[slot].kind == Kind::FUNCTION) {
+                out << "FN:" << sites_[slot].line << "," << sites_[slot].name << "\n";
+            }
+        }
+        for (std::size_t slot : slots) {
+            if (sites_[slot].kind == Kind::FUNCTION) {
+                out << "FNDA:" << counters_[slot].calls << "," << sites_[slot].name << "\n";
+                functions++;
+                functionsHit += counters_[slot].calls > 0;
+            }
+        }
+        out << "FNF:" << functions << "\nFNH:" << functionsHit << "\n";
+
+        // Branch sites on the same line are numbered as separate blocks
+        int branches = 0, branchesHit = 0, block = 0, previousLine = -1;
+        for (std::size_t slot : slots) {
+            const Site& site = sites_[slot];
+            if (site.kind != Kind::BRANCH && site.kind != Kind::LOOP) {
+                continue;
+            }
+            block = site.line == previousLine ? block + 1 : 0;
+            previousLine = site.line;
+            const Counter& counter = counters_[slot];
+            for (int branch = 0; branch < 2; branch++) {
+                out << "BRDA:" << site.line << "," << block << "," << branch << ",";
+                if (counter.hits == 0) {
+                    out << "-\n";
+                } else {
+                    out << counter.taken[branch] << "\n";
+                }
+                branches++;
+                branchesHit += counter.taken[branch] > 0;
+            }
+        }
+        out << "BRF:" << branches << "\nBRH:" << branchesHit << "\n";
+
+        // A line's count is that of its busiest statement
+        int lines = 0, linesHit = 0;
+        for (std::size_t i = 0; i < slots.size();) {
+            int line = sites_[slots[i]].line;
+            std::uint64_t hits = 0;
+            for (; i < slots.size() && sites_[slots[i]].line == line; i++) {
+                hits = std::max(hits, counters_[slots[i]].hits);
+            }
+            out << "DA:" << line << "," << hits << "\n";
+            lines++;
+            linesHit += hits > 0;
+        }
+        out << "LF:" << lines << "\nLH:" << linesHit << "\nend_of_record\n";
+    }
+}
+
+void Coverage::writeSummary(std::ostream& out, std::size_t maxLoops) const {
+    std::map<std::pair<std::string, int>, bool> lines;
+    int branches = 0, branchesHit = 0, functions = 0, functionsHit = 0;
+    std::vector<std::size_t> loops;
+    for (std::size_t slot = 0; slot < sites_.size(); slot++) {
+        const Site& site = sites_[slot];
+        const Counter& counter = counters_[slot];
+        if (site.line < 0) {
+            continue;
+        }
+        lines[{site.file, site.line}] |= counter.hits > 0;
+        if (site.kind == Kind::BRANCH || site.kind == Kind::LOOP) {
+            branches += 2;
+            branchesHit += (counter.taken[0] > 0) + (counter.taken[1] > 0);
+        }
+        if (site.kind == Kind::LOOP && counter.hits > 0) {
+            loops.push_back(slot);
+        }
+        if (site.kind == Kind::FUNCTION) {
+            functions++;
+            functionsHit += counter.calls > 0;
+        }
+    }
+    int linesHit = 0;
+    for (const auto& entry : lines) {
+        linesHit += entry.second;
+    }
+
+    out << "=== Coverage: " << linesHit << "/" << lines.size() << " lines, " << branchesHit << "/" << branches
+        << " branches, " << functionsHit << "/" << functions << " functions ===\n";
+    if (loops.empty()) {
+        return;
+    }
+
+    std::sort(loops.begin(), loops.end(),
+              [&](std::size_t a, std::size_t b) { return counters_[a].taken[0] > counters_[b].taken[0]; });
+    if (loops.size() > maxLoops) {
+        loops.resize(maxLoops);
+    }
+    char row[128];
+    std::snprintf(row, sizeof(row), "\n%10s %12s %10s  %s\n", "entries", "iterations", "avg trips", "loop");
+    out << row;
+    for (std::size_t slot : loops) {
+        const Counter& counter = counters_[slot];
+        std::snprintf(row, sizeof(row), "%10llu %12llu %10.1f  ", static_cast<unsigned long long>(counter.hits),
+                      static_cast<unsigned long long>(counter.taken[0]),
+                      static_cast<double>(counter.taken[0]) / static_cast<double>(counter.hits));
+        out << row << (sites_[slot].file.empty() ? "<input>" : sites_[slot].file) << ":" << sites_[slot].line << "\n";
+    }
+}
+
+} // namespace rbasic
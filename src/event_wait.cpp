@@ -0,0 +1,336 @@
+#include "event_wait.h"
+#include <cstdint>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#else
+#include "terminal.h"
+#endif
+
+namespace rbasic {
+
+namespace {
+
+// Milliseconds left until deadline, rounded up so a wait never ends early
+int remainingMs(std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return left.count() > 0 ? static_cast<int>(left.count()) : 0;
+}
+
+} // anonymous namespace
+
+EventWait& EventWait::instance() {
+    static EventWait eventWait;
+    return eventWait;
+}
+
+const char* EventWait::name(Source source) {
+    switch (source) {
+        case Source::TIMEOUT: return "timeout";
+        case Source::KEY: return "key";
+        case Source::SDL: return "sdl";
+        case Source::SERIAL: return "serial";
+        case Source::TIMER: return "timer";
+        case Source::FILE: return "file";
+    }
+    return "timeout";
+}
+
+void EventWait::setExternalQueue(ExternalQueue* queue) {
+    external_ = queue;
+}
+
+#ifdef __linux__
+
+// Each epoll entry carries its source and descriptor. The cancel eventfd is
+// tagged TIMEOUT, which no real source uses.
+static uint64_t tag(int fd, EventWait::Source source) {
+    return (static_cast<uint64_t>(source) << 32) | static_cast<uint32_t>(fd);
+}
+
+EventWait::~EventWait() {
+    if (helper_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(helperMutex_);
+            helperStopping_ = true;
+        }
+        helperChanged_.notify_all();
+        uint64_t one = 1;
+        (void)::write(cancelFd_, &one, sizeof(one));
+        helper_.join();
+    }
+    for (int fd : {timerFd_, inotifyFd_, cancelFd_, epollFd_}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+bool EventWait::open() {
+    if (epollFd_ >= 0) {
+        return true;
+    }
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    cancelFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || cancelFd_ < 0 || !add(cancelFd_, Source::TIMEOUT)) {
+        return false;
+    }
+    // Fails for a regular file on stdin, which then never reports a key
+    add(keyFd_, Source::KEY);
+    return true;
+}
+
+// Terminal::readKey's reader thread takes stdin over and signals each key it
+// queues on a pipe, which is readable while keys are queued
+void EventWait::setKeySource(int fd) {
+    fd = fd < 0 ? STDIN_FILENO : fd;
+    if (fd == keyFd_) {
+        return;
+    }
+    if (epollFd_ >= 0) {
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, keyFd_, nullptr);
+        add(fd, Source::KEY);
+    }
+    keyFd_ = fd;
+}
+
+bool EventWait::add(int fd, Source source) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = tag(fd, source);
+    return ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) == 0 || errno == EEXIST;
+}
+
+bool EventWait::ready(int timeoutMs, Source& source) {
+    epoll_event events[8];
+    int count = ::epoll_wait(epollFd_, events, 8, timeoutMs);
+    for (int i = 0; i < count; i++) {
+        int fd = static_cast<int>(events[i].data.u64 & 0xffffffffu);
+        source = static_cast<Source>(events[i].data.u64 >> 32);
+        switch (source) {
+            case Source::TIMEOUT:
+                continue;
+            case Source::KEY: {
+                // Readable (or hung up) with nothing left to read is end of
+                // input; stop watching it
+                int available = 0;
+                if (::ioctl(fd, FIONREAD, &available) != 0 || available == 0) {
+                    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+                    continue;
+                }
+                return true;
+            }
+            case Source::TIMER: {
+                uint64_t ticks;
+                (void)::read(fd, &ticks, sizeof(ticks));
+                return true;
+            }
+            case Source::FILE: {
+                alignas(inotify_event) char buffer[4096];
+                while (::read(fd, buffer, sizeof(buffer)) > 0) {
+                }
+                return true;
+            }
+            default:
+                return true;
+        }
+    }
+    return false;
+}
+
+EventWait::Source EventWait::wait(int timeoutMs) {
+    if (!open()) {
+        throw std::runtime_error("wait_event: cannot create epoll instance");
+    }
+    if (external_) {
+        return waitExternal(timeoutMs);
+    }
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        Source source;
+        if (ready(timeoutMs < 0 ? -1 : remainingMs(deadline), source)) {
+            return source;
+        }
+        if (timeoutMs >= 0 && Clock::now() >= deadline) {
+            return Source::TIMEOUT;
+        }
+    }
+}
+
+// Blocks in the external queue while the helper thread watches the
+// descriptors and wakes the queue if one becomes ready first
+EventWait::Source EventWait::waitExternal(int timeoutMs) {
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        Source source;
+        if (ready(0, source)) {
+            return source;
+        }
+        if (external_->pending()) {
+            return Source::SDL;
+        }
+        int remaining = timeoutMs < 0 ? -1 : remainingMs(deadline);
+        if (remaining == 0) {
+            return Source::TIMEOUT;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(helperMutex_);
+            helperArmed_ = true;
+            if (!helper_.joinable()) {
+                helper_ = std::thread([this] { helperLoop(); });
+            }
+        }
+        helperChanged_.notify_all();
+        external_->wait(remaining);
+
+        // Stop the helper before the descriptors are looked at again here
+        {
+            std::unique_lock<std::mutex> lock(helperMutex_);
+            if (helperArmed_) {
+                uint64_t one = 1;
+                (void)::write(cancelFd_, &one, sizeof(one));
+            }
+            helperChanged_.wait(lock, [this] { return !helperArmed_; });
+        }
+        uint64_t cancels;
+        (void)::read(cancelFd_, &cancels, sizeof(cancels));
+        external_->clearWakes();
+    }
+}
+
+void EventWait::helperLoop() {
+    std::unique_lock<std::mutex> lock(helperMutex_);
+    for (;;) {
+        helperChanged_.wait(lock, [this] { return helperArmed_ || helperStopping_; });
+        if (helperStopping_) {
+            return;
+        }
+        lock.unlock();
+        epoll_event events[8];
+        int count = ::epoll_wait(epollFd_, events, 8, -1);
+        int error = errno;
+        bool cancelled = false;
+        for (int i = 0; i < count; i++) {
+            cancelled = cancelled || static_cast<Source>(events[i].data.u64 >> 32) == Source::TIMEOUT;
+        }
+        if (count > 0 && !cancelled) {
+            external_->wake();
+        }
+        lock.lock();
+        if (count < 0 && error == EINTR) {
+            continue;
+        }
+        helperArmed_ = false;
+        helperChanged_.notify_all();
+    }
+}
+
+bool EventWait::setTimer(int intervalMs) {
+    if (intervalMs < 0 || !open()) {
+        return false;
+    }
+    if (timerFd_ < 0) {
+        timerFd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timerFd_ < 0 || !add(timerFd_, Source::TIMER)) {
+            return false;
+        }
+    }
+    itimerspec spec{};
+    spec.it_interval.tv_sec = intervalMs / 1000;
+    spec.it_interval.tv_nsec = static_cast<long>(intervalMs % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;  // All zero stops the timer
+    return ::timerfd_settime(timerFd_, 0, &spec, nullptr) == 0;
+}
+
+bool EventWait::watchFile(const std::string& path) {
+    if (!open()) {
+        return false;
+    }
+    if (inotifyFd_ < 0) {
+        inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd_ < 0 || !add(inotifyFd_, Source::FILE)) {
+            return false;
+        }
+    }
+    return ::inotify_add_watch(inotifyFd_, path.c_str(),
+                               IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF) >= 0;
+}
+
+bool EventWait::watchDescriptor(int fd) {
+    return fd >= 0 && open() && add(fd, Source::SERIAL);
+}
+
+#else
+
+EventWait::~EventWait() = default;
+
+bool EventWait::ready(int, Source& source) {
+    if (Terminal::kbhit()) {
+        source = Source::KEY;
+        return true;
+    }
+    const Clock::time_point now = Clock::now();
+    if (timerInterval_ > Clock::duration::zero() && now >= nextTick_) {
+        nextTick_ += timerInterval_;
+        if (nextTick_ <= now) {
+            nextTick_ = now + timerInterval_;  // Ticks missed while busy are dropped
+        }
+        source = Source::TIMER;
+        return true;
+    }
+    return false;
+}
+
+EventWait::Source EventWait::wait(int timeoutMs) {
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        Source source;
+        if (ready(0, source)) {
+            return source;
+        }
+        if (external_ && external_->pending()) {
+            return Source::SDL;
+        }
+        if (timeoutMs >= 0 && Clock::now() >= deadline) {
+            return Source::TIMEOUT;
+        }
+        if (external_) {
+            external_->wait(1);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+bool EventWait::setTimer(int intervalMs) {
+    if (intervalMs < 0) {
+        return false;
+    }
+    timerInterval_ = std::chrono::milliseconds(intervalMs);
+    nextTick_ = Clock::now() + timerInterval_;
+    return true;
+}
+
+void EventWait::setKeySource(int) {
+    // Terminal::kbhit already reads the key reader's queue while it runs
+}
+
+bool EventWait::watchFile(const std::string&) {
+    return false;  // Needs inotify
+}
+
+bool EventWait::watchDescriptor(int) {
+    return false;
+}
+
+#endif
+
+} // namespace rbasic
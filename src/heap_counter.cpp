@@ -0,0 +1,3 @@
+// The counting allocation functions for the interpreter, the tests and the
+// benchmark harness; the runtime library leaves them out (see heap_counter.h)
+#include "heap_counter.h"
@@ -0,0 +1,139 @@
+#include "hot_reload.h"
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#endif
+
+namespace rbasic {
+
+std::vector<std::string> HotReload::takeChanged() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.store(false, std::memory_order_relaxed);
+    std::vector<std::string> changed(changed_.begin(), changed_.end());
+    changed_.clear();
+    return changed;
+}
+
+#ifdef __linux__
+
+HotReload::HotReload() {
+    inotifyFd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopFd_ = ::eventfd(0, EFD_CLOEXEC);
+    if (inotifyFd_ < 0 || stopFd_ < 0) {
+        for (int fd : {inotifyFd_, stopFd_}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        throw std::runtime_error("--watch: cannot create inotify instance");
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+HotReload::~HotReload() {
+    uint64_t one = 1;
+    (void)::write(stopFd_, &one, sizeof(one));
+    thread_.join();
+    ::close(inotifyFd_);
+    ::close(stopFd_);
+}
+
+void HotReload::watch(const std::string& path) {
+    const std::filesystem::path absolute = std::filesystem::absolute(path).lexically_normal();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!files_.emplace(absolute.string(), path).second) {
+        return;
+    }
+    // Written in place, or written elsewhere and renamed over it
+    const std::string directory = absolute.parent_path().string();
+    int wd = ::inotify_add_watch(inotifyFd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd >= 0) {
+        directories_[wd] = directory;
+    }
+}
+
+void HotReload::run() {
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {stopFd_, POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+        ssize_t size = ::read(inotifyFd_, buffer, sizeof(buffer));
+        if (size <= 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (char* p = buffer; p < buffer + size;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            auto directory = directories_.find(event->wd);
+            if (directory != directories_.end() && event->len > 0) {
+                auto file = files_.find((std::filesystem::path(directory->second) / event->name).string());
+                if (file != files_.end()) {
+                    changed_.insert(file->second);
+                    pending_.store(true, std::memory_order_release);
+                }
+            }
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+
+#else
+
+HotReload::HotReload() {
+    thread_ = std::thread([this] { run(); });
+}
+
+HotReload::~HotReload() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_.notify_all();
+    thread_.join();
+}
+
+void HotReload::watch(const std::string& path) {
+    const std::filesystem::path absolute = std::filesystem::absolute(path).lexically_normal();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (files_.emplace(absolute.string(), path).second) {
+        std::error_code error;
+        stamps_[absolute.string()] = std::filesystem::last_write_time(absolute, error);
+    }
+}
+
+void HotReload::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_.wait_for(lock, std::chrono::milliseconds(250), [this] { return stopping_; })) {
+        for (const auto& file : files_) {
+            std::error_code error;
+            auto stamp = std::filesystem::last_write_time(file.first, error);
+            if (!error && stamp != stamps_[file.first]) {
+                stamps_[file.first] = stamp;
+                changed_.insert(file.second);
+                pending_.store(true, std::memory_order_release);
+            }
+        }
+    }
+}
+
+#endif
+
+} // namespace rbasic
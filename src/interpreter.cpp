@@ -6,8 +6,15 @@
 #include "lexer.h"
 #include "parser.h"
 #include "math_utils.h"
+#include "array_ops.h"
+#include "string_ops.h"
+#include "number_format.h"
+#include "array_file.h"
+#include "pixel_image.h"
+#include "event_wait.h"
+#include "vec_ops.h"
+#include "swizzle.h"
 #include "../runtime/basic_runtime.h"
-#include "../include/unified_value.h"
 
 // Raspberry Pi hardware support (conditional)
 #ifdef RPI_SUPPORT_ENABLED
@@ -18,6 +25,14 @@
 #include "rpi_serial.h"
 #endif
 
+#ifdef SDL2_SUPPORT_ENABLED
+#include "../runtime/sdl2_wrapper.h"
+#endif
+
+#ifdef SQLITE3_SUPPORT_ENABLED
+#include "../runtime/sqlite3_wrapper.h"
+#endif
+
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
@@ -33,6 +48,8 @@
 #endif
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
+#include <optional>
 
 #ifdef _WIN32
 // Undefine Windows macros that conflict with std::min/std::max
@@ -46,37 +63,702 @@
 
 namespace rbasic {
 
-// Helper functions for converting between BasicValue and UnifiedValue
-UnifiedValue basicValueToUnifiedValue(const BasicValue& bv) {
-    if (std::holds_alternative<int>(bv)) {
-        return make_int(std::get<int>(bv));
-    } else if (std::holds_alternative<double>(bv)) {
-        return make_double(std::get<double>(bv));
-    } else if (std::holds_alternative<std::string>(bv)) {
-        return make_string(std::get<std::string>(bv));
-    } else if (std::holds_alternative<bool>(bv)) {
-        return make_int(std::get<bool>(bv) ? 1 : 0);
-    } else if (std::holds_alternative<void*>(bv)) {
-        return make_pointer(std::get<void*>(bv), "void");
-    }
-    return make_int(0); // fallback
-}
-
-BasicValue unifiedValueToBasicValue(const UnifiedValue& uv) {
-    if (holds_type<int>(uv)) {
-        return get_value<int>(uv);
-    } else if (holds_type<double>(uv)) {
-        return get_value<double>(uv);
-    } else if (holds_type<std::string>(uv)) {
-        return get_value<std::string>(uv);
-    } else if (holds_type<bool>(uv)) {
-        return get_value<bool>(uv);
-    } else if (holds_type<void*>(uv)) {
-        return get_value<void*>(uv);
-    }
-    return 0; // fallback
+namespace {
+
+// Helpers for the whole-array builtins
+
+// Calls fn with the concrete typed array held in value; false if value is not a typed array
+template<typename Value, typename Fn>
+bool withTypedArray(Value& value, Fn&& fn) {
+    if (auto* doubles = rbasic::get_if<DoubleArrayValue>(&value)) {
+        fn(*doubles);
+    } else if (auto* ints = rbasic::get_if<IntArrayValue>(&value)) {
+        fn(*ints);
+    } else if (auto* bytes = rbasic::get_if<ByteArrayValue>(&value)) {
+        fn(*bytes);
+    } else {
+        return false;
+    }
+    return true;
 }
 
+// Calls fn with the packed vector array held in value; false if value is not one
+template<typename Value, typename Fn>
+bool withVecArray(Value& value, Fn&& fn) {
+    if (auto* vec3s = rbasic::get_if<Vec3ArrayValue>(&value)) {
+        fn(*vec3s);
+    } else if (auto* vec4s = rbasic::get_if<Vec4ArrayValue>(&value)) {
+        fn(*vec4s);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Number of elements in an array value, or -1 if value is not an array
+int arrayLength(const ValueType& value) {
+    int length = -1;
+    auto count = [&](const auto& array) { length = static_cast<int>(array.elements.size()); };
+    if (withTypedArray(value, count) || withVecArray(value, count)) {
+        return length;
+    }
+    if (auto* structArray = rbasic::get_if<StructArrayValue>(&value)) {
+        return static_cast<int>(structArray->size());
+    }
+    if (auto* array = rbasic::get_if<ArrayValue>(&value)) {
+        if (array->dimensions.empty()) {
+            return static_cast<int>(array->elements.size());
+        }
+        length = 1;
+        for (int dim : array->dimensions) {
+            length *= dim;
+        }
+        return length;
+    }
+    return -1;
+}
+
+// Calls fn with the glm vector held in value; false if value is not a vec2/vec3/vec4
+template<typename Value, typename Fn>
+bool withVec(Value& value, Fn&& fn) {
+    if (auto* v3 = rbasic::get_if<Vec3Value>(&value)) {
+        fn(v3->data);
+    } else if (auto* v4 = rbasic::get_if<Vec4Value>(&value)) {
+        fn(v4->data);
+    } else if (auto* v2 = rbasic::get_if<Vec2Value>(&value)) {
+        fn(v2->data);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// v.x reads one lane as a number; v.xy, v.zyx and so on read a new vector
+template<glm::length_t L>
+ValueType readSwizzle(const glm::vec<L, float>& v, const Swizzle& swizzle, const std::string& name) {
+    if (!swizzle.fits(L)) {
+        throw RuntimeError("Invalid component '" + name + "' for vec" + std::to_string(L));
+    }
+    switch (swizzle.count) {
+        case 1: return static_cast<double>(v[swizzle.lanes[0]]);
+        case 2: return Vec2Value(swizzleRead<2>(v, swizzle));
+        case 3: return Vec3Value(swizzleRead<3>(v, swizzle));
+        default: return Vec4Value(swizzleRead<4>(v, swizzle));
+    }
+}
+
+// Writes lanes of v in place: a number for one lane, a vector of matching size for several
+template<glm::length_t L>
+void writeSwizzle(glm::vec<L, float>& v, const Swizzle& swizzle, const std::string& name, const ValueType& value) {
+    if (!swizzle.fits(L) || !swizzle.writable()) {
+        throw RuntimeError("Invalid component '" + name + "' for vec" + std::to_string(L));
+    }
+    bool written = false;
+    switch (swizzle.count) {
+        case 1:
+            if (rbasic::holds_alternative<double>(value) || rbasic::holds_alternative<int>(value)) {
+                v[swizzle.lanes[0]] = static_cast<float>(TypeUtils::toDouble(value));
+                written = true;
+            }
+            break;
+        case 2:
+            if (auto* v2 = rbasic::get_if<Vec2Value>(&value)) {
+                swizzleWrite(v, swizzle, v2->data);
+                written = true;
+            }
+            break;
+        case 3:
+            if (auto* v3 = rbasic::get_if<Vec3Value>(&value)) {
+                swizzleWrite(v, swizzle, v3->data);
+                written = true;
+            }
+            break;
+        default:
+            if (auto* v4 = rbasic::get_if<Vec4Value>(&value)) {
+                swizzleWrite(v, swizzle, v4->data);
+                written = true;
+            }
+            break;
+    }
+    if (!written) {
+        throw RuntimeError(swizzle.count == 1 ? "Cannot assign non-numeric value to vector component"
+                                              : "Assigning to '" + name + "' requires a vec" + std::to_string(swizzle.count));
+    }
+}
+
+// Single-vector value type of a vector array's elements
+template<typename Array>
+using VecElementValue = std::conditional_t<std::is_same_v<Array, Vec3ArrayValue>, Vec3Value, Vec4Value>;
+
+template<typename Array>
+constexpr int vecArrayLanes() {
+    return std::is_same_v<Array, Vec3ArrayValue> ? 3 : 4;
+}
+
+// Row-major flat index into a vector array, bounds checked
+template<typename Array>
+size_t vecArrayIndex(const Array& array, const std::vector<int>& indices) {
+    size_t index = 0;
+    if (array.dimensions.size() != indices.size()) {
+        throw RuntimeError("vec" + std::to_string(vecArrayLanes<Array>()) + "_array expects " +
+                           std::to_string(array.dimensions.size()) + " indices");
+    }
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] < 0 || indices[i] >= array.dimensions[i]) {
+            throw RuntimeError("Array index out of bounds: " + std::to_string(indices[i]));
+        }
+        index = index * static_cast<size_t>(array.dimensions[i]) + static_cast<size_t>(indices[i]);
+    }
+    return index;
+}
+
+template<typename Array>
+void setVecArrayElement(Array& array, const std::vector<int>& indices, const ValueType& value) {
+    auto* vec = rbasic::get_if<VecElementValue<Array>>(&value);
+    if (!vec) {
+        const std::string lanes = std::to_string(vecArrayLanes<Array>());
+        throw RuntimeError("vec" + lanes + "_array elements must be vec" + lanes + " values");
+    }
+    array.elements[vecArrayIndex(array, indices)] = vec->data;
+}
+
+// Converts a BASIC number to an array's element type
+template<typename T>
+T typedArrayScalar(const ValueType& value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return TypeUtils::toDouble(value);
+    } else {
+        return static_cast<T>(TypeUtils::toInt(value));
+    }
+}
+
+// Results from double arrays stay double; int and byte arrays give ints
+template<typename T, typename R>
+ValueType typedArrayResult(R value) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<double>(value);
+    } else {
+        return static_cast<int>(value);
+    }
+}
+
+// Name of the variable if expr is a bare variable reference (no index or member)
+const std::string* plainVariableName(Expression& expr) {
+    auto* var = dynamic_cast<VariableExpr*>(&expr);
+    if (var && var->indices.empty() && var->member.empty()) {
+        return &var->name;
+    }
+    return nullptr;
+}
+
+// Typed user input: numbers become int or double, anything else stays a string
+ValueType numberOrString(const std::string& text) {
+    int intValue = 0;
+    double doubleValue = 0.0;
+    switch (NumberFormat::parseNumber(text, intValue, doubleValue)) {
+        case NumberFormat::NumberKind::INT: return intValue;
+        case NumberFormat::NumberKind::DOUBLE: return doubleValue;
+        default: return text;
+    }
+}
+
+// Helpers for the string builtins
+
+// View of a string argument; non-strings are formatted into storage first
+std::string_view stringArgument(const ValueType& value, std::string& storage) {
+    if (rbasic::holds_alternative<std::string>(value)) {
+        return value.text();
+    }
+    storage = valueToString(value);
+    return storage;
+}
+
+// join(array, separator) for generic and typed arrays
+std::string joinArray(const ValueType& value, const std::string& separator) {
+    std::string result;
+    auto append = [&](size_t index, const std::string& piece) {
+        if (index > 0) {
+            result += separator;
+        }
+        result += piece;
+    };
+    
+    if (auto* array = rbasic::get_if<ArrayValue>(&value)) {
+        size_t count = 1;
+        for (int dim : array->dimensions) {
+            count *= static_cast<size_t>(std::max(0, dim));
+        }
+        if (array->dimensions.empty()) {
+            count = array->elements.empty() ? 0 : static_cast<size_t>(array->elements.rbegin()->first) + 1;
+        }
+        for (size_t i = 0; i < count; i++) {
+            auto element = array->elements.find(static_cast<int>(i));
+            if (element == array->elements.end()) {
+                append(i, "0");  // Unset elements read as 0
+            } else {
+                append(i, rbasic::visit([](const auto& v) { return valueToString(ValueType(v)); }, element->second));
+            }
+        }
+        return result;
+    }
+    
+    bool typed = withTypedArray(value, [&](const auto& typedArray) {
+        result.reserve(typedArray.elements.size() * 4);
+        for (size_t i = 0; i < typedArray.elements.size(); i++) {
+            append(i, valueToString(typedArrayResult<typename decltype(typedArray.elements)::value_type>(typedArray.elements[i])));
+        }
+    });
+    if (!typed) {
+        throw RuntimeError("join requires an array");
+    }
+    return result;
+}
+
+// Helpers for save_array/load_array
+
+using StructField = std::variant<int, double, std::string, bool>;
+using ArrayElement = std::variant<int, double, std::string, bool, StructValue>;
+
+void putStruct(ArrayFile::RecordWriter& out, const StructValue& value) {
+    out.putTag(ArrayFile::ValueTag::STRUCT);
+    out.putString(value.typeName());
+    out.putCount(static_cast<uint32_t>(value.fields.size()));
+    for (size_t i = 0; i < value.fields.size(); i++) {
+        out.putString(value.layout->fieldNames[i]);
+        ArrayFile::putScalar(out, value.fields[i]);
+    }
+}
+
+void putElement(ArrayFile::RecordWriter& out, const ArrayElement& element) {
+    rbasic::visit([&](const auto& value) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(value)>, StructValue>) {
+            putStruct(out, value);
+        } else {
+            ArrayFile::putScalar(out, value);
+        }
+    }, element);
+}
+
+// Reads the body of a struct whose STRUCT tag has already been consumed.
+// Structs of the same shape within one file share a single layout.
+StructValue getStruct(ArrayFile::RecordReader& in, std::vector<StructLayoutPtr>& layouts) {
+    std::string typeName = in.getString();
+    uint32_t fieldCount = in.getCount();
+    std::vector<std::string> names;
+    std::vector<StructField> fields;
+    for (uint32_t i = 0; i < fieldCount; i++) {
+        names.push_back(in.getString());
+        fields.push_back(ArrayFile::getScalar(in, in.getTag()));
+    }
+    
+    auto layout = std::find_if(layouts.begin(), layouts.end(), [&](const StructLayoutPtr& candidate) {
+        return candidate->typeName == typeName && candidate->fieldNames == names;
+    });
+    if (layout == layouts.end()) {
+        layout = layouts.insert(layouts.end(), makeStructLayout(typeName, std::move(names)));
+    }
+    StructValue value(*layout);
+    value.fields = std::move(fields);
+    return value;
+}
+
+ArrayElement getElement(ArrayFile::RecordReader& in, std::vector<StructLayoutPtr>& layouts) {
+    ArrayFile::ValueTag tag = in.getTag();
+    if (tag == ArrayFile::ValueTag::STRUCT) {
+        return getStruct(in, layouts);
+    }
+    return rbasic::visit([](auto&& scalar) { return ArrayElement(std::move(scalar)); }, ArrayFile::getScalar(in, tag));
+}
+
+bool saveArrayFile(const std::string& filename, const ValueType& value) {
+    ArrayFile::Header header;
+    bool written = false;
+    bool typed = withTypedArray(value, [&](const auto& array) {
+        using Element = typename std::decay_t<decltype(array.elements)>::value_type;
+        header.type = ArrayFile::typedElementType<Element>();
+        header.dimensions = array.dimensions;
+        header.count = array.elements.size();
+        written = ArrayFile::write(filename, header, array.elements.data(), array.elements.size() * sizeof(Element));
+    });
+    if (typed) {
+        return written;
+    }
+    bool vectors = withVecArray(value, [&](const auto& array) {
+        using Vec = typename std::decay_t<decltype(array.elements)>::value_type;
+        header.type = ArrayFile::vectorElementType<Vec>();
+        header.dimensions = array.dimensions;
+        header.count = array.elements.size();
+        written = ArrayFile::write(filename, header, array.elements.data(), array.elements.size() * sizeof(Vec));
+    });
+    if (vectors) {
+        return written;
+    }
+    
+    ArrayFile::RecordWriter records;
+    if (auto* structArray = rbasic::get_if<StructArrayValue>(&value)) {
+        header.type = ArrayFile::ElementType::STRUCT_ARRAY;
+        header.dimensions = structArray->dimensions;
+        header.count = structArray->size();
+        ArrayFile::putStructArray(records, *structArray);
+    } else if (auto* array = rbasic::get_if<ArrayValue>(&value)) {
+        header.type = ArrayFile::ElementType::GENERIC;
+        header.dimensions = array->dimensions;
+        header.count = array->elements.size();
+        for (const auto& [index, element] : array->elements) {
+            records.putInt(index);
+            putElement(records, element);
+        }
+    } else if (auto* structValue = rbasic::get_if<StructValue>(&value)) {
+        header.type = ArrayFile::ElementType::STRUCT;
+        header.count = 1;
+        putStruct(records, *structValue);
+    } else {
+        throw RuntimeError("save_array requires an array or struct");
+    }
+    return ArrayFile::write(filename, header, records.bytes().data(), records.bytes().size());
+}
+
+ValueType loadArrayFile(const std::string& filename) {
+    ArrayFile::MappedFile file(filename);
+    if (!file.isOpen()) {
+        throw RuntimeError("load_array: cannot open file '" + filename + "'");
+    }
+    
+    try {
+        ArrayFile::Header header;
+        const uint8_t* payload = nullptr;
+        size_t payloadBytes = 0;
+        bool swapBytes = false;
+        ArrayFile::readHeader(file, header, payload, payloadBytes, swapBytes);
+        
+        switch (header.type) {
+            case ArrayFile::ElementType::BYTE: {
+                ByteArrayValue array;
+                array.dimensions = header.dimensions;
+                ArrayFile::readElements(array.elements, payload, payloadBytes, header.count, swapBytes);
+                return array;
+            }
+            case ArrayFile::ElementType::INT32: {
+                IntArrayValue array;
+                array.dimensions = header.dimensions;
+                ArrayFile::readElements(array.elements, payload, payloadBytes, header.count, swapBytes);
+                return array;
+            }
+            case ArrayFile::ElementType::DOUBLE: {
+                DoubleArrayValue array;
+                array.dimensions = header.dimensions;
+                ArrayFile::readElements(array.elements, payload, payloadBytes, header.count, swapBytes);
+                return array;
+            }
+            case ArrayFile::ElementType::GENERIC: {
+                ArrayValue array(header.dimensions);
+                ArrayFile::RecordReader in(payload, payloadBytes, swapBytes);
+                std::vector<StructLayoutPtr> layouts;
+                for (uint64_t i = 0; i < header.count; i++) {
+                    int index = in.getInt();
+                    array.elements[index] = getElement(in, layouts);
+                }
+                return array;
+            }
+            case ArrayFile::ElementType::STRUCT: {
+                ArrayFile::RecordReader in(payload, payloadBytes, swapBytes);
+                if (in.getTag() != ArrayFile::ValueTag::STRUCT) {
+                    throw std::runtime_error("corrupt struct record");
+                }
+                std::vector<StructLayoutPtr> layouts;
+                return getStruct(in, layouts);
+            }
+            case ArrayFile::ElementType::STRUCT_ARRAY: {
+                StructArrayValue array;
+                ArrayFile::RecordReader in(payload, payloadBytes, swapBytes);
+                ArrayFile::getStructArray(in, header, array);
+                return array;
+            }
+            case ArrayFile::ElementType::VEC3: {
+                Vec3ArrayValue array;
+                array.dimensions = header.dimensions;
+                ArrayFile::readVectors(array.elements, payload, payloadBytes, header.count, swapBytes);
+                return array;
+            }
+            case ArrayFile::ElementType::VEC4: {
+                Vec4ArrayValue array;
+                array.dimensions = header.dimensions;
+                ArrayFile::readVectors(array.elements, payload, payloadBytes, header.count, swapBytes);
+                return array;
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        throw RuntimeError("load_array: " + std::string(e.what()) + " in '" + filename + "'");
+    }
+    throw RuntimeError("load_array: unknown element type in '" + filename + "'");
+}
+
+// The pixels of a framebuffer argument (see pixel_image.h), read in place
+PixelImage::View framebufferView(const std::string& name, const ValueType& image) {
+    try {
+        if (auto* bytes = rbasic::get_if<ByteArrayValue>(&image)) {
+            return PixelImage::byteView(bytes->elements, bytes->dimensions);
+        }
+        if (auto* ints = rbasic::get_if<IntArrayValue>(&image)) {
+            return PixelImage::intView(ints->elements, ints->dimensions);
+        }
+    } catch (const std::runtime_error& e) {
+        throw RuntimeError(name + ": " + e.what());
+    }
+    throw RuntimeError(name + " requires a byte_array or int_array framebuffer");
+}
+
+// Helpers for struct arrays (one column per field)
+
+ValueType fieldToValue(const StructColumn::Field& field) {
+    return rbasic::visit([](const auto& value) { return ValueType(value); }, field);
+}
+
+StructColumn::Field valueToField(const ValueType& value) {
+    if (auto* i = rbasic::get_if<int>(&value)) return *i;
+    if (auto* d = rbasic::get_if<double>(&value)) return *d;
+    if (rbasic::holds_alternative<std::string>(value)) return std::string(value.text());
+    if (auto* b = rbasic::get_if<bool>(&value)) return *b;
+    throw RuntimeError("Unsupported value type for struct field");
+}
+
+size_t structArrayIndex(const StructArrayValue& array, const std::vector<int>& indices) {
+    try {
+        return array.flatIndex(indices);
+    } catch (const std::out_of_range& e) {
+        throw RuntimeError(std::string(e.what()) + " for array of " + array.typeName());
+    }
+}
+
+// Field index through an access site's inline cache; throws for an unknown field
+int cachedFieldIndex(FieldCache& cache, const StructLayoutPtr& layout, const std::string& field) {
+    int index = cache.lookup(layout, field);
+    if (index < 0) {
+        throw RuntimeError("Struct member '" + field + "' not found");
+    }
+    return index;
+}
+
+// Struct is StructValue or const StructValue, so reads leave a shared value shared
+template<typename Struct>
+auto& cachedField(Struct& value, FieldCache& cache, const std::string& field) {
+    return value.fields[cachedFieldIndex(cache, value.layout, field)];
+}
+
+template<typename Array>
+auto& structArrayColumn(Array& array, const std::string& field) {
+    int index = array.fieldIndex(field);
+    if (index < 0) {
+        throw RuntimeError("Struct member '" + field + "' not found");
+    }
+    return array.columns[index];
+}
+
+// arr[i] as a whole struct value
+StructValue structArrayElement(const StructArrayValue& array, size_t index) {
+    StructValue value(array.layout);
+    for (size_t f = 0; f < array.columns.size(); f++) {
+        value.fields[f] = array.columns[f].get(index);
+    }
+    return value;
+}
+
+// arr[i] = struct value: scatter the fields into their columns
+void setStructArrayElement(StructArrayValue& array, size_t index, const ValueType& value) {
+    auto* structValue = rbasic::get_if<StructValue>(&value);
+    if (!structValue || structValue->typeName() != array.typeName()) {
+        throw RuntimeError("Array of " + array.typeName() + " can only hold " + array.typeName() + " values");
+    }
+    if (structValue->layout == array.layout) {
+        for (size_t f = 0; f < array.columns.size(); f++) {
+            array.columns[f].set(index, structValue->fields[f]);
+        }
+        return;
+    }
+    // Same type name but a different layout (e.g. loaded from a file)
+    for (size_t f = 0; f < array.columns.size(); f++) {
+        if (const StructField* field = structValue->field(array.layout->fieldNames[f])) {
+            array.columns[f].set(index, *field);
+        }
+    }
+}
+
+// arr.field: a copy of the whole column, typed when the column is numeric
+ValueType structArrayColumnValue(const StructArrayValue& array, const std::string& field) {
+    const StructColumn& column = structArrayColumn(array, field);
+    switch (column.kind()) {
+        case StructColumn::Kind::INT: {
+            IntArrayValue result;
+            result.dimensions = array.dimensions;
+            result.elements = column.ints();
+            return result;
+        }
+        case StructColumn::Kind::DOUBLE: {
+            DoubleArrayValue result;
+            result.dimensions = array.dimensions;
+            result.elements = column.doubles();
+            return result;
+        }
+        default: {
+            ArrayValue result(array.dimensions);
+            for (size_t i = 0; i < column.size(); i++) {
+                rbasic::visit([&](const auto& v) { result.elements[static_cast<int>(i)] = v; }, column.get(i));
+            }
+            return result;
+        }
+    }
+}
+
+// arr.field = typed array: replace the whole column
+void setStructArrayColumn(StructArrayValue& array, const std::string& field, const ValueType& value) {
+    StructColumn& column = structArrayColumn(array, field);
+    bool typed = withTypedArray(value, [&](const auto& source) {
+        if (source.elements.size() != column.size()) {
+            throw RuntimeError("Column assignment needs " + std::to_string(column.size()) + " elements, got " +
+                               std::to_string(source.elements.size()));
+        }
+        using Element = typename std::decay_t<decltype(source.elements)>::value_type;
+        if constexpr (std::is_same_v<Element, double>) {
+            column.assign(source.elements);
+        } else {
+            column.assign(std::vector<int>(source.elements.begin(), source.elements.end()));
+        }
+    });
+    if (!typed) {
+        throw RuntimeError("Assigning to " + array.typeName() + " array member '" + field + "' requires a typed array");
+    }
+}
+
+// Memory statistics (mem_stats(), --mem-report)
+
+// Rough per-element cost of a std::map node beyond the key/value pair
+constexpr size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+
+size_t structHeapBytes(const StructValue& value) {
+    size_t bytes = heapBytes(value.fields);
+    for (const auto& field : value.fields) {
+        if (auto* text = rbasic::get_if<std::string>(&field)) {
+            bytes += heapBytes(*text);
+        }
+    }
+    return bytes;
+}
+
+size_t arrayHeapBytes(const ArrayValue& array) {
+    size_t bytes = heapBytes(array.dimensions);
+    for (const auto& element : array.elements) {
+        bytes += sizeof(element) + MAP_NODE_OVERHEAD;
+        if (auto* text = rbasic::get_if<std::string>(&element.second)) {
+            bytes += heapBytes(*text);
+        } else if (auto* instance = rbasic::get_if<StructValue>(&element.second)) {
+            bytes += structHeapBytes(*instance);
+        }
+    }
+    return bytes;
+}
+
+void addLiveValue(const ValueType& value, LiveValueBytes& bytes) {
+    bytes.variables++;
+    // A value shared by several variables is counted for each of them
+    const size_t self = sizeof(ValueType) + value.boxBytes();
+    if (rbasic::holds_alternative<std::string>(value)) {
+        const std::string* boxed = value.boxedString();
+        bytes.strings += self + (boxed ? heapBytes(*boxed) : 0);
+        return;
+    }
+    rbasic::visit([&](const auto& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, ArrayValue>) {
+            bytes.arrays += self + arrayHeapBytes(v);
+        } else if constexpr (std::is_same_v<T, StructArrayValue>) {
+            bytes.arrays += self + v.heapBytes();
+        } else if constexpr (std::is_same_v<T, ByteArrayValue> || std::is_same_v<T, IntArrayValue> ||
+                             std::is_same_v<T, DoubleArrayValue> || std::is_same_v<T, Vec3ArrayValue> ||
+                             std::is_same_v<T, Vec4ArrayValue>) {
+            bytes.arrays += self + heapBytes(v.elements) + heapBytes(v.dimensions);
+        } else if constexpr (std::is_same_v<T, StructValue>) {
+            bytes.structs += self + structHeapBytes(v);
+        } else if constexpr (std::is_same_v<T, PointerValue>) {
+            bytes.other += self + heapBytes(v.typeName);
+        } else {
+            bytes.other += self;
+        }
+    }, value);
+}
+
+size_t countStatements(const std::vector<std::unique_ptr<Statement>>& statements) {
+    size_t count = statements.size();
+    for (const auto& stmt : statements) {
+        if (auto* ifStmt = dynamic_cast<IfStmt*>(stmt.get())) {
+            count += countStatements(ifStmt->thenBranch) + countStatements(ifStmt->elseBranch);
+        } else if (auto* forStmt = dynamic_cast<ModernForStmt*>(stmt.get())) {
+            count += countStatements(forStmt->body);
+        } else if (auto* whileStmt = dynamic_cast<WhileStmt*>(stmt.get())) {
+            count += countStatements(whileStmt->body);
+        } else if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+            count += countStatements(func->body);
+        }
+    }
+    return count;
+}
+
+// Builtins that only compute a result from their arguments. Builtins are
+// dispatched before user functions, so these names always mean the builtin.
+bool isPureBuiltin(const CallExpr& call) {
+    const std::string& name = call.name;
+    const size_t argc = call.arguments.size();
+    if (argc == 1 && MathFunctionDispatcher::getInstance().hasFunction(name)) {
+        return true;
+    }
+    return ((name == "mid" || name == "instr") && (argc == 2 || argc == 3)) ||
+           ((name == "left" || name == "right") && argc == 2) ||
+           ((name == "len" || name == "str" || name == "val" ||
+             name == "upper" || name == "lower" || name == "trim") && argc == 1);
+}
+
+bool cannotAssign(const Expression& expr);
+
+bool cannotAssign(const std::vector<std::unique_ptr<Expression>>& exprs) {
+    return std::all_of(exprs.begin(), exprs.end(), [](const auto& expr) { return cannotAssign(*expr); });
+}
+
+// True if evaluating expr cannot assign to any variable
+bool cannotAssign(const Expression& expr) {
+    if (dynamic_cast<const LiteralExpr*>(&expr)) {
+        return true;
+    } else if (auto* variable = dynamic_cast<const VariableExpr*>(&expr)) {
+        return cannotAssign(variable->indices);
+    } else if (auto* binary = dynamic_cast<const BinaryExpr*>(&expr)) {
+        return cannotAssign(*binary->left) && cannotAssign(*binary->right);
+    } else if (auto* unary = dynamic_cast<const UnaryExpr*>(&expr)) {
+        return cannotAssign(*unary->operand);
+    } else if (auto* call = dynamic_cast<const CallExpr*>(&expr)) {
+        return isPureBuiltin(*call) && cannotAssign(call->arguments);
+    } else if (auto* member = dynamic_cast<const MemberAccessExpr*>(&expr)) {
+        return cannotAssign(*member->object);
+    } else if (auto* component = dynamic_cast<const GLMComponentAccessExpr*>(&expr)) {
+        return cannotAssign(*component->object);
+    } else if (auto* constructor = dynamic_cast<const GLMConstructorExpr*>(&expr)) {
+        return cannotAssign(constructor->arguments);
+    } else if (auto* literal = dynamic_cast<const StructLiteralExpr*>(&expr)) {
+        return cannotAssign(literal->values);
+    }
+    return false;
+}
+
+// Names visit(VariableExpr) resolves to constants rather than variables
+bool isConstantName(const std::string& name) {
+    return name == "NULL" || name == "null" || name == "TRUE" || name == "true" ||
+           name == "FALSE" || name == "false" || name.compare(0, 4, "SDL_") == 0 ||
+           name.compare(0, 5, "SDLK_") == 0 || name.compare(0, 7, "SQLITE_") == 0 ||
+           name.compare(0, 3, "MB_") == 0;
+}
+
+// Spare map nodes kept for reuse by scopes pushed later
+constexpr size_t MAX_SPARE_VARIABLES = 256;
+
+} // anonymous namespace
+
 Interpreter::Interpreter(std::unique_ptr<IOHandler> io) : hasReturned(false) {
     // Initialize boolean constants
     globals["true"] = true;
@@ -90,28 +772,49 @@ Interpreter::Interpreter(std::unique_ptr<IOHandler> io) : hasReturned(false) {
     }
 }
 
-void Interpreter::defineVariable(const std::string& name, const ValueType& value) {
-    if (!scopes.empty()) {
-        scopes.back()[name] = value;
+void Interpreter::defineVariable(const std::string& name, ValueType value) {
+    auto& scope = scopes.empty() ? globals : scopes.back();
+    auto found = scope.find(name);
+    if (found != scope.end()) {
+        found->second = std::move(value);
+    } else if (!spareVariables.empty()) {
+        // Reuse a node from a popped scope: function locals and parameters
+        // then cost no allocation beyond their values
+        auto node = std::move(spareVariables.back());
+        spareVariables.pop_back();
+        node.key() = name;
+        node.mapped() = std::move(value);
+        scope.insert(std::move(node));
     } else {
-        globals[name] = value;
+        scope.emplace(name, std::move(value));
     }
 }
 
 ValueType Interpreter::getVariable(const std::string& name) {
-    // Search through scope stack from top to bottom (reverse vector order)
+    if (ValueType* variable = findVariable(name)) {
+        return *variable;
+    }
+    throw RuntimeError("Undefined variable '" + name + "'", getCurrentPosition());
+}
+
+ValueType* Interpreter::findVariable(const std::string& name) {
     for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        if (it->find(name) != it->end()) {
-            return (*it)[name];
+        auto found = it->find(name);
+        if (found != it->end()) {
+            return &found->second;
         }
     }
     
-    // Check global scope
-    if (globals.find(name) != globals.end()) {
-        return globals[name];
+    auto found = globals.find(name);
+    return found != globals.end() ? &found->second : nullptr;
+}
+
+const std::vector<int>& Interpreter::evaluateIndices(std::vector<std::unique_ptr<Expression>>& indexExprs,
+                                                     std::vector<int>& indices) {
+    for (auto& indexExpr : indexExprs) {
+        indices.push_back(TypeUtils::toArrayIndex(evaluate(*indexExpr)));
     }
-    
-    throw RuntimeError("Undefined variable '" + name + "'", getCurrentPosition());
+    return indices;
 }
 
 bool Interpreter::variableExists(const std::string& name) {
@@ -130,46 +833,183 @@ bool Interpreter::variableExists(const std::string& name) {
     return false;
 }
 
-void Interpreter::setVariable(const std::string& name, const ValueType& value) {
-    // Search through scope stack from top to bottom to find existing variable
-    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-        if (it->find(name) != it->end()) {
-            (*it)[name] = value;
-            return;
-        }
+void Interpreter::setVariable(const std::string& name, ValueType value) {
+    if (ValueType* variable = findVariable(name)) {
+        *variable = std::move(value);
+    } else {
+        defineVariable(name, std::move(value));
     }
+}
+
+void Interpreter::setArrayElement(const std::string& name, std::vector<std::unique_ptr<Expression>>& indexExprs,
+                                  const ValueType& value) {
+    ScratchPool<int>::Lease indexLease(indexPool);
+    const std::vector<int>& indices = evaluateIndices(indexExprs, *indexLease);
     
-    // Check global scope
-    if (globals.find(name) != globals.end()) {
-        globals[name] = value;
+    ValueType* variable = findVariable(name);
+    if (!variable) {
+        throw RuntimeError("Undefined variable '" + name + "'", getCurrentPosition());
+    }
+    
+    if (auto* structArray = rbasic::get_if<StructArrayValue>(variable)) {
+        setStructArrayElement(*structArray, structArrayIndex(*structArray, indices), value);
+    } else if (withVecArray(*variable, [&](auto& array) { setVecArrayElement(array, indices, value); })) {
+        return;
+    } else if (auto* array = rbasic::get_if<ArrayValue>(variable)) {
+        auto& element = array->elements[array->calculateIndex(indices)];
+        
+        // Convert ValueType to simple variant for storage
+        if (rbasic::holds_alternative<int>(value)) {
+            element = rbasic::get<int>(value);
+        } else if (rbasic::holds_alternative<double>(value)) {
+            element = rbasic::get<double>(value);
+        } else if (rbasic::holds_alternative<std::string>(value)) {
+            element = rbasic::get<std::string>(value);
+        } else if (rbasic::holds_alternative<bool>(value)) {
+            element = rbasic::get<bool>(value);
+        } else if (rbasic::holds_alternative<StructValue>(value)) {
+            element = rbasic::get<StructValue>(value);
+        }
+    } else if (auto* bytes = rbasic::get_if<ByteArrayValue>(variable)) {
+        bytes->at(indices) = TypeUtils::getValue<uint8_t>(value);
+    } else if (auto* ints = rbasic::get_if<IntArrayValue>(variable)) {
+        ints->at(indices) = TypeUtils::toInt(value);
+    } else if (auto* doubles = rbasic::get_if<DoubleArrayValue>(variable)) {
+        doubles->at(indices) = TypeUtils::toDouble(value);
     } else {
-        defineVariable(name, value);
+        throw RuntimeError("Variable '" + name + "' is not an array");
     }
 }
 
 void Interpreter::pushScope() {
-    scopes.push_back(std::map<std::string, ValueType>());
+    scopes.emplace_back();
 }
 
 void Interpreter::popScope() {
-    if (!scopes.empty()) {
-        scopes.pop_back();
+    if (scopes.empty()) {
+        return;
+    }
+    auto& scope = scopes.back();
+    while (!scope.empty() && spareVariables.size() < MAX_SPARE_VARIABLES) {
+        auto node = scope.extract(scope.begin());
+        node.mapped() = 0;  // Free what the variable held now, not on reuse
+        spareVariables.push_back(std::move(node));
     }
+    scopes.pop_back();
 }
 
 void Interpreter::interpret(Program& program) {
     try {
+        std::optional<Profiler::FunctionScope> topLevel;
+        if (profiler) {
+            topLevel.emplace(*profiler, nullptr);
+        }
         program.accept(*this);
     } catch (const std::exception& e) {
         std::cerr << "Runtime error: " << e.what() << std::endl;
     }
 }
 
+void Interpreter::execute(Statement& stmt) {
+    if (hotReload && hotReload->pending()) {
+        reloadChangedFiles();
+    }
+    if (coverage && stmt.coverageSlot >= 0) {
+        coverage->counter(stmt.coverageSlot).hits++;
+    }
+    if (!profiler && !memoryTracker && !slowTrace) {
+        stmt.accept(*this);
+        return;
+    }
+    std::optional<Profiler::LineScope> timed;
+    std::optional<MemoryTracker::LineScope> counted;
+    std::optional<SlowTrace::StatementScope> traced;
+    if (profiler) {
+        timed.emplace(*profiler, stmt);
+    }
+    if (memoryTracker) {
+        counted.emplace(*memoryTracker, stmt);
+    }
+    if (slowTrace) {
+        traced.emplace(*slowTrace, stmt);
+    }
+    stmt.accept(*this);
+}
+
+LiveValueBytes Interpreter::liveValueBytes() const {
+    LiveValueBytes bytes;
+    for (const auto& entry : globals) {
+        addLiveValue(entry.second, bytes);
+    }
+    for (const auto& scope : scopes) {
+        for (const auto& entry : scope) {
+            addLiveValue(entry.second, bytes);
+        }
+    }
+    for (const auto& instance : structInstances) {
+        for (const auto& entry : instance.second) {
+            addLiveValue(entry.second, bytes);
+        }
+    }
+    return bytes;
+}
+
+std::vector<RetainedCode> Interpreter::retainedCode() const {
+    std::vector<RetainedCode> code;
+    for (const auto& entry : functions) {
+        const std::string& file = entry.second->getPosition().filename;
+        auto it = std::find_if(code.begin(), code.end(), [&](const RetainedCode& c) { return c.file == file; });
+        if (it == code.end()) {
+            it = code.insert(code.end(), RetainedCode{file});
+        }
+        it->functions++;
+        it->statements += countStatements(entry.second->body);
+    }
+    return code;
+}
+
+ValueType Interpreter::memStatsValue() const {
+    static const StructLayoutPtr layout = makeStructLayout("MemStats", {
+        "rss", "peak_rss", "allocations", "allocated_bytes", "string_bytes", "array_bytes", "struct_bytes",
+        "other_bytes", "variables", "functions", "function_statements"});
+    HeapCounts heap = heapCounts();
+    LiveValueBytes values = liveValueBytes();
+    size_t functionCount = 0, statementCount = 0;
+    for (const auto& file : retainedCode()) {
+        functionCount += file.functions;
+        statementCount += file.statements;
+    }
+
+    // Byte counts can pass INT_MAX, so they are doubles
+    StructValue stats(layout);
+    stats.fields = {static_cast<double>(currentRssBytes()), static_cast<double>(peakRssBytes()),
+                    static_cast<double>(heap.allocations), static_cast<double>(heap.bytes),
+                    static_cast<double>(values.strings), static_cast<double>(values.arrays),
+                    static_cast<double>(values.structs), static_cast<double>(values.other),
+                    static_cast<int>(values.variables), static_cast<int>(functionCount),
+                    static_cast<int>(statementCount)};
+    return stats;
+}
+
 ValueType Interpreter::evaluate(Expression& expr) {
     // Track source position for error reporting
     setCurrentPosition(expr.getPosition());
     expr.accept(*this);
-    return lastValue;
+    return std::move(lastValue);
+}
+
+const ValueType& Interpreter::evaluateOperand(Expression& expr, ValueType& scratch, bool borrow) {
+    if (borrow) {
+        auto* variable = dynamic_cast<VariableExpr*>(&expr);
+        if (variable && variable->indices.empty() && variable->member.empty() && !isConstantName(variable->name)) {
+            if (ValueType* value = findVariable(variable->name)) {
+                setCurrentPosition(expr.getPosition());
+                return *value;
+            }
+        }
+    }
+    scratch = evaluate(expr);
+    return scratch;
 }
 
 IOHandler* Interpreter::getIOHandler() const {
@@ -184,74 +1024,72 @@ void Interpreter::visit(LiteralExpr& node) {
 void Interpreter::visit(VariableExpr& node) {
     // Handle array access
     if (!node.indices.empty()) {
-        ValueType arrayVar = getVariable(node.name);
+        ScratchPool<int>::Lease indexLease(indexPool);
+        const std::vector<int>& indices = evaluateIndices(node.indices, *indexLease);
         
-        // Evaluate all indices
-        std::vector<int> indices;
-        for (auto& indexExpr : node.indices) {
-            indices.push_back(TypeUtils::toArrayIndex(evaluate(*indexExpr)));
+        // Every kind of array is read in place rather than copied, and through
+        // a const pointer so that a shared array is not unshared just to read
+        const ValueType* variable = findVariable(node.name);
+        if (!variable) {
+            throw RuntimeError("Undefined variable '" + node.name + "'", getCurrentPosition());
         }
         
-        if (std::holds_alternative<ArrayValue>(arrayVar)) {
-            ArrayValue& array = std::get<ArrayValue>(arrayVar);
-            int flatIndex = array.calculateIndex(indices);
+        if (auto* structArray = rbasic::get_if<StructArrayValue>(variable)) {
+            lastValue = structArrayElement(*structArray, structArrayIndex(*structArray, indices));
+            return;
+        }
+        
+        if (withVecArray(*variable, [&](const auto& array) {
+                using Element = VecElementValue<std::decay_t<decltype(array)>>;
+                lastValue = Element(array.elements[vecArrayIndex(array, indices)]);
+            })) {
+            return;
+        }
+        
+        if (auto* array = rbasic::get_if<ArrayValue>(variable)) {
+            auto found = array->elements.find(array->calculateIndex(indices));
             
-            if (array.elements.find(flatIndex) != array.elements.end()) {
+            if (found != array->elements.end()) {
                 // Convert from simple variant to full ValueType
-                auto& element = array.elements[flatIndex];
-                if (std::holds_alternative<int>(element)) {
-                    lastValue = std::get<int>(element);
-                } else if (std::holds_alternative<double>(element)) {
-                    lastValue = std::get<double>(element);
-                } else if (std::holds_alternative<std::string>(element)) {
-                    lastValue = std::get<std::string>(element);
-                } else if (std::holds_alternative<bool>(element)) {
-                    lastValue = std::get<bool>(element);
-                } else if (std::holds_alternative<StructValue>(element)) {
-                    lastValue = std::get<StructValue>(element);
+                auto& element = found->second;
+                if (rbasic::holds_alternative<int>(element)) {
+                    lastValue = rbasic::get<int>(element);
+                } else if (rbasic::holds_alternative<double>(element)) {
+                    lastValue = rbasic::get<double>(element);
+                } else if (rbasic::holds_alternative<std::string>(element)) {
+                    lastValue = rbasic::get<std::string>(element);
+                } else if (rbasic::holds_alternative<bool>(element)) {
+                    lastValue = rbasic::get<bool>(element);
+                } else if (rbasic::holds_alternative<StructValue>(element)) {
+                    lastValue = rbasic::get<StructValue>(element);
                 }
             } else {
                 // Return default value based on context - for now, return 0
                 lastValue = 0;
             }
-        } else if (std::holds_alternative<ByteArrayValue>(arrayVar)) {
-            ByteArrayValue& array = std::get<ByteArrayValue>(arrayVar);
-            lastValue = static_cast<int>(array.at(indices));
-        } else if (std::holds_alternative<IntArrayValue>(arrayVar)) {
-            IntArrayValue& array = std::get<IntArrayValue>(arrayVar);
-            lastValue = array.at(indices);
-        } else if (std::holds_alternative<DoubleArrayValue>(arrayVar)) {
-            DoubleArrayValue& array = std::get<DoubleArrayValue>(arrayVar);
-            lastValue = array.at(indices);
+        } else if (auto* bytes = rbasic::get_if<ByteArrayValue>(variable)) {
+            lastValue = static_cast<int>(bytes->at(indices));
+        } else if (auto* ints = rbasic::get_if<IntArrayValue>(variable)) {
+            lastValue = ints->at(indices);
+        } else if (auto* doubles = rbasic::get_if<DoubleArrayValue>(variable)) {
+            lastValue = doubles->at(indices);
         } else {
             throw RuntimeError("Variable '" + node.name + "' is not an array");
         }
         return;
     }
     
-    // Handle struct member access
+    // Handle struct member access: an indexed load from the struct in place
     if (!node.member.empty()) {
-        auto structValue = getVariable(node.name);
-        if (auto structVal = std::get_if<StructValue>(&structValue)) {
-            auto it = structVal->fields.find(node.member);
-            if (it != structVal->fields.end()) {
-                // Convert from struct field variant to ValueType
-                auto& fieldValue = it->second;
-                if (std::holds_alternative<int>(fieldValue)) {
-                    lastValue = std::get<int>(fieldValue);
-                } else if (std::holds_alternative<double>(fieldValue)) {
-                    lastValue = std::get<double>(fieldValue);
-                } else if (std::holds_alternative<std::string>(fieldValue)) {
-                    lastValue = std::get<std::string>(fieldValue);
-                } else if (std::holds_alternative<bool>(fieldValue)) {
-                    lastValue = std::get<bool>(fieldValue);
-                }
-            } else {
-                throw RuntimeError("Struct member '" + node.member + "' not found");
-            }
-        } else {
+        const ValueType* variable = findVariable(node.name);
+        if (!variable) {
+            throw RuntimeError("Undefined variable '" + node.name + "'", getCurrentPosition());
+        }
+        auto* structVal = rbasic::get_if<StructValue>(variable);
+        if (!structVal) {
             throw RuntimeError("'" + node.name + "' is not a struct");
         }
+        lastValue = fieldToValue(cachedField(*structVal, node.memberCache, node.member));
         return;
     }
     
@@ -259,8 +1097,8 @@ void Interpreter::visit(VariableExpr& node) {
     // First check if it's a predefined constant
     if (node.name == "NULL" || node.name == "null") {
         auto constant = basic_runtime::get_constant("NULL");
-        if (std::holds_alternative<void*>(constant)) {
-            lastValue = std::get<void*>(constant);
+        if (rbasic::holds_alternative<void*>(constant)) {
+            lastValue = rbasic::get<void*>(constant);
         } else {
             lastValue = static_cast<void*>(nullptr);
         }
@@ -268,8 +1106,8 @@ void Interpreter::visit(VariableExpr& node) {
     }
     if (node.name == "TRUE" || node.name == "true") {
         auto constant = basic_runtime::get_constant("TRUE");
-        if (std::holds_alternative<bool>(constant)) {
-            lastValue = std::get<bool>(constant);
+        if (rbasic::holds_alternative<bool>(constant)) {
+            lastValue = rbasic::get<bool>(constant);
         } else {
             lastValue = true;
         }
@@ -277,8 +1115,8 @@ void Interpreter::visit(VariableExpr& node) {
     }
     if (node.name == "FALSE" || node.name == "false") {
         auto constant = basic_runtime::get_constant("FALSE");
-        if (std::holds_alternative<bool>(constant)) {
-            lastValue = std::get<bool>(constant);
+        if (rbasic::holds_alternative<bool>(constant)) {
+            lastValue = rbasic::get<bool>(constant);
         } else {
             lastValue = false;
         }
@@ -289,10 +1127,10 @@ void Interpreter::visit(VariableExpr& node) {
     if (node.name.find("SDL_") == 0 || node.name.find("SDLK_") == 0 || 
         node.name.find("SQLITE_") == 0 || node.name.find("MB_") == 0) {
         auto constant = basic_runtime::get_constant(node.name);
-        if (std::holds_alternative<double>(constant)) {
-            lastValue = std::get<double>(constant);
-        } else if (std::holds_alternative<int>(constant)) {
-            lastValue = std::get<int>(constant);
+        if (rbasic::holds_alternative<double>(constant)) {
+            lastValue = rbasic::get<double>(constant);
+        } else if (rbasic::holds_alternative<int>(constant)) {
+            lastValue = rbasic::get<int>(constant);
         } else {
             lastValue = 0.0; // Default for unknown constants
         }
@@ -303,8 +1141,16 @@ void Interpreter::visit(VariableExpr& node) {
 }
 
 void Interpreter::visit(BinaryExpr& node) {
-    ValueType left = evaluate(*node.left);
-    ValueType right = evaluate(*node.right);
+    // Variable operands are read in place. The left one only when evaluating
+    // the right cannot assign, since it must still hold its value from before.
+    if (node.rightEffects == BinaryExpr::RightEffects::Unknown) {
+        node.rightEffects = cannotAssign(*node.right) ? BinaryExpr::RightEffects::None
+                                                       : BinaryExpr::RightEffects::MayAssign;
+    }
+    ValueType leftScratch, rightScratch;
+    const ValueType& left = evaluateOperand(*node.left, leftScratch,
+                                            node.rightEffects == BinaryExpr::RightEffects::None);
+    const ValueType& right = evaluateOperand(*node.right, rightScratch, true);
     
     if (node.operator_ == "+") {
         lastValue = addValues(left, right);
@@ -347,134 +1193,89 @@ void Interpreter::visit(BinaryExpr& node) {
 void Interpreter::visit(AssignExpr& node) {
     ValueType value = evaluate(*node.value);
     
-    // Handle array assignment
     if (!node.indices.empty()) {
-        ValueType arrayVar = getVariable(node.variable);
-        
-        // Evaluate all indices
-        std::vector<int> indices;
-        for (auto& indexExpr : node.indices) {
-            indices.push_back(TypeUtils::toArrayIndex(evaluate(*indexExpr)));
-        }
-        
-        if (std::holds_alternative<ArrayValue>(arrayVar)) {
-            ArrayValue array = std::get<ArrayValue>(arrayVar);
-            int flatIndex = array.calculateIndex(indices);
-            
-            // Convert ValueType to simple variant for storage
-            if (std::holds_alternative<int>(value)) {
-                array.elements[flatIndex] = std::get<int>(value);
-            } else if (std::holds_alternative<double>(value)) {
-                array.elements[flatIndex] = std::get<double>(value);
-            } else if (std::holds_alternative<std::string>(value)) {
-                array.elements[flatIndex] = std::get<std::string>(value);
-            } else if (std::holds_alternative<bool>(value)) {
-                array.elements[flatIndex] = std::get<bool>(value);
-            } else if (std::holds_alternative<StructValue>(value)) {
-                array.elements[flatIndex] = std::get<StructValue>(value);
-            }
-            
-            setVariable(node.variable, array);
-        } else if (std::holds_alternative<ByteArrayValue>(arrayVar)) {
-            ByteArrayValue array = std::get<ByteArrayValue>(arrayVar);
-            uint8_t byteValue = TypeUtils::getValue<uint8_t>(value);
-            array.at(indices) = byteValue;
-            setVariable(node.variable, array);
-        } else if (std::holds_alternative<IntArrayValue>(arrayVar)) {
-            IntArrayValue array = std::get<IntArrayValue>(arrayVar);
-            int intValue = TypeUtils::toInt(value);
-            array.at(indices) = intValue;
-            setVariable(node.variable, array);
-        } else if (std::holds_alternative<DoubleArrayValue>(arrayVar)) {
-            DoubleArrayValue array = std::get<DoubleArrayValue>(arrayVar);
-            double doubleValue = TypeUtils::toDouble(value);
-            array.at(indices) = doubleValue;
-            setVariable(node.variable, array);
-        } else {
-            throw RuntimeError("Variable '" + node.variable + "' is not an array");
-        }
+        setArrayElement(node.variable, node.indices, value);
     } else {
         // Regular variable assignment
         setVariable(node.variable, value);
     }
     
-    lastValue = value;
+    lastValue = std::move(value);
 }
 
 void Interpreter::visit(ComponentAssignExpr& node) {
     ValueType newValue = evaluate(*node.value);
     
-    // Get the variable name first, before evaluating the object
+    // Struct member writes happen in place: arr[i].field, arr.field (whole column) and s.field
     if (auto varExpr = dynamic_cast<VariableExpr*>(node.object.get())) {
-        std::string varName = varExpr->name;
-        ValueType objectValue = getVariable(varName);  // Get directly from variables map
+        ScratchPool<int>::Lease indexLease(indexPool);
+        const std::vector<int>& indices = evaluateIndices(varExpr->indices, *indexLease);
+        ValueType* target = varExpr->member.empty() ? findVariable(varExpr->name) : nullptr;
         
-        // Convert the new value to float for GLM components
-        float floatValue = 0.0f;
-        if (std::holds_alternative<double>(newValue)) {
-            floatValue = static_cast<float>(std::get<double>(newValue));
-        } else if (std::holds_alternative<int>(newValue)) {
-            floatValue = static_cast<float>(std::get<int>(newValue));
-        } else {
-            throw RuntimeError("Cannot assign non-numeric value to vector component");
+        if (auto* structArray = rbasic::get_if<StructArrayValue>(target)) {
+            if (indices.empty()) {
+                setStructArrayColumn(*structArray, node.component, newValue);
+            } else {
+                size_t index = structArrayIndex(*structArray, indices);
+                int field = cachedFieldIndex(node.fieldCache, structArray->layout, node.component);
+                structArray->columns[field].set(index, valueToField(newValue));
+            }
+            lastValue = newValue;
+            return;
         }
         
-        // Update the component based on vector type
-        if (std::holds_alternative<Vec2Value>(objectValue)) {
-            Vec2Value vec = std::get<Vec2Value>(objectValue);
-            if (node.component == "x") {
-                vec.data.x = floatValue;
-            } else if (node.component == "y") {
-                vec.data.y = floatValue;
-            } else {
-                throw RuntimeError("Invalid component '" + node.component + "' for vec2");
-            }
-            setVariable(varName, vec);
-            lastValue = static_cast<double>(floatValue);
-        } else if (std::holds_alternative<Vec3Value>(objectValue)) {
-            Vec3Value vec = std::get<Vec3Value>(objectValue);
-            if (node.component == "x") {
-                vec.data.x = floatValue;
-            } else if (node.component == "y") {
-                vec.data.y = floatValue;
-            } else if (node.component == "z") {
-                vec.data.z = floatValue;
-            } else {
-                throw RuntimeError("Invalid component '" + node.component + "' for vec3");
-            }
-            setVariable(varName, vec);
-            lastValue = static_cast<double>(floatValue);
-        } else if (std::holds_alternative<Vec4Value>(objectValue)) {
-            Vec4Value vec = std::get<Vec4Value>(objectValue);
-            if (node.component == "x") {
-                vec.data.x = floatValue;
-            } else if (node.component == "y") {
-                vec.data.y = floatValue;
-            } else if (node.component == "z") {
-                vec.data.z = floatValue;
-            } else if (node.component == "w") {
-                vec.data.w = floatValue;
-            } else {
-                throw RuntimeError("Invalid component '" + node.component + "' for vec4");
+        StructValue* structValue = nullptr;
+        if (auto* array = rbasic::get_if<ArrayValue>(target); array && !indices.empty()) {
+            auto element = array->elements.find(array->calculateIndex(indices));
+            if (element == array->elements.end() || !rbasic::holds_alternative<StructValue>(element->second)) {
+                throw RuntimeError("Array element is not a struct");
             }
-            setVariable(varName, vec);
-            lastValue = static_cast<double>(floatValue);
-        } else {
-            throw RuntimeError("Component assignment not supported for this type");
+            structValue = &rbasic::get<StructValue>(element->second);
+        } else if (indices.empty()) {
+            structValue = rbasic::get_if<StructValue>(target);
         }
-    } else {
-        throw RuntimeError("Can only assign to components of variables");
+        if (structValue) {
+            cachedField(*structValue, node.fieldCache, node.component) = valueToField(newValue);
+            lastValue = newValue;
+            return;
+        }
+        
+        // Vector lanes are written in place: v.x = 1, v.xy = vec2(...), pts[i].z = 0
+        if (node.swizzle.valid() && target) {
+            bool written = indices.empty()
+                ? withVec(*target, [&](auto& vec) { writeSwizzle(vec, node.swizzle, node.component, newValue); })
+                : withVecArray(*target, [&](auto& array) {
+                      writeSwizzle(array.elements[vecArrayIndex(array, indices)], node.swizzle, node.component, newValue);
+                  });
+            if (written) {
+                lastValue = newValue;
+                return;
+            }
+        }
+        
+        if (!target && varExpr->member.empty()) {
+            throw RuntimeError("Undefined variable '" + varExpr->name + "'", getCurrentPosition());
+        }
+        if (!indices.empty()) {
+            throw RuntimeError("Member assignment is only supported on struct and vector array elements");
+        }
+        if (target && withVec(*target, [](const auto&) {})) {
+            throw RuntimeError("Invalid component '" + node.component + "' for vector");
+        }
+        throw RuntimeError("Component assignment not supported for this type");
     }
+    
+    throw RuntimeError("Can only assign to components of variables");
 }
 
 void Interpreter::visit(UnaryExpr& node) {
     ValueType operand = evaluate(*node.operand);
     
     if (node.operator_ == "-") {
-        if (std::holds_alternative<int>(operand)) {
-            lastValue = -std::get<int>(operand);
-        } else if (std::holds_alternative<double>(operand)) {
-            lastValue = -std::get<double>(operand);
+        if (rbasic::holds_alternative<int>(operand)) {
+            lastValue = -rbasic::get<int>(operand);
+        } else if (rbasic::holds_alternative<double>(operand)) {
+            lastValue = -rbasic::get<double>(operand);
         } else {
             throw RuntimeError("Cannot negate non-numeric value");
         }
@@ -489,6 +1290,21 @@ void Interpreter::visit(CallExpr& node) {
     // Set position for error reporting
     setCurrentPosition(node.getPosition());
     
+    if (!slowTrace) {
+        dispatchCall(node);
+        return;
+    }
+    
+    // Logged after the call returns, so a user function's line names its caller's stack
+    auto start = SlowTrace::Clock::now();
+    dispatchCall(node);
+    auto elapsed = SlowTrace::Clock::now() - start;
+    if (slowTrace->isSlow(elapsed)) {
+        slowTrace->callDone(node.name, argumentSummary(node), elapsed);
+    }
+}
+
+void Interpreter::dispatchCall(CallExpr& node) {
     // Dispatch to specialized handlers
     if (handleIOFunctions(node) ||
         handleMathFunctions(node) ||
@@ -507,6 +1323,35 @@ void Interpreter::visit(CallExpr& node) {
     throw RuntimeError("Unknown function: " + node.name, getCurrentPosition());
 }
 
+std::string Interpreter::argumentSummary(CallExpr& node) {
+    // Arguments are not evaluated again, which could repeat side effects:
+    // literals and plain variables are shown by value, anything else as "..."
+    const size_t maxText = 60;
+    std::string summary;
+    for (size_t i = 0; i < node.arguments.size(); i++) {
+        if (i > 0) {
+            summary += ", ";
+        }
+        const ValueType* value = nullptr;
+        if (auto* literal = dynamic_cast<LiteralExpr*>(node.arguments[i].get())) {
+            value = &literal->value;
+        } else if (const std::string* name = plainVariableName(*node.arguments[i])) {
+            summary += *name + "=";
+            value = findVariable(*name);
+        }
+        if (!value) {
+            summary += "...";
+            continue;
+        }
+        std::string text = valueToString(*value);
+        if (text.size() > maxText) {
+            text = text.substr(0, maxText) + "...";
+        }
+        summary += rbasic::holds_alternative<std::string>(*value) ? "\"" + text + "\"" : text;
+    }
+    return summary;
+}
+
 // I/O Functions Handler
 bool Interpreter::handleIOFunctions(CallExpr& node) {
     if (node.name == "print") {
@@ -539,23 +1384,7 @@ bool Interpreter::handleIOFunctions(CallExpr& node) {
     if (node.name == "input" && node.arguments.size() == 0) {
         std::string input_text = ioHandler->input();
         
-        // Try to parse as number first
-        ValueType value;
-        try {
-            if (hasDecimalPoint(input_text)) {
-                value = std::stod(input_text);
-            } else {
-                value = std::stoi(input_text);
-            }
-        } catch (const std::invalid_argument&) {
-            // If not a number, store as string
-            value = input_text;
-        } catch (const std::out_of_range&) {
-            // Number too large, store as string
-            value = input_text;
-        }
-        
-        lastValue = value;
+        lastValue = numberOrString(input_text);
         return true;
     }
     
@@ -566,22 +1395,52 @@ bool Interpreter::handleIOFunctions(CallExpr& node) {
     
     if (node.name == "sleep" && node.arguments.size() == 1) {
         node.arguments[0]->accept(*this);
-        int ms = std::holds_alternative<int>(lastValue) ? std::get<int>(lastValue) : 
-                 static_cast<int>(std::get<double>(lastValue));
+        int ms = rbasic::holds_alternative<int>(lastValue) ? rbasic::get<int>(lastValue) : 
+                 static_cast<int>(rbasic::get<double>(lastValue));
         std::this_thread::sleep_for(std::chrono::milliseconds(ms));
         lastValue = 0;
         return true;
     }
     
+    if (node.name == "mem_stats" && node.arguments.size() == 0) {
+        lastValue = memStatsValue();
+        return true;
+    }
+    
     if (node.name == "sleep_ms" && node.arguments.size() == 1) {
         node.arguments[0]->accept(*this);
-        int ms = std::holds_alternative<int>(lastValue) ? std::get<int>(lastValue) : 
-                 static_cast<int>(std::get<double>(lastValue));
+        int ms = rbasic::holds_alternative<int>(lastValue) ? rbasic::get<int>(lastValue) : 
+                 static_cast<int>(rbasic::get<double>(lastValue));
         std::this_thread::sleep_for(std::chrono::milliseconds(ms));
         lastValue = 0;
         return true;
     }
     
+    // Blocking wait on stdin, SDL, serial ports, the event timer and watched files
+    if (node.name == "wait_event" && node.arguments.size() == 1) {
+        int timeoutMs = TypeUtils::toInt(evaluate(*node.arguments[0]));
+        try {
+            lastValue = std::string(EventWait::name(EventWait::instance().wait(timeoutMs)));
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(e.what());
+        }
+        return true;
+    }
+    
+    if (node.name == "event_timer" && node.arguments.size() == 1) {
+        lastValue = EventWait::instance().setTimer(TypeUtils::toInt(evaluate(*node.arguments[0])));
+        return true;
+    }
+    
+    if (node.name == "event_watch_file" && node.arguments.size() == 1) {
+        ValueType path = evaluate(*node.arguments[0]);
+        if (!rbasic::holds_alternative<std::string>(path)) {
+            throw RuntimeError("event_watch_file requires a filename");
+        }
+        lastValue = EventWait::instance().watchFile(rbasic::get<std::string>(path));
+        return true;
+    }
+    
     return false; // Function not handled by this dispatcher
 }
 
@@ -594,10 +1453,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
             double numArg = 0.0;
             
             // Convert argument to double
-            if (std::holds_alternative<int>(arg)) {
-                numArg = static_cast<double>(std::get<int>(arg));
-            } else if (std::holds_alternative<double>(arg)) {
-                numArg = std::get<double>(arg);
+            if (rbasic::holds_alternative<int>(arg)) {
+                numArg = static_cast<double>(rbasic::get<int>(arg));
+            } else if (rbasic::holds_alternative<double>(arg)) {
+                numArg = rbasic::get<double>(arg);
             } else {
                 throw RuntimeError(node.name + " requires a numeric argument");
             }
@@ -623,10 +1482,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
             ValueType base = evaluate(*node.arguments[0]);
             ValueType exp = evaluate(*node.arguments[1]);
             
-            double baseNum = std::holds_alternative<int>(base) ? 
-                static_cast<double>(std::get<int>(base)) : std::get<double>(base);
-            double expNum = std::holds_alternative<int>(exp) ? 
-                static_cast<double>(std::get<int>(exp)) : std::get<double>(exp);
+            double baseNum = rbasic::holds_alternative<int>(base) ? 
+                static_cast<double>(rbasic::get<int>(base)) : rbasic::get<double>(base);
+            double expNum = rbasic::holds_alternative<int>(exp) ? 
+                static_cast<double>(rbasic::get<int>(exp)) : rbasic::get<double>(exp);
                 
             lastValue = std::pow(baseNum, expNum);
             return true;
@@ -634,10 +1493,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
             ValueType y = evaluate(*node.arguments[0]);
             ValueType x = evaluate(*node.arguments[1]);
             
-            double yNum = std::holds_alternative<int>(y) ? 
-                static_cast<double>(std::get<int>(y)) : std::get<double>(y);
-            double xNum = std::holds_alternative<int>(x) ? 
-                static_cast<double>(std::get<int>(x)) : std::get<double>(x);
+            double yNum = rbasic::holds_alternative<int>(y) ? 
+                static_cast<double>(rbasic::get<int>(y)) : rbasic::get<double>(y);
+            double xNum = rbasic::holds_alternative<int>(x) ? 
+                static_cast<double>(rbasic::get<int>(x)) : rbasic::get<double>(x);
                 
             lastValue = std::atan2(yNum, xNum);
             return true;
@@ -645,10 +1504,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
             ValueType left = evaluate(*node.arguments[0]);
             ValueType right = evaluate(*node.arguments[1]);
             
-            int leftInt = std::holds_alternative<int>(left) ? 
-                std::get<int>(left) : static_cast<int>(std::get<double>(left));
-            int rightInt = std::holds_alternative<int>(right) ? 
-                std::get<int>(right) : static_cast<int>(std::get<double>(right));
+            int leftInt = rbasic::holds_alternative<int>(left) ? 
+                rbasic::get<int>(left) : static_cast<int>(rbasic::get<double>(left));
+            int rightInt = rbasic::holds_alternative<int>(right) ? 
+                rbasic::get<int>(right) : static_cast<int>(rbasic::get<double>(right));
                 
             if (rightInt == 0) {
                 throw RuntimeError("MOD by zero");
@@ -659,10 +1518,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
             ValueType left = evaluate(*node.arguments[0]);
             ValueType right = evaluate(*node.arguments[1]);
             
-            double leftNum = std::holds_alternative<int>(left) ? 
-                static_cast<double>(std::get<int>(left)) : std::get<double>(left);
-            double rightNum = std::holds_alternative<int>(right) ? 
-                static_cast<double>(std::get<int>(right)) : std::get<double>(right);
+            double leftNum = rbasic::holds_alternative<int>(left) ? 
+                static_cast<double>(rbasic::get<int>(left)) : rbasic::get<double>(left);
+            double rightNum = rbasic::holds_alternative<int>(right) ? 
+                static_cast<double>(rbasic::get<int>(right)) : rbasic::get<double>(right);
                 
             lastValue = std::min(leftNum, rightNum);
             return true;
@@ -670,10 +1529,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
             ValueType left = evaluate(*node.arguments[0]);
             ValueType right = evaluate(*node.arguments[1]);
             
-            double leftNum = std::holds_alternative<int>(left) ? 
-                static_cast<double>(std::get<int>(left)) : std::get<double>(left);
-            double rightNum = std::holds_alternative<int>(right) ? 
-                static_cast<double>(std::get<int>(right)) : std::get<double>(right);
+            double leftNum = rbasic::holds_alternative<int>(left) ? 
+                static_cast<double>(rbasic::get<int>(left)) : rbasic::get<double>(left);
+            double rightNum = rbasic::holds_alternative<int>(right) ? 
+                static_cast<double>(rbasic::get<int>(right)) : rbasic::get<double>(right);
                 
             lastValue = std::max(leftNum, rightNum);
             return true;
@@ -696,10 +1555,10 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
         } else if (node.arguments.size() == 1) {
             ValueType arg = evaluate(*node.arguments[0]);
             int maxVal = 1;
-            if (std::holds_alternative<int>(arg)) {
-                maxVal = std::get<int>(arg);
-            } else if (std::holds_alternative<double>(arg)) {
-                maxVal = static_cast<int>(std::get<double>(arg));
+            if (rbasic::holds_alternative<int>(arg)) {
+                maxVal = rbasic::get<int>(arg);
+            } else if (rbasic::holds_alternative<double>(arg)) {
+                maxVal = static_cast<int>(rbasic::get<double>(arg));
             }
             if (maxVal <= 0) maxVal = 1;
             lastValue = (std::rand() % maxVal) + 1;  // 1 to maxVal
@@ -716,16 +1575,16 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
     // GLM vector functions
     if (node.name == "length" && node.arguments.size() == 1) {
         ValueType arg = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<Vec2Value>(arg)) {
-            Vec2Value vec = std::get<Vec2Value>(arg);
+        if (rbasic::holds_alternative<Vec2Value>(arg)) {
+            Vec2Value vec = rbasic::get<Vec2Value>(arg);
             lastValue = static_cast<double>(glm::length(vec.data));
             return true;
-        } else if (std::holds_alternative<Vec3Value>(arg)) {
-            Vec3Value vec = std::get<Vec3Value>(arg);
+        } else if (rbasic::holds_alternative<Vec3Value>(arg)) {
+            Vec3Value vec = rbasic::get<Vec3Value>(arg);
             lastValue = static_cast<double>(glm::length(vec.data));
             return true;
-        } else if (std::holds_alternative<Vec4Value>(arg)) {
-            Vec4Value vec = std::get<Vec4Value>(arg);
+        } else if (rbasic::holds_alternative<Vec4Value>(arg)) {
+            Vec4Value vec = rbasic::get<Vec4Value>(arg);
             lastValue = static_cast<double>(glm::length(vec.data));
             return true;
         } else {
@@ -735,16 +1594,16 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
     
     if (node.name == "normalize" && node.arguments.size() == 1) {
         ValueType arg = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<Vec2Value>(arg)) {
-            Vec2Value vec = std::get<Vec2Value>(arg);
+        if (rbasic::holds_alternative<Vec2Value>(arg)) {
+            Vec2Value vec = rbasic::get<Vec2Value>(arg);
             lastValue = Vec2Value(glm::normalize(vec.data));
             return true;
-        } else if (std::holds_alternative<Vec3Value>(arg)) {
-            Vec3Value vec = std::get<Vec3Value>(arg);
+        } else if (rbasic::holds_alternative<Vec3Value>(arg)) {
+            Vec3Value vec = rbasic::get<Vec3Value>(arg);
             lastValue = Vec3Value(glm::normalize(vec.data));
             return true;
-        } else if (std::holds_alternative<Vec4Value>(arg)) {
-            Vec4Value vec = std::get<Vec4Value>(arg);
+        } else if (rbasic::holds_alternative<Vec4Value>(arg)) {
+            Vec4Value vec = rbasic::get<Vec4Value>(arg);
             lastValue = Vec4Value(glm::normalize(vec.data));
             return true;
         } else {
@@ -756,19 +1615,19 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
         ValueType left = evaluate(*node.arguments[0]);
         ValueType right = evaluate(*node.arguments[1]);
         
-        if (std::holds_alternative<Vec2Value>(left) && std::holds_alternative<Vec2Value>(right)) {
-            Vec2Value leftVec = std::get<Vec2Value>(left);
-            Vec2Value rightVec = std::get<Vec2Value>(right);
+        if (rbasic::holds_alternative<Vec2Value>(left) && rbasic::holds_alternative<Vec2Value>(right)) {
+            Vec2Value leftVec = rbasic::get<Vec2Value>(left);
+            Vec2Value rightVec = rbasic::get<Vec2Value>(right);
             lastValue = static_cast<double>(glm::dot(leftVec.data, rightVec.data));
             return true;
-        } else if (std::holds_alternative<Vec3Value>(left) && std::holds_alternative<Vec3Value>(right)) {
-            Vec3Value leftVec = std::get<Vec3Value>(left);
-            Vec3Value rightVec = std::get<Vec3Value>(right);
+        } else if (rbasic::holds_alternative<Vec3Value>(left) && rbasic::holds_alternative<Vec3Value>(right)) {
+            Vec3Value leftVec = rbasic::get<Vec3Value>(left);
+            Vec3Value rightVec = rbasic::get<Vec3Value>(right);
             lastValue = static_cast<double>(glm::dot(leftVec.data, rightVec.data));
             return true;
-        } else if (std::holds_alternative<Vec4Value>(left) && std::holds_alternative<Vec4Value>(right)) {
-            Vec4Value leftVec = std::get<Vec4Value>(left);
-            Vec4Value rightVec = std::get<Vec4Value>(right);
+        } else if (rbasic::holds_alternative<Vec4Value>(left) && rbasic::holds_alternative<Vec4Value>(right)) {
+            Vec4Value leftVec = rbasic::get<Vec4Value>(left);
+            Vec4Value rightVec = rbasic::get<Vec4Value>(right);
             lastValue = static_cast<double>(glm::dot(leftVec.data, rightVec.data));
             return true;
         } else {
@@ -780,9 +1639,9 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
         ValueType left = evaluate(*node.arguments[0]);
         ValueType right = evaluate(*node.arguments[1]);
         
-        if (std::holds_alternative<Vec3Value>(left) && std::holds_alternative<Vec3Value>(right)) {
-            Vec3Value leftVec = std::get<Vec3Value>(left);
-            Vec3Value rightVec = std::get<Vec3Value>(right);
+        if (rbasic::holds_alternative<Vec3Value>(left) && rbasic::holds_alternative<Vec3Value>(right)) {
+            Vec3Value leftVec = rbasic::get<Vec3Value>(left);
+            Vec3Value rightVec = rbasic::get<Vec3Value>(right);
             lastValue = Vec3Value(glm::cross(leftVec.data, rightVec.data));
             return true;
         } else {
@@ -794,19 +1653,19 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
         ValueType left = evaluate(*node.arguments[0]);
         ValueType right = evaluate(*node.arguments[1]);
         
-        if (std::holds_alternative<Vec2Value>(left) && std::holds_alternative<Vec2Value>(right)) {
-            Vec2Value leftVec = std::get<Vec2Value>(left);
-            Vec2Value rightVec = std::get<Vec2Value>(right);
+        if (rbasic::holds_alternative<Vec2Value>(left) && rbasic::holds_alternative<Vec2Value>(right)) {
+            Vec2Value leftVec = rbasic::get<Vec2Value>(left);
+            Vec2Value rightVec = rbasic::get<Vec2Value>(right);
             lastValue = static_cast<double>(glm::distance(leftVec.data, rightVec.data));
             return true;
-        } else if (std::holds_alternative<Vec3Value>(left) && std::holds_alternative<Vec3Value>(right)) {
-            Vec3Value leftVec = std::get<Vec3Value>(left);
-            Vec3Value rightVec = std::get<Vec3Value>(right);
+        } else if (rbasic::holds_alternative<Vec3Value>(left) && rbasic::holds_alternative<Vec3Value>(right)) {
+            Vec3Value leftVec = rbasic::get<Vec3Value>(left);
+            Vec3Value rightVec = rbasic::get<Vec3Value>(right);
             lastValue = static_cast<double>(glm::distance(leftVec.data, rightVec.data));
             return true;
-        } else if (std::holds_alternative<Vec4Value>(left) && std::holds_alternative<Vec4Value>(right)) {
-            Vec4Value leftVec = std::get<Vec4Value>(left);
-            Vec4Value rightVec = std::get<Vec4Value>(right);
+        } else if (rbasic::holds_alternative<Vec4Value>(left) && rbasic::holds_alternative<Vec4Value>(right)) {
+            Vec4Value leftVec = rbasic::get<Vec4Value>(left);
+            Vec4Value rightVec = rbasic::get<Vec4Value>(right);
             lastValue = static_cast<double>(glm::distance(leftVec.data, rightVec.data));
             return true;
         } else {
@@ -818,151 +1677,535 @@ bool Interpreter::handleMathFunctions(CallExpr& node) {
 }
 
 bool Interpreter::handleStringFunctions(CallExpr& node) {
-    // String functions (mid, left, right, len, str, val)
-    if (node.arguments.size() == 2 || (node.name == "mid" && (node.arguments.size() == 2 || node.arguments.size() == 3))) {
-        if (node.name == "mid") {
-            if (node.arguments.size() < 2 || node.arguments.size() > 3) {
-                throw RuntimeError("MID requires 2 or 3 arguments");
+    // String functions: every argument is evaluated exactly once, and string
+    // arguments are read through string_view so only the result is allocated
+    const std::string& name = node.name;
+    const size_t argc = node.arguments.size();
+    
+    const bool isStringFunction =
+        (name == "mid" && (argc == 2 || argc == 3)) ||
+        ((name == "left" || name == "right") && argc == 2) ||
+        (name == "instr" && (argc == 2 || argc == 3)) ||
+        ((name == "split" || name == "join") && argc == 2) ||
+        (name == "replace" && argc == 3) ||
+        ((name == "len" || name == "str" || name == "val" ||
+          name == "upper" || name == "lower" || name == "trim") && argc == 1);
+    if (!isStringFunction) {
+        return false;
+    }
+    
+    ScratchPool<ValueType>::Lease scratch(argumentPool);
+    auto args = evaluateArgumentsInPlace(node, *scratch);
+    
+    if (name == "str") {
+        lastValue = valueToString(*args[0]);
+        return true;
+    }
+    
+    if (name == "join") {
+        lastValue = joinArray(*args[0], valueToString(*args[1]));
+        return true;
+    }
+    
+    // len of an array is its number of elements
+    if (name == "len") {
+        int length = arrayLength(*args[0]);
+        if (length >= 0) {
+            lastValue = length;
+            return true;
+        }
+    }
+    
+    std::string text;  // Backing storage when the first argument is not already a string
+    std::string_view str = stringArgument(*args[0], text);
+    
+    if (name == "mid") {
+        int start = TypeUtils::toInt(*args[1]);
+        int length = argc == 3 ? TypeUtils::toInt(*args[2]) : -1;
+        lastValue = std::string(StringOps::mid(str, start, length));
+    } else if (name == "left") {
+        lastValue = std::string(StringOps::left(str, TypeUtils::toInt(*args[1])));
+    } else if (name == "right") {
+        lastValue = std::string(StringOps::right(str, TypeUtils::toInt(*args[1])));
+    } else if (name == "len") {
+        lastValue = static_cast<int>(str.size());
+    } else if (name == "val") {
+        int intValue = 0;
+        double doubleValue = 0.0;
+        switch (NumberFormat::parseNumber(str, intValue, doubleValue)) {
+            case NumberFormat::NumberKind::INT: lastValue = intValue; break;
+            case NumberFormat::NumberKind::DOUBLE: lastValue = doubleValue; break;
+            default: lastValue = 0; break;  // Default to 0 if conversion fails
+        }
+    } else if (name == "instr") {
+        std::string needleText;
+        std::string_view needle = stringArgument(*args[1], needleText);
+        int start = argc == 3 ? TypeUtils::toInt(*args[2]) : 1;
+        lastValue = StringOps::instr(str, needle, start);
+    } else if (name == "split") {
+        std::string delimiterText;
+        auto parts = StringOps::split(str, stringArgument(*args[1], delimiterText));
+        ArrayValue result({static_cast<int>(parts.size())});
+        for (size_t i = 0; i < parts.size(); i++) {
+            result.elements[static_cast<int>(i)] = std::string(parts[i]);
+        }
+        lastValue = std::move(result);
+    } else if (name == "replace") {
+        std::string fromText, toText;
+        lastValue = StringOps::replace(str, stringArgument(*args[1], fromText), stringArgument(*args[2], toText));
+    } else if (name == "upper") {
+        lastValue = StringOps::upper(str);
+    } else if (name == "lower") {
+        lastValue = StringOps::lower(str);
+    } else {
+        lastValue = std::string(StringOps::trim(str));
+    }
+    return true;
+}
+
+bool Interpreter::handleArrayFunctions(CallExpr& node) {
+    // Array creation functions
+    if (node.name == "byte_array" && node.arguments.size() >= 1) {
+        std::vector<int> dims;
+        for (auto& arg : node.arguments) {
+            ValueType dimVal = evaluate(*arg);
+            int dim = 0;
+            if (rbasic::holds_alternative<int>(dimVal)) {
+                dim = rbasic::get<int>(dimVal);
+            } else if (rbasic::holds_alternative<double>(dimVal)) {
+                dim = static_cast<int>(rbasic::get<double>(dimVal));
+            } else {
+                throw RuntimeError("Array dimensions must be numeric");
             }
+            dims.push_back(dim);
+        }
+        lastValue = ByteArrayValue(dims);
+        return true;
+    }
+    
+    if (node.name == "int_array" && node.arguments.size() >= 1) {
+        std::vector<int> dims;
+        for (auto& arg : node.arguments) {
+            ValueType dimVal = evaluate(*arg);
+            int dim = 0;
+            if (rbasic::holds_alternative<int>(dimVal)) {
+                dim = rbasic::get<int>(dimVal);
+            } else if (rbasic::holds_alternative<double>(dimVal)) {
+                dim = static_cast<int>(rbasic::get<double>(dimVal));
+            } else {
+                throw RuntimeError("Array dimensions must be numeric");
+            }
+            dims.push_back(dim);
+        }
+        lastValue = IntArrayValue(dims);
+        return true;
+    }
+    
+    if (node.name == "double_array" && node.arguments.size() >= 1) {
+        std::vector<int> dims;
+        for (auto& arg : node.arguments) {
+            ValueType dimVal = evaluate(*arg);
+            int dim = 0;
+            if (rbasic::holds_alternative<int>(dimVal)) {
+                dim = rbasic::get<int>(dimVal);
+            } else if (rbasic::holds_alternative<double>(dimVal)) {
+                dim = static_cast<int>(rbasic::get<double>(dimVal));
+            } else {
+                throw RuntimeError("Array dimensions must be numeric");
+            }
+            dims.push_back(dim);
+        }
+        lastValue = DoubleArrayValue(dims);
+        return true;
+    }
+    
+    // Whole-array operations on typed arrays (see array_ops.h for the kernels)
+    if (node.name.compare(0, 6, "array_") == 0) {
+        return handleTypedArrayOperation(node);
+    }
+    
+    return handleVecArrayOperation(node);
+}
+
+bool Interpreter::handleVecArrayOperation(CallExpr& node) {
+    const std::string& name = node.name;
+    const size_t argc = node.arguments.size();
+    
+    if ((name == "vec3_array" || name == "vec4_array") && argc >= 1) {
+        std::vector<int> dims;
+        for (auto& arg : node.arguments) {
+            int dim = TypeUtils::toInt(evaluate(*arg));
+            if (dim < 0) {
+                throw RuntimeError("Array dimensions cannot be negative");
+            }
+            dims.push_back(dim);
+        }
+        if (name == "vec3_array") {
+            lastValue = Vec3ArrayValue(dims);
+        } else {
+            lastValue = Vec4ArrayValue(dims);
+        }
+        return true;
+    }
+    
+    // Bulk GLM operations over a whole vector array (see vec_ops.h for the kernels).
+    // Each returns a new array; the input array is read in place.
+    const bool isBulkOperation = ((name == "transform_points" || name == "rotate_all" || name == "dot_all") && argc == 2) ||
+                                 (name == "normalize_all" && argc == 1);
+    if (!isBulkOperation) {
+        return false;
+    }
+    
+    ScratchPool<ValueType>::Lease scratch(argumentPool);
+    auto args = evaluateArgumentsInPlace(node, *scratch);
+    ValueType* source = args[argc - 1];
+    
+    bool handled = withVecArray(*source, [&](const auto& array) {
+        using ArrayT = std::decay_t<decltype(array)>;
+        constexpr int lanes = vecArrayLanes<ArrayT>();
+        const size_t n = array.elements.size();
+        const float* in = glm::value_ptr(array.elements.front());
+        
+        if (name == "dot_all") {
+            auto* other = rbasic::get_if<ArrayT>(args[0]);
+            if (!other || other->elements.size() != n) {
+                throw RuntimeError("dot_all requires two vector arrays of the same type and size");
+            }
+            DoubleArrayValue result;
+            result.dimensions = array.dimensions;
+            result.elements.resize(n);
+            if (n > 0) {
+                VecOps::dot<lanes>(glm::value_ptr(other->elements.front()), in, result.elements.data(), n);
+            }
+            lastValue = std::move(result);
+            return;
+        }
+        
+        ArrayT result;
+        result.dimensions = array.dimensions;
+        result.elements.resize(n);
+        if (name == "transform_points") {
+            auto* matrix = rbasic::get_if<Mat4Value>(args[0]);
+            if (!matrix) {
+                throw RuntimeError("transform_points requires a mat4 and a vector array");
+            }
+            if (n > 0) {
+                VecOps::transform<lanes>(glm::value_ptr(matrix->data), in, glm::value_ptr(result.elements.front()), n);
+            }
+        } else if (name == "rotate_all") {
+            auto* rotation = rbasic::get_if<QuatValue>(args[0]);
+            if (!rotation) {
+                throw RuntimeError("rotate_all requires a quat and a vector array");
+            }
+            const float q[4] = {rotation->data.x, rotation->data.y, rotation->data.z, rotation->data.w};
+            if (n > 0) {
+                VecOps::rotate<lanes>(q, in, glm::value_ptr(result.elements.front()), n);
+            }
+        } else if (n > 0) {
+            VecOps::normalize<lanes>(in, glm::value_ptr(result.elements.front()), n);
+        }
+        lastValue = std::move(result);
+    });
+    if (!handled) {
+        throw RuntimeError(name + " requires a vec3_array or vec4_array");
+    }
+    return true;
+}
+
+std::vector<ValueType*> Interpreter::evaluateArgumentsInPlace(CallExpr& node, std::vector<ValueType>& scratch,
+                                                              int target) {
+    // Plain variable arguments are used in place so large arrays and strings are
+    // not copied. Arguments are evaluated left to right. A variable followed by
+    // an argument that may have side effects (anything but a variable or a
+    // literal) is read at its turn into a shared copy, so f(x, g()) passes x as
+    // it was before g ran. The other variables, and the in-place target, are
+    // resolved once everything is evaluated, so no pointer is left dangling.
+    const size_t argc = node.arguments.size();
+    std::vector<ValueType*> args(argc, nullptr);
+    scratch.clear();
+    scratch.reserve(argc);
+    
+    size_t lastSideEffect = 0;  // One past the last argument that may have side effects
+    for (size_t i = 0; i < argc; i++) {
+        if (!plainVariableName(*node.arguments[i]) && !dynamic_cast<LiteralExpr*>(node.arguments[i].get())) {
+            lastSideEffect = i + 1;
+        }
+    }
+    
+    auto variable = [&](const std::string& name) {
+        ValueType* value = findVariable(name);
+        if (!value) {
+            throw RuntimeError("Undefined variable '" + name + "'", getCurrentPosition());
+        }
+        return value;
+    };
+    for (size_t i = 0; i < argc; i++) {
+        const std::string* name = plainVariableName(*node.arguments[i]);
+        if (!name) {
+            scratch.push_back(evaluate(*node.arguments[i]));
+            args[i] = &scratch.back();
+        } else if (i + 1 < lastSideEffect && static_cast<int>(i) != target) {
+            scratch.push_back(*variable(*name));  // Shares arrays and long strings, no deep copy
+            args[i] = &scratch.back();
+        }
+    }
+    for (size_t i = 0; i < argc; i++) {
+        if (!args[i]) {
+            args[i] = variable(*plainVariableName(*node.arguments[i]));
+        }
+    }
+    return args;
+}
+
+bool Interpreter::handleTypedArrayOperation(CallExpr& node) {
+    const std::string& name = node.name;
+    const size_t argc = node.arguments.size();
+    
+    auto requireVariable = [&](size_t index) {
+        if (!plainVariableName(*node.arguments[index])) {
+            throw RuntimeError(name + " modifies its array argument in place and requires a variable");
+        }
+    };
+    auto typedArrayError = [&]() {
+        return RuntimeError(name + " requires a typed array (byte_array, int_array or double_array)");
+    };
+    
+    // Elementwise arithmetic: returns a new array, right operand is an array or a number
+    if ((name == "array_add" || name == "array_sub" || name == "array_mul" || name == "array_div") && argc == 2) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        const char op = name[6];  // 'a', 's', 'm' or 'd'
+        ValueType result;
+        
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            using ArrayT = std::decay_t<decltype(a)>;
+            using T = typename decltype(a.elements)::value_type;
+            ArrayT out;
+            out.dimensions = a.dimensions;
+            out.elements.resize(a.elements.size());
+            const size_t n = a.elements.size();
             
-            std::string str = valueToString(evaluate(*node.arguments[0]));
-            int start = std::holds_alternative<int>(evaluate(*node.arguments[1])) ? 
-                std::get<int>(evaluate(*node.arguments[1])) : 
-                static_cast<int>(std::get<double>(evaluate(*node.arguments[1])));
-            
-            start = std::max(1, start) - 1; // Convert from 1-based to 0-based
-            
-            if (node.arguments.size() == 3) {
-                int length = std::holds_alternative<int>(evaluate(*node.arguments[2])) ? 
-                    std::get<int>(evaluate(*node.arguments[2])) : 
-                    static_cast<int>(std::get<double>(evaluate(*node.arguments[2])));
-                    
-                if (start >= static_cast<int>(str.length())) {
-                    lastValue = std::string("");
-                } else {
-                    lastValue = str.substr(start, length);
+            if (auto* b = rbasic::get_if<ArrayT>(args[1])) {
+                if (b->elements.size() != n) {
+                    throw RuntimeError(name + " requires arrays of the same size");
                 }
-            } else {
-                if (start >= static_cast<int>(str.length())) {
-                    lastValue = std::string("");
-                } else {
-                    lastValue = str.substr(start);
+                if constexpr (std::is_integral_v<T>) {
+                    if (op == 'd' && ArrayOps::containsZero(b->elements.data(), n)) {
+                        throw RuntimeError("Division by zero");
+                    }
+                }
+                switch (op) {
+                    case 'a': ArrayOps::add(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                    case 's': ArrayOps::subtract(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                    case 'm': ArrayOps::multiply(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                    default:  ArrayOps::divide(a.elements.data(), b->elements.data(), out.elements.data(), n); break;
+                }
+            } else if (TypeUtils::isNumeric(*args[1])) {
+                T s = typedArrayScalar<T>(*args[1]);
+                if (op == 'd' && s == T()) {
+                    throw RuntimeError("Division by zero");
                 }
+                switch (op) {
+                    case 'a': ArrayOps::addScalar(a.elements.data(), s, out.elements.data(), n); break;
+                    case 's': ArrayOps::subtractScalar(a.elements.data(), s, out.elements.data(), n); break;
+                    case 'm': ArrayOps::multiplyScalar(a.elements.data(), s, out.elements.data(), n); break;
+                    default:  ArrayOps::divideScalar(a.elements.data(), s, out.elements.data(), n); break;
+                }
+            } else {
+                throw RuntimeError(name + " requires a typed array of the same type or a number as its second argument");
             }
-            return true;
-        } else if (node.name == "left") {
-            std::string str = valueToString(evaluate(*node.arguments[0]));
-            int length = std::holds_alternative<int>(evaluate(*node.arguments[1])) ? 
-                std::get<int>(evaluate(*node.arguments[1])) : 
-                static_cast<int>(std::get<double>(evaluate(*node.arguments[1])));
-                
-            lastValue = str.substr(0, std::max(0, length));
-            return true;
-        } else if (node.name == "right") {
-            std::string str = valueToString(evaluate(*node.arguments[0]));
-            int length = std::holds_alternative<int>(evaluate(*node.arguments[1])) ? 
-                std::get<int>(evaluate(*node.arguments[1])) : 
-                static_cast<int>(std::get<double>(evaluate(*node.arguments[1])));
-                
-            int start = std::max(0, static_cast<int>(str.length()) - length);
-            lastValue = str.substr(start);
-            return true;
+            result = std::move(out);
+        });
+        if (!handled) {
+            throw typedArrayError();
         }
+        lastValue = std::move(result);
+        return true;
     }
     
-    // Single-argument string functions
-    if (node.arguments.size() == 1) {
-        if (node.name == "len") {
-            std::string str = valueToString(evaluate(*node.arguments[0]));
-            lastValue = static_cast<int>(str.length());
-            return true;
-        } else if (node.name == "str") {
-            ValueType value = evaluate(*node.arguments[0]);
-            lastValue = valueToString(value);
-            return true;
-        } else if (node.name == "val") {
-            std::string str = valueToString(evaluate(*node.arguments[0]));
-            try {
-                if (hasDecimalPoint(str)) {
-                    lastValue = std::stod(str);
-                } else {
-                    lastValue = std::stoi(str);
-                }
-            } catch (const std::exception&) {
-                lastValue = 0; // Default to 0 if conversion fails
+    // array_axpy(alpha, x, y): y = alpha * x + y, updating y in place
+    if (name == "array_axpy" && argc == 3) {
+        requireVariable(2);
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch, 2);
+        if (!TypeUtils::isNumeric(*args[0])) {
+            throw RuntimeError("array_axpy requires a numeric scale factor");
+        }
+        bool handled = withTypedArray(*args[2], [&](auto& y) {
+            using ArrayT = std::decay_t<decltype(y)>;
+            using T = typename decltype(y.elements)::value_type;
+            auto* x = rbasic::get_if<ArrayT>(args[1]);
+            if (!x || x->elements.size() != y.elements.size()) {
+                throw RuntimeError("array_axpy requires x and y to be typed arrays of the same type and size");
             }
-            return true;
+            ArrayOps::axpy(typedArrayScalar<T>(*args[0]), x->elements.data(), y.elements.data(), y.elements.size());
+        });
+        if (!handled) {
+            throw typedArrayError();
         }
+        lastValue = 0;
+        return true;
     }
     
-    return false; // Function not handled by this dispatcher
-}
-
-bool Interpreter::handleArrayFunctions(CallExpr& node) {
-    // Array creation functions
-    if (node.name == "byte_array" && node.arguments.size() >= 1) {
-        std::vector<int> dims;
-        for (auto& arg : node.arguments) {
-            ValueType dimVal = evaluate(*arg);
-            int dim = 0;
-            if (std::holds_alternative<int>(dimVal)) {
-                dim = std::get<int>(dimVal);
-            } else if (std::holds_alternative<double>(dimVal)) {
-                dim = static_cast<int>(std::get<double>(dimVal));
+    // Reductions: min/max keep the element type; sum and mean are always doubles so int sums cannot overflow
+    if ((name == "array_sum" || name == "array_min" || name == "array_max" || name == "array_mean") && argc == 1) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            using T = typename decltype(a.elements)::value_type;
+            const size_t n = a.elements.size();
+            if (name == "array_sum") {
+                lastValue = ArrayOps::sum(a.elements.data(), n);
+                return;
+            }
+            if (n == 0) {
+                throw RuntimeError(name + " requires a non-empty array");
+            }
+            if (name == "array_mean") {
+                lastValue = ArrayOps::sum(a.elements.data(), n) / static_cast<double>(n);
+            } else if (name == "array_min") {
+                lastValue = typedArrayResult<T>(ArrayOps::minValue(a.elements.data(), n));
             } else {
-                throw RuntimeError("Array dimensions must be numeric");
+                lastValue = typedArrayResult<T>(ArrayOps::maxValue(a.elements.data(), n));
             }
-            dims.push_back(dim);
+        });
+        if (!handled) {
+            throw typedArrayError();
         }
-        lastValue = ByteArrayValue(dims);
         return true;
     }
     
-    if (node.name == "int_array" && node.arguments.size() >= 1) {
-        std::vector<int> dims;
-        for (auto& arg : node.arguments) {
-            ValueType dimVal = evaluate(*arg);
-            int dim = 0;
-            if (std::holds_alternative<int>(dimVal)) {
-                dim = std::get<int>(dimVal);
-            } else if (std::holds_alternative<double>(dimVal)) {
-                dim = static_cast<int>(std::get<double>(dimVal));
-            } else {
-                throw RuntimeError("Array dimensions must be numeric");
+    if (name == "array_dot" && argc == 2) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            using ArrayT = std::decay_t<decltype(a)>;
+            auto* b = rbasic::get_if<ArrayT>(args[1]);
+            if (!b || b->elements.size() != a.elements.size()) {
+                throw RuntimeError("array_dot requires typed arrays of the same type and size");
             }
-            dims.push_back(dim);
+            lastValue = ArrayOps::dot(a.elements.data(), b->elements.data(), a.elements.size());
+        });
+        if (!handled) {
+            throw typedArrayError();
         }
-        lastValue = IntArrayValue(dims);
         return true;
     }
     
-    if (node.name == "double_array" && node.arguments.size() >= 1) {
-        std::vector<int> dims;
-        for (auto& arg : node.arguments) {
-            ValueType dimVal = evaluate(*arg);
-            int dim = 0;
-            if (std::holds_alternative<int>(dimVal)) {
-                dim = std::get<int>(dimVal);
-            } else if (std::holds_alternative<double>(dimVal)) {
-                dim = static_cast<int>(std::get<double>(dimVal));
-            } else {
-                throw RuntimeError("Array dimensions must be numeric");
+    // array_fill(arr, value): sets every element in place
+    if (name == "array_fill" && argc == 2) {
+        requireVariable(0);
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch, 0);
+        if (!TypeUtils::isNumeric(*args[1])) {
+            throw RuntimeError("array_fill requires a numeric fill value");
+        }
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            using T = typename decltype(a.elements)::value_type;
+            ArrayOps::fill(a.elements.data(), typedArrayScalar<T>(*args[1]), a.elements.size());
+        });
+        if (!handled) {
+            throw typedArrayError();
+        }
+        lastValue = 0;
+        return true;
+    }
+    
+    // array_copy(dst, dst_start, src, src_start, count): copies a range in place
+    if (name == "array_copy" && argc == 5) {
+        requireVariable(0);
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch, 0);
+        const int dstStart = TypeUtils::toInt(*args[1]);
+        const int srcStart = TypeUtils::toInt(*args[3]);
+        const int count = TypeUtils::toInt(*args[4]);
+        bool handled = withTypedArray(*args[0], [&](auto& dst) {
+            using ArrayT = std::decay_t<decltype(dst)>;
+            auto* src = rbasic::get_if<ArrayT>(args[2]);
+            if (!src) {
+                throw RuntimeError("array_copy requires source and destination arrays of the same type");
             }
-            dims.push_back(dim);
+            if (dstStart < 0 || srcStart < 0 || count < 0 ||
+                static_cast<size_t>(dstStart) + count > dst.elements.size() ||
+                static_cast<size_t>(srcStart) + count > src->elements.size()) {
+                throw RuntimeError("array_copy range out of bounds");
+            }
+            ArrayOps::copy(src->elements.data() + srcStart, dst.elements.data() + dstStart, static_cast<size_t>(count));
+        });
+        if (!handled) {
+            throw typedArrayError();
         }
-        lastValue = DoubleArrayValue(dims);
+        lastValue = count;
         return true;
     }
     
-    return false; // Function not handled by this dispatcher
+    // array_slice(arr, start, count): returns a new one-dimensional array
+    if (name == "array_slice" && argc == 3) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        const int start = TypeUtils::toInt(*args[1]);
+        const int count = TypeUtils::toInt(*args[2]);
+        ValueType result;
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            using ArrayT = std::decay_t<decltype(a)>;
+            if (start < 0 || count < 0 || static_cast<size_t>(start) + count > a.elements.size()) {
+                throw RuntimeError("array_slice range out of bounds");
+            }
+            ArrayT out(std::vector<int>{count});
+            ArrayOps::copy(a.elements.data() + start, out.elements.data(), static_cast<size_t>(count));
+            result = std::move(out);
+        });
+        if (!handled) {
+            throw typedArrayError();
+        }
+        lastValue = std::move(result);
+        return true;
+    }
+    
+    // array_sort(arr): sorts ascending in place
+    if (name == "array_sort" && argc == 1) {
+        requireVariable(0);
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch, 0);
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            ArrayOps::sort(a.elements.data(), a.elements.size());
+        });
+        if (!handled) {
+            throw typedArrayError();
+        }
+        lastValue = 0;
+        return true;
+    }
+    
+    // array_prefix_sum(arr): returns the inclusive running total
+    if (name == "array_prefix_sum" && argc == 1) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        ValueType result;
+        bool handled = withTypedArray(*args[0], [&](auto& a) {
+            using ArrayT = std::decay_t<decltype(a)>;
+            ArrayT out;
+            out.dimensions = a.dimensions;
+            out.elements.resize(a.elements.size());
+            ArrayOps::prefixSum(a.elements.data(), out.elements.data(), a.elements.size());
+            result = std::move(out);
+        });
+        if (!handled) {
+            throw typedArrayError();
+        }
+        lastValue = std::move(result);
+        return true;
+    }
+    
+    return false;
 }
 
 bool Interpreter::handleFileFunctions(CallExpr& node) {
     // File I/O functions
     if (node.name == "file_exists" && node.arguments.size() == 1) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<std::string>(filenameVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
             lastValue = std::filesystem::exists(filename);
         } else {
             lastValue = false;
@@ -972,8 +2215,8 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     
     if (node.name == "file_size" && node.arguments.size() == 1) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<std::string>(filenameVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
             try {
                 if (std::filesystem::exists(filename)) {
                     auto size = std::filesystem::file_size(filename);
@@ -994,8 +2237,8 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     
     if (node.name == "delete_file" && node.arguments.size() == 1) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<std::string>(filenameVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
             try {
                 lastValue = std::filesystem::remove(filename);
             } catch (...) {
@@ -1010,9 +2253,9 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     if (node.name == "rename_file" && node.arguments.size() == 2) {
         ValueType oldnameVal = evaluate(*node.arguments[0]);
         ValueType newnameVal = evaluate(*node.arguments[1]);
-        if (std::holds_alternative<std::string>(oldnameVal) && std::holds_alternative<std::string>(newnameVal)) {
-            std::string oldname = std::get<std::string>(oldnameVal);
-            std::string newname = std::get<std::string>(newnameVal);
+        if (rbasic::holds_alternative<std::string>(oldnameVal) && rbasic::holds_alternative<std::string>(newnameVal)) {
+            std::string oldname = rbasic::get<std::string>(oldnameVal);
+            std::string newname = rbasic::get<std::string>(newnameVal);
             try {
                 std::filesystem::rename(oldname, newname);
                 lastValue = true;
@@ -1027,8 +2270,8 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     
     if (node.name == "read_text_file" && node.arguments.size() == 1) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<std::string>(filenameVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
             std::ifstream file(filename);
             if (file.is_open()) {
                 std::string content((std::istreambuf_iterator<char>(file)),
@@ -1047,9 +2290,9 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     if (node.name == "write_text_file" && node.arguments.size() == 2) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
         ValueType contentVal = evaluate(*node.arguments[1]);
-        if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<std::string>(contentVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
-            std::string content = std::get<std::string>(contentVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<std::string>(contentVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
+            std::string content = rbasic::get<std::string>(contentVal);
             std::ofstream file(filename);
             if (file.is_open()) {
                 file << content;
@@ -1068,9 +2311,9 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     if (node.name == "append_text_file" && node.arguments.size() == 2) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
         ValueType contentVal = evaluate(*node.arguments[1]);
-        if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<std::string>(contentVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
-            std::string content = std::get<std::string>(contentVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<std::string>(contentVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
+            std::string content = rbasic::get<std::string>(contentVal);
             std::ofstream file(filename, std::ios::app);
             if (file.is_open()) {
                 file << content;
@@ -1086,10 +2329,58 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
         return true;
     }
     
+    if (node.name == "save_array" && node.arguments.size() == 2) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        if (!rbasic::holds_alternative<std::string>(*args[0])) {
+            throw RuntimeError("save_array requires a filename");
+        }
+        lastValue = saveArrayFile(rbasic::get<std::string>(*args[0]), *args[1]);
+        return true;
+    }
+    
+    if (node.name == "load_array" && node.arguments.size() == 1) {
+        ValueType filenameVal = evaluate(*node.arguments[0]);
+        if (!rbasic::holds_alternative<std::string>(filenameVal)) {
+            throw RuntimeError("load_array requires a filename");
+        }
+        lastValue = loadArrayFile(rbasic::get<std::string>(filenameVal));
+        return true;
+    }
+    
+    if (node.name == "framebuffer" && node.arguments.size() == 2) {
+        int width = TypeUtils::toInt(evaluate(*node.arguments[0]));
+        int height = TypeUtils::toInt(evaluate(*node.arguments[1]));
+        ByteArrayValue image;
+        try {
+            image.elements = PixelImage::blank(width, height);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(std::string("framebuffer: ") + e.what());
+        }
+        image.dimensions = {height, width, 4};
+        lastValue = std::move(image);
+        return true;
+    }
+    
+    if (node.name == "save_image" && node.arguments.size() == 2) {
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        auto args = evaluateArgumentsInPlace(node, *scratch);
+        if (!rbasic::holds_alternative<std::string>(*args[0])) {
+            throw RuntimeError("save_image requires a filename");
+        }
+        PixelImage::View view = framebufferView("save_image", *args[1]);
+        try {
+            lastValue = PixelImage::save(rbasic::get<std::string>(*args[0]), view);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(std::string("save_image: ") + e.what());
+        }
+        return true;
+    }
+    
     if (node.name == "load_binary_file" && node.arguments.size() == 1) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
-        if (std::holds_alternative<std::string>(filenameVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
             std::ifstream file(filename, std::ios::binary);
             if (file.is_open()) {
                 // Get file size
@@ -1117,9 +2408,9 @@ bool Interpreter::handleFileFunctions(CallExpr& node) {
     if (node.name == "write_binary_file" && node.arguments.size() == 2) {
         ValueType filenameVal = evaluate(*node.arguments[0]);
         ValueType bufferVal = evaluate(*node.arguments[1]);
-        if (std::holds_alternative<std::string>(filenameVal) && std::holds_alternative<ByteArrayValue>(bufferVal)) {
-            std::string filename = std::get<std::string>(filenameVal);
-            ByteArrayValue& buffer = std::get<ByteArrayValue>(bufferVal);
+        if (rbasic::holds_alternative<std::string>(filenameVal) && rbasic::holds_alternative<ByteArrayValue>(bufferVal)) {
+            std::string filename = rbasic::get<std::string>(filenameVal);
+            ByteArrayValue& buffer = rbasic::get<ByteArrayValue>(bufferVal);
             std::ofstream file(filename, std::ios::binary);
             if (file.is_open()) {
                 file.write(reinterpret_cast<const char*>(buffer.elements.data()), buffer.elements.size());
@@ -1147,6 +2438,12 @@ bool Interpreter::handleTerminalFunctions(CallExpr& node) {
         terminalInitialized = true;
     }
     
+    // Arguments are evaluated up front, so calls meant for later handlers
+    // (user functions above all) must not get this far
+    if (node.name.compare(0, 9, "terminal_") != 0) {
+        return false;
+    }
+    
     std::vector<ValueType> args;
     for (auto& arg : node.arguments) {
         args.push_back(evaluate(*arg));
@@ -1281,6 +2578,15 @@ bool Interpreter::handleTerminalFunctions(CallExpr& node) {
         return true;
     }
     
+    if (node.name == "terminal_read_key" && args.size() == 1) {
+        try {
+            lastValue = Terminal::readKey(TypeUtils::toInt(args[0]));
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(e.what());
+        }
+        return true;
+    }
+    
     if (node.name == "terminal_getline") {
         if (args.size() >= 2) {
             lastValue = Terminal::getline(TypeUtils::toString(args[0]), 
@@ -1309,6 +2615,30 @@ bool Interpreter::handleTerminalFunctions(CallExpr& node) {
         return true;
     }
     
+    if (node.name == "terminal_begin_frame") {
+        Terminal::beginFrame();
+        lastValue = 0;
+        return true;
+    }
+    
+    if (node.name == "terminal_put") {
+        if (args.size() < 3 || args.size() > 5) {
+            throw RuntimeError("terminal_put requires 3 to 5 arguments (row, col, text[, foreground[, background]])",
+                               getCurrentPosition());
+        }
+        Terminal::put(TypeUtils::toInt(args[0]), TypeUtils::toInt(args[1]), TypeUtils::toString(args[2]),
+                      args.size() >= 4 ? static_cast<Colour>(TypeUtils::toInt(args[3])) : Colour::DEFAULT,
+                      args.size() >= 5 ? static_cast<Colour>(TypeUtils::toInt(args[4])) : Colour::DEFAULT);
+        lastValue = 0;
+        return true;
+    }
+    
+    if (node.name == "terminal_end_frame") {
+        Terminal::endFrame();
+        lastValue = 0;
+        return true;
+    }
+    
     return false; // Function not handled by this dispatcher
 }
 
@@ -1326,24 +2656,37 @@ bool Interpreter::handleUserDefinedFunction(CallExpr& node) {
         }
         
         // Evaluate arguments in the CURRENT scope before creating new scope
-        std::vector<ValueType> argValues;
-        for (size_t i = 0; i < node.arguments.size(); i++) {
-            ValueType argValue = evaluate(*node.arguments[i]);
-            argValues.push_back(argValue);
+        {
+            ScratchPool<ValueType>::Lease argValues(argumentPool);
+            for (size_t i = 0; i < node.arguments.size(); i++) {
+                argValues->push_back(evaluate(*node.arguments[i]));
+            }
+            
+            // Create new scope for function
+            pushScope();
+            
+            // Bind parameters, moving in the pre-evaluated arguments
+            for (size_t i = 0; i < func.parameters.size(); i++) {
+                defineVariable(func.parameters[i], std::move((*argValues)[i]));
+            }
         }
         
-        // Create new scope for function
-        pushScope();
-        
-        // Bind parameters using pre-evaluated arguments
-        for (size_t i = 0; i < func.parameters.size(); i++) {
-            defineVariable(func.parameters[i], argValues[i]);
+        if (coverage && func.coverageSlot >= 0) {
+            coverage->counter(func.coverageSlot).calls++;
         }
         
         // Execute function body
+        std::optional<Profiler::FunctionScope> profile;
+        std::optional<SlowTrace::FunctionScope> traced;
+        if (profiler) {
+            profile.emplace(*profiler, &func);
+        }
+        if (slowTrace) {
+            traced.emplace(*slowTrace, func);
+        }
         hasReturned = false;
         for (auto& stmt : func.body) {
-            stmt->accept(*this);
+            execute(*stmt);
             if (hasReturned) break;
         }
         
@@ -1362,9 +2705,9 @@ void Interpreter::visit(StructLiteralExpr& node) {
         throw RuntimeError("Unknown struct type: " + node.structName);
     }
     
-    // Create struct instance with field values
-    StructValue structValue(node.structName);
+    // Create struct instance with field values in declaration order
     const auto& structDecl = *structIt->second;
+    StructValue structValue(structDecl.layout);
     
     if (node.values.size() != structDecl.fields.size()) {
         throw RuntimeError("Struct '" + node.structName + "' expects " + 
@@ -1372,26 +2715,11 @@ void Interpreter::visit(StructLiteralExpr& node) {
                           std::to_string(node.values.size()));
     }
     
-    // Initialize fields with provided values
     for (size_t i = 0; i < node.values.size(); i++) {
-        ValueType value = evaluate(*node.values[i]);
-        const std::string& fieldName = structDecl.fields[i];
-        
-        // Convert ValueType to the variant type used in StructValue
-        if (std::holds_alternative<int>(value)) {
-            structValue.fields[fieldName] = std::get<int>(value);
-        } else if (std::holds_alternative<double>(value)) {
-            structValue.fields[fieldName] = std::get<double>(value);
-        } else if (std::holds_alternative<std::string>(value)) {
-            structValue.fields[fieldName] = std::get<std::string>(value);
-        } else if (std::holds_alternative<bool>(value)) {
-            structValue.fields[fieldName] = std::get<bool>(value);
-        } else {
-            throw RuntimeError("Unsupported value type for struct field");
-        }
+        structValue.fields[i] = valueToField(evaluate(*node.values[i]));
     }
     
-    lastValue = structValue;
+    lastValue = std::move(structValue);
 }
 
 void Interpreter::visit(GLMConstructorExpr& node) {
@@ -1403,10 +2731,10 @@ void Interpreter::visit(GLMConstructorExpr& node) {
             ValueType x_val = evaluate(*node.arguments[0]);
             ValueType y_val = evaluate(*node.arguments[1]);
             
-            float x = std::holds_alternative<double>(x_val) ? static_cast<float>(std::get<double>(x_val)) :
-                     std::holds_alternative<int>(x_val) ? static_cast<float>(std::get<int>(x_val)) : 0.0f;
-            float y = std::holds_alternative<double>(y_val) ? static_cast<float>(std::get<double>(y_val)) :
-                     std::holds_alternative<int>(y_val) ? static_cast<float>(std::get<int>(y_val)) : 0.0f;
+            float x = rbasic::holds_alternative<double>(x_val) ? static_cast<float>(rbasic::get<double>(x_val)) :
+                     rbasic::holds_alternative<int>(x_val) ? static_cast<float>(rbasic::get<int>(x_val)) : 0.0f;
+            float y = rbasic::holds_alternative<double>(y_val) ? static_cast<float>(rbasic::get<double>(y_val)) :
+                     rbasic::holds_alternative<int>(y_val) ? static_cast<float>(rbasic::get<int>(y_val)) : 0.0f;
             
             lastValue = Vec2Value(x, y);
             break;
@@ -1419,12 +2747,12 @@ void Interpreter::visit(GLMConstructorExpr& node) {
             ValueType y_val = evaluate(*node.arguments[1]);
             ValueType z_val = evaluate(*node.arguments[2]);
             
-            float x = std::holds_alternative<double>(x_val) ? static_cast<float>(std::get<double>(x_val)) :
-                     std::holds_alternative<int>(x_val) ? static_cast<float>(std::get<int>(x_val)) : 0.0f;
-            float y = std::holds_alternative<double>(y_val) ? static_cast<float>(std::get<double>(y_val)) :
-                     std::holds_alternative<int>(y_val) ? static_cast<float>(std::get<int>(y_val)) : 0.0f;
-            float z = std::holds_alternative<double>(z_val) ? static_cast<float>(std::get<double>(z_val)) :
-                     std::holds_alternative<int>(z_val) ? static_cast<float>(std::get<int>(z_val)) : 0.0f;
+            float x = rbasic::holds_alternative<double>(x_val) ? static_cast<float>(rbasic::get<double>(x_val)) :
+                     rbasic::holds_alternative<int>(x_val) ? static_cast<float>(rbasic::get<int>(x_val)) : 0.0f;
+            float y = rbasic::holds_alternative<double>(y_val) ? static_cast<float>(rbasic::get<double>(y_val)) :
+                     rbasic::holds_alternative<int>(y_val) ? static_cast<float>(rbasic::get<int>(y_val)) : 0.0f;
+            float z = rbasic::holds_alternative<double>(z_val) ? static_cast<float>(rbasic::get<double>(z_val)) :
+                     rbasic::holds_alternative<int>(z_val) ? static_cast<float>(rbasic::get<int>(z_val)) : 0.0f;
             
             lastValue = Vec3Value(x, y, z);
             break;
@@ -1438,14 +2766,14 @@ void Interpreter::visit(GLMConstructorExpr& node) {
             ValueType z_val = evaluate(*node.arguments[2]);
             ValueType w_val = evaluate(*node.arguments[3]);
             
-            float x = std::holds_alternative<double>(x_val) ? static_cast<float>(std::get<double>(x_val)) :
-                     std::holds_alternative<int>(x_val) ? static_cast<float>(std::get<int>(x_val)) : 0.0f;
-            float y = std::holds_alternative<double>(y_val) ? static_cast<float>(std::get<double>(y_val)) :
-                     std::holds_alternative<int>(y_val) ? static_cast<float>(std::get<int>(y_val)) : 0.0f;
-            float z = std::holds_alternative<double>(z_val) ? static_cast<float>(std::get<double>(z_val)) :
-                     std::holds_alternative<int>(z_val) ? static_cast<float>(std::get<int>(z_val)) : 0.0f;
-            float w = std::holds_alternative<double>(w_val) ? static_cast<float>(std::get<double>(w_val)) :
-                     std::holds_alternative<int>(w_val) ? static_cast<float>(std::get<int>(w_val)) : 0.0f;
+            float x = rbasic::holds_alternative<double>(x_val) ? static_cast<float>(rbasic::get<double>(x_val)) :
+                     rbasic::holds_alternative<int>(x_val) ? static_cast<float>(rbasic::get<int>(x_val)) : 0.0f;
+            float y = rbasic::holds_alternative<double>(y_val) ? static_cast<float>(rbasic::get<double>(y_val)) :
+                     rbasic::holds_alternative<int>(y_val) ? static_cast<float>(rbasic::get<int>(y_val)) : 0.0f;
+            float z = rbasic::holds_alternative<double>(z_val) ? static_cast<float>(rbasic::get<double>(z_val)) :
+                     rbasic::holds_alternative<int>(z_val) ? static_cast<float>(rbasic::get<int>(z_val)) : 0.0f;
+            float w = rbasic::holds_alternative<double>(w_val) ? static_cast<float>(rbasic::get<double>(w_val)) :
+                     rbasic::holds_alternative<int>(w_val) ? static_cast<float>(rbasic::get<int>(w_val)) : 0.0f;
             
             lastValue = Vec4Value(x, y, z, w);
             break;
@@ -1457,8 +2785,8 @@ void Interpreter::visit(GLMConstructorExpr& node) {
                 std::vector<float> elements;
                 for (int i = 0; i < 9; i++) {
                     ValueType val = evaluate(*node.arguments[i]);
-                    float f = std::holds_alternative<double>(val) ? static_cast<float>(std::get<double>(val)) :
-                             std::holds_alternative<int>(val) ? static_cast<float>(std::get<int>(val)) : 0.0f;
+                    float f = rbasic::holds_alternative<double>(val) ? static_cast<float>(rbasic::get<double>(val)) :
+                             rbasic::holds_alternative<int>(val) ? static_cast<float>(rbasic::get<int>(val)) : 0.0f;
                     elements.push_back(f);
                 }
                 glm::mat3 mat(elements[0], elements[1], elements[2], 
@@ -1477,8 +2805,8 @@ void Interpreter::visit(GLMConstructorExpr& node) {
                 std::vector<float> elements;
                 for (int i = 0; i < 16; i++) {
                     ValueType val = evaluate(*node.arguments[i]);
-                    float f = std::holds_alternative<double>(val) ? static_cast<float>(std::get<double>(val)) :
-                             std::holds_alternative<int>(val) ? static_cast<float>(std::get<int>(val)) : 0.0f;
+                    float f = rbasic::holds_alternative<double>(val) ? static_cast<float>(rbasic::get<double>(val)) :
+                             rbasic::holds_alternative<int>(val) ? static_cast<float>(rbasic::get<int>(val)) : 0.0f;
                     elements.push_back(f);
                 }
                 glm::mat4 mat(elements[0], elements[1], elements[2], elements[3],
@@ -1500,14 +2828,14 @@ void Interpreter::visit(GLMConstructorExpr& node) {
                 ValueType y_val = evaluate(*node.arguments[2]);
                 ValueType z_val = evaluate(*node.arguments[3]);
                 
-                float w = std::holds_alternative<double>(w_val) ? static_cast<float>(std::get<double>(w_val)) :
-                         std::holds_alternative<int>(w_val) ? static_cast<float>(std::get<int>(w_val)) : 1.0f;
-                float x = std::holds_alternative<double>(x_val) ? static_cast<float>(std::get<double>(x_val)) :
-                         std::holds_alternative<int>(x_val) ? static_cast<float>(std::get<int>(x_val)) : 0.0f;
-                float y = std::holds_alternative<double>(y_val) ? static_cast<float>(std::get<double>(y_val)) :
-                         std::holds_alternative<int>(y_val) ? static_cast<float>(std::get<int>(y_val)) : 0.0f;
-                float z = std::holds_alternative<double>(z_val) ? static_cast<float>(std::get<double>(z_val)) :
-                         std::holds_alternative<int>(z_val) ? static_cast<float>(std::get<int>(z_val)) : 0.0f;
+                float w = rbasic::holds_alternative<double>(w_val) ? static_cast<float>(rbasic::get<double>(w_val)) :
+                         rbasic::holds_alternative<int>(w_val) ? static_cast<float>(rbasic::get<int>(w_val)) : 1.0f;
+                float x = rbasic::holds_alternative<double>(x_val) ? static_cast<float>(rbasic::get<double>(x_val)) :
+                         rbasic::holds_alternative<int>(x_val) ? static_cast<float>(rbasic::get<int>(x_val)) : 0.0f;
+                float y = rbasic::holds_alternative<double>(y_val) ? static_cast<float>(rbasic::get<double>(y_val)) :
+                         rbasic::holds_alternative<int>(y_val) ? static_cast<float>(rbasic::get<int>(y_val)) : 0.0f;
+                float z = rbasic::holds_alternative<double>(z_val) ? static_cast<float>(rbasic::get<double>(z_val)) :
+                         rbasic::holds_alternative<int>(z_val) ? static_cast<float>(rbasic::get<int>(z_val)) : 0.0f;
                 
                 lastValue = QuatValue(w, x, y, z);
             } else {
@@ -1523,188 +2851,100 @@ void Interpreter::visit(GLMConstructorExpr& node) {
 void Interpreter::visit(GLMComponentAccessExpr& node) {
     ValueType objectValue = evaluate(*node.object);
     
-    if (std::holds_alternative<Vec2Value>(objectValue)) {
-        const Vec2Value& vec = std::get<Vec2Value>(objectValue);
-        if (node.component == "x") {
-            lastValue = static_cast<double>(vec.data.x);
-        } else if (node.component == "y") {
-            lastValue = static_cast<double>(vec.data.y);
-        } else {
-            throw RuntimeError("Invalid component '" + node.component + "' for vec2");
-        }
-    } else if (std::holds_alternative<Vec3Value>(objectValue)) {
-        const Vec3Value& vec = std::get<Vec3Value>(objectValue);
-        if (node.component == "x") {
-            lastValue = static_cast<double>(vec.data.x);
-        } else if (node.component == "y") {
-            lastValue = static_cast<double>(vec.data.y);
-        } else if (node.component == "z") {
-            lastValue = static_cast<double>(vec.data.z);
-        } else {
-            throw RuntimeError("Invalid component '" + node.component + "' for vec3");
-        }
-    } else if (std::holds_alternative<Vec4Value>(objectValue)) {
-        const Vec4Value& vec = std::get<Vec4Value>(objectValue);
-        if (node.component == "x") {
-            lastValue = static_cast<double>(vec.data.x);
-        } else if (node.component == "y") {
-            lastValue = static_cast<double>(vec.data.y);
-        } else if (node.component == "z") {
-            lastValue = static_cast<double>(vec.data.z);
-        } else if (node.component == "w") {
-            lastValue = static_cast<double>(vec.data.w);
-        } else {
-            throw RuntimeError("Invalid component '" + node.component + "' for vec4");
-        }
-    } else {
+    if (!withVec(objectValue, [&](const auto& vec) { lastValue = readSwizzle(vec, node.swizzle, node.component); })) {
         throw RuntimeError("Component access not supported for this type");  
     }
 }
 
 void Interpreter::visit(MemberAccessExpr& node) {
-    ValueType objectValue = evaluate(*node.object);
+    // arr[i].field and arr.field on a struct array read the column directly
+    auto* varExpr = dynamic_cast<VariableExpr*>(node.object.get());
+    if (varExpr && varExpr->member.empty() &&
+        rbasic::get_if<StructArrayValue>(static_cast<const ValueType*>(findVariable(varExpr->name)))) {
+        ScratchPool<int>::Lease indexLease(indexPool);
+        const std::vector<int>& indices = evaluateIndices(varExpr->indices, *indexLease);
+        auto* structArray = rbasic::get_if<StructArrayValue>(static_cast<const ValueType*>(findVariable(varExpr->name)));
+        if (!structArray) {
+            throw RuntimeError("Variable '" + varExpr->name + "' is not an array");
+        }
+        if (indices.empty()) {
+            lastValue = structArrayColumnValue(*structArray, node.member);
+        } else {
+            size_t index = structArrayIndex(*structArray, indices);
+            int field = cachedFieldIndex(node.fieldCache, structArray->layout, node.member);
+            lastValue = fieldToValue(structArray->columns[field].get(index));
+        }
+        return;
+    }
     
-    // Check if this is GLM component access first
-    if ((node.member == "x" || node.member == "y" || node.member == "z" || node.member == "w") &&
-        (std::holds_alternative<Vec2Value>(objectValue) || std::holds_alternative<Vec3Value>(objectValue) || std::holds_alternative<Vec4Value>(objectValue))) {
-        
-        // Handle GLM component access
-        if (std::holds_alternative<Vec2Value>(objectValue)) {
-            const Vec2Value& vec = std::get<Vec2Value>(objectValue);
-            if (node.member == "x") {
-                lastValue = static_cast<double>(vec.data.x);
-            } else if (node.member == "y") {
-                lastValue = static_cast<double>(vec.data.y);
-            } else {
-                throw RuntimeError("Invalid component '" + node.member + "' for vec2");
-            }
-        } else if (std::holds_alternative<Vec3Value>(objectValue)) {
-            const Vec3Value& vec = std::get<Vec3Value>(objectValue);
-            if (node.member == "x") {
-                lastValue = static_cast<double>(vec.data.x);
-            } else if (node.member == "y") {
-                lastValue = static_cast<double>(vec.data.y);
-            } else if (node.member == "z") {
-                lastValue = static_cast<double>(vec.data.z);
-            } else {
-                throw RuntimeError("Invalid component '" + node.member + "' for vec3");
-            }
-        } else if (std::holds_alternative<Vec4Value>(objectValue)) {
-            const Vec4Value& vec = std::get<Vec4Value>(objectValue);
-            if (node.member == "x") {
-                lastValue = static_cast<double>(vec.data.x);
-            } else if (node.member == "y") {
-                lastValue = static_cast<double>(vec.data.y);
-            } else if (node.member == "z") {
-                lastValue = static_cast<double>(vec.data.z);
-            } else if (node.member == "w") {
-                lastValue = static_cast<double>(vec.data.w);
-            } else {
-                throw RuntimeError("Invalid component '" + node.member + "' for vec4");
-            }
+    // s.field on a struct variable is an indexed load without copying the struct
+    if (varExpr && varExpr->member.empty() && varExpr->indices.empty()) {
+        const ValueType* variable = findVariable(varExpr->name);
+        if (auto* structVal = rbasic::get_if<StructValue>(variable)) {
+            lastValue = fieldToValue(cachedField(*structVal, node.fieldCache, node.member));
+            return;
         }
-    } else if (std::holds_alternative<StructValue>(objectValue)) {
-        // Handle struct member access
-        const StructValue& structVal = std::get<StructValue>(objectValue);
-        auto it = structVal.fields.find(node.member);
-        if (it != structVal.fields.end()) {
-            // Convert from struct field variant to ValueType
-            auto& fieldValue = it->second;
-            if (std::holds_alternative<int>(fieldValue)) {
-                lastValue = std::get<int>(fieldValue);
-            } else if (std::holds_alternative<double>(fieldValue)) {
-                lastValue = std::get<double>(fieldValue);
-            } else if (std::holds_alternative<std::string>(fieldValue)) {
-                lastValue = std::get<std::string>(fieldValue);
-            } else if (std::holds_alternative<bool>(fieldValue)) {
-                lastValue = std::get<bool>(fieldValue);
+    }
+    
+    // Vector lanes and swizzles are read in place: v.x, v.zyx, pts[i].xy
+    if (varExpr && varExpr->member.empty() && node.swizzle.valid()) {
+        if (const ValueType* target = findVariable(varExpr->name)) {
+            auto read = [&](const auto& vec) { lastValue = readSwizzle(vec, node.swizzle, node.member); };
+            if (varExpr->indices.empty() ? withVec(*target, read) : withVecArray(*target, [&](const auto& array) {
+                    ScratchPool<int>::Lease indexLease(indexPool);
+                    read(array.elements[vecArrayIndex(array, evaluateIndices(varExpr->indices, *indexLease))]);
+                })) {
+                return;
             }
-        } else {
-            throw RuntimeError("Struct member '" + node.member + "' not found");
         }
+    }
+    
+    ValueType objectValue = evaluate(*node.object);
+    
+    if (node.swizzle.valid() &&
+        withVec(objectValue, [&](const auto& vec) { lastValue = readSwizzle(vec, node.swizzle, node.member); })) {
+        return;
+    } else if (auto* structVal = rbasic::get_if<StructValue>(&objectValue)) {
+        // Handle struct member access
+        lastValue = fieldToValue(cachedField(*structVal, node.fieldCache, node.member));
     } else {
         throw RuntimeError("Member access is only supported on struct and GLM vector types");
     }
 }
 
 void Interpreter::visit(ExpressionStmt& node) {
+    // A plain assignment as a statement moves its value into the variable,
+    // with no copy kept as the result of the expression
+    auto* assignment = dynamic_cast<AssignExpr*>(node.expression.get());
+    if (assignment && assignment->indices.empty()) {
+        setCurrentPosition(assignment->getPosition());
+        setVariable(assignment->variable, evaluate(*assignment->value));
+        return;
+    }
     evaluate(*node.expression);
 }
 
 void Interpreter::visit(VarStmt& node) {
     ValueType value = evaluate(*node.value);
     
-    // Handle struct member assignment
+    // Handle struct member assignment in place
     if (!node.member.empty()) {
-        ValueType structVar = getVariable(node.variable);
-        if (std::holds_alternative<StructValue>(structVar)) {
-            StructValue structVal = std::get<StructValue>(structVar);
-            
-            // Convert ValueType to simple variant for storage
-            if (std::holds_alternative<int>(value)) {
-                structVal.fields[node.member] = std::get<int>(value);
-            } else if (std::holds_alternative<double>(value)) {
-                structVal.fields[node.member] = std::get<double>(value);
-            } else if (std::holds_alternative<std::string>(value)) {
-                structVal.fields[node.member] = std::get<std::string>(value);
-            } else if (std::holds_alternative<bool>(value)) {
-                structVal.fields[node.member] = std::get<bool>(value);
-            }
-            
-            defineVariable(node.variable, structVal);  // Update the variable
-        } else {
+        ValueType* variable = findVariable(node.variable);
+        if (!variable) {
+            throw RuntimeError("Undefined variable '" + node.variable + "'", getCurrentPosition());
+        }
+        auto* structVal = rbasic::get_if<StructValue>(variable);
+        if (!structVal) {
             throw RuntimeError("Variable '" + node.variable + "' is not a struct");
         }
+        cachedField(*structVal, node.memberCache, node.member) = valueToField(value);
     }
     // Handle array assignment
     else if (!node.indices.empty()) {
-        ValueType arrayVar = getVariable(node.variable);
-        
-        // Evaluate all indices
-        std::vector<int> indices;
-        for (auto& indexExpr : node.indices) {
-            indices.push_back(TypeUtils::toArrayIndex(evaluate(*indexExpr)));
-        }
-        
-        if (std::holds_alternative<ArrayValue>(arrayVar)) {
-            ArrayValue array = std::get<ArrayValue>(arrayVar);
-            int flatIndex = array.calculateIndex(indices);
-            
-            // Convert ValueType to simple variant for storage
-            if (std::holds_alternative<int>(value)) {
-                array.elements[flatIndex] = std::get<int>(value);
-            } else if (std::holds_alternative<double>(value)) {
-                array.elements[flatIndex] = std::get<double>(value);
-            } else if (std::holds_alternative<std::string>(value)) {
-                array.elements[flatIndex] = std::get<std::string>(value);
-            } else if (std::holds_alternative<bool>(value)) {
-                array.elements[flatIndex] = std::get<bool>(value);
-            } else if (std::holds_alternative<StructValue>(value)) {
-                array.elements[flatIndex] = std::get<StructValue>(value);
-            }
-            
-            setVariable(node.variable, array);  // Use setVariable instead of defineVariable
-        } else if (std::holds_alternative<ByteArrayValue>(arrayVar)) {
-            ByteArrayValue array = std::get<ByteArrayValue>(arrayVar);
-            uint8_t byteValue = TypeUtils::getValue<uint8_t>(value);
-            array.at(indices) = byteValue;
-            setVariable(node.variable, array);
-        } else if (std::holds_alternative<IntArrayValue>(arrayVar)) {
-            IntArrayValue array = std::get<IntArrayValue>(arrayVar);
-            int intValue = TypeUtils::toInt(value);
-            array.at(indices) = intValue;
-            setVariable(node.variable, array);
-        } else if (std::holds_alternative<DoubleArrayValue>(arrayVar)) {
-            DoubleArrayValue array = std::get<DoubleArrayValue>(arrayVar);
-            double doubleValue = TypeUtils::toDouble(value);
-            array.at(indices) = doubleValue;
-            setVariable(node.variable, array);
-        } else {
-            throw RuntimeError("Variable '" + node.variable + "' is not an array");
-        }
+        setArrayElement(node.variable, node.indices, value);
     } else {
         // Regular variable assignment
-        defineVariable(node.variable, value);
+        defineVariable(node.variable, std::move(value));
     }
 }
 
@@ -1722,33 +2962,20 @@ void Interpreter::visit(PrintStmt& node) {
 void Interpreter::visit(InputStmt& node) {
     std::string input_text = ioHandler->input();
     
-    // Try to parse as number first
-    ValueType value;
-    try {
-        if (hasDecimalPoint(input_text)) {
-            // Contains decimal point, parse as double
-            value = std::stod(input_text);
-        } else {
-            // Try to parse as integer
-            value = std::stoi(input_text);
-        }
-    } catch (const std::exception&) {
-        // If parsing fails, store as string
-        value = input_text;
-    }
-    
-    setVariable(node.variable, value);
+    setVariable(node.variable, numberOrString(input_text));
 }
 
 void Interpreter::visit(IfStmt& node) {
     ValueType condition = evaluate(*node.condition);
+    bool taken = isTruthy(condition);
+    countBranch(node, taken ? 0 : 1);
     
-    if (isTruthy(condition)) {
+    if (taken) {
         // Create new scope for the then branch
         pushScope();
         
         for (auto& stmt : node.thenBranch) {
-            stmt->accept(*this);
+            execute(*stmt);
             if (hasReturned) {
                 popScope();
                 return;
@@ -1762,7 +2989,7 @@ void Interpreter::visit(IfStmt& node) {
         pushScope();
         
         for (auto& stmt : node.elseBranch) {
-            stmt->accept(*this);
+            execute(*stmt);
             if (hasReturned) {
                 popScope();
                 return;
@@ -1793,9 +3020,10 @@ void Interpreter::visit(ModernForStmt& node) {
     
     // Execute the loop
     while (isTruthy(evaluate(*node.condition))) {
+        countBranch(node, 0);
         // Execute body - can access all parent scope variables
         for (auto& stmt : node.body) {
-            stmt->accept(*this);
+            execute(*stmt);
             if (hasReturned) {
                 // Restore on early return
                 if (hadVariable) {
@@ -1808,6 +3036,7 @@ void Interpreter::visit(ModernForStmt& node) {
         // Execute increment
         evaluate(*node.increment);
     }
+    countBranch(node, 1);
     
     // Restore or remove loop variable
     if (hadVariable) {
@@ -1822,14 +3051,16 @@ void Interpreter::visit(ModernForStmt& node) {
 
 void Interpreter::visit(WhileStmt& node) {
     while (isTruthy(evaluate(*node.condition))) {
+        countBranch(node, 0);
         // Execute while block without creating new scope for now
         for (auto& stmt : node.body) {
-            stmt->accept(*this);
+            execute(*stmt);
             if (hasReturned) {
                 return;
             }
         }
     }
+    countBranch(node, 1);
 }
 
 void Interpreter::visit(ReturnStmt& node) {
@@ -1842,18 +3073,22 @@ void Interpreter::visit(ReturnStmt& node) {
 }
 
 void Interpreter::visit(FunctionDecl& node) {
-    functions[node.name] = std::make_unique<FunctionDecl>(
-        node.name, node.parameters, node.paramTypes, node.returnType, std::vector<std::unique_ptr<Statement>>());
-    
-    // Move the body statements
-    for (auto& stmt : node.body) {
-        functions[node.name]->body.push_back(std::move(stmt));
-    }
+    // The definition takes the body over in one move. A declaration run again
+    // (inside a loop, or by :bench in the REPL) has no body left, so it
+    // defines the function it made the first time.
+    if (!node.definition) {
+        node.definition = std::make_shared<FunctionDecl>(
+            node.name, node.parameters, node.paramTypes, node.returnType, std::move(node.body));
+        node.definition->setPosition(node.getPosition());
+        node.definition->coverageSlot = node.coverageSlot;
+    }
+    functions[node.name] = node.definition;
 }
 
 void Interpreter::visit(StructDecl& node) {
-    structs[node.name] = std::make_unique<StructDecl>(
-        node.name, node.fields, node.fieldTypes);
+    auto decl = std::make_unique<StructDecl>(node.name, node.fields, node.fieldTypes);
+    decl->layout = node.layout;  // Instances share the declaration's layout
+    structs[node.name] = std::move(decl);
 }
 
 void Interpreter::visit(DimStmt& node) {
@@ -1871,23 +3106,20 @@ void Interpreter::visit(DimStmt& node) {
             // Check if it's a defined struct type
             auto structIt = structs.find(node.type);
             if (structIt != structs.end()) {
-                StructValue structInstance(node.type);
+                StructValue structInstance(structIt->second->layout);
                 
                 // Initialize struct fields with default values
-                for (size_t i = 0; i < structIt->second->fields.size(); i++) {
-                    const std::string& fieldName = structIt->second->fields[i];
+                for (size_t i = 0; i < structIt->second->fieldTypes.size(); i++) {
                     const std::string& fieldType = structIt->second->fieldTypes[i];
                     
-                    if (fieldType == "integer") {
-                        structInstance.fields[fieldName] = 0;
-                    } else if (fieldType == "double") {
-                        structInstance.fields[fieldName] = 0.0;
+                    if (fieldType == "double") {
+                        structInstance.fields[i] = 0.0;
                     } else if (fieldType == "string") {
-                        structInstance.fields[fieldName] = std::string("");
+                        structInstance.fields[i] = std::string("");
                     } else if (fieldType == "boolean") {
-                        structInstance.fields[fieldName] = false;
+                        structInstance.fields[i] = false;
                     } else {
-                        structInstance.fields[fieldName] = 0; // Default for unknown types
+                        structInstance.fields[i] = 0; // integer and unknown types
                     }
                 }
                 
@@ -1904,6 +3136,13 @@ void Interpreter::visit(DimStmt& node) {
             dimensions.push_back(TypeUtils::toInt(evaluate(*dimExpr)));
         }
         
+        // Arrays of a declared struct type get column storage
+        auto structIt = structs.find(node.type);
+        if (structIt != structs.end()) {
+            defineVariable(node.variable, StructArrayValue(structIt->second->layout, dimensions));
+            return;
+        }
+        
         ArrayValue array(dimensions);
         defineVariable(node.variable, array);
     }
@@ -1940,14 +3179,20 @@ void Interpreter::visit(ImportStmt& node) {
         // Parse the imported file
         Lexer lexer(source);
         auto tokens = lexer.tokenize();
-        Parser parser(tokens);
+        Parser parser(tokens, filepath);
         auto program = parser.parse();
+        if (coverage) {
+            coverage->addProgram(*program);
+        }
         
         // Execute the imported file in current context
         program->accept(*this);
         
         // Mark as imported
         importedFiles.insert(filepath);
+        if (hotReload) {
+            hotReload->watch(filepath);
+        }
         
     } catch (const std::exception& e) {
         importStack.erase(filepath);
@@ -1959,11 +3204,46 @@ void Interpreter::visit(ImportStmt& node) {
 
 void Interpreter::visit(Program& node) {
     for (auto& stmt : node.statements) {
-        stmt->accept(*this);
+        execute(*stmt);
         if (hasReturned) break;
     }
 }
 
+// Only function declarations are taken from a changed file. Its other
+// statements are not run again, so globals keep their values, and a file
+// that fails to parse leaves every function as it was.
+void Interpreter::reloadChangedFiles() {
+    for (const std::string& path : hotReload->takeChanged()) {
+        std::unique_ptr<Program> program;
+        try {
+            std::ifstream file(path);
+            if (!file.is_open()) {
+                throw std::runtime_error("cannot open file");
+            }
+            std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            Lexer lexer(source);
+            Parser parser(lexer.tokenize(), path);
+            program = parser.parse();
+        } catch (const std::exception& e) {
+            std::cerr << "watch: " << path << ": " << e.what() << "; keeping the running functions" << std::endl;
+            continue;
+        }
+        
+        int reloaded = 0;
+        for (auto& stmt : program->statements) {
+            if (auto* func = dynamic_cast<FunctionDecl*>(stmt.get())) {
+                auto old = functions.find(func->name);
+                if (old != functions.end()) {
+                    hotReload->retire(old->second);
+                }
+                visit(*func);
+                reloaded++;
+            }
+        }
+        std::cerr << "watch: reloaded " << reloaded << " function(s) from " << path << std::endl;
+    }
+}
+
 std::string Interpreter::resolveImportPath(const std::string& filename) {
     // If absolute path, use as-is
     if (std::filesystem::path(filename).is_absolute()) {
@@ -2072,9 +3352,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("gpio_set_mode requires 2 arguments (pin, mode)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int pin = std::get<int>(lastValue);
+        int pin = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int mode = std::get<int>(lastValue);
+        int mode = rbasic::get<int>(lastValue);
         int result = rpi::gpio_set_mode(pin, mode);
         lastValue = result;
         return true;
@@ -2084,9 +3364,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("gpio_set_pull requires 2 arguments (pin, pull)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int pin = std::get<int>(lastValue);
+        int pin = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int pull = std::get<int>(lastValue);
+        int pull = rbasic::get<int>(lastValue);
         int result = rpi::gpio_set_pull(pin, pull);
         lastValue = result;
         return true;
@@ -2096,9 +3376,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("gpio_write requires 2 arguments (pin, value)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int pin = std::get<int>(lastValue);
+        int pin = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int value = std::get<int>(lastValue);
+        int value = rbasic::get<int>(lastValue);
         int result = rpi::gpio_write(pin, value);
         lastValue = result;
         return true;
@@ -2108,7 +3388,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("gpio_read requires 1 argument (pin)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int pin = std::get<int>(lastValue);
+        int pin = rbasic::get<int>(lastValue);
         int result = rpi::gpio_read(pin);
         lastValue = result;
         return true;
@@ -2120,9 +3400,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("spi_open requires 2 arguments (bus, cs)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int bus = std::get<int>(lastValue);
+        int bus = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int cs = std::get<int>(lastValue);
+        int cs = rbasic::get<int>(lastValue);
         int result = rpi::spi_open(bus, cs);
         lastValue = result;
         return true;
@@ -2132,7 +3412,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("spi_close requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         rpi::spi_close(handle);
         lastValue = 0;
         return true;
@@ -2142,9 +3422,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("spi_set_speed requires 2 arguments (handle, speed)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int speed = std::get<int>(lastValue);
+        int speed = rbasic::get<int>(lastValue);
         int result = rpi::spi_set_speed(handle, speed);
         lastValue = result;
         return true;
@@ -2154,9 +3434,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("spi_write_byte requires 2 arguments (handle, byte)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int byte = std::get<int>(lastValue);
+        int byte = rbasic::get<int>(lastValue);
         int result = rpi::spi_write_byte(handle, byte);
         lastValue = result;
         return true;
@@ -2166,7 +3446,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("spi_read_byte requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         int result = rpi::spi_read_byte(handle);
         lastValue = result;
         return true;
@@ -2178,7 +3458,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_open requires 1 argument (bus)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int bus = std::get<int>(lastValue);
+        int bus = rbasic::get<int>(lastValue);
         int result = rpi::i2c_open(bus);
         lastValue = result;
         return true;
@@ -2188,7 +3468,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_close requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         rpi::i2c_close(handle);
         lastValue = 0;
         return true;
@@ -2198,9 +3478,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_set_address requires 2 arguments (handle, address)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int address = std::get<int>(lastValue);
+        int address = rbasic::get<int>(lastValue);
         int result = rpi::i2c_set_address(handle, address);
         lastValue = result;
         return true;
@@ -2210,9 +3490,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_write_byte requires 2 arguments (handle, value)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int value = std::get<int>(lastValue);
+        int value = rbasic::get<int>(lastValue);
         int result = rpi::i2c_write_byte(handle, value);
         lastValue = result;
         return true;
@@ -2222,7 +3502,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_read_byte requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         int result = rpi::i2c_read_byte(handle);
         lastValue = result;
         return true;
@@ -2232,11 +3512,11 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_write_reg requires 3 arguments (handle, reg, value)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int reg = std::get<int>(lastValue);
+        int reg = rbasic::get<int>(lastValue);
         node.arguments[2]->accept(*this);
-        int value = std::get<int>(lastValue);
+        int value = rbasic::get<int>(lastValue);
         int result = rpi::i2c_write_reg(handle, reg, value);
         lastValue = result;
         return true;
@@ -2246,9 +3526,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("i2c_read_reg requires 2 arguments (handle, reg)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int reg = std::get<int>(lastValue);
+        int reg = rbasic::get<int>(lastValue);
         int result = rpi::i2c_read_reg(handle, reg);
         lastValue = result;
         return true;
@@ -2260,7 +3540,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("pwm_init requires 1 argument (channel)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int channel = std::get<int>(lastValue);
+        int channel = rbasic::get<int>(lastValue);
         int result = rpi::pwm_init(channel);
         lastValue = result;
         return true;
@@ -2270,7 +3550,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("pwm_cleanup requires 1 argument (channel)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int channel = std::get<int>(lastValue);
+        int channel = rbasic::get<int>(lastValue);
         rpi::pwm_cleanup(channel);
         lastValue = 0;
         return true;
@@ -2280,9 +3560,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("pwm_set_frequency requires 2 arguments (channel, frequency)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int channel = std::get<int>(lastValue);
+        int channel = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int frequency = std::get<int>(lastValue);
+        int frequency = rbasic::get<int>(lastValue);
         int result = rpi::pwm_set_frequency(channel, frequency);
         lastValue = result;
         return true;
@@ -2292,9 +3572,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("pwm_set_duty_cycle requires 2 arguments (channel, percent)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int channel = std::get<int>(lastValue);
+        int channel = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        double percent = std::holds_alternative<int>(lastValue) ? static_cast<double>(std::get<int>(lastValue)) : std::get<double>(lastValue);
+        double percent = rbasic::holds_alternative<int>(lastValue) ? static_cast<double>(rbasic::get<int>(lastValue)) : rbasic::get<double>(lastValue);
         int result = rpi::pwm_set_duty_cycle(channel, percent);
         lastValue = result;
         return true;
@@ -2304,7 +3584,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("pwm_enable requires 1 argument (channel)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int channel = std::get<int>(lastValue);
+        int channel = rbasic::get<int>(lastValue);
         int result = rpi::pwm_enable(channel);
         lastValue = result;
         return true;
@@ -2314,7 +3594,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("pwm_disable requires 1 argument (channel)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int channel = std::get<int>(lastValue);
+        int channel = rbasic::get<int>(lastValue);
         int result = rpi::pwm_disable(channel);
         lastValue = result;
         return true;
@@ -2326,7 +3606,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_open requires 1 argument (device)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        std::string device = std::get<std::string>(lastValue);
+        std::string device = rbasic::get<std::string>(std::move(lastValue));
         int result = rpi::serial_open(device.c_str());
         lastValue = result;
         return true;
@@ -2336,7 +3616,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_close requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         rpi::serial_close(handle);
         lastValue = 0;
         return true;
@@ -2346,9 +3626,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_set_baud requires 2 arguments (handle, baud)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int baud = std::get<int>(lastValue);
+        int baud = rbasic::get<int>(lastValue);
         int result = rpi::serial_set_baud(handle, baud);
         lastValue = result;
         return true;
@@ -2358,9 +3638,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_write_byte requires 2 arguments (handle, byte)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        int byte = std::get<int>(lastValue);
+        int byte = rbasic::get<int>(lastValue);
         int result = rpi::serial_write_byte(handle, byte);
         lastValue = result;
         return true;
@@ -2370,7 +3650,7 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_read_byte requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         int result = rpi::serial_read_byte(handle);
         lastValue = result;
         return true;
@@ -2380,9 +3660,9 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_write_string requires 2 arguments (handle, string)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         node.arguments[1]->accept(*this);
-        std::string str = std::get<std::string>(lastValue);
+        std::string str = rbasic::get<std::string>(std::move(lastValue));
         int result = rpi::serial_write_string(handle, str.c_str());
         lastValue = result;
         return true;
@@ -2392,11 +3672,20 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("serial_available requires 1 argument (handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int handle = std::get<int>(lastValue);
+        int handle = rbasic::get<int>(lastValue);
         int result = rpi::serial_available(handle);
         lastValue = result;
         return true;
     }
+    if (fname == "event_watch_serial") {
+        if (node.arguments.size() != 1) {
+            throw RuntimeError("event_watch_serial requires 1 argument (handle)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this);
+        int handle = rbasic::get<int>(lastValue);
+        lastValue = EventWait::instance().watchDescriptor(rpi::serial_fd(handle));
+        return true;
+    }
     
     return false; // Function not recognized
 #else
@@ -2405,26 +3694,66 @@ bool Interpreter::handleRPIFunctions([[maybe_unused]] CallExpr& node) {
 #endif
 }
 
-// Helper function to convert BasicValue (from basic_runtime) to ValueType (interpreter)
-static ValueType convertBasicValue(const BasicValue& bv) {
-    return std::visit([](auto&& arg) -> ValueType {
-        using T = std::decay_t<decltype(arg)>;
-        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, double> || 
-                      std::is_same_v<T, std::string> || std::is_same_v<T, bool> ||
-                      std::is_same_v<T, void*>) {
-            return arg;
-        } else {
-            // For complex types, we return 0 as placeholder
-            // In practice, SDL2/SQLite3 functions mostly return int/string
-            return 0;
+#if defined(SDL2_SUPPORT_ENABLED) || defined(SQLITE3_SUPPORT_ENABLED)
+// Helper function to convert BasicValue (from basic_runtime) to ValueType (interpreter).
+// Results are temporaries, so strings such as column text are moved, not copied.
+static ValueType convertBasicValue(BasicValue&& bv) {
+    // The scalar kinds both value types start with are taken over as they are
+    ValueType result;
+    if (result.adopt(std::move(bv))) {
+        return result;
+    }
+    // For complex types, we return 0 as placeholder
+    // In practice, SDL2/SQLite3 functions mostly return int/string
+    return 0;
+}
+#endif
+
+#ifdef SDL2_SUPPORT_ENABLED
+// Coordinates for the batched SDL primitives, read from the array in place.
+// A generic array's elements are converted into 'converted', which must
+// outlive the column. False if value is not an array.
+static bool drawColumn(const ValueType& value, basic_runtime::DrawColumn& column, size_t& length,
+                       std::vector<int>& converted) {
+    if (auto* ints = rbasic::get_if<IntArrayValue>(&value)) {
+        column = basic_runtime::draw_int_column(ints->elements);
+        length = ints->elements.size();
+    } else if (auto* doubles = rbasic::get_if<DoubleArrayValue>(&value)) {
+        column = basic_runtime::draw_double_column(doubles->elements);
+        length = doubles->elements.size();
+    } else if (auto* bytes = rbasic::get_if<ByteArrayValue>(&value)) {
+        column = basic_runtime::draw_byte_column(bytes->elements);
+        length = bytes->elements.size();
+    } else if (auto* array = rbasic::get_if<ArrayValue>(&value)) {
+        length = 1;
+        for (int dim : array->dimensions) {
+            length *= dim;
+        }
+        // Elements never assigned, and strings, read as 0
+        converted.assign(length, 0);
+        for (const auto& element : array->elements) {
+            if (element.first < 0 || static_cast<size_t>(element.first) >= length) {
+                continue;
+            } else if (auto* n = rbasic::get_if<int>(&element.second)) {
+                converted[element.first] = *n;
+            } else if (auto* d = rbasic::get_if<double>(&element.second)) {
+                converted[element.first] = static_cast<int>(*d);
+            } else if (auto* b = rbasic::get_if<bool>(&element.second)) {
+                converted[element.first] = *b ? 1 : 0;
+            }
         }
-    }, bv);
+        column = basic_runtime::draw_int_column(converted);
+    } else {
+        return false;
+    }
+    return true;
 }
+#endif
 
 // SDL2 Graphics Functions Handler
 bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
 #ifdef SDL2_SUPPORT_ENABLED
-    std::string fname = node.name;
+    const std::string& fname = node.name;
     
     // Core SDL functions
     if (fname == "sdl_init") {
@@ -2432,7 +3761,7 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sdl_init requires 1 argument (flags)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        int flags = std::get<int>(lastValue);
+        int flags = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_init(flags));
         return true;
     }
@@ -2451,12 +3780,12 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 6) {
             throw RuntimeError("sdl_create_window requires 6 arguments (title, x, y, w, h, flags)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); std::string title = std::get<std::string>(lastValue);
-        node.arguments[1]->accept(*this); int x = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int y = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int w = std::get<int>(lastValue);
-        node.arguments[4]->accept(*this); int h = std::get<int>(lastValue);
-        node.arguments[5]->accept(*this); int flags = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); std::string title = rbasic::get<std::string>(std::move(lastValue));
+        node.arguments[1]->accept(*this); int x = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int y = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int w = rbasic::get<int>(lastValue);
+        node.arguments[4]->accept(*this); int h = rbasic::get<int>(lastValue);
+        node.arguments[5]->accept(*this); int flags = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_create_window(title, x, y, w, h, flags));
         return true;
     }
@@ -2465,15 +3794,15 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sdl_destroy_window requires 1 argument (window_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sdl_destroy_window(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sdl_destroy_window(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sdl_set_window_title") {
         if (node.arguments.size() != 2) {
             throw RuntimeError("sdl_set_window_title requires 2 arguments (window_handle, title)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int handle = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); std::string title = std::get<std::string>(lastValue);
+        node.arguments[0]->accept(*this); int handle = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); std::string title = rbasic::get<std::string>(std::move(lastValue));
         lastValue = convertBasicValue(basic_runtime::func_sdl_set_window_title(handle, title));
         return true;
     }
@@ -2483,9 +3812,9 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 3) {
             throw RuntimeError("sdl_create_renderer requires 3 arguments (window_handle, index, flags)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int window = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int flags = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int window = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int flags = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_create_renderer(window, index, flags));
         return true;
     }
@@ -2494,7 +3823,7 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sdl_destroy_renderer requires 1 argument (renderer_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sdl_destroy_renderer(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sdl_destroy_renderer(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sdl_render_clear") {
@@ -2502,7 +3831,7 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sdl_render_clear requires 1 argument (renderer_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sdl_render_clear(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sdl_render_clear(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sdl_render_present") {
@@ -2510,18 +3839,18 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sdl_render_present requires 1 argument (renderer_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sdl_render_present(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sdl_render_present(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sdl_set_render_draw_color") {
         if (node.arguments.size() != 5) {
             throw RuntimeError("sdl_set_render_draw_color requires 5 arguments (renderer_handle, r, g, b, a)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int renderer = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int r = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int g = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int b = std::get<int>(lastValue);
-        node.arguments[4]->accept(*this); int a = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int r = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int g = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int b = rbasic::get<int>(lastValue);
+        node.arguments[4]->accept(*this); int a = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_set_render_draw_color(renderer, r, g, b, a));
         return true;
     }
@@ -2531,11 +3860,11 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 5) {
             throw RuntimeError("sdl_render_draw_line requires 5 arguments (renderer_handle, x1, y1, x2, y2)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int renderer = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int x1 = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int y1 = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int x2 = std::get<int>(lastValue);
-        node.arguments[4]->accept(*this); int y2 = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int x1 = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int y1 = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int x2 = rbasic::get<int>(lastValue);
+        node.arguments[4]->accept(*this); int y2 = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_render_draw_line(renderer, x1, y1, x2, y2));
         return true;
     }
@@ -2543,11 +3872,11 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 5) {
             throw RuntimeError("sdl_render_draw_rect requires 5 arguments (renderer_handle, x, y, w, h)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int renderer = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int x = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int y = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int w = std::get<int>(lastValue);
-        node.arguments[4]->accept(*this); int h = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int x = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int y = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int w = rbasic::get<int>(lastValue);
+        node.arguments[4]->accept(*this); int h = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_render_draw_rect(renderer, x, y, w, h));
         return true;
     }
@@ -2555,24 +3884,117 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 5) {
             throw RuntimeError("sdl_render_fill_rect requires 5 arguments (renderer_handle, x, y, w, h)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int renderer = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int x = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int y = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int w = std::get<int>(lastValue);
-        node.arguments[4]->accept(*this); int h = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int x = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int y = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int w = rbasic::get<int>(lastValue);
+        node.arguments[4]->accept(*this); int h = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_render_fill_rect(renderer, x, y, w, h));
         return true;
     }
     
+    // Batched primitives and draw lists: one call draws whole coordinate arrays
+    if (fname == "sdl_render_draw_points" || fname == "sdl_render_fill_rects" ||
+        fname == "sdl_draw_list_points" || fname == "sdl_draw_list_fill_rects") {
+        bool points = fname == "sdl_render_draw_points" || fname == "sdl_draw_list_points";
+        bool list = fname.compare(0, 14, "sdl_draw_list_") == 0;
+        size_t arrays = points ? 2 : 4;
+        if (node.arguments.size() != arrays + 1) {
+            throw RuntimeError(fname + " requires " + std::to_string(arrays + 1) + " arguments (" +
+                                   (list ? "list_handle" : "renderer_handle") + (points ? ", xs, ys)" : ", xs, ys, ws, hs)"),
+                               getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int handle = rbasic::get<int>(lastValue);
+        
+        // Array variables are read where they live, not copied
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        scratch->resize(arrays);
+        basic_runtime::DrawColumn columns[4];
+        std::vector<int> converted[4];
+        size_t count = 0;
+        for (size_t i = 0; i < arrays; ++i) {
+            const ValueType& value = evaluateOperand(*node.arguments[i + 1], (*scratch)[i], true);
+            size_t length = 0;
+            if (!drawColumn(value, columns[i], length, converted[i])) {
+                throw RuntimeError(fname + ": argument " + std::to_string(i + 2) + " is not an array", getCurrentPosition());
+            }
+            if (i > 0 && length != count) {
+                throw RuntimeError(fname + ": the arrays differ in length (" + std::to_string(count) + " and " +
+                                   std::to_string(length) + ")", getCurrentPosition());
+            }
+            count = length;
+        }
+        
+        lastValue = 0;
+        if (fname == "sdl_render_draw_points") {
+            lastValue = basic_runtime::sdl_render_draw_points(handle, columns[0], columns[1], count);
+        } else if (fname == "sdl_render_fill_rects") {
+            lastValue = basic_runtime::sdl_render_fill_rects(handle, columns[0], columns[1], columns[2], columns[3], count);
+        } else if (points) {
+            basic_runtime::sdl_draw_list_points(handle, columns[0], columns[1], count);
+        } else {
+            basic_runtime::sdl_draw_list_fill_rects(handle, columns[0], columns[1], columns[2], columns[3], count);
+        }
+        return true;
+    }
+    if (fname == "sdl_draw_list_create") {
+        lastValue = convertBasicValue(basic_runtime::func_sdl_draw_list_create());
+        return true;
+    }
+    if (fname == "sdl_draw_list_destroy" || fname == "sdl_draw_list_clear") {
+        if (node.arguments.size() != 1) {
+            throw RuntimeError(fname + " requires 1 argument (list_handle)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int list = rbasic::get<int>(lastValue);
+        lastValue = convertBasicValue(fname == "sdl_draw_list_destroy" ? basic_runtime::func_sdl_draw_list_destroy(list)
+                                                                       : basic_runtime::func_sdl_draw_list_clear(list));
+        return true;
+    }
+    if (fname == "sdl_draw_list_set_color") {
+        if (node.arguments.size() != 5) {
+            throw RuntimeError("sdl_draw_list_set_color requires 5 arguments (list_handle, r, g, b, a)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int list = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int r = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int g = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int b = rbasic::get<int>(lastValue);
+        node.arguments[4]->accept(*this); int a = rbasic::get<int>(lastValue);
+        lastValue = convertBasicValue(basic_runtime::func_sdl_draw_list_set_color(list, r, g, b, a));
+        return true;
+    }
+    if (fname == "sdl_draw_list_replay") {
+        if (node.arguments.size() != 2) {
+            throw RuntimeError("sdl_draw_list_replay requires 2 arguments (list_handle, renderer_handle)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int list = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        lastValue = convertBasicValue(basic_runtime::func_sdl_draw_list_replay(list, renderer));
+        return true;
+    }
+    if (fname == "sdl_present_framebuffer") {
+        if (node.arguments.size() != 2) {
+            throw RuntimeError("sdl_present_framebuffer requires 2 arguments (renderer_handle, framebuffer)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        
+        // The framebuffer is uploaded from where it lives, not copied
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        scratch->resize(1);
+        PixelImage::View view = framebufferView(fname, evaluateOperand(*node.arguments[1], (*scratch)[0], true));
+        Uint32 format = view.format == PixelImage::Format::RGBA_BYTES ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB888;
+        lastValue = basic_runtime::sdl_present_framebuffer(renderer, view.pixels, view.width, view.height, format);
+        return true;
+    }
+    
 #ifdef SDL2_GFX_AVAILABLE
     if (fname == "sdl_render_draw_circle") {
         if (node.arguments.size() != 4) {
             throw RuntimeError("sdl_render_draw_circle requires 4 arguments (renderer_handle, x, y, radius)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int renderer = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int x = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int y = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int radius = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int x = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int y = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int radius = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_render_draw_circle(renderer, x, y, radius));
         return true;
     }
@@ -2580,10 +4002,10 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 4) {
             throw RuntimeError("sdl_render_fill_circle requires 4 arguments (renderer_handle, x, y, radius)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int renderer = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int x = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int y = std::get<int>(lastValue);
-        node.arguments[3]->accept(*this); int radius = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int renderer = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int x = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int y = rbasic::get<int>(lastValue);
+        node.arguments[3]->accept(*this); int radius = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sdl_render_fill_circle(renderer, x, y, radius));
         return true;
     }
@@ -2615,7 +4037,7 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sdl_delay requires 1 argument (milliseconds)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sdl_delay(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sdl_delay(rbasic::get<int>(lastValue)));
         return true;
     }
     
@@ -2628,7 +4050,7 @@ bool Interpreter::handleSDL2Functions([[maybe_unused]] CallExpr& node) {
 // SQLite3 Database Functions Handler
 bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
 #ifdef SQLITE3_SUPPORT_ENABLED
-    std::string fname = node.name;
+    const std::string& fname = node.name;
     
     // Core database functions
     if (fname == "sqlite_open") {
@@ -2636,7 +4058,7 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_open requires 1 argument (filename)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_open(std::get<std::string>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_open(rbasic::get<std::string>(lastValue)));
         return true;
     }
     if (fname == "sqlite_close") {
@@ -2644,15 +4066,15 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_close requires 1 argument (db_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_close(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_close(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sqlite_exec") {
         if (node.arguments.size() != 2) {
             throw RuntimeError("sqlite_exec requires 2 arguments (db_handle, sql)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int db = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); std::string sql = std::get<std::string>(lastValue);
+        node.arguments[0]->accept(*this); int db = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); std::string sql = rbasic::get<std::string>(std::move(lastValue));
         lastValue = convertBasicValue(basic_runtime::func_sqlite_exec(db, sql));
         return true;
     }
@@ -2661,7 +4083,7 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_errmsg requires 1 argument (db_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_errmsg(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_errmsg(rbasic::get<int>(lastValue)));
         return true;
     }
     
@@ -2670,8 +4092,8 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 2) {
             throw RuntimeError("sqlite_prepare requires 2 arguments (db_handle, sql)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int db = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); std::string sql = std::get<std::string>(lastValue);
+        node.arguments[0]->accept(*this); int db = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); std::string sql = rbasic::get<std::string>(std::move(lastValue));
         lastValue = convertBasicValue(basic_runtime::func_sqlite_prepare(db, sql));
         return true;
     }
@@ -2680,7 +4102,7 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_finalize requires 1 argument (stmt_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_finalize(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_finalize(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sqlite_reset") {
@@ -2688,7 +4110,7 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_reset requires 1 argument (stmt_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_reset(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_reset(rbasic::get<int>(lastValue)));
         return true;
     }
     
@@ -2697,9 +4119,9 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 3) {
             throw RuntimeError("sqlite_bind_int requires 3 arguments (stmt_handle, index, value)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int stmt = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); int value = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); int value = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sqlite_bind_int(stmt, index, value));
         return true;
     }
@@ -2707,9 +4129,9 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 3) {
             throw RuntimeError("sqlite_bind_double requires 3 arguments (stmt_handle, index, value)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int stmt = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); double value = std::get<double>(lastValue);
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); double value = rbasic::get<double>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sqlite_bind_double(stmt, index, value));
         return true;
     }
@@ -2717,9 +4139,9 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 3) {
             throw RuntimeError("sqlite_bind_text requires 3 arguments (stmt_handle, index, value)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int stmt = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
-        node.arguments[2]->accept(*this); std::string value = std::get<std::string>(lastValue);
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
+        node.arguments[2]->accept(*this); std::string value = rbasic::get<std::string>(std::move(lastValue));
         lastValue = convertBasicValue(basic_runtime::func_sqlite_bind_text(stmt, index, value));
         return true;
     }
@@ -2730,7 +4152,7 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_step requires 1 argument (stmt_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_step(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_step(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sqlite_column_count") {
@@ -2738,15 +4160,15 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_column_count requires 1 argument (stmt_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_column_count(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_column_count(rbasic::get<int>(lastValue)));
         return true;
     }
     if (fname == "sqlite_column_int") {
         if (node.arguments.size() != 2) {
             throw RuntimeError("sqlite_column_int requires 2 arguments (stmt_handle, index)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int stmt = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sqlite_column_int(stmt, index));
         return true;
     }
@@ -2754,8 +4176,8 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 2) {
             throw RuntimeError("sqlite_column_double requires 2 arguments (stmt_handle, index)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int stmt = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sqlite_column_double(stmt, index));
         return true;
     }
@@ -2763,8 +4185,8 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
         if (node.arguments.size() != 2) {
             throw RuntimeError("sqlite_column_text requires 2 arguments (stmt_handle, index)", getCurrentPosition());
         }
-        node.arguments[0]->accept(*this); int stmt = std::get<int>(lastValue);
-        node.arguments[1]->accept(*this); int index = std::get<int>(lastValue);
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int index = rbasic::get<int>(lastValue);
         lastValue = convertBasicValue(basic_runtime::func_sqlite_column_text(stmt, index));
         return true;
     }
@@ -2780,7 +4202,133 @@ bool Interpreter::handleSQLite3Functions([[maybe_unused]] CallExpr& node) {
             throw RuntimeError("sqlite_changes requires 1 argument (db_handle)", getCurrentPosition());
         }
         node.arguments[0]->accept(*this);
-        lastValue = convertBasicValue(basic_runtime::func_sqlite_changes(std::get<int>(lastValue)));
+        lastValue = convertBasicValue(basic_runtime::func_sqlite_changes(rbasic::get<int>(lastValue)));
+        return true;
+    }
+    
+    // Bulk fetch: whole columns in one call instead of a step and a column
+    // call per cell
+    if (fname == "sqlite_fetch_all" || fname == "sqlite_fetch_columns") {
+        size_t expected = fname == "sqlite_fetch_all" ? 1 : 2;
+        if (node.arguments.size() != expected) {
+            throw RuntimeError(fname + (expected == 1 ? " requires 1 argument (stmt_handle)"
+                                                      : " requires 2 arguments (stmt_handle, max_rows)"),
+                               getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int stmt = rbasic::get<int>(lastValue);
+        size_t maxRows = 0;
+        if (expected == 2) {
+            node.arguments[1]->accept(*this);
+            int limit = TypeUtils::toInt(lastValue);
+            if (limit <= 0) {
+                throw RuntimeError("sqlite_fetch_columns: max_rows must be positive", getCurrentPosition());
+            }
+            maxRows = static_cast<size_t>(limit);
+        }
+        StructArrayValue rows;
+        try {
+            static_cast<StructArray&>(rows) = basic_runtime::sqlite_fetch_rows(stmt, maxRows);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(e.what(), getCurrentPosition());
+        }
+        lastValue = std::move(rows);
+        return true;
+    }
+    
+    // Batch execution
+    if (fname == "sqlite_exec_batch") {
+        if (node.arguments.size() < 3) {
+            throw RuntimeError("sqlite_exec_batch requires at least 3 arguments (db_handle, sql, array, ...)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int db = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); std::string sql = rbasic::get<std::string>(std::move(lastValue));
+        
+        // Array variables are bound where they live, not copied; any other
+        // argument is evaluated into a scratch value that outlives the batch
+        ScratchPool<ValueType>::Lease scratch(argumentPool);
+        scratch->resize(node.arguments.size() - 2);
+        std::vector<basic_runtime::BatchColumn> columns;
+        size_t rows = 0;
+        for (size_t i = 2; i < node.arguments.size(); ++i) {
+            const ValueType& column = evaluateOperand(*node.arguments[i], (*scratch)[i - 2], true);
+            size_t length = 0;
+            if (auto* ints = rbasic::get_if<IntArrayValue>(&column)) {
+                columns.push_back(basic_runtime::batch_int_column(ints->elements));
+                length = ints->elements.size();
+            } else if (auto* doubles = rbasic::get_if<DoubleArrayValue>(&column)) {
+                columns.push_back(basic_runtime::batch_double_column(doubles->elements));
+                length = doubles->elements.size();
+            } else if (auto* bytes = rbasic::get_if<ByteArrayValue>(&column)) {
+                columns.push_back(basic_runtime::batch_byte_column(bytes->elements));
+                length = bytes->elements.size();
+            } else if (auto* array = rbasic::get_if<ArrayValue>(&column)) {
+                length = 1;
+                for (int dim : array->dimensions) {
+                    length *= dim;
+                }
+                columns.push_back([array](sqlite3_stmt* stmt, int index, std::size_t row) {
+                    // Elements never assigned read as 0
+                    auto found = array->elements.find(static_cast<int>(row));
+                    if (found == array->elements.end()) {
+                        return sqlite3_bind_int(stmt, index, 0);
+                    }
+                    auto& element = found->second;
+                    if (auto* n = rbasic::get_if<int>(&element)) {
+                        return sqlite3_bind_int(stmt, index, *n);
+                    } else if (auto* d = rbasic::get_if<double>(&element)) {
+                        return sqlite3_bind_double(stmt, index, *d);
+                    } else if (auto* str = rbasic::get_if<std::string>(&element)) {
+                        return sqlite3_bind_text(stmt, index, str->c_str(), static_cast<int>(str->size()), SQLITE_STATIC);
+                    } else if (auto* b = rbasic::get_if<bool>(&element)) {
+                        return sqlite3_bind_int(stmt, index, *b ? 1 : 0);
+                    }
+                    return SQLITE_MISMATCH;
+                });
+            } else {
+                throw RuntimeError("sqlite_exec_batch: argument " + std::to_string(i + 1) + " is not an array",
+                                   getCurrentPosition());
+            }
+            if (i > 2 && length != rows) {
+                throw RuntimeError("sqlite_exec_batch: the arrays differ in length (" + std::to_string(rows) + " and " +
+                                   std::to_string(length) + ")", getCurrentPosition());
+            }
+            rows = length;
+        }
+        try {
+            lastValue = basic_runtime::sqlite_exec_batch(db, sql, columns, rows);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(e.what(), getCurrentPosition());
+        }
+        return true;
+    }
+    
+    // Asynchronous writes
+    if (fname == "sqlite_async") {
+        if (node.arguments.size() != 3 && node.arguments.size() != 4) {
+            throw RuntimeError("sqlite_async requires 3 or 4 arguments (db_handle, batch_rows, window_ms[, synchronous])",
+                               getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this); int db = rbasic::get<int>(lastValue);
+        node.arguments[1]->accept(*this); int batchRows = TypeUtils::toInt(lastValue);
+        node.arguments[2]->accept(*this); int windowMs = TypeUtils::toInt(lastValue);
+        std::string synchronous = "NORMAL";
+        if (node.arguments.size() == 4) {
+            node.arguments[3]->accept(*this);
+            synchronous = rbasic::get<std::string>(std::move(lastValue));
+        }
+        try {
+            lastValue = basic_runtime::sqlite_async(db, batchRows, windowMs, synchronous);
+        } catch (const std::runtime_error& e) {
+            throw RuntimeError(e.what(), getCurrentPosition());
+        }
+        return true;
+    }
+    if (fname == "sqlite_flush") {
+        if (node.arguments.size() != 1) {
+            throw RuntimeError("sqlite_flush requires 1 argument (db_handle)", getCurrentPosition());
+        }
+        node.arguments[0]->accept(*this);
+        lastValue = basic_runtime::sqlite_flush(rbasic::get<int>(lastValue));
         return true;
     }
     
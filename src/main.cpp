@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <fstream>
 #include <filesystem>
+#include <optional>
 
 using namespace rbasic;
 
@@ -31,6 +32,14 @@ void printUsage(const std::string& programName) {
     std::cout << "  -o, --output       Specify output filename (compile mode only)\n";
     std::cout << "  --io <type>        I/O handler type: console (default: console)\n";
     std::cout << "  --keep-cpp         Keep generated C++ file (compile mode only)\n";
+    std::cout << "  --profile          Time lines and functions, report on exit (interpret mode only)\n";
+    std::cout << "  --profile-out <f>  Collapsed call stacks for flame graphs (default: <program>.folded)\n";
+    std::cout << "  --coverage         Count line, branch and loop executions (interpret mode only)\n";
+    std::cout << "  --coverage-out <f> lcov tracefile to write (default: <program>.info)\n";
+    std::cout << "  --mem-report       Memory use by value kind and allocations by line on exit (compiled: totals only)\n";
+    std::cout << "  --trace-slow=<ms>  Log statements and function calls taking at least <ms> (interpret mode only)\n";
+    std::cout << "  --trace-out <f>    File for the slow log (default: stderr)\n";
+    std::cout << "  --watch            Reload functions from the program and its imports when saved (interpret mode only)\n";
     std::cout << "  --help             Show this help message\n";
 }
 
@@ -130,6 +139,7 @@ bool compileToExecutable(const std::string& cppFile, const std::string& outputFi
 #endif
 #ifdef SQLITE3_SUPPORT_ENABLED
         linkFlags.push_back("-lsqlite3");
+        linkFlags.push_back("-pthread");  // sqlite_async's writer thread
 #endif
         
         builder.compiler("g++")
@@ -174,6 +184,14 @@ int main(int argc, char* argv[]) {
         std::string outputFile;
         std::string ioType = "console";
         bool keepCppFile = false;
+        bool profile = false;
+        std::string profileOutput;
+        bool coverage = false;
+        std::string coverageOutput;
+        bool memReport = false;
+        double traceSlowMs = -1;     // Negative: tracing off
+        std::string traceOutput;
+        bool watch = false;
         
         // Parse command line arguments
         for (int i = 1; i < argc; i++) {
@@ -206,6 +224,36 @@ int main(int argc, char* argv[]) {
                 }
             } else if (arg == "--keep-cpp") {
                 keepCppFile = true;
+            } else if (arg == "--profile") {
+                profile = true;
+            } else if (arg == "--profile-out") {
+                profile = true;
+                if (i + 1 < argc) {
+                    profileOutput = argv[++i];
+                }
+            } else if (arg == "--coverage") {
+                coverage = true;
+            } else if (arg == "--coverage-out") {
+                coverage = true;
+                if (i + 1 < argc) {
+                    coverageOutput = argv[++i];
+                }
+            } else if (arg == "--mem-report") {
+                memReport = true;
+            } else if (arg.rfind("--trace-slow=", 0) == 0) {
+                std::string value = arg.substr(std::string("--trace-slow=").size());
+                char* end = nullptr;
+                traceSlowMs = std::strtod(value.c_str(), &end);
+                if (value.empty() || *end != '\0' || traceSlowMs < 0) {
+                    std::cerr << "Error: --trace-slow needs a threshold in milliseconds, e.g. --trace-slow=50\n";
+                    return 1;
+                }
+            } else if (arg == "--watch") {
+                watch = true;
+            } else if (arg == "--trace-out") {
+                if (i + 1 < argc) {
+                    traceOutput = argv[++i];
+                }
             } else if (inputFile.empty()) {
                 inputFile = arg;
                 if (mode.empty()) {
@@ -255,7 +303,7 @@ int main(int argc, char* argv[]) {
         Lexer lexer(source);
         auto tokens = lexer.tokenize();
         
-        Parser parser(std::move(tokens));
+        Parser parser(std::move(tokens), inputFile);
         auto program = parser.parse();
         
         if (mode == "interpret") {
@@ -264,13 +312,80 @@ int main(int argc, char* argv[]) {
             // Create appropriate I/O handler
             auto ioHandler = createIOHandler(ioType);
             
+            Profiler profiler;
+            Coverage counters;
+            MemoryTracker memoryTracker;
+            std::optional<HotReload> hotReload;
             Interpreter interpreter(std::move(ioHandler));
             interpreter.setCurrentFile(inputFile);
-            interpreter.interpret(*program);
+            interpreter.setProfiler(profile ? &profiler : nullptr);
+            interpreter.setMemoryTracker(memReport ? &memoryTracker : nullptr);
+            if (watch) {
+                hotReload.emplace();
+                hotReload->watch(inputFile);
+                interpreter.setHotReload(&*hotReload);
+            }
+            if (coverage) {
+                counters.addProgram(*program);
+                interpreter.setCoverage(&counters);
+            }
+            
+            // The trace's writer thread finishes the log when it goes out of scope
+            std::ofstream traceFile;
+            if (traceSlowMs >= 0 && !traceOutput.empty()) {
+                traceFile.open(traceOutput);
+                if (!traceFile) {
+                    std::cerr << "Error: cannot write slow trace to " << traceOutput << "\n";
+                    return 1;
+                }
+            }
+            {
+                std::optional<SlowTrace> slowTrace;
+                if (traceSlowMs >= 0) {
+                    slowTrace.emplace(traceOutput.empty() ? std::cerr : traceFile, traceSlowMs);
+                    interpreter.setSlowTrace(&*slowTrace);
+                }
+                interpreter.interpret(*program);
+                interpreter.setSlowTrace(nullptr);
+            }
+            
+            if (coverage) {
+                if (coverageOutput.empty()) {
+                    coverageOutput = std::filesystem::path(inputFile).stem().string() + ".info";
+                }
+                std::ofstream tracefile(coverageOutput);
+                if (!tracefile) {
+                    std::cerr << "Error: cannot write coverage to " << coverageOutput << "\n";
+                    return 1;
+                }
+                counters.writeLcov(tracefile);
+                counters.writeSummary(std::cerr);
+                std::cerr << "Coverage written to " << coverageOutput << "\n";
+            }
+            
+            if (memReport) {
+                memoryTracker.writeReport(std::cerr, interpreter.liveValueBytes(), interpreter.retainedCode());
+            }
+            
+            if (profile) {
+                // Report on stderr so the program's own output is left alone
+                profiler.writeReport(std::cerr);
+                if (profileOutput.empty()) {
+                    profileOutput = std::filesystem::path(inputFile).stem().string() + ".folded";
+                }
+                std::ofstream stacks(profileOutput);
+                if (!stacks) {
+                    std::cerr << "Error: cannot write profile stacks to " << profileOutput << "\n";
+                    return 1;
+                }
+                profiler.writeCollapsedStacks(stacks);
+                std::cerr << "Call stacks written to " << profileOutput << "\n";
+            }
         } else if (mode == "compile") {
             std::cout << "=== Compiling " << inputFile << " ===\n";
             
             CodeGenerator generator;
+            generator.setMemoryReport(memReport);
             std::string cppCode = generator.generate(*program);
             
             // Write generated C++ code to temporary file
@@ -0,0 +1,107 @@
+#include "memory_tracker.h"
+#include "ast.h"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+
+namespace rbasic {
+
+namespace {
+
+HeapCounts operator-(const HeapCounts& a, const HeapCounts& b) {
+    return HeapCounts{a.allocations - b.allocations, a.bytes - b.bytes};
+}
+
+HeapCounts& operator+=(HeapCounts& a, const HeapCounts& b) {
+    a.allocations += b.allocations;
+    a.bytes += b.bytes;
+    return a;
+}
+
+std::string lineName(const Statement& stmt) {
+    const SourcePosition& pos = stmt.getPosition();
+    if (pos.line < 0) {
+        return "<unknown>";
+    }
+    return (pos.filename.empty() ? std::string("<input>") : pos.filename) + ":" + std::to_string(pos.line);
+}
+
+} // anonymous namespace
+
+void MemoryTracker::enterLine(const Statement& stmt) {
+    auto it = lineIndex_.find(&stmt);
+    if (it == lineIndex_.end()) {
+        std::string name = lineName(stmt);
+        auto named = lineByName_.find(name);
+        if (named == lineByName_.end()) {
+            named = lineByName_.emplace(name, lines_.size()).first;
+            lines_.push_back(Stats{name, 0, {}});
+        }
+        it = lineIndex_.emplace(&stmt, named->second).first;
+    }
+    frames_.push_back(Frame{it->second, heapCounts(), {}});
+}
+
+void MemoryTracker::exitLine() {
+    Frame frame = frames_.back();
+    frames_.pop_back();
+    HeapCounts elapsed = heapCounts() - frame.start;
+
+    Stats& entry = lines_[frame.index];
+    entry.executions++;
+    entry.allocated += elapsed - frame.children;
+    if (!frames_.empty()) {
+        frames_.back().children += elapsed;
+    }
+}
+
+void MemoryTracker::writeReport(std::ostream& out, const LiveValueBytes& values, const std::vector<RetainedCode>& code,
+                                std::size_t maxLines) const {
+    HeapCounts heap = heapCounts();
+    out << "=== Memory: rss " << formatBytes(currentRssBytes()) << ", peak " << formatBytes(peakRssBytes()) << ", "
+        << heap.allocations << " allocations (" << formatBytes(heap.bytes) << ") ===\n";
+
+    char row[160];
+    out << "\nLive values (" << values.variables << " variables, " << formatBytes(values.total()) << ")\n";
+    const std::pair<const char*, std::size_t> kinds[] = {
+        {"strings", values.strings}, {"arrays", values.arrays}, {"structs", values.structs}, {"other", values.other}};
+    for (const auto& kind : kinds) {
+        std::snprintf(row, sizeof(row), "%12s  %s\n", formatBytes(kind.second).c_str(), kind.first);
+        out << row;
+    }
+
+    if (!code.empty()) {
+        out << "\nRetained functions\n";
+        std::snprintf(row, sizeof(row), "%10s %12s  %s\n", "functions", "statements", "file");
+        out << row;
+        for (const auto& entry : code) {
+            std::snprintf(row, sizeof(row), "%10zu %12zu  ", entry.functions, entry.statements);
+            out << row << (entry.file.empty() ? "<input>" : entry.file) << "\n";
+        }
+    }
+
+    std::vector<const Stats*> sorted;
+    for (const auto& entry : lines_) {
+        if (entry.allocated.allocations > 0) {
+            sorted.push_back(&entry);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Stats* a, const Stats* b) { return a->allocated.bytes > b->allocated.bytes; });
+    std::size_t allocating = sorted.size();
+    if (sorted.size() > maxLines) {
+        sorted.resize(maxLines);
+    }
+
+    out << "\nAllocations by line (top " << sorted.size() << " of " << allocating << ")\n";
+    std::snprintf(row, sizeof(row), "%12s %12s %12s  %s\n", "allocs", "bytes", "execs", "location");
+    out << row;
+    for (const Stats* entry : sorted) {
+        std::snprintf(row, sizeof(row), "%12llu %12s %12llu  ",
+                      static_cast<unsigned long long>(entry->allocated.allocations),
+                      formatBytes(entry->allocated.bytes).c_str(), static_cast<unsigned long long>(entry->executions));
+        out << row << entry->name << "\n";
+    }
+}
+
+} // namespace rbasic
@@ -0,0 +1,184 @@
+#include "number_format.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+// Floating-point to_chars/from_chars arrived after the integer overloads
+// (GCC 11, MSVC 2019); older toolchains fall back to the C library
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define RBASIC_FLOAT_CHARCONV 1
+#endif
+
+namespace rbasic {
+
+namespace NumberFormat {
+
+namespace {
+
+// Large enough for any int or shortest-form double
+constexpr size_t BUFFER_SIZE = 64;
+
+// Plain notation inside this magnitude range, scientific outside it,
+// so 500000.0 prints as "500000" rather than "5e+05"
+bool useFixedNotation(double value) {
+    double magnitude = std::fabs(value);
+    return magnitude == 0.0 || (magnitude >= 1e-5 && magnitude < 1e16);
+}
+
+// Shortest form that reads back to the same T (double, or float for vector lanes)
+template<typename T>
+size_t writeShortest(char* buffer, T value) {
+#ifdef RBASIC_FLOAT_CHARCONV
+    auto format = useFixedNotation(value) ? std::chars_format::fixed : std::chars_format::scientific;
+    auto result = std::to_chars(buffer, buffer + BUFFER_SIZE, value, format);
+    return static_cast<size_t>(result.ptr - buffer);
+#else
+    if (!std::isfinite(value)) {
+        return static_cast<size_t>(std::snprintf(buffer, BUFFER_SIZE, "%g", static_cast<double>(value)));
+    }
+    // Shortest significant digit count that reads back to the same value
+    constexpr int maxPrecision = std::is_same_v<T, float> ? 9 : 17;
+    int precision = 1;
+    for (; precision < maxPrecision; precision++) {
+        std::snprintf(buffer, BUFFER_SIZE, "%.*e", precision - 1, static_cast<double>(value));
+        T parsed;
+        if constexpr (std::is_same_v<T, float>) {
+            parsed = std::strtof(buffer, nullptr);
+        } else {
+            parsed = std::strtod(buffer, nullptr);
+        }
+        if (parsed == value) {
+            break;
+        }
+    }
+    int length;
+    if (useFixedNotation(value)) {
+        int exponent = value == 0.0 ? 0 : static_cast<int>(std::floor(std::log10(std::fabs(value))));
+        int decimals = precision - 1 - exponent;
+        length = std::snprintf(buffer, BUFFER_SIZE, "%.*f", decimals > 0 ? decimals : 0, static_cast<double>(value));
+    } else {
+        length = std::snprintf(buffer, BUFFER_SIZE, "%.*e", precision - 1, static_cast<double>(value));
+    }
+    return static_cast<size_t>(length);
+#endif
+}
+
+// Text for a number shown to the user. A double that is exactly a float,
+// such as a vector component, prints in the float's shorter form, so 0.8f
+// shows as 0.8 rather than 0.800000011920929.
+size_t writeNumber(char* buffer, double value) {
+    size_t length = writeShortest(buffer, value);
+    float narrow = static_cast<float>(value);
+    if (static_cast<double>(narrow) == value) {
+        char floatBuffer[BUFFER_SIZE];
+        size_t floatLength = writeShortest(floatBuffer, narrow);
+        if (floatLength < length) {
+            std::memcpy(buffer, floatBuffer, floatLength);
+            length = floatLength;
+        }
+    }
+    return length;
+}
+
+// Skip the leading whitespace and '+' that stoi/stod accept but from_chars does not
+std::string_view numberStart(std::string_view text) {
+    size_t i = 0;
+    while (i < text.size() && (text[i] == ' ' || text[i] == '\t' || text[i] == '\n' ||
+                               text[i] == '\r' || text[i] == '\f' || text[i] == '\v')) {
+        i++;
+    }
+    if (i + 1 < text.size() && text[i] == '+' && text[i + 1] != '-') {
+        i++;
+    }
+    return text.substr(i);
+}
+
+// Characters consumed parsing a double prefix, or 0 if there is none
+size_t scanDouble(std::string_view text, double& value) {
+#ifdef RBASIC_FLOAT_CHARCONV
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc()) {
+        return 0;
+    }
+    return static_cast<size_t>(result.ptr - text.data());
+#else
+    std::string copy(text);
+    char* end = nullptr;
+    value = std::strtod(copy.c_str(), &end);
+    if (end == copy.c_str() || std::isinf(value)) {
+        return 0;
+    }
+    return static_cast<size_t>(end - copy.c_str());
+#endif
+}
+
+} // anonymous namespace
+
+std::string formatInt(int value) {
+    char buffer[BUFFER_SIZE];
+    auto result = std::to_chars(buffer, buffer + BUFFER_SIZE, value);
+    return std::string(buffer, result.ptr);
+}
+
+std::string formatDouble(double value) {
+    char buffer[BUFFER_SIZE];
+    return std::string(buffer, writeNumber(buffer, value));
+}
+
+void appendInt(std::string& out, int value) {
+    char buffer[BUFFER_SIZE];
+    auto result = std::to_chars(buffer, buffer + BUFFER_SIZE, value);
+    out.append(buffer, result.ptr);
+}
+
+void appendDouble(std::string& out, double value) {
+    char buffer[BUFFER_SIZE];
+    out.append(buffer, writeNumber(buffer, value));
+}
+
+std::string doubleLiteral(double value) {
+    if (std::isnan(value)) {
+        return "std::numeric_limits<double>::quiet_NaN()";
+    }
+    if (std::isinf(value)) {
+        return value > 0 ? "std::numeric_limits<double>::infinity()" : "-std::numeric_limits<double>::infinity()";
+    }
+    // Exact double form: a value that is also a float must not take the float's shorter text
+    char buffer[BUFFER_SIZE];
+    std::string text(buffer, writeShortest(buffer, value));
+    if (text.find_first_of(".e") == std::string::npos) {
+        text += ".0";  // Keep integral values typed as double
+    }
+    return text;
+}
+
+bool parseInt(std::string_view text, int& value) {
+    text = numberStart(text);
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc();
+}
+
+bool parseDouble(std::string_view text, double& value) {
+    return scanDouble(numberStart(text), value) > 0;
+}
+
+NumberKind parseNumber(std::string_view text, int& intValue, double& doubleValue) {
+    text = numberStart(text);
+    size_t doubleLength = scanDouble(text, doubleValue);
+    if (doubleLength == 0) {
+        return NumberKind::NONE;
+    }
+
+    auto intResult = std::from_chars(text.data(), text.data() + text.size(), intValue);
+    if (intResult.ec == std::errc() && static_cast<size_t>(intResult.ptr - text.data()) == doubleLength) {
+        return NumberKind::INT;
+    }
+    return NumberKind::DOUBLE;
+}
+
+} // namespace NumberFormat
+
+} // namespace rbasic
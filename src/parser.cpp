@@ -1,10 +1,12 @@
 #include "parser.h"
+#include "number_format.h"
 #include <algorithm>
 #include <iostream>
 
 namespace rbasic {
 
-Parser::Parser(std::vector<Token> token_list) : tokens(std::move(token_list)), current(0) {}
+Parser::Parser(std::vector<Token> token_list, std::string source_file)
+    : tokens(std::move(token_list)), current(0), filename(std::move(source_file)) {}
 
 Token Parser::peek() const {
     if (current >= tokens.size()) {
@@ -107,6 +109,14 @@ std::unique_ptr<Expression> Parser::assignment() {
             expr.release(); // Release the component expression
             return std::make_unique<ComponentAssignExpr>(std::move(object), component, std::move(value));
         }
+        // Struct member assignment (e.g., particles[i].x = 5.0); vector
+        // components parse as member access too, so this covers v.x = 1.0
+        else if (auto memberExpr = dynamic_cast<MemberAccessExpr*>(expr.get())) {
+            auto object = std::move(memberExpr->object);
+            std::string member = memberExpr->member;
+            auto value = assignment(); // Right associative
+            return std::make_unique<ComponentAssignExpr>(std::move(object), member, std::move(value));
+        }
         // This should be a variable expression
         else if (auto varExpr = dynamic_cast<VariableExpr*>(expr.get())) {
             std::string variable = varExpr->name;
@@ -296,11 +306,12 @@ std::unique_ptr<Expression> Parser::call() {
 std::unique_ptr<Expression> Parser::primary() {
     if (match({TokenType::NUMBER})) {
         std::string value = previous().value;
-        if (hasDecimalPoint(value)) {
-            return std::make_unique<LiteralExpr>(std::stod(value));
-        } else {
-            return std::make_unique<LiteralExpr>(std::stoi(value));
+        int intValue = 0;
+        double doubleValue = 0.0;
+        if (NumberFormat::parseNumber(value, intValue, doubleValue) == NumberFormat::NumberKind::INT) {
+            return std::make_unique<LiteralExpr>(intValue);
         }
+        return std::make_unique<LiteralExpr>(doubleValue);
     }
     
     if (match({TokenType::STRING})) {
@@ -349,6 +360,14 @@ std::vector<std::unique_ptr<Expression>> Parser::arguments() {
 
 // Statement parsing
 std::unique_ptr<Statement> Parser::statement() {
+    // Statements carry the position of their first token (used by --profile)
+    Token start = peek();
+    auto stmt = statementBody();
+    stmt->setPosition(SourcePosition(start.line, start.column, filename));
+    return stmt;
+}
+
+std::unique_ptr<Statement> Parser::statementBody() {
     try {
         // Strict check: detect common typo pattern at statement start where a user types
         // an identifier followed by another identifier and '=' (e.g. "vay y=2;")
@@ -608,10 +627,10 @@ std::unique_ptr<Statement> Parser::dimStatement() {
 
 std::unique_ptr<Statement> Parser::importStatement() {
     // Parse: import 'filename.bas';
-    auto filename = consume(TokenType::STRING, "Expected filename string after 'import'");
+    auto path = consume(TokenType::STRING, "Expected filename string after 'import'");
     consume(TokenType::SEMICOLON, "Expected ';' after import statement");
     
-    return std::make_unique<ImportStmt>(filename.value);
+    return std::make_unique<ImportStmt>(path.value);
 }
 
 std::unique_ptr<Statement> Parser::expressionStatement() {
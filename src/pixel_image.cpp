@@ -0,0 +1,140 @@
+#include "pixel_image.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+
+namespace rbasic {
+
+namespace PixelImage {
+
+namespace {
+
+// Pixel i of an image as R, G, B, A
+struct Pixel {
+    uint8_t r, g, b, a;
+};
+
+Pixel pixelAt(const View& image, std::size_t i) {
+    if (image.format == Format::RGBA_BYTES) {
+        const uint8_t* p = static_cast<const uint8_t*>(image.pixels) + i * 4;
+        return {p[0], p[1], p[2], p[3]};
+    }
+    const int value = static_cast<const int*>(image.pixels)[i];
+    return {static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value), 255};
+}
+
+// BMP header fields are little endian whatever the host
+void putLE(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+// 32 bits per pixel, BI_RGB, rows bottom to top as B, G, R, A (the layout
+// of the test_pattern*.bmp files, which SDL_LoadBMP reads with alpha)
+std::vector<uint8_t> encodeBMP(const View& image) {
+    const uint32_t pixelBytes = static_cast<uint32_t>(image.width) * static_cast<uint32_t>(image.height) * 4;
+    std::vector<uint8_t> out;
+    out.reserve(54 + pixelBytes);
+    out.push_back('B');
+    out.push_back('M');
+    putLE(out, 54 + pixelBytes, 4);  // File size
+    putLE(out, 0, 4);                // Reserved
+    putLE(out, 54, 4);               // Pixel data offset
+    putLE(out, 40, 4);               // BITMAPINFOHEADER
+    putLE(out, static_cast<uint32_t>(image.width), 4);
+    putLE(out, static_cast<uint32_t>(image.height), 4);
+    putLE(out, 1, 2);                // Planes
+    putLE(out, 32, 2);               // Bits per pixel
+    putLE(out, 0, 4);                // BI_RGB
+    putLE(out, pixelBytes, 4);
+    putLE(out, 2835, 4);             // 72 dpi
+    putLE(out, 2835, 4);
+    putLE(out, 0, 4);                // Palette colours
+    putLE(out, 0, 4);
+    for (int y = image.height - 1; y >= 0; y--) {
+        std::size_t i = static_cast<std::size_t>(y) * image.width;
+        for (int x = 0; x < image.width; x++, i++) {
+            Pixel p = pixelAt(image, i);
+            out.insert(out.end(), {p.b, p.g, p.r, p.a});
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> encodePPM(const View& image) {
+    const std::string header = "P6\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+    std::vector<uint8_t> out(header.begin(), header.end());
+    const std::size_t count = static_cast<std::size_t>(image.width) * image.height;
+    out.reserve(out.size() + count * 3);
+    for (std::size_t i = 0; i < count; i++) {
+        Pixel p = pixelAt(image, i);
+        out.insert(out.end(), {p.r, p.g, p.b});
+    }
+    return out;
+}
+
+std::string lowerExtension(const std::string& filename) {
+    std::size_t dot = filename.rfind('.');
+    if (dot == std::string::npos || filename.find_first_of("/\\", dot) != std::string::npos) {
+        return "";
+    }
+    std::string extension = filename.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+} // anonymous namespace
+
+View byteView(const std::vector<uint8_t>& elements, const std::vector<int>& dimensions) {
+    if (dimensions.size() != 3 || dimensions[2] != 4 || dimensions[0] <= 0 || dimensions[1] <= 0 ||
+        elements.size() != static_cast<std::size_t>(dimensions[0]) * dimensions[1] * 4) {
+        throw std::runtime_error("a byte framebuffer must be byte_array(height, width, 4)");
+    }
+    return {elements.data(), dimensions[1], dimensions[0], Format::RGBA_BYTES};
+}
+
+View intView(const std::vector<int>& elements, const std::vector<int>& dimensions) {
+    if (dimensions.size() != 2 || dimensions[0] <= 0 || dimensions[1] <= 0 ||
+        elements.size() != static_cast<std::size_t>(dimensions[0]) * dimensions[1]) {
+        throw std::runtime_error("an int framebuffer must be int_array(height, width)");
+    }
+    return {elements.data(), dimensions[1], dimensions[0], Format::RGB_INTS};
+}
+
+std::vector<uint8_t> blank(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        throw std::runtime_error("framebuffer size must be positive");
+    }
+    std::vector<uint8_t> pixels(static_cast<std::size_t>(width) * height * 4, 0);
+    for (std::size_t i = 3; i < pixels.size(); i += 4) {
+        pixels[i] = 255;
+    }
+    return pixels;
+}
+
+bool save(const std::string& filename, const View& image) {
+    const std::string extension = lowerExtension(filename);
+    std::vector<uint8_t> bytes;
+    if (extension == "bmp") {
+        bytes = encodeBMP(image);
+    } else if (extension == "ppm") {
+        bytes = encodePPM(image);
+    } else {
+        throw std::runtime_error("image filename must end in .bmp or .ppm");
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    file.close();
+    return !file.fail();
+}
+
+} // namespace PixelImage
+
+} // namespace rbasic
@@ -0,0 +1,142 @@
+#include "profiler.h"
+#include "ast.h"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+
+namespace rbasic {
+
+namespace {
+
+double toMilliseconds(Profiler::Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+std::string lineName(const Statement& stmt) {
+    const SourcePosition& pos = stmt.getPosition();
+    if (pos.line < 0) {
+        return "<unknown>";
+    }
+    return (pos.filename.empty() ? std::string("<input>") : pos.filename) + ":" + std::to_string(pos.line);
+}
+
+} // anonymous namespace
+
+void Profiler::enter(std::vector<Stats>& stats, std::vector<Frame>& frames, std::size_t index, std::size_t stack) {
+    stats[index].active++;
+    frames.push_back(Frame{index, stack, Clock::now()});
+}
+
+Profiler::Clock::duration Profiler::exit(std::vector<Stats>& stats, std::vector<Frame>& frames) {
+    Frame frame = frames.back();
+    frames.pop_back();
+    Clock::duration elapsed = Clock::now() - frame.start;
+
+    Stats& entry = stats[frame.index];
+    entry.count++;
+    if (--entry.active == 0) {
+        entry.inclusive += elapsed;
+    }
+    entry.exclusive += elapsed - frame.children;
+    if (!frames.empty()) {
+        frames.back().children += elapsed;
+    }
+    return elapsed - frame.children;
+}
+
+void Profiler::enterLine(const Statement& stmt) {
+    auto it = lineIndex_.find(&stmt);
+    if (it == lineIndex_.end()) {
+        std::string name = lineName(stmt);
+        auto named = lineByName_.find(name);
+        if (named == lineByName_.end()) {
+            named = lineByName_.emplace(name, lines_.size()).first;
+            lines_.push_back(Stats{name});
+        }
+        it = lineIndex_.emplace(&stmt, named->second).first;
+    }
+    enter(lines_, lineFrames_, it->second, 0);
+}
+
+void Profiler::exitLine() {
+    exit(lines_, lineFrames_);
+}
+
+void Profiler::enterFunction(const FunctionDecl* func) {
+    auto it = functionIndex_.find(func);
+    if (it == functionIndex_.end()) {
+        it = functionIndex_.emplace(func, functions_.size()).first;
+        functions_.push_back(Stats{func ? func->name : "(main)"});
+    }
+
+    std::size_t parent = functionFrames_.empty() ? std::string::npos : functionFrames_.back().stack;
+    std::uint64_t key = (static_cast<std::uint64_t>(parent + 1) << 32) | it->second;
+    auto stack = stackIndex_.find(key);
+    if (stack == stackIndex_.end()) {
+        stack = stackIndex_.emplace(key, stacks_.size()).first;
+        stacks_.push_back(CallStack{parent, it->second});
+    }
+    enter(functions_, functionFrames_, it->second, stack->second);
+}
+
+void Profiler::exitFunction() {
+    std::size_t stack = functionFrames_.back().stack;
+    stacks_[stack].exclusive += exit(functions_, functionFrames_);
+}
+
+std::string Profiler::stackName(std::size_t stack) const {
+    std::string name = functions_[stacks_[stack].function].name;
+    for (std::size_t parent = stacks_[stack].parent; parent != std::string::npos; parent = stacks_[parent].parent) {
+        name = functions_[stacks_[parent].function].name + ";" + name;
+    }
+    return name;
+}
+
+void Profiler::writeReport(std::ostream& out, std::size_t maxLines) const {
+    Clock::duration total{};
+    for (const auto& stack : stacks_) {
+        total += stack.exclusive;
+    }
+    double totalMs = toMilliseconds(total);
+
+    auto byExclusive = [](const Stats* a, const Stats* b) { return a->exclusive > b->exclusive; };
+    auto writeTable = [&](const std::vector<Stats>& stats, const char* countLabel, const char* nameLabel,
+                          std::size_t limit) {
+        std::vector<const Stats*> sorted;
+        for (const auto& entry : stats) {
+            sorted.push_back(&entry);
+        }
+        std::sort(sorted.begin(), sorted.end(), byExclusive);
+        if (sorted.size() > limit) {
+            sorted.resize(limit);
+        }
+
+        char row[160];
+        std::snprintf(row, sizeof(row), "%10s %12s %12s %7s  %s\n", countLabel, "incl ms", "excl ms", "excl %", nameLabel);
+        out << row;
+        for (const Stats* entry : sorted) {
+            double exclusiveMs = toMilliseconds(entry->exclusive);
+            std::snprintf(row, sizeof(row), "%10llu %12.3f %12.3f %6.1f%%  ", static_cast<unsigned long long>(entry->count),
+                          toMilliseconds(entry->inclusive), exclusiveMs, totalMs > 0 ? 100.0 * exclusiveMs / totalMs : 0.0);
+            out << row << entry->name << "\n";
+        }
+    };
+
+    char header[80];
+    std::snprintf(header, sizeof(header), "=== Profile: %.3f ms ===\n", totalMs);
+    out << header << "\nFunctions\n";
+    writeTable(functions_, "calls", "function", functions_.size());
+    out << "\nLines (top " << std::min(maxLines, lines_.size()) << " of " << lines_.size() << ")\n";
+    writeTable(lines_, "hits", "location", maxLines);
+}
+
+void Profiler::writeCollapsedStacks(std::ostream& out) const {
+    for (std::size_t i = 0; i < stacks_.size(); i++) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(stacks_[i].exclusive).count();
+        if (micros > 0) {
+            out << stackName(i) << " " << micros << "\n";
+        }
+    }
+}
+
+} // namespace rbasic
@@ -1,10 +1,13 @@
 #include "repl.h"
 #include "common.h"
+#include "type_utils.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <iomanip>
 
 namespace rbasic {
 
@@ -19,7 +22,43 @@ std::string removeQuotes(const std::string& str) {
     return result;
 }
 
-REPL::REPL() : inMultilineMode(false), lineNumber(1) {
+// Whether text ends inside a string literal or block comment, by the rules
+// the lexer uses, so that more lines are needed to lex it
+static bool endsInsideLiteral(const std::string& text) {
+    bool inString = false;
+    bool inComment = false;
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (inComment) {
+            if (c == '*' && i + 1 < text.size() && text[i + 1] == '/') {
+                inComment = false;
+                i++;
+            }
+        } else if (inString) {
+            if (c == '\\') {
+                i++;  // Escaped character
+            } else if (c == '"') {
+                inString = false;
+            }
+        } else if (c == '"') {
+            inString = true;
+        } else if (c == '/' && i + 1 < text.size() && text[i + 1] == '/') {
+            while (i < text.size() && text[i] != '\n') i++;
+        } else if (c == '/' && i + 1 < text.size() && text[i + 1] == '*') {
+            inComment = true;
+            i++;
+        }
+    }
+    return inString || inComment;
+}
+
+static std::string formatMs(double ms) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << ms << " ms";
+    return out.str();
+}
+
+REPL::REPL() : lexedLines(0), braceDepth(0), inMultilineMode(false), lineNumber(1) {
 }
 
 int REPL::run() {
@@ -70,6 +109,8 @@ void REPL::showHelp() {
     Terminal::println("  :load <file>          - Load and execute a .bas file", Colour::DEFAULT);
     Terminal::println("  :save <file>          - Save current session to file", Colour::DEFAULT);
     Terminal::println("  :history              - Show command history", Colour::DEFAULT);
+    Terminal::println("  :time <code>          - Run code and show how long it took", Colour::DEFAULT);
+    Terminal::println("  :bench <n> <code>     - Run code n times and show mean, median, min and max", Colour::DEFAULT);
     Terminal::println("  :quit or :exit        - Exit REPL", Colour::DEFAULT);
     Terminal::println("");
     Terminal::println("Code Execution:", Colour::BRIGHT_YELLOW);
@@ -94,116 +135,185 @@ void REPL::processLine(const std::string& line) {
         return;
     }
     
-    // Add line to multiline buffer
-    if (!currentMultilineBuffer.empty()) {
-        currentMultilineBuffer += "\n";
+    // Lex just the new line, unless a string or comment is still open
+    unlexed += line;
+    unlexed += '\n';
+    if (!endsInsideLiteral(unlexed)) {
+        lexPending();
     }
-    currentMultilineBuffer += line;
     
     // Check if statement is complete or if user wants to force execution
-    if (line.empty() || isCompleteStatement(currentMultilineBuffer)) {
-        if (!currentMultilineBuffer.empty()) {
+    if (line.empty() || isCompleteStatement()) {
+        lexPending();
+        if (!pendingTokens.empty()) {
             executeBuffer();
         }
-        currentMultilineBuffer.clear();
+        pendingTokens.clear();
+        lexedLines = 0;
+        braceDepth = 0;
         inMultilineMode = false;
     } else {
         inMultilineMode = true;
     }
 }
 
-bool REPL::isCompleteStatement(const std::string& code) {
-    // Simple brace counting for now
-    int braceCount = countBraces(code);
-    
-    // If braces are balanced, statement might be complete
-    if (braceCount == 0) {
-        // Check for keywords that typically start multi-line blocks
-        std::string trimmed = code;
-        // Remove leading whitespace
-        trimmed.erase(0, trimmed.find_first_not_of(" \t\n\r"));
-        
-        // If line ends with certain keywords, it's likely incomplete
-        if (trimmed.length() >= 8 && trimmed.substr(trimmed.length() - 8) == "function") return false;
-        if (trimmed.length() >= 6 && trimmed.substr(trimmed.length() - 6) == "struct") return false;
-        if (trimmed.length() >= 2 && trimmed.substr(trimmed.length() - 2) == "if") return false;
-        if (trimmed.length() >= 4 && trimmed.substr(trimmed.length() - 4) == "else") return false;
-        if (trimmed.length() >= 3 && trimmed.substr(trimmed.length() - 3) == "for") return false;
-        if (trimmed.length() >= 5 && trimmed.substr(trimmed.length() - 5) == "while") return false;
-        if (trimmed.length() >= 1 && trimmed.substr(trimmed.length() - 1) == "{") return false;
-        
-        return true;
+void REPL::lexPending() {
+    if (unlexed.empty()) {
+        return;
     }
-    
-    return false; // Unmatched braces
-}
-
-int REPL::countBraces(const std::string& code) {
-    int count = 0;
-    bool inString = false;
-    bool inComment = false;
-    
-    for (size_t i = 0; i < code.length(); i++) {
-        char c = code[i];
-        
-        // Handle string literals
-        if (c == '"' && !inComment) {
-            if (i == 0 || code[i-1] != '\\') {
-                inString = !inString;
-            }
+    Lexer lexer(unlexed);
+    for (Token& token : lexer.tokenize()) {
+        if (token.type == TokenType::EOF_TOKEN) {
             continue;
         }
-        
-        if (inString) continue;
-        
-        // Handle comments
-        if (c == '/' && i + 1 < code.length()) {
-            if (code[i + 1] == '/') {
-                // Line comment - skip to end of line
-                while (i < code.length() && code[i] != '\n') i++;
-                continue;
-            } else if (code[i + 1] == '*') {
-                // Block comment
-                inComment = true;
-                i++; // Skip the '*'
-                continue;
-            }
-        }
-        
-        if (inComment) {
-            if (c == '*' && i + 1 < code.length() && code[i + 1] == '/') {
-                inComment = false;
-                i++; // Skip the '/'
-            }
-            continue;
+        token.line += lexedLines;  // Line within the whole statement, for errors
+        if (token.type == TokenType::LEFT_BRACE) {
+            braceDepth++;
+        } else if (token.type == TokenType::RIGHT_BRACE) {
+            braceDepth--;
         }
-        
-        // Count braces
-        if (c == '{') count++;
-        else if (c == '}') count--;
+        pendingTokens.push_back(std::move(token));
+    }
+    lexedLines += static_cast<int>(std::count(unlexed.begin(), unlexed.end(), '\n'));
+    unlexed.clear();
+}
+
+bool REPL::isCompleteStatement() const {
+    // An open string, comment or brace means more is to come
+    if (!unlexed.empty() || braceDepth != 0) {
+        return false;
+    }
+    if (pendingTokens.empty()) {
+        return true;
     }
     
-    return count;
+    // So does a block keyword with its block still to follow, as does a
+    // block's header when its brace goes on the next line
+    switch (pendingTokens.back().type) {
+        case TokenType::FUNCTION:
+        case TokenType::STRUCT:
+        case TokenType::IF:
+        case TokenType::ELSE:
+        case TokenType::FOR:
+        case TokenType::WHILE:
+            return false;
+        case TokenType::RIGHT_PAREN:
+            switch (pendingTokens.front().type) {
+                case TokenType::FUNCTION:
+                case TokenType::IF:
+                case TokenType::FOR:
+                case TokenType::WHILE:
+                    return false;
+                default:
+                    return true;
+            }
+        default:
+            return true;
+    }
 }
 
 void REPL::executeBuffer() {
+    std::unique_ptr<Program> program;
     try {
-        // Create temporary program from buffer
-        Lexer lexer(currentMultilineBuffer);
-        auto tokens = lexer.tokenize();
-        Parser parser(tokens);
-        auto program = parser.parse();
-        
-        // Execute in existing interpreter context
-        interpreter.interpret(*program);
-        
+        // The tokens were lexed line by line as they were typed
+        Parser parser(std::move(pendingTokens));
+        program = parser.parse();
+    } catch (const SyntaxError& e) {
+        Terminal::println("Syntax Error: " + std::string(e.what()), Colour::RED);
+        return;
+    } catch (const std::exception& e) {
+        Terminal::println("Error: " + std::string(e.what()), Colour::RED);
+        return;
+    }
+    
+    // Execute in existing interpreter context
+    recordSymbols(*program);
+    runProgram(*program);
+}
+
+std::unique_ptr<Program> REPL::parseCode(const std::string& code) {
+    try {
+        Lexer lexer(code);
+        Parser parser(lexer.tokenize());
+        return parser.parse();
     } catch (const SyntaxError& e) {
         Terminal::println("Syntax Error: " + std::string(e.what()), Colour::RED);
+    } catch (const std::exception& e) {
+        Terminal::println("Error: " + std::string(e.what()), Colour::RED);
+    }
+    return nullptr;
+}
+
+bool REPL::runProgram(Program& program) {
+    try {
+        program.accept(interpreter);
+        return true;
     } catch (const RuntimeError& e) {
         Terminal::println("Runtime Error: " + std::string(e.what()), Colour::RED);
     } catch (const std::exception& e) {
         Terminal::println("Error: " + std::string(e.what()), Colour::RED);
     }
+    return false;
+}
+
+void REPL::recordSymbols(const Program& program) {
+    for (const auto& stmt : program.statements) {
+        if (auto* func = dynamic_cast<const FunctionDecl*>(stmt.get())) {
+            symbols[func->name] = "function";
+        } else if (auto* decl = dynamic_cast<const StructDecl*>(stmt.get())) {
+            symbols[decl->name] = "struct";
+        } else if (auto* dim = dynamic_cast<const DimStmt*>(stmt.get())) {
+            symbols[dim->variable] = "variable";
+        } else if (auto* var = dynamic_cast<const VarStmt*>(stmt.get())) {
+            if (var->indices.empty() && var->member.empty()) {
+                symbols[var->variable] = "variable";
+            }
+        }
+    }
+}
+
+void REPL::timeCode(const std::string& code) {
+    auto program = parseCode(code);
+    if (!program) {
+        return;
+    }
+    recordSymbols(*program);
+    auto start = std::chrono::steady_clock::now();
+    bool ok = runProgram(*program);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    if (ok) {
+        Terminal::println("Time: " + formatMs(elapsed.count()), Colour::GREEN);
+    }
+}
+
+void REPL::benchCode(int runs, const std::string& code) {
+    // Parsed once, so the runs time execution alone
+    auto program = parseCode(code);
+    if (!program) {
+        return;
+    }
+    recordSymbols(*program);
+    std::vector<double> times;
+    times.reserve(static_cast<size_t>(runs));
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = runProgram(*program);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (!ok) {
+            Terminal::println("Stopped at run " + std::to_string(i + 1), Colour::YELLOW);
+            return;
+        }
+        times.push_back(elapsed.count());
+    }
+    
+    double total = 0;
+    for (double time : times) {
+        total += time;
+    }
+    std::sort(times.begin(), times.end());
+    Terminal::println(std::to_string(runs) + " runs: mean " + formatMs(total / runs) +
+                      ", median " + formatMs(times[times.size() / 2]) +
+                      ", min " + formatMs(times.front()) + ", max " + formatMs(times.back()), Colour::GREEN);
 }
 
 void REPL::handleMetaCommand(const std::string& command) {
@@ -231,6 +341,24 @@ void REPL::handleMetaCommand(const std::string& command) {
         } else {
             Terminal::println("Usage: :load <filename>", Colour::YELLOW);
         }
+    } else if (cmd == ":time") {
+        std::string code;
+        std::getline(iss >> std::ws, code);
+        if (!code.empty()) {
+            timeCode(code);
+        } else {
+            Terminal::println("Usage: :time <code>", Colour::YELLOW);
+        }
+    } else if (cmd == ":bench") {
+        int runs = 0;
+        std::string code;
+        iss >> runs;
+        std::getline(iss >> std::ws, code);
+        if (runs > 0 && !code.empty()) {
+            benchCode(runs, code);
+        } else {
+            Terminal::println("Usage: :bench <runs> <code>", Colour::YELLOW);
+        }
     } else if (cmd == ":save") {
         std::string filename;
         iss >> filename;
@@ -247,16 +375,37 @@ void REPL::handleMetaCommand(const std::string& command) {
 }
 
 void REPL::listVariables() {
+    if (symbols.empty()) {
+        Terminal::println("Nothing defined yet", Colour::YELLOW);
+        return;
+    }
+    
     Terminal::println("Current Session State:", Colour::BRIGHT_YELLOW);
-    Terminal::println("(Note: Variable inspection not yet implemented)", Colour::YELLOW);
-    Terminal::println("Use the interpreter's built-in variable system", Colour::DEFAULT);
-    Terminal::println("");
+    for (const auto& symbol : symbols) {
+        std::string line = "  " + symbol.second + " " + symbol.first;
+        if (symbol.second == "variable") {
+            try {
+                VariableExpr variable(symbol.first);
+                std::string value = TypeUtils::toString(interpreter.evaluate(variable));
+                std::replace(value.begin(), value.end(), '\n', ' ');
+                line += " = " + (value.size() > 60 ? value.substr(0, 57) + "..." : value);
+            } catch (const std::exception&) {
+                line += " (not set)";  // Its statement failed before setting it
+            }
+        }
+        std::cout << line << "\n";
+    }
+    std::cout << "\n";
 }
 
 void REPL::clearSession() {
     // Create a new interpreter instance to clear all state
     interpreter = Interpreter();
-    currentMultilineBuffer.clear();
+    pendingTokens.clear();
+    unlexed.clear();
+    lexedLines = 0;
+    braceDepth = 0;
+    symbols.clear();
     inMultilineMode = false;
     Terminal::println("Session cleared - all variables and functions removed", Colour::GREEN);
 }
@@ -295,10 +444,10 @@ void REPL::loadFile(const std::string& filename) {
     
     try {
         Lexer lexer(content);
-        auto tokens = lexer.tokenize();
-        Parser parser(tokens);
+        Parser parser(lexer.tokenize());
         auto program = parser.parse();
         
+        recordSymbols(*program);
         interpreter.interpret(*program);
         Terminal::println("Loaded and executed: " + resolvedPath, Colour::GREEN);
         
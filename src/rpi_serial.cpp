@@ -504,6 +504,14 @@ int serial_available(int handle) {
     return g_serial_ports[handle]->available();
 }
 
+int serial_fd(int handle) {
+    if (handle < 0 || handle >= 4 || g_serial_ports[handle] == nullptr) {
+        return -1;
+    }
+    
+    return g_serial_ports[handle]->fd();
+}
+
 void serial_flush(int handle) {
     if (handle < 0 || handle >= 4 || g_serial_ports[handle] == nullptr) {
         return;
@@ -1,4 +1,5 @@
 #include "runtime.h"
+#include "terminal.h"
 #include <cmath>
 #include <sstream>
 
@@ -17,6 +18,7 @@ ValueType Runtime::basicPrint(const std::vector<ValueType>& args) {
 }
 
 ValueType Runtime::basicInput(const std::vector<ValueType>& /* args */) {
+    Terminal::stopReadingKeys();
     std::string line;
     std::getline(std::cin, line);
     
@@ -73,10 +75,10 @@ ValueType Runtime::basicRight(const std::vector<ValueType>& args) {
 ValueType Runtime::basicAbs(const std::vector<ValueType>& args) {
     if (args.empty()) return 0;
     
-    if (std::holds_alternative<int>(args[0])) {
-        return std::abs(std::get<int>(args[0]));
-    } else if (std::holds_alternative<double>(args[0])) {
-        return std::abs(std::get<double>(args[0]));
+    if (rbasic::holds_alternative<int>(args[0])) {
+        return std::abs(rbasic::get<int>(args[0]));
+    } else if (rbasic::holds_alternative<double>(args[0])) {
+        return std::abs(rbasic::get<double>(args[0]));
     }
     
     return 0;
@@ -98,15 +100,15 @@ ValueType Runtime::basicRnd(const std::vector<ValueType>& /* args */) {
 
 // Type conversion functions
 int Runtime::toInt(const ValueType& value) {
-    if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value);
-    } else if (std::holds_alternative<double>(value)) {
-        return static_cast<int>(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? 1 : 0;
-    } else if (std::holds_alternative<std::string>(value)) {
+    if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value);
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return static_cast<int>(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? 1 : 0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
         try {
-            return std::stoi(std::get<std::string>(value));
+            return std::stoi(rbasic::get<std::string>(value));
         } catch (const std::exception&) {
             return 0;
         }
@@ -115,15 +117,15 @@ int Runtime::toInt(const ValueType& value) {
 }
 
 double Runtime::toDouble(const ValueType& value) {
-    if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return static_cast<double>(std::get<int>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? 1.0 : 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
+    if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return static_cast<double>(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? 1.0 : 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
         try {
-            return std::stod(std::get<std::string>(value));
+            return std::stod(rbasic::get<std::string>(value));
         } catch (const std::exception&) {
             return 0.0;
         }
@@ -132,27 +134,27 @@ double Runtime::toDouble(const ValueType& value) {
 }
 
 std::string Runtime::toString(const ValueType& value) {
-    if (std::holds_alternative<std::string>(value)) {
-        return std::get<std::string>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::to_string(std::get<int>(value));
-    } else if (std::holds_alternative<double>(value)) {
-        return std::to_string(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? "true" : "false";
+    if (rbasic::holds_alternative<std::string>(value)) {
+        return rbasic::get<std::string>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return std::to_string(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return std::to_string(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? "true" : "false";
     }
     return "";
 }
 
 bool Runtime::toBool(const ValueType& value) {
-    if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value) != 0;
-    } else if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value) != 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        return !std::get<std::string>(value).empty();
+    if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value) != 0;
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value) != 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        return !rbasic::get<std::string>(value).empty();
     }
     return false;
 }
@@ -0,0 +1,84 @@
+#include "slow_trace.h"
+#include "ast.h"
+#include <cstdio>
+#include <ostream>
+
+namespace rbasic {
+
+SlowTrace::SlowTrace(std::ostream& out, double thresholdMs, std::size_t capacity)
+    : out_(out),
+      threshold_(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(thresholdMs))),
+      ring_(capacity) {
+    writer_ = std::thread([this] { writerLoop(); });
+}
+
+SlowTrace::~SlowTrace() {
+    stopping_.store(true);
+    wake_.notify_one();
+    writer_.join();
+    if (std::uint64_t lost = dropped()) {
+        out_ << "slow trace: " << lost << " line(s) dropped, log buffer full\n";
+        out_.flush();
+    }
+}
+
+std::string SlowTrace::prefix(Clock::duration elapsed) const {
+    char ms[32];
+    std::snprintf(ms, sizeof(ms), "%10.2f ms  ", std::chrono::duration<double, std::milli>(elapsed).count());
+    std::string line = std::string("slow ") + ms;
+    SourcePosition pos = statements_.empty() ? SourcePosition() : statements_.back()->getPosition();
+    line += pos.isValid() ? (pos.filename.empty() ? std::string("<input>") : pos.filename) + ":" +
+                                std::to_string(pos.line)
+                          : std::string("<unknown>");
+    line += "  (main)";
+    for (const FunctionDecl* func : stack_) {
+        line += " > " + func->name;
+    }
+    return line;
+}
+
+void SlowTrace::statementDone(Clock::duration elapsed) {
+    if (isSlow(elapsed)) {
+        push(prefix(elapsed) + "\n");
+    }
+    statements_.pop_back();
+}
+
+void SlowTrace::callDone(const std::string& name, const std::string& arguments, Clock::duration elapsed) {
+    if (isSlow(elapsed)) {
+        push(prefix(elapsed) + "  " + name + "(" + arguments + ")\n");
+    }
+}
+
+void SlowTrace::push(std::string line) {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == ring_.size()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring_[head % ring_.size()] = std::move(line);
+    head_.store(head + 1, std::memory_order_release);
+    wake_.notify_one();
+}
+
+void SlowTrace::writerLoop() {
+    for (;;) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t head = head_.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            std::string line = std::move(ring_[tail % ring_.size()]);
+            tail_.store(tail + 1, std::memory_order_release);
+            out_ << line;
+        }
+        out_.flush();
+        if (stopping_.load() && tail_.load() == head_.load()) {
+            return;
+        }
+        // push() notifies without the mutex, so a wakeup can be missed;
+        // the timeout bounds how long a line then waits
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        wake_.wait_for(lock, std::chrono::milliseconds(100));
+    }
+}
+
+} // namespace rbasic
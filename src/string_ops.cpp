@@ -0,0 +1,116 @@
+#include "string_ops.h"
+#include <algorithm>
+
+namespace rbasic {
+
+namespace StringOps {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+} // anonymous namespace
+
+std::string_view mid(std::string_view s, int start, int length) {
+    size_t offset = static_cast<size_t>(std::max(1, start) - 1);  // 1-based to 0-based
+    if (offset >= s.size()) {
+        return std::string_view();
+    }
+    return length < 0 ? s.substr(offset) : s.substr(offset, static_cast<size_t>(length));
+}
+
+std::string_view left(std::string_view s, int length) {
+    return s.substr(0, static_cast<size_t>(std::max(0, length)));
+}
+
+std::string_view right(std::string_view s, int length) {
+    size_t count = std::min(s.size(), static_cast<size_t>(std::max(0, length)));
+    return s.substr(s.size() - count);
+}
+
+int instr(std::string_view haystack, std::string_view needle, int start) {
+    size_t offset = static_cast<size_t>(std::max(1, start) - 1);
+    if (offset > haystack.size()) {
+        return 0;
+    }
+    size_t found = haystack.find(needle, offset);
+    return found == std::string_view::npos ? 0 : static_cast<int>(found) + 1;
+}
+
+std::vector<std::string_view> split(std::string_view s, std::string_view delimiter) {
+    std::vector<std::string_view> parts;
+    if (delimiter.empty()) {
+        parts.reserve(s.size());
+        for (size_t i = 0; i < s.size(); i++) {
+            parts.push_back(s.substr(i, 1));
+        }
+        return parts;
+    }
+
+    size_t begin = 0;
+    while (true) {
+        size_t found = s.find(delimiter, begin);
+        if (found == std::string_view::npos) {
+            parts.push_back(s.substr(begin));
+            return parts;
+        }
+        parts.push_back(s.substr(begin, found - begin));
+        begin = found + delimiter.size();
+    }
+}
+
+std::string replace(std::string_view s, std::string_view from, std::string_view to) {
+    if (from.empty()) {
+        return std::string(s);
+    }
+
+    std::string result;
+    result.reserve(s.size());
+    size_t begin = 0;
+    size_t found;
+    while ((found = s.find(from, begin)) != std::string_view::npos) {
+        result.append(s, begin, found - begin);
+        result.append(to);
+        begin = found + from.size();
+    }
+    result.append(s, begin, std::string_view::npos);
+    return result;
+}
+
+std::string upper(std::string_view s) {
+    std::string result(s);
+    for (char& c : result) {
+        if (c >= 'a' && c <= 'z') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+    }
+    return result;
+}
+
+std::string lower(std::string_view s) {
+    std::string result(s);
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return result;
+}
+
+std::string_view trim(std::string_view s) {
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && isSpace(s[begin])) {
+        begin++;
+    }
+    while (end > begin && isSpace(s[end - 1])) {
+        end--;
+    }
+    return s.substr(begin, end - begin);
+}
+
+} // namespace StringOps
+
+} // namespace rbasic
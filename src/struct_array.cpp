@@ -0,0 +1,164 @@
+#include "struct_array.h"
+#include "memory_stats.h"
+#include <stdexcept>
+
+namespace rbasic {
+
+std::size_t StructColumn::size() const {
+    switch (kind_) {
+        case Kind::INT: return ints_.size();
+        case Kind::DOUBLE: return doubles_.size();
+        default: return values_.size();
+    }
+}
+
+std::size_t StructColumn::heapBytes() const {
+    std::size_t bytes = rbasic::heapBytes(ints_) + rbasic::heapBytes(doubles_) + rbasic::heapBytes(values_);
+    for (const Field& value : values_) {
+        if (auto* text = std::get_if<std::string>(&value)) {
+            bytes += rbasic::heapBytes(*text);
+        }
+    }
+    return bytes;
+}
+
+StructColumn::Field StructColumn::get(std::size_t index) const {
+    switch (kind_) {
+        case Kind::INT: return ints_[index];
+        case Kind::DOUBLE: return doubles_[index];
+        default: return values_[index];
+    }
+}
+
+void StructColumn::set(std::size_t index, const Field& value) {
+    if (kind_ == Kind::INT) {
+        if (auto* i = std::get_if<int>(&value)) {
+            ints_[index] = *i;
+            return;
+        }
+        if (std::holds_alternative<double>(value)) {
+            widenToDouble();
+        } else {
+            widenToGeneric();
+        }
+    }
+    if (kind_ == Kind::DOUBLE) {
+        if (auto* d = std::get_if<double>(&value)) {
+            doubles_[index] = *d;
+            return;
+        }
+        if (auto* i = std::get_if<int>(&value)) {
+            doubles_[index] = *i;
+            return;
+        }
+        widenToGeneric();
+    }
+    values_[index] = value;
+}
+
+void StructColumn::assign(std::vector<int> values) {
+    if (values.size() != size()) {
+        throw std::runtime_error("struct column size mismatch");
+    }
+    doubles_.clear();
+    values_.clear();
+    ints_ = std::move(values);
+    kind_ = Kind::INT;
+}
+
+void StructColumn::assign(std::vector<double> values) {
+    if (values.size() != size()) {
+        throw std::runtime_error("struct column size mismatch");
+    }
+    ints_.clear();
+    values_.clear();
+    doubles_ = std::move(values);
+    kind_ = Kind::DOUBLE;
+}
+
+void StructColumn::assign(std::vector<Field> values) {
+    if (values.size() != size()) {
+        throw std::runtime_error("struct column size mismatch");
+    }
+    ints_.clear();
+    doubles_.clear();
+    values_ = std::move(values);
+    kind_ = Kind::GENERIC;
+}
+
+void StructColumn::widenToDouble() {
+    doubles_.assign(ints_.begin(), ints_.end());
+    ints_.clear();
+    ints_.shrink_to_fit();
+    kind_ = Kind::DOUBLE;
+}
+
+void StructColumn::widenToGeneric() {
+    values_.reserve(size());
+    if (kind_ == Kind::INT) {
+        values_.assign(ints_.begin(), ints_.end());
+        ints_.clear();
+        ints_.shrink_to_fit();
+    } else {
+        values_.assign(doubles_.begin(), doubles_.end());
+        doubles_.clear();
+        doubles_.shrink_to_fit();
+    }
+    kind_ = Kind::GENERIC;
+}
+
+StructArray::StructArray(StructLayoutPtr structLayout, const std::vector<int>& dims)
+    : layout(std::move(structLayout)), dimensions(dims) {
+    std::size_t total = 1;
+    for (int dim : dims) {
+        if (dim < 0) {
+            throw std::runtime_error("negative struct array dimension");
+        }
+        total *= static_cast<std::size_t>(dim);
+    }
+    columns.assign(layout->fieldNames.size(), StructColumn(total));
+}
+
+std::size_t StructArray::size() const {
+    return columns.empty() ? 0 : columns.front().size();
+}
+
+std::size_t StructArray::heapBytes() const {
+    std::size_t bytes = rbasic::heapBytes(columns) + rbasic::heapBytes(dimensions);
+    for (const StructColumn& column : columns) {
+        bytes += column.heapBytes();
+    }
+    return bytes;
+}
+
+StructColumn& StructArray::column(const std::string& field) {
+    int index = fieldIndex(field);
+    if (index < 0) {
+        throw std::runtime_error("Struct member '" + field + "' not found in " + typeName());
+    }
+    return columns[index];
+}
+
+const StructColumn& StructArray::column(const std::string& field) const {
+    int index = fieldIndex(field);
+    if (index < 0) {
+        throw std::runtime_error("Struct member '" + field + "' not found in " + typeName());
+    }
+    return columns[index];
+}
+
+std::size_t StructArray::flatIndex(const std::vector<int>& indices) const {
+    if (indices.size() != dimensions.size()) {
+        throw std::out_of_range("struct array expects " + std::to_string(dimensions.size()) + " indices");
+    }
+    std::size_t index = 0;
+    for (std::size_t i = 0; i < dimensions.size(); i++) {
+        if (indices[i] < 0 || indices[i] >= dimensions[i]) {
+            throw std::out_of_range("struct array index out of range");
+        }
+        index = index * static_cast<std::size_t>(dimensions[i]) + static_cast<std::size_t>(indices[i]);
+    }
+    return index;
+}
+
+} // namespace rbasic
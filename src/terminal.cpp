@@ -1,14 +1,26 @@
 #include "terminal.h"
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <conio.h>
 #else
+#include "event_wait.h"
 #include <termios.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <csignal>
 #include <sys/ioctl.h>
+#include <atomic>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -16,11 +28,366 @@
 
 namespace rbasic {
 
+// One character cell of a frame: a UTF-8 sequence and its colours
+struct FrameCell {
+    char glyph[4] = {' ', 0, 0, 0};
+    std::uint8_t size = 1;
+    std::int8_t foreground = -1;
+    std::int8_t background = -1;
+    
+    bool operator==(const FrameCell& other) const {
+        return size == other.size && foreground == other.foreground && background == other.background &&
+               std::memcmp(glyph, other.glyph, size) == 0;
+    }
+    bool operator!=(const FrameCell& other) const { return !(*this == other); }
+};
+
+#ifndef _WIN32
+// A key as readKey returns it, and the first byte the terminal sent for it,
+// which is what getch returns while the key reader runs
+struct Key {
+    char text[12];
+    unsigned char first;
+};
+
+// Name of the key an escape sequence (ESC [ ... or ESC O x) stands for, or
+// nullptr if it is not one we know. Modifier parameters are ignored.
+static const char* escapeName(const unsigned char* sequence, size_t length) {
+    static const char* const functionKeys[] = {"F1", "F2", "F3", "F4", "F5", "F6",
+                                               "F7", "F8", "F9", "F10", "F11", "F12"};
+    const unsigned char final = sequence[length - 1];
+    if (final != '~') {
+        switch (final) {
+            case 'A': return "UP";
+            case 'B': return "DOWN";
+            case 'C': return "RIGHT";
+            case 'D': return "LEFT";
+            case 'H': return "HOME";
+            case 'F': return "END";
+        }
+        // ESC [ R is also a cursor position report, so only ESC O gives F1-F4
+        if (sequence[1] == 'O' && final >= 'P' && final <= 'S') {
+            return functionKeys[final - 'P'];
+        }
+        return nullptr;
+    }
+    int number = 0;
+    for (size_t i = 2; i < length && sequence[i] >= '0' && sequence[i] <= '9'; i++) {
+        number = number * 10 + (sequence[i] - '0');
+    }
+    switch (number) {
+        case 1: case 7: return "HOME";
+        case 2: return "INSERT";
+        case 3: return "DELETE";
+        case 4: case 8: return "END";
+        case 5: return "PGUP";
+        case 6: return "PGDN";
+        case 11: case 12: case 13: case 14: case 15: return functionKeys[number - 11];
+        case 17: case 18: case 19: case 20: case 21: return functionKeys[number - 12];
+        case 23: case 24: return functionKeys[number - 13];
+    }
+    return nullptr;
+}
+
+// Bytes in the escape sequence at the start of bytes: 1 for a lone ESC
+// (or ESC then an ordinary key, as Alt sends), 0 if it is cut short
+static size_t escapeLength(const unsigned char* bytes, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+    if (bytes[1] == 'O') {
+        return size < 3 ? 0 : 3;
+    }
+    if (bytes[1] != '[') {
+        return 1;
+    }
+    size_t i = 2;
+    while (i < size && bytes[i] >= 0x30 && bytes[i] <= 0x3F) {
+        i++;  // Parameters
+    }
+    if (i == size) {
+        return 0;
+    }
+    return bytes[i] >= 0x40 && bytes[i] <= 0x7E ? i + 1 : 1;
+}
+
+// Reads stdin on a thread of its own, with the terminal in raw mode for as
+// long as it runs, and queues decoded keys in a single-producer
+// single-consumer ring. Every key queued also writes a byte to a pipe, so
+// a reader with nothing to do blocks in poll on the pipe (as wait_event
+// does); taking a queued key, or finding none, needs no system call.
+class KeyReader {
+public:
+    KeyReader();
+    ~KeyReader();
+    KeyReader(const KeyReader&) = delete;
+    KeyReader& operator=(const KeyReader&) = delete;
+
+    bool empty() const { return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire); }
+    bool next(Key& key, int timeoutMs);  // false on timeout, or at end of input
+    int descriptor() const { return notify_[0]; }
+
+private:
+    static constexpr size_t CAPACITY = 256;   // Keys; more are dropped until some are read
+    static constexpr int ESCAPE_WAIT_MS = 25; // For the rest of a sequence after ESC
+
+    void run();
+    size_t decode(const unsigned char* bytes, size_t size, bool flush);
+    bool signalKey(unsigned char c);
+    void push(const char* text, size_t length, unsigned char first);
+    bool pop(Key& key);
+    void signal();
+    void drain();
+    void closeAll();
+
+    Key ring_[CAPACITY];
+    std::atomic<size_t> head_{0};   // Written by the reader thread
+    std::atomic<size_t> tail_{0};   // Written by the thread taking keys
+    std::atomic<bool> ended_{false};
+    int notify_[2] = {-1, -1};      // A byte per key queued
+    int stop_[2] = {-1, -1};        // Written to end the reader thread
+    struct termios saved_;
+    struct termios raw_;
+    bool restore_ = false;
+    std::thread thread_;
+};
+
+KeyReader::KeyReader() {
+    if (::pipe(notify_) != 0 || ::pipe(stop_) != 0) {
+        closeAll();
+        throw std::runtime_error("terminal_read_key: cannot create pipe");
+    }
+    for (int fd : {notify_[0], notify_[1], stop_[0], stop_[1]}) {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    ::fcntl(notify_[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(notify_[1], F_SETFL, O_NONBLOCK);
+
+    // Raw once, for as long as the reader runs. The reader sends the
+    // signals for Ctrl+C, Ctrl+\ and Ctrl+Z itself (see signalKey), so
+    // that the terminal is back in line mode when they take effect.
+    if (tcgetattr(STDIN_FILENO, &saved_) == 0) {
+        raw_ = saved_;
+        raw_.c_lflag &= ~(ICANON | ECHO | ISIG);
+        // A read with nothing waiting returns at once rather than blocking,
+        // so the thread never sits in read after another reader of stdin
+        // took the bytes poll saw, and can always be joined
+        raw_.c_cc[VMIN] = 0;
+        raw_.c_cc[VTIME] = 0;
+        restore_ = tcsetattr(STDIN_FILENO, TCSANOW, &raw_) == 0;
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+KeyReader::~KeyReader() {
+    const char stop = 1;
+    (void)::write(stop_[1], &stop, 1);
+    thread_.join();
+    if (restore_) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_);
+    }
+    closeAll();
+}
+
+void KeyReader::closeAll() {
+    for (int fd : {notify_[0], notify_[1], stop_[0], stop_[1]}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+void KeyReader::run() {
+    unsigned char buffer[64];
+    size_t size = 0;
+    for (;;) {
+        pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {stop_[0], POLLIN, 0}};
+        // A sequence cut short is finished by bytes that follow at once, or
+        // was a lone ESC
+        int ready = ::poll(fds, 2, size > 0 ? ESCAPE_WAIT_MS : -1);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready < 0 || fds[1].revents != 0) {
+            break;
+        }
+        if (ready == 0) {
+            decode(buffer, size, true);
+            size = 0;
+            continue;
+        }
+        ssize_t got = ::read(STDIN_FILENO, buffer + size, sizeof(buffer) - size);
+        if (got < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (got == 0 && restore_ && (fds[0].revents & (POLLHUP | POLLERR)) == 0) {
+            continue;  // Raw mode with nothing left to read; poll again
+        }
+        if (got <= 0) {
+            break;  // End of input
+        }
+        size += static_cast<size_t>(got);
+        size_t used = decode(buffer, size, size == sizeof(buffer));
+        std::memmove(buffer, buffer + used, size - used);
+        size -= used;
+    }
+    decode(buffer, size, true);
+    ended_.store(true, std::memory_order_release);
+    signal();
+}
+
+// Queues the whole keys at the start of bytes and returns the bytes they
+// used. A key cut short is left for more bytes unless flush is set.
+size_t KeyReader::decode(const unsigned char* bytes, size_t size, bool flush) {
+    size_t i = 0;
+    while (i < size) {
+        const unsigned char c = bytes[i];
+        const char* name = nullptr;
+        size_t length = 1;
+        if (signalKey(c)) {
+            i++;
+            continue;
+        }
+        if (c == 0x1B) {
+            length = escapeLength(bytes + i, size - i);
+            if (length == 0 && !flush) {
+                break;
+            }
+            length = length == 0 ? 1 : length;
+            name = length == 1 ? "ESC" : escapeName(bytes + i, length);
+            if (!name) {
+                i += length;  // Not a key we know; dropped
+                continue;
+            }
+        } else if (c == '\r' || c == '\n') {
+            name = "ENTER";
+        } else if (c == '\t') {
+            name = "TAB";
+        } else if (c == 0x7F || c == 0x08) {
+            name = "BACKSPACE";
+        } else if (c >= 0xC0 && c <= 0xF7) {
+            length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            if (i + length > size) {
+                if (!flush) {
+                    break;
+                }
+                length = size - i;
+            }
+        }
+        if (name) {
+            push(name, std::strlen(name), c);
+        } else {
+            push(reinterpret_cast<const char*>(bytes + i), length, c);
+        }
+        i += length;
+    }
+    return i;
+}
+
+// The interrupt, quit and suspend keys raise their signals as they would in
+// line mode, with line mode restored first in case they stop the program
+bool KeyReader::signalKey(unsigned char c) {
+    if (!restore_ || c == _POSIX_VDISABLE) {
+        return false;
+    }
+    int number = c == saved_.c_cc[VINTR] ? SIGINT : c == saved_.c_cc[VQUIT] ? SIGQUIT :
+                 c == saved_.c_cc[VSUSP] ? SIGTSTP : 0;
+    if (number == 0) {
+        return false;
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_);
+    ::kill(::getpid(), number);
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw_);  // Handled, or continued after Ctrl+Z
+    return true;
+}
+
+void KeyReader::push(const char* text, size_t length, unsigned char first) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == CAPACITY) {
+        return;
+    }
+    Key& key = ring_[head % CAPACITY];
+    length = length < sizeof(key.text) ? length : sizeof(key.text) - 1;
+    std::memcpy(key.text, text, length);
+    key.text[length] = '\0';
+    key.first = first;
+    head_.store(head + 1, std::memory_order_release);
+    signal();
+}
+
+bool KeyReader::pop(Key& key) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    key = ring_[tail % CAPACITY];
+    tail_.store(tail + 1, std::memory_order_release);
+    if (tail + 1 == head_.load(std::memory_order_acquire)) {
+        // Empty now, so empty the pipe too; signal again for a key pushed meanwhile
+        drain();
+        if (!empty()) {
+            signal();
+        }
+    }
+    return true;
+}
+
+bool KeyReader::next(Key& key, int timeoutMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;) {
+        if (pop(key)) {
+            return true;
+        }
+        if (ended_.load(std::memory_order_acquire)) {
+            return pop(key);
+        }
+        int remaining = -1;
+        if (timeoutMs >= 0) {
+            auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            remaining = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+        }
+        if (remaining == 0) {
+            return false;
+        }
+        pollfd fd = {notify_[0], POLLIN, 0};
+        int ready = ::poll(&fd, 1, remaining);
+        if (ready == 0) {
+            return false;
+        }
+        if (ready > 0 && empty()) {
+            // The byte of a key already taken, written after pop emptied the pipe
+            drain();
+            if (!empty()) {
+                signal();
+            }
+        }
+    }
+}
+
+void KeyReader::signal() {
+    const char byte = 1;
+    (void)::write(notify_[1], &byte, 1);  // A full pipe is already readable
+}
+
+void KeyReader::drain() {
+    char bytes[64];
+    while (::read(notify_[0], bytes, sizeof(bytes)) > 0) {
+    }
+}
+#endif
+
 // Terminal state structure for proper encapsulation
 struct TerminalState {
     bool initialized = false;
     bool colourSupported = false;
     
+    // Frame being drawn and the one on screen, row-major; shown is empty
+    // when the screen contents are not known
+    std::vector<FrameCell> frame;
+    std::vector<FrameCell> shown;
+    int frameRows = 0;
+    int frameCols = 0;
+    
 #ifdef _WIN32
     void* hConsole = nullptr;
     void* hStdin = nullptr;
@@ -32,6 +399,7 @@ struct TerminalState {
     bool termiosWasSaved = false;
     int savedCursorRow = 0;
     int savedCursorCol = 0;
+    std::unique_ptr<KeyReader> keyReader;  // Started by readKey
 #endif
 };
 
@@ -41,6 +409,16 @@ TerminalState& getTerminalState() {
     return state;
 }
 
+#ifndef _WIN32
+// Ends readKey's raw mode and gives stdin back to line-based reads
+static void stopKeyReader(TerminalState& state) {
+    if (state.keyReader) {
+        state.keyReader.reset();
+        EventWait::instance().setKeySource(-1);
+    }
+}
+#endif
+
 bool Terminal::initialize() {
     TerminalState& state = getTerminalState();
     
@@ -98,6 +476,9 @@ bool Terminal::initialize() {
 
 void Terminal::cleanup() {
     TerminalState& state = getTerminalState();
+#ifndef _WIN32
+    stopKeyReader(state);
+#endif
     
     if (!state.initialized) {
         return;
@@ -133,6 +514,7 @@ bool Terminal::supportsColour() {
 
 void Terminal::clear() {
     TerminalState& state = getTerminalState();
+    state.shown.clear();
     
 #ifdef _WIN32
     COORD coordScreen = {0, 0};
@@ -160,7 +542,6 @@ void Terminal::clear() {
     
     SetConsoleCursorPosition(state.hConsole, coordScreen);
 #else
-    (void)state; // Suppress unused variable warning on non-Windows
     std::cout << "\033[2J\033[H" << std::flush;
 #endif
 }
@@ -189,7 +570,7 @@ void Terminal::getCursor(int& row, int& col) {
         row = col = 0;
     }
 #else
-    (void)state; // Suppress unused variable warning on non-Windows
+    stopKeyReader(state);  // It would take the reply
     // For Linux, we need to use raw terminal I/O to avoid interfering with stdout
     // Save terminal settings
     struct termios oldTermios;
@@ -397,6 +778,11 @@ bool Terminal::kbhit() {
 #ifdef _WIN32
     return _kbhit() != 0;
 #else
+    TerminalState& state = getTerminalState();
+    if (state.keyReader) {
+        return !state.keyReader->empty();
+    }
+    
     // Linux implementation using select()
     fd_set readfds;
     struct timeval tv;
@@ -415,6 +801,12 @@ int Terminal::getch() {
 #ifdef _WIN32
     return _getch();
 #else
+    TerminalState& state = getTerminalState();
+    Key key;
+    if (state.keyReader) {
+        return state.keyReader->next(key, -1) ? key.first : EOF;
+    }
+    
     struct termios oldt, newt;
     int ch;
     
@@ -430,7 +822,64 @@ int Terminal::getch() {
 #endif
 }
 
+std::string Terminal::readKey(int timeoutMs) {
+#ifdef _WIN32
+    // The console delivers keys already decoded, so poll it
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!_kbhit()) {
+        if (timeoutMs >= 0 && std::chrono::steady_clock::now() >= deadline) {
+            return "";
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int ch = _getch();
+    if (ch == 0 || ch == 0xE0) {
+        const int code = _getch();  // Scan code of a special key
+        switch (code) {
+            case 72: return "UP";
+            case 80: return "DOWN";
+            case 75: return "LEFT";
+            case 77: return "RIGHT";
+            case 71: return "HOME";
+            case 79: return "END";
+            case 73: return "PGUP";
+            case 81: return "PGDN";
+            case 82: return "INSERT";
+            case 83: return "DELETE";
+            case 133: return "F11";
+            case 134: return "F12";
+            case 59: case 60: case 61: case 62: case 63:
+            case 64: case 65: case 66: case 67: case 68:
+                return "F" + std::to_string(code - 58);
+        }
+        return "";
+    }
+    switch (ch) {
+        case '\r': return "ENTER";
+        case '\t': return "TAB";
+        case 8: return "BACKSPACE";
+        case 27: return "ESC";
+    }
+    return std::string(1, static_cast<char>(ch));
+#else
+    TerminalState& state = getTerminalState();
+    if (!state.keyReader) {
+        state.keyReader = std::make_unique<KeyReader>();
+        EventWait::instance().setKeySource(state.keyReader->descriptor());
+    }
+    Key key;
+    return state.keyReader->next(key, timeoutMs) ? key.text : "";
+#endif
+}
+
+void Terminal::stopReadingKeys() {
+#ifndef _WIN32
+    stopKeyReader(getTerminalState());
+#endif
+}
+
 std::string Terminal::getline(const std::string& prompt, Colour promptColour) {
+    stopReadingKeys();
     if (!prompt.empty()) {
         print(prompt, promptColour);
     }
@@ -487,4 +936,150 @@ void Terminal::setEcho(bool enabled) {
 #endif
 }
 
-} // namespace rbasic
\ No newline at end of file
+void Terminal::beginFrame() {
+    TerminalState& state = getTerminalState();
+    int rows, cols;
+    getSize(rows, cols);
+    rows = rows > 0 ? rows : 0;
+    cols = cols > 0 ? cols : 0;
+    if (rows != state.frameRows || cols != state.frameCols) {
+        state.frameRows = rows;
+        state.frameCols = cols;
+        state.shown.clear();
+    }
+    state.frame.assign(static_cast<size_t>(rows) * cols, FrameCell());
+}
+
+void Terminal::put(int row, int col, const std::string& text, Colour foreground, Colour background) {
+    TerminalState& state = getTerminalState();
+    int c = col;
+    for (size_t i = 0; i < text.size();) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        if (lead == '\n') {
+            ++row;
+            c = col;
+            ++i;
+            continue;
+        }
+        
+        FrameCell cell;
+        cell.foreground = static_cast<std::int8_t>(foreground);
+        cell.background = static_cast<std::int8_t>(background);
+        size_t size = lead < 0x80 ? 1 : lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+        if (lead >= 0x80 && (lead < 0xC0 || lead > 0xF7 || i + size > text.size())) {
+            cell.glyph[0] = '?';  // Not valid UTF-8
+            size = 1;
+        } else if (lead >= 0x20 && lead != 0x7F) {
+            std::memcpy(cell.glyph, text.data() + i, size);
+            cell.size = static_cast<std::uint8_t>(size);
+        }  // Other control characters stay blank cells
+        i += size;
+        
+        if (row >= 0 && row < state.frameRows && c >= 0 && c < state.frameCols) {
+            state.frame[static_cast<size_t>(row) * state.frameCols + c] = cell;
+        }
+        ++c;
+    }
+}
+
+// Writes out in full with one write where the terminal takes it all
+static void writeFrame(const std::string& out) {
+    std::cout.flush();
+#ifdef _WIN32
+    std::cout << out << std::flush;
+#else
+    size_t done = 0;
+    while (done < out.size()) {
+        ssize_t written = ::write(STDOUT_FILENO, out.data() + done, out.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        done += static_cast<size_t>(written);
+    }
+#endif
+}
+
+static void appendColours(std::string& out, int foreground, int background) {
+    // Reset first, as bright foregrounds are set with the bold attribute
+    out += "\033[0";
+    if (foreground >= 0) {
+        if (foreground >= 8) {
+            out += ";1";
+        }
+        out += ";" + std::to_string(30 + foreground % 8);
+    }
+    if (background >= 0) {
+        out += ";" + std::to_string(40 + background % 8);
+    }
+    out += "m";
+}
+
+void Terminal::endFrame() {
+    TerminalState& state = getTerminalState();
+    if (state.frame.empty()) {
+        return;
+    }
+    
+    std::string out;
+    if (state.shown.size() != state.frame.size()) {
+        out += "\033[0m\033[2J";
+        state.shown.assign(state.frame.size(), FrameCell());
+    }
+    
+    // Cursor position and colours as the output so far leaves them;
+    // -2 is not known
+    int cursorRow = -1;
+    int cursorCol = -1;
+    int foreground = -2;
+    int background = -2;
+    const int cols = state.frameCols;
+    for (int row = 0; row < state.frameRows; ++row) {
+        const FrameCell* line = &state.frame[static_cast<size_t>(row) * cols];
+        FrameCell* shownLine = &state.shown[static_cast<size_t>(row) * cols];
+        for (int col = 0; col < cols; ++col) {
+            const FrameCell& cell = line[col];
+            if (cell == shownLine[col]) {
+                continue;
+            }
+            
+            if (row != cursorRow || col != cursorCol) {
+                // Sending a few unchanged cells again is shorter than moving
+                // the cursor past them, if their colours are already set
+                bool resend = row == cursorRow && col > cursorCol && col - cursorCol <= 4;
+                for (int k = cursorCol; resend && k < col; ++k) {
+                    resend = !state.colourSupported ||
+                             (line[k].foreground == foreground && line[k].background == background);
+                }
+                if (resend) {
+                    for (int k = cursorCol; k < col; ++k) {
+                        out.append(line[k].glyph, line[k].size);
+                    }
+                } else {
+                    out += "\033[" + std::to_string(row + 1) + ";" + std::to_string(col + 1) + "H";
+                }
+            }
+            if (state.colourSupported && (cell.foreground != foreground || cell.background != background)) {
+                foreground = cell.foreground;
+                background = cell.background;
+                appendColours(out, foreground, background);
+            }
+            out.append(cell.glyph, cell.size);
+            shownLine[col] = cell;
+            cursorRow = row;
+            cursorCol = col + 1;
+        }
+    }
+    
+    if (out.empty()) {
+        return;
+    }
+    if (foreground != -2 && (foreground != -1 || background != -1)) {
+        out += "\033[0m";
+    }
+    writeFrame(out);
+}
+
+} // namespace rbasic
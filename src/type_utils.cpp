@@ -1,4 +1,5 @@
 #include "type_utils.h"
+#include "number_format.h"
 #include <sstream>
 #include <cmath>
 
@@ -7,73 +8,73 @@ namespace rbasic {
 namespace TypeUtils {
 
 int toInt(const ValueType& value) {
-    if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value);
-    } else if (std::holds_alternative<double>(value)) {
-        return static_cast<int>(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? 1 : 0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        const auto& str = std::get<std::string>(value);
-        try {
-            return std::stoi(str);
-        } catch (const std::exception&) {
+    if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value);
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return static_cast<int>(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? 1 : 0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        const auto& str = rbasic::get<std::string>(value);
+        int result = 0;
+        if (!NumberFormat::parseInt(str, result)) {
             throw ConversionError("Cannot convert string '" + str + "' to integer");
         }
+        return result;
     }
     throw ConversionError("Cannot convert value to integer");
 }
 
 double toDouble(const ValueType& value) {
-    if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return static_cast<double>(std::get<int>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? 1.0 : 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        const auto& str = std::get<std::string>(value);
-        try {
-            return std::stod(str);
-        } catch (const std::exception&) {
+    if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return static_cast<double>(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? 1.0 : 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        const auto& str = rbasic::get<std::string>(value);
+        double result = 0.0;
+        if (!NumberFormat::parseDouble(str, result)) {
             throw ConversionError("Cannot convert string '" + str + "' to double");
         }
+        return result;
     }
     throw ConversionError("Cannot convert value to double");
 }
 
 std::string toString(const ValueType& value) {
-    if (std::holds_alternative<std::string>(value)) {
-        return std::get<std::string>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::to_string(std::get<int>(value));
-    } else if (std::holds_alternative<double>(value)) {
-        return std::to_string(std::get<double>(value));
-    } else if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value) ? "true" : "false";
-    } else if (std::holds_alternative<ArrayValue>(value)) {
+    if (rbasic::holds_alternative<std::string>(value)) {
+        return rbasic::get<std::string>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return NumberFormat::formatInt(rbasic::get<int>(value));
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return NumberFormat::formatDouble(rbasic::get<double>(value));
+    } else if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value) ? "true" : "false";
+    } else if (rbasic::holds_alternative<ArrayValue>(value)) {
         return "[Array]";
-    } else if (std::holds_alternative<StructValue>(value)) {
+    } else if (rbasic::holds_alternative<StructValue>(value)) {
         return "[Struct]";
-    } else if (std::holds_alternative<ByteArrayValue>(value)) {
+    } else if (rbasic::holds_alternative<ByteArrayValue>(value)) {
         return "[ByteArray]";
-    } else if (std::holds_alternative<IntArrayValue>(value)) {
+    } else if (rbasic::holds_alternative<IntArrayValue>(value)) {
         return "[IntArray]";
-    } else if (std::holds_alternative<DoubleArrayValue>(value)) {
+    } else if (rbasic::holds_alternative<DoubleArrayValue>(value)) {
         return "[DoubleArray]";
     }
     return "[Unknown]";
 }
 
 bool toBool(const ValueType& value) {
-    if (std::holds_alternative<bool>(value)) {
-        return std::get<bool>(value);
-    } else if (std::holds_alternative<int>(value)) {
-        return std::get<int>(value) != 0;
-    } else if (std::holds_alternative<double>(value)) {
-        return std::get<double>(value) != 0.0;
-    } else if (std::holds_alternative<std::string>(value)) {
-        const auto& str = std::get<std::string>(value);
+    if (rbasic::holds_alternative<bool>(value)) {
+        return rbasic::get<bool>(value);
+    } else if (rbasic::holds_alternative<int>(value)) {
+        return rbasic::get<int>(value) != 0;
+    } else if (rbasic::holds_alternative<double>(value)) {
+        return rbasic::get<double>(value) != 0.0;
+    } else if (rbasic::holds_alternative<std::string>(value)) {
+        const auto& str = rbasic::get<std::string>(value);
         return !str.empty() && str != "false" && str != "0";
     }
     return false; // Arrays and structs are considered true if they exist
@@ -117,28 +118,32 @@ uint8_t getValue<uint8_t>(const ValueType& value) {
 }
 
 bool isNumeric(const ValueType& value) {
-    return std::holds_alternative<int>(value) || std::holds_alternative<double>(value);
+    return rbasic::holds_alternative<int>(value) || rbasic::holds_alternative<double>(value);
 }
 
 bool isArray(const ValueType& value) {
-    return std::holds_alternative<ArrayValue>(value);
+    return rbasic::holds_alternative<ArrayValue>(value);
 }
 
 bool isTypedArray(const ValueType& value) {
-    return std::holds_alternative<ByteArrayValue>(value) ||
-           std::holds_alternative<IntArrayValue>(value) ||
-           std::holds_alternative<DoubleArrayValue>(value);
+    return rbasic::holds_alternative<ByteArrayValue>(value) ||
+           rbasic::holds_alternative<IntArrayValue>(value) ||
+           rbasic::holds_alternative<DoubleArrayValue>(value);
 }
 
 size_t getArraySize(const ValueType& value) {
-    if (std::holds_alternative<ArrayValue>(value)) {
-        return std::get<ArrayValue>(value).elements.size();
-    } else if (std::holds_alternative<ByteArrayValue>(value)) {
-        return std::get<ByteArrayValue>(value).elements.size();
-    } else if (std::holds_alternative<IntArrayValue>(value)) {
-        return std::get<IntArrayValue>(value).elements.size();
-    } else if (std::holds_alternative<DoubleArrayValue>(value)) {
-        return std::get<DoubleArrayValue>(value).elements.size();
+    if (rbasic::holds_alternative<ArrayValue>(value)) {
+        return rbasic::get<ArrayValue>(value).elements.size();
+    } else if (rbasic::holds_alternative<ByteArrayValue>(value)) {
+        return rbasic::get<ByteArrayValue>(value).elements.size();
+    } else if (rbasic::holds_alternative<IntArrayValue>(value)) {
+        return rbasic::get<IntArrayValue>(value).elements.size();
+    } else if (rbasic::holds_alternative<DoubleArrayValue>(value)) {
+        return rbasic::get<DoubleArrayValue>(value).elements.size();
+    } else if (rbasic::holds_alternative<Vec3ArrayValue>(value)) {
+        return rbasic::get<Vec3ArrayValue>(value).elements.size();
+    } else if (rbasic::holds_alternative<Vec4ArrayValue>(value)) {
+        return rbasic::get<Vec4ArrayValue>(value).elements.size();
     }
     throw ConversionError("Value is not an array");
 }
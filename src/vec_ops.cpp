@@ -0,0 +1,163 @@
+#include "vec_ops.h"
+#include "array_ops.h"
+#include <cmath>
+
+// This file only sees floats, never glm::vec types, so enabling GLM's
+// intrinsics here does not change the layout of the vectors other files use.
+#ifndef GLM_FORCE_INTRINSICS
+#define GLM_FORCE_INTRINSICS
+#endif
+#include "glm/detail/setup.hpp"
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+#include "glm/simd/matrix.h"
+#define VEC_OPS_SSE 1
+#endif
+
+#ifdef _OPENMP
+// One vector per iteration, spread across threads once the array is large enough.
+// Every kernel names its element count 'n'.
+#define VEC_OPS_LOOP _Pragma("omp parallel for if(n > ArrayOps::PARALLEL_THRESHOLD)")
+#else
+#define VEC_OPS_LOOP
+#endif
+
+namespace rbasic {
+
+namespace VecOps {
+
+namespace {
+
+#ifdef VEC_OPS_SSE
+// Unaligned loads and stores: packed vec3s are only 4-byte aligned
+template<int Lanes>
+glm_vec4 load(const float* p, float w) {
+    if constexpr (Lanes == 4) {
+        return _mm_loadu_ps(p);
+    } else {
+        return _mm_set_ps(w, p[2], p[1], p[0]);
+    }
+}
+
+template<int Lanes>
+void store(float* p, glm_vec4 v) {
+    if constexpr (Lanes == 4) {
+        _mm_storeu_ps(p, v);
+    } else {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, v);
+        p[0] = lanes[0];
+        p[1] = lanes[1];
+        p[2] = lanes[2];
+    }
+}
+#endif
+
+} // anonymous namespace
+
+template<int Lanes>
+void transform(const float* m, const float* in, float* out, std::size_t n) {
+#ifdef VEC_OPS_SSE
+    const glm_vec4 columns[4] = {_mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12)};
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        store<Lanes>(out + i * Lanes, glm_mat4_mul_vec4(columns, load<Lanes>(in + i * Lanes, 1.0f)));
+    }
+#else
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const float* v = in + i * Lanes;
+        float w = Lanes == 4 ? v[Lanes - 1] : 1.0f;
+        float result[4];
+        for (int row = 0; row < 4; ++row) {
+            result[row] = m[row] * v[0] + m[4 + row] * v[1] + m[8 + row] * v[2] + m[12 + row] * w;
+        }
+        for (int lane = 0; lane < Lanes; ++lane) {
+            out[i * Lanes + lane] = result[lane];
+        }
+    }
+#endif
+}
+
+template<int Lanes>
+void rotate(const float* q, const float* in, float* out, std::size_t n) {
+    // v' = v + w * t + cross(u, t) with u = q.xyz and t = 2 * cross(u, v),
+    // the same expansion glm uses for quat * vec3
+    const float ux = q[0], uy = q[1], uz = q[2], qw = q[3];
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const float* v = in + i * Lanes;
+        float* r = out + i * Lanes;
+        float vx = v[0], vy = v[1], vz = v[2];
+        float tx = 2.0f * (uy * vz - uz * vy);
+        float ty = 2.0f * (uz * vx - ux * vz);
+        float tz = 2.0f * (ux * vy - uy * vx);
+        r[0] = vx + qw * tx + (uy * tz - uz * ty);
+        r[1] = vy + qw * ty + (uz * tx - ux * tz);
+        r[2] = vz + qw * tz + (ux * ty - uy * tx);
+        if constexpr (Lanes == 4) {
+            r[3] = v[3];
+        }
+    }
+}
+
+template<int Lanes>
+void normalize(const float* in, float* out, std::size_t n) {
+#ifdef VEC_OPS_SSE
+    // Full-precision sqrt and divide rather than glm_vec4_normalize's
+    // approximate reciprocal square root, so results match glm::normalize
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        glm_vec4 v = load<Lanes>(in + i * Lanes, 0.0f);
+        store<Lanes>(out + i * Lanes, _mm_div_ps(v, _mm_sqrt_ps(glm_vec4_dot(v, v))));
+    }
+#else
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        const float* v = in + i * Lanes;
+        float squared = 0.0f;
+        for (int lane = 0; lane < Lanes; ++lane) {
+            squared += v[lane] * v[lane];
+        }
+        float length = std::sqrt(squared);
+        for (int lane = 0; lane < Lanes; ++lane) {
+            out[i * Lanes + lane] = v[lane] / length;
+        }
+    }
+#endif
+}
+
+template<int Lanes>
+void dot(const float* a, const float* b, double* out, std::size_t n) {
+#ifdef VEC_OPS_SSE
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        glm_vec4 product = glm_vec4_dot(load<Lanes>(a + i * Lanes, 0.0f), load<Lanes>(b + i * Lanes, 0.0f));
+        out[i] = static_cast<double>(_mm_cvtss_f32(product));
+    }
+#else
+    VEC_OPS_LOOP
+    for (std::size_t i = 0; i < n; ++i) {
+        float sum = 0.0f;
+        for (int lane = 0; lane < Lanes; ++lane) {
+            sum += a[i * Lanes + lane] * b[i * Lanes + lane];
+        }
+        out[i] = static_cast<double>(sum);
+    }
+#endif
+}
+
+#define VEC_OPS_INSTANTIATE(Lanes) \
+    template void transform<Lanes>(const float*, const float*, float*, std::size_t); \
+    template void rotate<Lanes>(const float*, const float*, float*, std::size_t); \
+    template void normalize<Lanes>(const float*, float*, std::size_t); \
+    template void dot<Lanes>(const float*, const float*, double*, std::size_t);
+
+VEC_OPS_INSTANTIATE(3)
+VEC_OPS_INSTANTIATE(4)
+
+#undef VEC_OPS_INSTANTIATE
+
+} // namespace VecOps
+
+} // namespace rbasic
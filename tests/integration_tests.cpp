@@ -2,9 +2,25 @@
 #include "../include/parser.h"
 #include "../include/interpreter.h"
 #include "../include/io_handler.h"
+#include "../include/repl.h"
+#include "../include/number_format.h"
+#include "../runtime/basic_runtime.h"
 #include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cstdlib>
+#endif
 
 using namespace rbasic;
 
@@ -81,4 +97,1128 @@ void test_integration() {
         
         assert(output.str() == "Hello, World!\n");
     }
-}
\ No newline at end of file
+    
+    // Test whole-array operations on typed arrays
+    {
+        std::string code = R"(
+            var a = int_array(5);
+            a[0] = 5; a[1] = 3; a[2] = 9; a[3] = 1; a[4] = 7;
+            var b = int_array(5);
+            array_fill(b, 2);
+            print(array_sum(array_add(a, b)), array_dot(a, b), array_min(a), array_max(a));
+            array_axpy(3, b, a);
+            array_sort(a);
+            print(a[0], a[4]);
+            var p = array_prefix_sum(array_slice(a, 1, 3));
+            print(p[2]);
+            var big = int_array(3);
+            array_fill(big, 2000000000);
+            print(array_sum(big), array_dot(big, big) > 1000000000000000000.0);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "35 50 1 9\n7 15\n33\n6000000000 true\n");
+    }
+    
+    // Test string builtins (arguments are evaluated exactly once, left to right)
+    {
+        std::string code = R"(
+            var calls = 0;
+            function next() {
+                calls = calls + 1;
+                return calls;
+            }
+            print(mid("abcdef", next(), next()), calls);
+            var parts = split(trim("  a,b,,c  "), ",");
+            print(join(parts, "|"), instr("hello world", "o", 6));
+            print(upper(replace("x-y-z", "-", "+")), lower("ABC"), right("abc", -1) + left("abc", 2));
+            var s = "abc";
+            function swap() {
+                s = "zzz";
+                return "z";
+            }
+            var a = int_array(3);
+            function shrink() {
+                a = int_array(2);
+                return 7;
+            }
+            array_fill(a, shrink());
+            print(instr(s, swap()), s, len(a), a[1]);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "ab 2\na|b||c 8\nX+Y+Z abc ab\n0 zzz 2 7\n");
+    }
+    
+    // Test number formatting and parsing (shortest round-trip doubles)
+    {
+        std::string code = R"(
+            print(2.5, 0.1 + 0.2, 3.0, 500000.0, 1.0 / 4);
+            print(str(1.0 / 3.0), val("3.25") * 2, val("  42 apples"), val("abc"), val("1e3"));
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "2.5 0.30000000000000004 3 500000 0.25\n0.3333333333333333 6.5 42 0 1000\n");
+    }
+    
+    // Test float vector lanes print as written: 0.8f prints as 0.8, and storing it back keeps the same float
+    {
+        std::string code = R"(
+            var c = vec4(0.8, 0.6, 0.4, 1.0);
+            var n = normalize(vec3(3, 4, 0));
+            print(c.x, c.y, c.z, c.w, n.x, n.y, length(vec2(0.1, 0)), dot(c, vec4(1, 0, 0, 0)));
+            var d = vec2(0, 0);
+            d.x = c.x;
+            print(d.x == c.x, c.x * 10, str(c.y));
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "0.8 0.6 0.4 1 0.6 0.8 0.1 0.8\ntrue 8.00000011920929 0.6\n");
+        
+        // Generated C++ keeps the exact double; 1/1024 is a float too and keeps its exact text
+        assert(NumberFormat::doubleLiteral(static_cast<double>(0.8f)) == "0.800000011920929");
+        assert(NumberFormat::formatDouble(1.0 / 1024) == "0.0009765625");
+    }
+    
+    // Test binary save_array/load_array round trips
+    {
+        std::string dir = std::filesystem::temp_directory_path().string();
+        std::string doubles = dir + "/rbasic_test_doubles.rba";
+        std::string points = dir + "/rbasic_test_points.rba";
+        std::string code = R"(
+            struct Point { x, y, label };
+            var d = double_array(5);
+            for (var i = 0; i < 5; i = i + 1) { d[i] = i * 0.5; }
+            dim pts(3);
+            for (var i = 0; i < 3; i = i + 1) { pts[i] = Point { i, i * 2.5, "p" + str(i) }; }
+            print(save_array(")" + doubles + R"(", d), save_array(")" + points + R"(", pts));
+            var d2 = load_array(")" + doubles + R"(");
+            var p2 = load_array(")" + points + R"(");
+            print(d2[1], d2[4], array_sum(d2), p2[2].y, p2[1].label);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        std::filesystem::remove(doubles);
+        std::filesystem::remove(points);
+        
+        assert(output.str() == "true true\n0.5 2 5 5 p1\n");
+    }
+    
+    // Test save_array/load_array of struct arrays and vec3/vec4 arrays, read back by both modes
+    {
+        std::string dir = std::filesystem::temp_directory_path().string();
+        std::string particles = dir + "/rbasic_test_particles.rba";
+        std::string vec3s = dir + "/rbasic_test_vec3s.rba";
+        std::string vec4s = dir + "/rbasic_test_vec4s.rba";
+        std::string copy = dir + "/rbasic_test_particles_copy.rba";
+        std::string code = R"(
+            struct P { x, y, name };
+            dim ps(3) as P;
+            ps[0] = P { 1, 2.5, "a" };
+            ps[1] = P { 3, 4.5, "bb" };
+            ps[2].x = 7;
+            var vs = vec3_array(2);
+            vs[1] = vec3(0.1, 0.2, 0.3);
+            var ws = vec4_array(4);
+            ws[3] = vec4(1, 2, 3, 0.8);
+            print(save_array(")" + particles + R"(", ps), save_array(")" + vec3s + R"(", vs),
+                  save_array(")" + vec4s + R"(", ws));
+            var q = load_array(")" + particles + R"(");
+            var v2 = load_array(")" + vec3s + R"(");
+            var w2 = load_array(")" + vec4s + R"(");
+            print(len(q), q[0].x, q[1].y, q[1].name, q[2].x, len(v2), v2[1].x, v2[1].z, len(w2), w2[3].w);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "true true true\n3 1 4.5 bb 7 2 0.1 0.3 4 0.8\n");
+        
+        // The compiled runtime reads the same files, and writes them back the same way
+        BasicValue loaded = basic_runtime::load_array(particles);
+        [[maybe_unused]] bool saved = basic_runtime::save_array(copy, loaded);
+        assert(saved);
+        loaded = basic_runtime::load_array(copy);
+        [[maybe_unused]] const auto& structArray = rbasic::get<BasicStructArray>(loaded);
+        assert(structArray.typeName() == "P" && structArray.dimensions == std::vector<int>{3});
+        assert(structArray.column("x").ints() == (std::vector<int>{1, 3, 7}));
+        assert(structArray.column("y").doubles() == (std::vector<double>{2.5, 4.5, 0}));
+        assert(std::get<std::string>(structArray.column("name").get(1)) == "bb");
+        BasicValue vectors = basic_runtime::load_array(vec4s);
+        assert(rbasic::get<BasicVec4Array>(vectors).elements[3].w == 0.8f);
+        
+        for (const std::string& path : {particles, vec3s, vec4s, copy}) {
+            std::filesystem::remove(path);
+        }
+    }
+    // Test struct arrays with column storage
+    {
+        std::string code = R"(
+            struct Particle { x, vx, name };
+            dim ps(4) as Particle;
+            for (var i = 0; i < 4; i = i + 1) { ps[i] = Particle { i * 1.0, 0.5, "p" + str(i) }; }
+            ps[2].x = 10;
+            ps.x = array_add(ps.x, ps.vx);
+            var q = ps[1];
+            print(ps[2].x, ps[3].name, array_sum(ps.x), q.x, q.name);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "10.5 p3 16 1.5 p1\n");
+    }
+    
+    // Test fixed-layout struct field reads and in-place member writes
+    {
+        std::string code = R"(
+            struct Particle { x, v, name };
+            var p = Particle { 0.0, 1.5, "a" };
+            var q = p;
+            for (var i = 0; i < 4; i = i + 1) { p.x = p.x + p.v; }
+            q.name = "b";
+            function bump(s) { s.x = s.x + 100; return s.x; }
+            print(p.x, q.x, p.name, q.name, bump(p), p.x);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "6 0 a b 106 6\n");
+    }
+    
+    // Test whole-array GLM operations on packed vector arrays
+    {
+        std::string code = R"(
+            var pts = vec3_array(3);
+            pts[0] = vec3(1, 0, 0);
+            pts[1] = vec3(0, 2, 0);
+            pts[2] = vec3(0, 0, 3);
+            var moved = transform_points(mat4(1,0,0,0, 0,1,0,0, 0,0,1,0, 10,20,30,1), pts);
+            var turned = rotate_all(quat(0.70710678, 0, 0, 0.70710678), pts);
+            var unit = normalize_all(pts);
+            var d = dot_all(pts, unit);
+            var m = moved[1];
+            var t = turned[0];
+            var u = unit[2];
+            print(m.x, m.y, m.z, round(t.x), round(t.y), u.z, d[1], d[2]);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "10 22 30 0 1 1 2 3\n");
+    }
+    
+    // Test vector component writes in place and swizzle reads/writes
+    {
+        std::string code = R"(
+            var v = vec3(1, 2, 3);
+            v.x = v.x + 10;
+            v.zy = vec2(7, 8);
+            var s = v.zyx;
+            var pts = vec3_array(2);
+            pts[1].xz = vec2(4, 6);
+            pts[1].y = 5;
+            var q = pts[1].zyx;
+            print(v.x, v.y, v.z, s.x, s.z, q.x, q.y, q.z, vec4(1, 2, 3, 4).wz.x);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "11 8 7 7 11 6 5 4 4\n");
+    }
+    
+    // Test the --profile line and function timings
+    {
+        std::string code = R"(function square(n) {
+            var total = 0;
+            for (var i = 0; i < n; i = i + 1) { total = total + i * i; }
+            return total;
+        }
+        function twice(n) { return square(n) + square(n); }
+        print(twice(500));
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens), "prof.bas");
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Profiler profiler;
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.setProfiler(&profiler);
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        std::ostringstream report;
+        std::ostringstream stacks;
+        profiler.writeReport(report);
+        profiler.writeCollapsedStacks(stacks);
+        std::string text = report.str();
+        [[maybe_unused]] size_t squareRow = text.find("  square\n");
+        assert(output.str() == "83083500\n");
+        assert(squareRow != std::string::npos);
+        assert(text.substr(text.rfind('\n', squareRow) + 1, 10) == "         2");
+        assert(text.find("prof.bas:3\n") != std::string::npos);
+        assert(stacks.str().find("(main);twice;square ") != std::string::npos);
+    }
+    
+    // Test --coverage line, branch and call counters in lcov form
+    {
+        std::string code = R"(function classify(n) {
+            if (n > 5) { return 1; }
+            return 0;
+        }
+        function unused() { return 2; }
+        var big = 0;
+        for (var i = 0; i < 10; i = i + 1) { big = big + classify(i); }
+        print(big);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens), "cov.bas");
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Coverage coverage;
+        coverage.addProgram(*program);
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.setCoverage(&coverage);
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        std::ostringstream lcov;
+        coverage.writeLcov(lcov);
+        std::string info = lcov.str();
+        assert(output.str() == "4\n");
+        assert(info.find("SF:cov.bas\n") != std::string::npos);
+        assert(info.find("FNDA:10,classify\nFNDA:0,unused\n") != std::string::npos);
+        assert(info.find("BRDA:2,0,0,4\nBRDA:2,0,1,6\nBRDA:7,0,0,10\nBRDA:7,0,1,1\n") != std::string::npos);
+        assert(info.find("DA:3,6\nDA:5,1\n") != std::string::npos);
+        assert(info.find("LF:7\nLH:7\nend_of_record\n") != std::string::npos);
+    }
+    
+    // Test mem_stats() value bytes and --mem-report allocations by line
+    {
+        std::string code = R"(function pad(n) { return n + 1; }
+        var text = "";
+        for (var i = 0; i < 50; i = i + 1) { text = text + "0123456789"; }
+        var data = double_array(1000);
+        var m = mem_stats();
+        print(m.string_bytes >= 500, m.array_bytes >= 8000, m.allocations > 0, m.functions, m.function_statements);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens), "mem.bas");
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        MemoryTracker tracker;
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.setMemoryTracker(&tracker);
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        std::ostringstream report;
+        tracker.writeReport(report, interpreter.liveValueBytes(), interpreter.retainedCode());
+        std::string text = report.str();
+        [[maybe_unused]] size_t loopRow = text.find("  mem.bas:3\n");
+        assert(output.str() == "true true true 1 1\n");
+        assert(loopRow != std::string::npos);
+        assert(text.substr(loopRow - 12, 12) == "          51");  // The loop and its 50 body runs
+        assert(text.find("         1            1  mem.bas\n") != std::string::npos);
+    }
+    
+    // Test in-place array writes, pooled temporaries and single argument evaluation
+    {
+        std::string code = R"(var a = int_array(100);
+        var idx = int_array(100);
+        dim names(3);
+        names[0] = "a";
+        var x = 10;
+        function bump() { x = x + 1; return 1; }
+        function noisy(v) { print("arg", v); return v; }
+        function twice(v) { return v * 2; }
+        for (var i = 0; i < 100; i = i + 1) { idx[i] = 99 - i; }
+        var before = mem_stats().allocations;
+        for (var i = 0; i < 1000; i = i + 1) { a[idx[i mod 100]] = a[(i + 1) mod 100] + i * 2; }
+        var used = mem_stats().allocations - before;
+        names[1] = names[0] + "b";
+        print(a[0], a[99], used < 20, names[1], x + bump(), x, twice(noisy(3)));
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        // x + bump() reads x before the call; noisy(3) runs once
+        assert(output.str() == "10980 17964 true ab 11 11 arg 3\n6\n");
+    }
+    
+    // Test --trace-slow: slow statements and builtin and user function calls with position, stack and arguments
+    {
+        std::string code = R"(function wait(ms) {
+            sleep(ms);
+        }
+        var pause = 30;
+        wait(pause);
+        print("done");
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens), "slow.bas");
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        std::ostringstream log;
+        Interpreter interpreter(createIOHandler("console"));
+        {
+            SlowTrace trace(log, 20);
+            interpreter.setSlowTrace(&trace);
+            interpreter.interpret(*program);
+            interpreter.setSlowTrace(nullptr);
+        }
+        
+        std::cout.rdbuf(old_cout);
+        
+        std::string text = log.str();
+        assert(output.str() == "done\n");
+        assert(text.find("slow.bas:2  (main) > wait  sleep(ms=30)\n") != std::string::npos);
+        assert(text.find("slow.bas:2  (main) > wait\n") != std::string::npos);
+        assert(text.find("slow.bas:5  (main)  wait(pause=30)\n") != std::string::npos);
+        assert(text.find("slow.bas:5  (main)\n") != std::string::npos);
+        assert(text.find("slow.bas:6") == std::string::npos);
+    }
+    
+#ifdef SQLITE3_SUPPORT_ENABLED
+    // Test sqlite_exec_batch and the statement cache behind sqlite_exec
+    {
+        std::string code = R"BAS(var db = sqlite_open(":memory:");
+        sqlite_exec(db, "CREATE TABLE t (id INTEGER PRIMARY KEY, v REAL, tag TEXT)");
+        var ids = int_array(4);
+        var vs = double_array(4);
+        var tags[4];
+        for (var i = 0; i < 4; i = i + 1) {
+            ids[i] = i + 1;
+            vs[i] = i * 0.5;
+            tags[i] = "t" + str(i);
+        }
+        var rows = sqlite_exec_batch(db, "INSERT INTO t VALUES (?, ?, ?)", ids, vs, tags);
+        var failed = sqlite_exec_batch(db, "INSERT INTO t VALUES (?, ?, ?)", ids, vs, tags);
+        var error = sqlite_errmsg(db);
+        for (var k = 0; k < 3; k = k + 1) {
+            sqlite_exec(db, "UPDATE t SET v = v + 1 WHERE id = 1");
+        }
+        var st = sqlite_prepare(db, "SELECT count(*), sum(v), max(tag) FROM t");
+        sqlite_step(st);
+        print(rows, failed, error);
+        print(sqlite_column_int(st, 0), sqlite_column_double(st, 1), sqlite_column_text(st, 2));
+        sqlite_finalize(st);
+        sqlite_close(db);
+        )BAS";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "4 -1 UNIQUE constraint failed: t.id\n4 6 t3\n");
+    }
+    
+    // Test sqlite_fetch_all / sqlite_fetch_columns: typed columns, chunks and len of arrays
+    {
+        std::string code = R"BAS(var db = sqlite_open(":memory:");
+        sqlite_exec(db, "CREATE TABLE t (id INTEGER, v REAL, tag TEXT)");
+        sqlite_exec(db, "INSERT INTO t VALUES (1, 0.5, 'a'), (2, 1.5, 'b'), (3, 2, NULL)");
+        var st = sqlite_prepare(db, "SELECT id, v, tag, id * 2 AS twice FROM t ORDER BY id");
+        var rows = sqlite_fetch_all(st);
+        print(len(rows), array_sum(rows.id), array_sum(rows.v), rows[1].tag, rows[2].tag, array_sum(rows.twice));
+        sqlite_reset(st);
+        var sizes = "";
+        var chunk = sqlite_fetch_columns(st, 2);
+        while (len(chunk) > 0) {
+            sizes = sizes + str(len(chunk)) + ":" + str(chunk[0].id) + " ";
+            chunk = sqlite_fetch_columns(st, 2);
+        }
+        print(sizes + str(len(int_array(5))));
+        sqlite_finalize(st);
+        sqlite_close(db);
+        )BAS";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "3 6 4 b 0 12\n2:1 1:3 5\n");
+    }
+    
+    // Test sqlite_async / sqlite_flush: queued writes, a failure reported at the flush, reads after it
+    {
+        std::string path = std::filesystem::temp_directory_path().string() + "/rbasic_test_async.db";
+        std::filesystem::remove(path);
+        std::string code = R"BAS(var db = sqlite_open(")BAS" + path + R"BAS(");
+        sqlite_exec(db, "CREATE TABLE t (id INTEGER)");
+        var started = sqlite_async(db, 64, 5, "normal");
+        for (var i = 0; i < 500; i = i + 1) {
+            sqlite_exec(db, "INSERT INTO t VALUES (" + str(i) + ")");
+        }
+        sqlite_exec(db, "INSERT INTO nope VALUES (1)");
+        var flushed = sqlite_flush(db);
+        print(started, flushed, sqlite_errmsg(db), sqlite_flush(db));
+        var st = sqlite_prepare(db, "SELECT count(*), sum(id) FROM t");
+        sqlite_step(st);
+        print(sqlite_column_int(st, 0), sqlite_column_int(st, 1));
+        sqlite_finalize(st);
+        sqlite_close(db);
+        var mem = sqlite_open(":memory:");
+        print(sqlite_async(mem, 64, 5));
+        sqlite_close(mem);
+        )BAS";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + "-wal");
+        std::filesystem::remove(path + "-shm");
+        
+        assert(output.str() == "0 1 no such table: nope 0\n500 124750\n21\n");
+    }
+    
+    // Test sqlite_async with the script's own transactions: BEGIN/COMMIT/ROLLBACK pass through the writer
+    {
+        std::string path = std::filesystem::temp_directory_path().string() + "/rbasic_test_async_tx.db";
+        std::filesystem::remove(path);
+        std::string code = R"BAS(var db = sqlite_open(")BAS" + path + R"BAS(");
+        sqlite_exec(db, "CREATE TABLE t (id INTEGER)");
+        sqlite_async(db, 4, 1000);
+        sqlite_exec(db, "INSERT INTO t VALUES (1)");
+        sqlite_exec(db, "BEGIN");
+        for (var i = 2; i <= 10; i = i + 1) {
+            sqlite_exec(db, "INSERT INTO t VALUES (" + str(i) + ")");
+        }
+        sqlite_exec(db, "COMMIT");
+        sqlite_exec(db, "begin");
+        sqlite_exec(db, "INSERT INTO t VALUES (100)");
+        sqlite_exec(db, "ROLLBACK");
+        sqlite_exec(db, "SAVEPOINT s");
+        sqlite_exec(db, "INSERT INTO t VALUES (11)");
+        sqlite_exec(db, "RELEASE s");
+        sqlite_exec(db, "INSERT INTO t VALUES (12); COMMIT");
+        sqlite_exec(db, "INSERT INTO t VALUES (13)");
+        var flushed = sqlite_flush(db);
+        var st = sqlite_prepare(db, "SELECT count(*), sum(id) FROM t");
+        sqlite_step(st);
+        print(flushed, sqlite_column_int(st, 0), sqlite_column_int(st, 1));
+        sqlite_finalize(st);
+        sqlite_close(db);
+        )BAS";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + "-wal");
+        std::filesystem::remove(path + "-shm");
+        
+        assert(output.str() == "0 13 91\n");
+    }
+#endif
+    
+#ifndef _WIN32
+    // Test terminal frames: rendered to a 3x10 pty, each frame sends only the cells that changed
+    {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        [[maybe_unused]] bool unlocked = master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0;
+        assert(unlocked);
+        int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+        assert(slave >= 0);
+        struct termios raw;
+        tcgetattr(slave, &raw);
+        cfmakeraw(&raw);
+        tcsetattr(slave, TCSANOW, &raw);
+        struct winsize size = {};
+        size.ws_row = 3;
+        size.ws_col = 10;
+        ioctl(slave, TIOCSWINSZ, &size);
+        
+        auto run = [&](const std::string& code) {
+            Lexer lexer(code);
+            Parser parser(lexer.tokenize());
+            auto program = parser.parse();
+            std::cout.flush();
+            int savedStdout = dup(STDOUT_FILENO);
+            dup2(slave, STDOUT_FILENO);
+            Interpreter interpreter(createIOHandler("console"));
+            interpreter.interpret(*program);
+            std::cout.flush();
+            dup2(savedStdout, STDOUT_FILENO);
+            close(savedStdout);
+            
+            std::string written;
+            char buffer[256];
+            struct pollfd ready = {master, POLLIN, 0};
+            while (poll(&ready, 1, 50) > 0) {
+                ssize_t n = read(master, buffer, sizeof(buffer));
+                if (n <= 0) {
+                    break;
+                }
+                written.append(buffer, static_cast<size_t>(n));
+            }
+            return written;
+        };
+        
+        // Starts the terminal afresh on the pty, so colours are on
+        run("terminal_cleanup(); terminal_init();");
+        std::string first = run(R"(terminal_begin_frame(); terminal_put(0, 0, "hello"); terminal_put(1, 2, "ab", 1);
+            terminal_end_frame();)");
+        std::string second = run(R"(terminal_begin_frame(); terminal_put(0, 0, "help"); terminal_put(1, 2, "ab", 1);
+            terminal_end_frame();)");
+        std::string same = run(R"(terminal_begin_frame(); terminal_put(0, 0, "help"); terminal_put(1, 2, "ab", 1);
+            terminal_end_frame();)");
+        std::string gap = run(R"(terminal_begin_frame(); terminal_put(0, 0, "xelpx"); terminal_put(1, 2, "ab", 1);
+            terminal_put(2, 8, "long line"); terminal_end_frame();)");
+        close(slave);
+        close(master);
+        
+        assert(first == "\033[0m\033[2J\033[1;1H\033[0mhello\033[2;3H\033[0;31mab\033[0m");
+        assert(second == "\033[1;4H\033[0mp ");
+        assert(same.empty());
+        assert(gap == "\033[1;1H\033[0mxelpx\033[3;9Hlo");
+    }
+#endif
+    
+#if defined(SDL2_SUPPORT_ENABLED) && !defined(_WIN32)
+    // Test batched SDL primitives and draw lists on a software renderer with the dummy video driver
+    {
+        setenv("SDL_VIDEODRIVER", "dummy", 1);
+        std::string code = R"(
+            sdl_init(32);
+            var window = sdl_create_window("batch", 0, 0, 64, 64, 8);
+            var renderer = sdl_create_renderer(window, -1, 1);
+            var xs = int_array(3);
+            var ys = double_array(3);
+            var sizes[3];
+            for (var i = 0; i < 3; i = i + 1) {
+                xs[i] = i * 10;
+                ys[i] = i * 5.5;
+                sizes[i] = 4;
+            }
+            print(sdl_render_draw_points(renderer, xs, ys), sdl_render_fill_rects(renderer, xs, ys, sizes, sizes));
+            var scene = sdl_draw_list_create();
+            sdl_draw_list_set_color(scene, 255, 0, 0, 255);
+            sdl_draw_list_points(scene, xs, ys);
+            sdl_draw_list_fill_rects(scene, xs, ys, sizes, sizes);
+            print(sdl_draw_list_replay(scene, renderer), sdl_draw_list_replay(scene, 99));
+            sdl_draw_list_destroy(scene);
+            sdl_quit();
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "0 0\n0 -1\n");
+    }
+#endif
+    
+    // Test software framebuffers written as BMP and PPM files
+    {
+        std::string dir = std::filesystem::temp_directory_path().string();
+        std::string bmp = dir + "/rbasic_test_fb.bmp";
+        std::string ppm = dir + "/rbasic_test_fb.ppm";
+        std::string code = R"(
+            var fb = framebuffer(2, 2);
+            fb[0, 1, 0] = 255;
+            fb[1, 0, 2] = 128;
+            var img = int_array(1, 2);
+            img[0, 1] = 65280;
+            print(save_image(")" + bmp + R"(", fb), save_image(")" + ppm + R"(", img), array_sum(fb));
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        auto readFile = [](const std::string& path) {
+            std::ifstream file(path, std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        };
+        std::string bmpBytes = readFile(bmp);
+        std::string ppmBytes = readFile(ppm);
+        std::filesystem::remove(bmp);
+        std::filesystem::remove(ppm);
+        
+        assert(output.str() == "true true 1403\n");
+        // 54-byte header, then rows bottom up as B, G, R, A
+        assert(bmpBytes.size() == 54 + 16 && bmpBytes.compare(0, 2, "BM") == 0);
+        assert(bmpBytes.substr(54) == std::string("\x80\0\0\xff\0\0\0\xff\0\0\0\xff\0\0\xff\xff", 16));
+        assert(ppmBytes == std::string("P6\n2 1\n255\n\0\0\0\0\xff\0", 17));
+    }
+    
+    // Test wait_event with the event timer and a watched file
+    {
+        std::string path = std::filesystem::temp_directory_path().string() + "/rbasic_test_watch.txt";
+        std::string code = R"(
+            print(event_timer(10), wait_event(1000), event_timer(0), wait_event(20));
+            write_text_file(")" + path + R"(", "a");
+            print(event_watch_file(")" + path + R"("));
+            write_text_file(")" + path + R"(", "b");
+            print(wait_event(1000));
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+#ifdef __linux__
+        // Whatever the test runner left on stdin must not be reported as a key
+        int savedStdin = dup(STDIN_FILENO);
+        int devNull = open("/dev/null", O_RDONLY);
+        dup2(devNull, STDIN_FILENO);
+#endif
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        std::filesystem::remove(path);
+        
+#ifdef __linux__
+        dup2(savedStdin, STDIN_FILENO);
+        close(savedStdin);
+        close(devNull);
+        assert(output.str() == "true timer true timeout\ntrue\nfile\n");
+#else
+        assert(output.str().compare(0, 24, "true timer true timeout\n") == 0);
+#endif
+    }
+    
+#ifndef _WIN32
+    // Test terminal_read_key: keys typed on a pty arrive decoded, and cleanup leaves line mode on
+    {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        [[maybe_unused]] bool unlocked = master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0;
+        assert(unlocked);
+        int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+        assert(slave >= 0);
+        
+        std::string code = R"(
+            var keys = terminal_read_key(0) + ",";
+            for (var i = 0; i < 7; i = i + 1) {
+                keys = keys + terminal_read_key(2000) + ",";
+            }
+            print(keys + terminal_read_key(0));
+            terminal_cleanup();
+        )";
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        int savedStdin = dup(STDIN_FILENO);
+        dup2(slave, STDIN_FILENO);
+        std::thread typist([master] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const char keys[] = "a\033[A\033OP\033[15~\r\xc3\xa9\033";
+            ssize_t written = write(master, keys, sizeof(keys) - 1);
+            assert(written == static_cast<ssize_t>(sizeof(keys) - 1));
+            (void)written;
+        });
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        typist.join();
+        dup2(savedStdin, STDIN_FILENO);
+        close(savedStdin);
+        
+        struct termios mode;
+        tcgetattr(slave, &mode);
+        close(slave);
+        close(master);
+        
+        // terminal_cleanup's attribute resets follow
+        const std::string keys = ",a,UP,F1,F5,ENTER,\xc3\xa9,ESC,\n";
+        assert(output.str().compare(0, keys.size(), keys) == 0);
+        assert((mode.c_lflag & (ICANON | ECHO)) == (ICANON | ECHO));
+    }
+    
+    // Test terminal_read_key then input: input stops the key reader, so lines are echoed and read whole
+    {
+        int master = posix_openpt(O_RDWR | O_NOCTTY);
+        [[maybe_unused]] bool unlocked = master >= 0 && grantpt(master) == 0 && unlockpt(master) == 0;
+        assert(unlocked);
+        int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+        assert(slave >= 0);
+        
+        std::string code = R"(
+            var key = terminal_read_key(2000);
+            var first = input();
+            var second = input();
+            print(key + "," + first + "," + second);
+        )";
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        int savedStdin = dup(STDIN_FILENO);
+        dup2(slave, STDIN_FILENO);
+        std::cin.clear();
+        std::thread typist([master] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            ssize_t written = write(master, "x", 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            written += write(master, "hello\nworld\n", 12);
+            assert(written == 13);
+            (void)written;
+        });
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        typist.join();
+        dup2(savedStdin, STDIN_FILENO);
+        close(savedStdin);
+        
+        // What the terminal echoed back
+        std::string echoed;
+        fcntl(master, F_SETFL, O_NONBLOCK);
+        char buffer[256];
+        for (ssize_t got; (got = read(master, buffer, sizeof(buffer))) > 0;) {
+            echoed.append(buffer, static_cast<size_t>(got));
+        }
+        struct termios mode;
+        tcgetattr(slave, &mode);
+        close(slave);
+        close(master);
+        
+        assert(output.str() == "x,hello,world\n");
+        assert(echoed.find("hello") != std::string::npos && echoed.find('x') == std::string::npos);
+        assert((mode.c_lflag & (ICANON | ECHO)) == (ICANON | ECHO));
+    }
+#endif
+    
+    // Test the REPL: a definition typed over several lines, a string spanning lines, :time, :bench and :list
+    {
+        std::istringstream input("function sq(x)\n{\n    return x * x;\n}\nvar s = \"a\nb\";\n"
+                                 ":time print(sq(5));\n:bench 3 print(sq(2));\n:list\n");
+        std::ostringstream output;
+        std::streambuf* old_cin = std::cin.rdbuf(input.rdbuf());
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        REPL repl;
+        repl.run();
+        
+        std::cout.rdbuf(old_cout);
+        std::cin.rdbuf(old_cin);
+        std::cin.clear();
+        
+        const std::string text = output.str();
+        assert(text.find("25\n") != std::string::npos);
+        assert(text.find("Time: ") != std::string::npos);
+        assert(text.find("4\n4\n4\n") != std::string::npos);
+        assert(text.find("3 runs: mean ") != std::string::npos);
+        assert(text.find("function sq") != std::string::npos);
+        assert(text.find("variable s = a b") != std::string::npos);
+        assert(text.find("Error") == std::string::npos);
+    }
+    
+    // Test --watch: saving an imported file swaps in its functions while globals keep their values
+    {
+        std::string path = std::filesystem::temp_directory_path().string() + "/rbasic_test_reload.bas";
+        {
+            std::ofstream lib(path);
+            lib << "function f() { return 1; }\n";
+        }
+        std::string code = R"(
+            import ")" + path + R"(";
+            var state = 41;
+            var before = f();
+            write_text_file(")" + path + R"(", "function f() { return state + 1; }");
+            var after = f();
+            var waited = 0;
+            while (after == 1 and waited < 400) {
+                sleep_ms(5);
+                after = f();
+                waited = waited + 1;
+            }
+            print(before, after);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::ostringstream errors;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        std::streambuf* old_cerr = std::cerr.rdbuf(errors.rdbuf());
+        
+        HotReload hotReload;
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.setHotReload(&hotReload);
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        std::cerr.rdbuf(old_cerr);
+        std::filesystem::remove(path);
+        
+        assert(output.str() == "1 42\n");
+        assert(errors.str() == "watch: reloaded 1 function(s) from " + path + "\n");
+    }
+    
+    // Test the 16-byte values: copies share an array or long string until one of them is written
+    {
+        static_assert(sizeof(ValueType) == 16, "interpreter values are 16 bytes");
+        static_assert(sizeof(BasicValue) == 16, "compiled runtime values are 16 bytes");
+        
+        ValueType ints = IntArrayValue({3});
+        ValueType intsCopy = ints;
+        rbasic::get<IntArrayValue>(ints).elements[0] = 5;
+        assert(rbasic::get<IntArrayValue>(intsCopy).elements[0] == 0);
+        assert(ints.boxBytes() > 0 && ValueType(7).boxBytes() == 0);
+        
+        BasicValue text = std::string(40, 'x');
+        BasicValue textCopy = text;
+        rbasic::get<std::string>(text)[0] = 'y';
+        assert(textCopy.text() == std::string(40, 'x') && text.text()[0] == 'y');
+        BasicValue shortText = std::string("short");
+        assert(shortText.boxBytes() == 0 && shortText.text() == "short");
+        
+        std::string code = R"(
+            var a = int_array(3);
+            a[0] = 5;
+            var b = a;
+            a[0] = 1;
+            function fill(arr) { arr[1] = 9; return arr[1]; }
+            var r = fill(a);
+            var v = vec3(1, 2, 3);
+            var w = v;
+            v.x = 7;
+            var s = "a string longer than fourteen";
+            var t = s;
+            s = s + "!";
+            var short = "short";
+            var copy = short;
+            short = short + "er";
+            print(a[0], a[1], b[0], r, w.x, v.x, len(t), len(s), copy, short);
+        )";
+        
+        Lexer lexer(code);
+        auto tokens = lexer.tokenize();
+        Parser parser(std::move(tokens));
+        auto program = parser.parse();
+        
+        std::ostringstream output;
+        std::streambuf* old_cout = std::cout.rdbuf(output.rdbuf());
+        
+        Interpreter interpreter(createIOHandler("console"));
+        interpreter.interpret(*program);
+        
+        std::cout.rdbuf(old_cout);
+        
+        assert(output.str() == "1 0 5 9 1 7 29 30 short shorter\n");
+    }
+}
@@ -25,7 +25,7 @@ void test_lexer() {
         Lexer lexer("print(\"Hello, World!\");");
         auto tokens = lexer.tokenize();
         
-        assert(tokens.size() == 6); // print, (, "Hello, World!", ), ;, EOF
+        assert(tokens.size() == 5); // print, (, "Hello, World!", ), ;
         assert(tokens[0].type == TokenType::IDENTIFIER);
         assert(tokens[0].value == "print");
         assert(tokens[1].type == TokenType::LEFT_PAREN);
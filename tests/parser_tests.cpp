@@ -20,7 +20,7 @@ void test_parser() {
         (void)varStmt; // Suppress unused variable warning
     }
     
-    // Test print statement
+    // Test print call (print is a built-in function, parsed as a call expression)
     {
         Lexer lexer("print(\"Hello\");");
         auto tokens = lexer.tokenize();
@@ -28,10 +28,13 @@ void test_parser() {
         auto program = parser.parse();
         
         assert(program->statements.size() == 1);
-        auto printStmt = dynamic_cast<PrintStmt*>(program->statements[0].get());
-        assert(printStmt != nullptr);
-        assert(printStmt->expressions.size() == 1);
-        (void)printStmt; // Suppress unused variable warning
+        auto exprStmt = dynamic_cast<ExpressionStmt*>(program->statements[0].get());
+        assert(exprStmt != nullptr);
+        auto callExpr = dynamic_cast<CallExpr*>(exprStmt->expression.get());
+        assert(callExpr != nullptr);
+        assert(callExpr->name == "print");
+        assert(callExpr->arguments.size() == 1);
+        (void)callExpr; // Suppress unused variable warning
     }
     
     // Test binary expression